@@ -0,0 +1,129 @@
+/*
+ * Copyright 2024 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "apps.h"
+#include "progs.h"
+#include <openssl/err.h>
+#include <openssl/x509_vfy.h>
+
+typedef enum OPTION_choice {
+    OPT_COMMON,
+    OPT_OUT,
+    OPT_PROV_ENUM
+} OPTION_CHOICE;
+
+const OPTIONS snapshot_options[] = {
+    {OPT_HELP_STR, 1, '-', "Usage: %s [options] file...\n"},
+
+    OPT_SECTION("General"),
+    {"help", OPT_HELP, '-', "Display this summary"},
+
+    OPT_SECTION("Output"),
+    {"out", OPT_OUT, '>', "Output file"},
+
+    OPT_PROV_OPTIONS,
+
+    OPT_PARAMETERS(),
+    {"file", 0, 0, "Files of PEM certificates and CRLs to include"},
+    {NULL}
+};
+
+int snapshot_main(int argc, char **argv)
+{
+    BIO *out = NULL;
+    X509_STORE *store = NULL;
+    X509_LOOKUP *lookup;
+    OPTION_CHOICE o;
+    int ret = 1, i;
+    char *outfile = NULL, *tmpfile = NULL, *prog;
+
+    prog = opt_init(argc, argv, snapshot_options);
+    while ((o = opt_next()) != OPT_EOF) {
+        switch (o) {
+        case OPT_EOF:
+        case OPT_ERR:
+ opthelp:
+            BIO_printf(bio_err, "%s: Use -help for summary.\n", prog);
+            goto end;
+        case OPT_HELP:
+            ret = 0;
+            opt_help(snapshot_options);
+            goto end;
+        case OPT_OUT:
+            outfile = opt_arg();
+            break;
+        case OPT_PROV_CASES:
+            if (!opt_provider(o))
+                goto end;
+            break;
+        }
+    }
+
+    /* At least one input file is required. */
+    argc = opt_num_rest();
+    argv = opt_rest();
+    if (argc == 0)
+        goto opthelp;
+
+    if ((store = X509_STORE_new()) == NULL
+            || (lookup = X509_STORE_add_lookup(store,
+                                               X509_LOOKUP_file())) == NULL)
+        goto end;
+    for (i = 0; i < argc; i++) {
+        if (X509_load_cert_crl_file_ex(lookup, argv[i], X509_FILETYPE_PEM,
+                                       app_get0_libctx(),
+                                       app_get0_propq()) <= 0) {
+            BIO_printf(bio_err, "%s: Error loading file %s\n", prog, argv[i]);
+            goto end;
+        }
+    }
+
+    /*
+     * Snapshots are memory mapped by the processes using them, so never
+     * rewrite one in place: write a new file and rename it over the old one.
+     */
+    if (outfile != NULL) {
+        size_t len = strlen(outfile) + sizeof(".tmp");
+
+        tmpfile = app_malloc(len, "temporary file name");
+        BIO_snprintf(tmpfile, len, "%s.tmp", outfile);
+    }
+    out = bio_open_default(tmpfile, 'w', FORMAT_BINARY);
+    if (out == NULL)
+        goto end;
+    if (!X509_STORE_write_snapshot(store, out) || BIO_flush(out) <= 0) {
+        BIO_printf(bio_err, "%s: Error writing snapshot\n", prog);
+        goto end;
+    }
+    if (tmpfile != NULL) {
+        BIO_free_all(out);
+        out = NULL;
+#ifdef _WIN32
+        /* rename() doesn't replace an existing file on Windows */
+        remove(outfile);
+#endif
+        if (rename(tmpfile, outfile) != 0) {
+            BIO_printf(bio_err, "%s: Error renaming %s to %s\n", prog,
+                       tmpfile, outfile);
+            goto end;
+        }
+    }
+    ret = 0;
+ end:
+    if (ret != 0)
+        ERR_print_errors(bio_err);
+    BIO_free_all(out);
+    if (ret != 0 && tmpfile != NULL)
+        remove(tmpfile);
+    OPENSSL_free(tmpfile);
+    X509_STORE_free(store);
+    return ret;
+}
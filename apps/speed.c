@@ -251,7 +251,8 @@ const OPTIONS speed_options[] = {
     OPT_SECTION("General"),
     {"help", OPT_HELP, '-', "Display this summary"},
     {"mb", OPT_MB, '-',
-     "Enable (tls1>=1) multi-block mode on EVP-named cipher"},
+     "Enable (tls1>=1) multi-block mode on EVP-named cipher or batch mode on"
+     " EVP-named digest"},
     {"mr", OPT_MR, '-', "Produce machine readable output"},
 #ifndef NO_FORK
     {"multi", OPT_MULTI, 'p', "Run benchmarks in parallel"},
@@ -482,9 +483,10 @@ static double ecdh_results[EC_NUM][1];      /* 1 op: derivation */
 static double ecdsa_results[ECDSA_NUM][2];  /* 2 ops: sign then verify */
 
 #ifndef OPENSSL_NO_ECX
-enum { R_EC_Ed25519, R_EC_Ed448, EdDSA_NUM };
+enum { R_EC_Ed25519, R_EC_Ed25519_PRECOMP, R_EC_Ed448, EdDSA_NUM };
 static const OPT_PAIR eddsa_choices[EdDSA_NUM] = {
     {"ed25519", R_EC_Ed25519},
+    {"ed25519-precomp", R_EC_Ed25519_PRECOMP},
     {"ed448", R_EC_Ed448}
 
 };
@@ -638,6 +640,42 @@ static int EVP_Digest_md_loop(void *args)
     return EVP_Digest_loop(evp_md_name, D_EVP, args);
 }
 
+/* Number of equally sized messages hashed per EVP_DigestBatch() call */
+#define DIGEST_BATCH_NUM 16
+
+static int EVP_Digest_batch_loop(void *args)
+{
+    loopargs_t *tempargs = *(loopargs_t **) args;
+    unsigned char digest[DIGEST_BATCH_NUM][EVP_MAX_MD_SIZE];
+    const unsigned char *in[DIGEST_BATCH_NUM];
+    size_t inlen[DIGEST_BATCH_NUM];
+    unsigned char *out[DIGEST_BATCH_NUM];
+    int count, i, mdlen;
+    EVP_MD *md = NULL;
+
+    if (!opt_md_silent(evp_md_name, &md))
+        return -1;
+    mdlen = EVP_MD_get_size(md);
+    if (mdlen <= 0 || mdlen > EVP_MAX_MD_SIZE) {
+        EVP_MD_free(md);
+        return -1;
+    }
+    for (i = 0; i < DIGEST_BATCH_NUM; i++) {
+        in[i] = tempargs->buf;
+        inlen[i] = (size_t)lengths[testnum];
+        out[i] = digest[i];
+    }
+    for (count = 0; COND(c[D_EVP][testnum]); count += DIGEST_BATCH_NUM) {
+        if (!EVP_DigestBatch(md, DIGEST_BATCH_NUM, in, inlen, out,
+                             (size_t)mdlen)) {
+            count = -1;
+            break;
+        }
+    }
+    EVP_MD_free(md);
+    return count;
+}
+
 static int EVP_Digest_MD2_loop(void *args)
 {
     return EVP_Digest_loop("md2", D_MD2, args);
@@ -1860,6 +1898,7 @@ int speed_main(int argc, char **argv)
     static const EC_CURVE ed_curves[EdDSA_NUM] = {
         /* EdDSA */
         {"Ed25519", NID_ED25519, 253, 64},
+        {"Ed25519-precomp", NID_ED25519, 253, 64},
         {"Ed448", NID_ED448, 456, 114}
     };
 #endif /* OPENSSL_NO_ECX */
@@ -2320,12 +2359,13 @@ int speed_main(int argc, char **argv)
         }
     }
     if (multiblock) {
-        if (evp_cipher == NULL) {
+        if (evp_cipher == NULL && evp_md_name == NULL) {
             BIO_printf(bio_err, "-mb can be used only with a multi-block"
-                                " capable cipher\n");
+                                " capable cipher or a digest\n");
             goto end;
-        } else if (!(EVP_CIPHER_get_flags(evp_cipher) &
-                     EVP_CIPH_FLAG_TLS1_1_MULTIBLOCK)) {
+        } else if (evp_cipher != NULL
+                   && !(EVP_CIPHER_get_flags(evp_cipher) &
+                        EVP_CIPH_FLAG_TLS1_1_MULTIBLOCK)) {
             BIO_printf(bio_err, "%s is not a multi-block capable\n",
                        EVP_CIPHER_get0_name(evp_cipher));
             goto end;
@@ -2830,12 +2870,16 @@ int speed_main(int argc, char **argv)
                 print_result(D_EVP, testnum, count, d);
             }
         } else if (evp_md_name != NULL) {
+            int (*loopfunc) (void *) = EVP_Digest_md_loop;
+
             names[D_EVP] = evp_md_name;
+            if (multiblock)
+                loopfunc = EVP_Digest_batch_loop;
 
             for (testnum = 0; testnum < size_num; testnum++) {
                 print_message(names[D_EVP], lengths[testnum], seconds.sym);
                 Time_F(START);
-                count = run_benchmark(async_jobs, EVP_Digest_md_loop, loopargs);
+                count = run_benchmark(async_jobs, loopfunc, loopargs);
                 d = Time_F(STOP);
                 print_result(D_EVP, testnum, count, d);
                 if (count < 0)
@@ -3357,6 +3401,14 @@ int speed_main(int argc, char **argv)
             }
             EVP_PKEY_CTX_free(ed_pctx);
 
+            if (testnum == R_EC_Ed25519_PRECOMP
+                && !EVP_PKEY_set_int_param(ed_pkey, OSSL_PKEY_PARAM_PRECOMPUTE,
+                                           1)) {
+                st = 0;
+                EVP_PKEY_free(ed_pkey);
+                break;
+            }
+
             if (!EVP_DigestSignInit(loopargs[i].eddsa_ctx[testnum], NULL, NULL,
                                     NULL, ed_pkey)) {
                 st = 0;
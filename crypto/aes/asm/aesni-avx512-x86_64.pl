@@ -0,0 +1,435 @@
+#! /usr/bin/env perl
+# Copyright 2024 The OpenSSL Project Authors. All Rights Reserved.
+#
+# Licensed under the Apache License 2.0 (the "License").  You may not use
+# this file except in compliance with the License.  You can obtain a copy
+# in the file LICENSE in the source distribution or at
+# https://www.openssl.org/source/license.html
+#
+#
+# AES-XTS and AES-CTR for processors with VAES and AVX-512.
+#
+# Both modes are embarrassingly parallel, so instead of interleaving eight
+# 128-bit AES-NI streams as aesni-x86_64.pl does, sixteen blocks are kept in
+# four 512-bit registers and every round key is applied to all of them with
+# four VAES instructions.
+#
+# XTS tweaks for the sixteen blocks of an iteration are kept in four zmm
+# registers as well. The tweaks of the next iteration are obtained by
+# multiplying each of them by x^16 in GF(2^128), which is a two byte shift
+# followed by a carry-less multiplication of the two bytes shifted out by the
+# reduction polynomial. Blocks that don't fill a whole iteration, and the
+# ciphertext stealing of a partial final block, are processed one at a time.
+#
+# CTR keeps the 32-bit counters byte swapped in the last dword of each lane,
+# so that sixteen consecutive counters are obtained with dword additions that
+# wrap around modulo 2^32 like aesni_ctr32_encrypt_blocks. The final up to
+# fifteen blocks use masked loads and stores.
+#
+# Both functions use the key schedules of aesni_set_encrypt_key() and
+# aesni_set_decrypt_key() and are selected at run time when
+# ossl_vaes_vpclmulqdq_capable() reports support for AVX512F, AVX512DQ,
+# AVX512BW, AVX512VL, VAES and VPCLMULQDQ.
+
+# $output is the last argument if it looks like a file (it has an extension)
+# $flavour is the first argument if it doesn't look like a file
+$output  = $#ARGV >= 0 && $ARGV[$#ARGV] =~ m|\.\w+$| ? pop   : undef;
+$flavour = $#ARGV >= 0 && $ARGV[0] !~ m|\.|          ? shift : undef;
+
+$win64 = 0;
+$win64 = 1 if ($flavour =~ /[nm]asm|mingw64/ || $output =~ /\.asm$/);
+
+$avx512vaes = 0;
+
+$0 =~ m/(.*[\/\\])[^\/\\]+$/;
+$dir = $1;
+($xlate = "${dir}x86_64-xlate.pl" and -f $xlate)
+  or ($xlate = "${dir}../../perlasm/x86_64-xlate.pl" and -f $xlate)
+  or die "can't locate x86_64-xlate.pl";
+
+if (`$ENV{CC} -Wa,-v -c -o /dev/null -x assembler /dev/null 2>&1` =~ /GNU assembler version ([2-9]\.[0-9]+)/) {
+  $avx512vaes = ($1 >= 2.30);
+}
+
+if (!$avx512vaes
+  && $win64
+  && ($flavour =~ /nasm/ || $ENV{ASM} =~ /nasm/)
+  && `nasm -v 2>&1` =~ /NASM version ([2-9]\.[0-9]+)(?:\.([0-9]+))?/)
+{
+  $avx512vaes = ($1 == 2.13 && $2 >= 3) + ($1 >= 2.14);
+}
+
+if (!$avx512vaes && `$ENV{CC} -v 2>&1`
+    =~ /(Apple)?\s*((?:clang|LLVM) version|.*based on LLVM) ([0-9]+)\.([0-9]+)\.([0-9]+)?/) {
+    my $ver = $3 + $4/100.0 + $5/10000.0; # 3.1.0->3.01, 3.10.1->3.1001
+    if ($1) {
+        # Apple conditions, they use a different version series, see
+        # https://en.wikipedia.org/wiki/Xcode#Xcode_7.0_-_10.x_(since_Free_On-Device_Development)_2
+        # clang 7.0.0 is Apple clang 10.0.1
+        $avx512vaes = ($ver>=10.0001)
+    } else {
+        $avx512vaes = ($ver>=7.0);
+    }
+}
+
+open OUT, "| \"$^X\" \"$xlate\" $flavour \"$output\""
+  or die "can't call $xlate: $!";
+*STDOUT = *OUT;
+
+# Only volatile registers are used on both ABIs: xmm6-xmm15 are avoided in
+# favour of zmm16-zmm31, and the Win64 prologue generated for \@function
+# moves the arguments to the System V registers.
+my ($inp, $out, $len, $key1, $key2, $ivp) =
+    ("%rdi", "%rsi", "%rdx", "%rcx", "%r8", "%r9");
+my ($rounds, $kp, $tail) = ("%eax", "%r10", "%r11");
+my @dat = map("%zmm$_", (0..3));
+my $rk = "%zmm4";
+my $tmp = "%zmm5";
+my @tw = map("%zmm$_", (16..19));
+my @tt = map("%zmm$_", (20..23));
+my $poly = "%zmm24";
+my ($xdat, $xt1, $xprev, $xtw) = map("%xmm$_", (0, 1, 3, 5));
+
+my $label = 0;
+
+# Encrypt or decrypt the blocks in the registers @_ with the key schedule
+# at $key, applying each round key to all of them.
+sub aes_rounds {
+    my ($op, $key, @regs) = @_;
+    my $l = $label++;
+    my $bcast = $regs[0] =~ /zmm/ ? "vbroadcasti32x4" : "vmovdqu";
+    my $xor = $regs[0] =~ /zmm/ ? "vpxorq" : "vpxor";
+    my $r = $regs[0] =~ /zmm/ ? $rk : "%xmm4";
+    my $code = <<___;
+	$bcast	($key),$r
+	mov	240($key),$rounds
+	lea	16($key),$kp
+___
+    $code .= "\t$xor\t$r,$_,$_\n" foreach (@regs);
+    $code .= <<___;
+.Laes_${op}_$l:
+	$bcast	($kp),$r
+___
+    $code .= "\tvaes$op\t$r,$_,$_\n" foreach (@regs);
+    $code .= <<___;
+	lea	16($kp),$kp
+	dec	$rounds
+	jnz	.Laes_${op}_$l
+	$bcast	($kp),$r
+___
+    $code .= "\tvaes${op}last\t$r,$_,$_\n" foreach (@regs);
+    return $code;
+}
+
+# Multiply the tweak in $xtw by x.
+sub xts_double {
+    return <<___;
+	vpshufd	\$0x13,$xtw,$xt1
+	vpsrad	\$31,$xt1,$xt1
+	vpaddq	$xtw,$xtw,$xtw
+	vpand	.Lxts_magic(%rip),$xt1,$xt1
+	vpxor	$xt1,$xtw,$xtw
+___
+}
+
+if ($avx512vaes) {
+
+$code .= ".text\n";
+
+foreach my $dir ("enc", "dec") {
+my $name = "ossl_aes_xts_${dir}rypt_avx512";
+$code .= <<___;
+.globl	$name
+.type	$name,\@function,6
+.align	32
+$name:
+.cfi_startproc
+	endbranch
+	cmp	\$16,$len
+	jb	.Lxts_${dir}_done
+
+	vmovdqu	($ivp),$xtw
+___
+$code .= aes_rounds("enc", $key2, $xtw);
+$code .= <<___;
+	mov	$len,$tail
+	and	\$15,$tail
+	and	\$-16,$len
+___
+# Decryption of a partial final block needs the last full block first
+$code .= <<___ if ($dir eq "dec");
+	test	$tail,$tail
+	jz	.Lxts_dec_full
+	sub	\$16,$len
+.Lxts_dec_full:
+___
+$code .= <<___;
+	cmp	\$256,$len
+	jb	.Lxts_${dir}_blocks
+
+	vbroadcasti32x4	.Lxts_poly(%rip),$poly
+___
+for (my $i = 0; $i < 16; $i++) {
+    $code .= "\tvinserti32x4\t\$" . ($i % 4) . ",$xtw,$tw[$i / 4],$tw[$i / 4]\n";
+    $code .= xts_double() if ($i < 15);
+}
+$code .= <<___;
+	jmp	.Lxts_${dir}_loop16
+
+.align	32
+.Lxts_${dir}_loop16:
+	vmovdqu64	0($inp),$dat[0]
+	vmovdqu64	64($inp),$dat[1]
+	vmovdqu64	128($inp),$dat[2]
+	vmovdqu64	192($inp),$dat[3]
+	lea	256($inp),$inp
+___
+$code .= "\tvpxorq\t$tw[$_],$dat[$_],$dat[$_]\n" foreach (0..3);
+$code .= aes_rounds($dir, $key1, @dat);
+$code .= "\tvpxorq\t$tw[$_],$dat[$_],$dat[$_]\n" foreach (0..3);
+$code .= <<___;
+	vmovdqu64	$dat[0],0($out)
+	vmovdqu64	$dat[1],64($out)
+	vmovdqu64	$dat[2],128($out)
+	vmovdqu64	$dat[3],192($out)
+	lea	256($out),$out
+___
+# Advance the sixteen tweaks by x^16
+$code .= "\tvpsrldq\t\$14,$tw[$_],$tt[$_]\n" foreach (0..3);
+$code .= "\tvpclmulqdq\t\$0x00,$poly,$tt[$_],$tt[$_]\n" foreach (0..3);
+$code .= "\tvpslldq\t\$2,$tw[$_],$tw[$_]\n" foreach (0..3);
+$code .= "\tvpxorq\t$tt[$_],$tw[$_],$tw[$_]\n" foreach (0..3);
+$code .= <<___;
+	sub	\$256,$len
+	cmp	\$256,$len
+	jae	.Lxts_${dir}_loop16
+
+	vmovdqa64	%xmm16,$xtw
+
+.Lxts_${dir}_blocks:
+	test	$len,$len
+	jz	.Lxts_${dir}_tail
+.Lxts_${dir}_loop1:
+	vpxor	($inp),$xtw,$xdat
+	lea	16($inp),$inp
+___
+$code .= aes_rounds($dir, $key1, $xdat);
+$code .= <<___;
+	vpxor	$xtw,$xdat,$xdat
+	vmovdqu	$xdat,($out)
+	lea	16($out),$out
+___
+$code .= xts_double();
+$code .= <<___;
+	sub	\$16,$len
+	jnz	.Lxts_${dir}_loop1
+
+.Lxts_${dir}_tail:
+	test	$tail,$tail
+	jz	.Lxts_${dir}_done
+___
+if ($dir eq "enc") {
+# Swap the partial plaintext block with the head of the last ciphertext
+# block, which becomes the final partial block, and encrypt the result in
+# place of the last full block.
+$code .= <<___;
+	xor	%eax,%eax
+.Lxts_enc_steal:
+	movzb	($inp,%rax),%r8d
+	movzb	-16($out,%rax),%r9d
+	mov	%r9b,($out,%rax)
+	mov	%r8b,-16($out,%rax)
+	inc	%rax
+	cmp	$tail,%rax
+	jb	.Lxts_enc_steal
+
+	vpxor	-16($out),$xtw,$xdat
+___
+$code .= aes_rounds("enc", $key1, $xdat);
+$code .= <<___;
+	vpxor	$xtw,$xdat,$xdat
+	vmovdqu	$xdat,-16($out)
+___
+} else {
+# The last full ciphertext block is decrypted with the tweak of the partial
+# block that follows it, and the block reassembled from the partial block
+# with the one before.
+$code .= <<___;
+	vmovdqa	$xtw,$xprev
+___
+$code .= xts_double();
+$code .= <<___;
+	vpxor	($inp),$xtw,$xdat
+___
+$code .= aes_rounds("dec", $key1, $xdat);
+$code .= <<___;
+	vpxor	$xtw,$xdat,$xdat
+	vmovdqu	$xdat,($out)
+
+	xor	%eax,%eax
+.Lxts_dec_steal:
+	movzb	16($inp,%rax),%r8d
+	movzb	($out,%rax),%r9d
+	mov	%r9b,16($out,%rax)
+	mov	%r8b,($out,%rax)
+	inc	%rax
+	cmp	$tail,%rax
+	jb	.Lxts_dec_steal
+
+	vpxor	($out),$xprev,$xdat
+___
+$code .= aes_rounds("dec", $key1, $xdat);
+$code .= <<___;
+	vpxor	$xprev,$xdat,$xdat
+	vmovdqu	$xdat,($out)
+___
+}
+$code .= <<___;
+
+.Lxts_${dir}_done:
+	vzeroupper
+	ret
+.cfi_endproc
+.size	$name,.-$name
+___
+}
+
+{
+my $ivec = "%r8";
+my ($bswap, $ctr) = ("%zmm17", "%zmm16");
+my @inc = map("%zmm$_", (18..21));
+my $key = $key1;
+
+$code .= <<___;
+.globl	ossl_aes_ctr32_encrypt_blocks_avx512
+.type	ossl_aes_ctr32_encrypt_blocks_avx512,\@function,5
+.align	32
+ossl_aes_ctr32_encrypt_blocks_avx512:
+.cfi_startproc
+	endbranch
+	test	$len,$len
+	jz	.Lctr_done
+
+	vbroadcasti32x4	($ivec),$ctr
+	vbroadcasti32x4	.Lctr_bswap(%rip),$bswap
+	vpshufb	$bswap,$ctr,$ctr
+	vpaddd	.Lctr_init(%rip),$ctr,$ctr
+	vbroadcasti32x4	.Lctr_four(%rip),$inc[0]
+	vpaddd	$inc[0],$inc[0],$inc[1]
+	vpaddd	$inc[0],$inc[1],$inc[2]
+	vpaddd	$inc[1],$inc[1],$inc[3]
+	cmp	\$16,$len
+	jb	.Lctr_tail
+	jmp	.Lctr_loop16
+
+.align	32
+.Lctr_loop16:
+	vpshufb	$bswap,$ctr,$dat[0]
+	vpaddd	$inc[0],$ctr,$dat[1]
+	vpaddd	$inc[1],$ctr,$dat[2]
+	vpaddd	$inc[2],$ctr,$dat[3]
+	vpaddd	$inc[3],$ctr,$ctr
+	vpshufb	$bswap,$dat[1],$dat[1]
+	vpshufb	$bswap,$dat[2],$dat[2]
+	vpshufb	$bswap,$dat[3],$dat[3]
+___
+$code .= aes_rounds("enc", $key, @dat);
+$code .= <<___;
+	vpxorq	0($inp),$dat[0],$dat[0]
+	vpxorq	64($inp),$dat[1],$dat[1]
+	vpxorq	128($inp),$dat[2],$dat[2]
+	vpxorq	192($inp),$dat[3],$dat[3]
+	lea	256($inp),$inp
+	vmovdqu64	$dat[0],0($out)
+	vmovdqu64	$dat[1],64($out)
+	vmovdqu64	$dat[2],128($out)
+	vmovdqu64	$dat[3],192($out)
+	lea	256($out),$out
+	sub	\$16,$len
+	cmp	\$16,$len
+	jae	.Lctr_loop16
+
+	test	$len,$len
+	jz	.Lctr_done
+
+.Lctr_tail:
+	# One mask bit per quadword of the remaining blocks, eight per register
+	mov	$key,%r11
+	lea	($len,$len),%ecx
+	mov	\$1,%eax
+	shlq	%cl,%rax
+	dec	%rax
+	kmovq	%rax,%k1
+	shr	\$8,%rax
+	kmovq	%rax,%k2
+	shr	\$8,%rax
+	kmovq	%rax,%k3
+	shr	\$8,%rax
+	kmovq	%rax,%k4
+
+	vpshufb	$bswap,$ctr,$dat[0]
+	vpaddd	$inc[0],$ctr,$dat[1]
+	vpaddd	$inc[1],$ctr,$dat[2]
+	vpaddd	$inc[2],$ctr,$dat[3]
+	vpshufb	$bswap,$dat[1],$dat[1]
+	vpshufb	$bswap,$dat[2],$dat[2]
+	vpshufb	$bswap,$dat[3],$dat[3]
+___
+$code .= aes_rounds("enc", "%r11", @dat);
+for (my $i = 0; $i < 4; $i++) {
+    my $k = "%k" . ($i + 1);
+    my $off = 64 * $i;
+    $code .= <<___;
+	vmovdqu64	$off($inp),$tmp\{$k\}\{z\}
+	vpxorq	$tmp,$dat[$i],$dat[$i]
+	vmovdqu64	$dat[$i],$off($out)\{$k\}
+___
+}
+$code .= <<___;
+
+.Lctr_done:
+	vzeroupper
+	ret
+.cfi_endproc
+.size	ossl_aes_ctr32_encrypt_blocks_avx512,.-ossl_aes_ctr32_encrypt_blocks_avx512
+___
+}
+
+$code .= <<___;
+.align	64
+.Lctr_init:
+	.long	0,0,0,0, 0,0,0,1, 0,0,0,2, 0,0,0,3
+.Lctr_bswap:
+	.byte	0,1,2,3,4,5,6,7,8,9,10,11,15,14,13,12
+.Lctr_four:
+	.long	0,0,0,4
+.Lxts_poly:
+	.quad	0x87,0
+.Lxts_magic:
+	.long	0x87,0,1,0
+.asciz	"AES-XTS and AES-CTR for VAES and AVX-512"
+.align	64
+___
+
+} else {
+# Fallback for old assembler. ossl_vaes_vpclmulqdq_capable() reports no
+# support in that case, so these are never called.
+$code .= <<___;
+.text
+.globl	ossl_aes_xts_encrypt_avx512
+.globl	ossl_aes_xts_decrypt_avx512
+.globl	ossl_aes_ctr32_encrypt_blocks_avx512
+.type	ossl_aes_xts_encrypt_avx512,\@abi-omnipotent
+ossl_aes_xts_encrypt_avx512:
+ossl_aes_xts_decrypt_avx512:
+ossl_aes_ctr32_encrypt_blocks_avx512:
+	.byte	0x0f,0x0b	# ud2
+	ret
+.size	ossl_aes_xts_encrypt_avx512,.-ossl_aes_xts_encrypt_avx512
+___
+}
+
+$code =~ s/\`([^\`]*)\`/eval $1/gem;
+print $code;
+
+close STDOUT or die "error closing STDOUT: $!";
@@ -1,5 +1,5 @@
 /*
- * Copyright 2008-2023 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2008-2024 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -15,6 +15,7 @@
 #include <openssl/cms.h>
 #include "cms_local.h"
 #include "crypto/asn1.h"
+#include "internal/thread.h"
 
 static BIO *cms_get_text_bio(BIO *out, unsigned int flags)
 {
@@ -301,6 +302,112 @@ static int cms_signerinfo_verify_cert(CMS_SignerInfo *si,
 
 }
 
+/*
+ * Verification of the signer certificates of a SignedData with several
+ * signers. When the library context allows threads, see OSSL_set_max_threads(),
+ * the signers are shared out between worker threads and the calling thread.
+ * Each signer records its own result and error queue, and only the errors of
+ * the first failing signer are reported, so the outcome is the same as when
+ * the signers are verified one after the other.
+ */
+typedef struct {
+    CMS_SignerInfo *si;
+    STACK_OF(X509) **chain;
+    ERR_STATE *err;
+    int ret;
+} CMS_SIGNER_VERIFY;
+
+typedef struct {
+    CMS_SIGNER_VERIFY *sv;
+    int num;
+    int first;
+    int step;
+    X509_STORE *store;
+    STACK_OF(X509) *untrusted;
+    STACK_OF(X509_CRL) *crls;
+    const CMS_CTX *cms_ctx;
+} CMS_SIGNERS_VERIFY;
+
+typedef struct {
+    CMS_SIGNERS_VERIFY *svs;
+    int first;
+} CMS_SIGNERS_THREAD;
+
+static void cms_signers_verify_cert(const CMS_SIGNERS_VERIFY *svs, int first)
+{
+    CMS_SIGNER_VERIFY *sv;
+    int i;
+
+    for (i = first; i < svs->num; i += svs->step) {
+        sv = &svs->sv[i];
+        ERR_set_mark();
+        sv->ret = cms_signerinfo_verify_cert(sv->si, svs->store,
+                                             svs->untrusted, svs->crls,
+                                             sv->chain, svs->cms_ctx);
+        if (!sv->ret)
+            OSSL_ERR_STATE_save_to_mark(sv->err);
+        ERR_pop_to_mark();
+    }
+}
+
+static CRYPTO_THREAD_RETVAL cms_signers_verify_thr(void *vdata)
+{
+    CMS_SIGNERS_THREAD *thr = vdata;
+
+    cms_signers_verify_cert(thr->svs, thr->first);
+    return 1;
+}
+
+static int cms_signers_verify_mt(CMS_SIGNERS_VERIFY *svs)
+{
+    OSSL_LIB_CTX *libctx = ossl_cms_ctx_get0_libctx(svs->cms_ctx);
+    CMS_SIGNERS_THREAD *thr = NULL;
+    void **t = NULL;
+    uint64_t avail;
+    int i, nthreads, ret = 0;
+
+    avail = ossl_get_avail_threads(libctx);
+    nthreads = avail < (uint64_t)svs->num - 1 ? (int)avail : svs->num - 1;
+
+    if (nthreads > 0) {
+        t = OPENSSL_zalloc(nthreads * sizeof(*t));
+        thr = OPENSSL_zalloc(nthreads * sizeof(*thr));
+        if (t == NULL || thr == NULL)
+            goto err;
+    }
+    for (i = 0; i < svs->num; i++)
+        if ((svs->sv[i].err = OSSL_ERR_STATE_new()) == NULL)
+            goto err;
+
+    /* The calling thread verifies signers 0, n + 1, 2n + 2... itself */
+    svs->step = nthreads + 1;
+    for (i = 0; i < nthreads; i++) {
+        thr[i].svs = svs;
+        thr[i].first = i + 1;
+        t[i] = ossl_crypto_thread_start(libctx, &cms_signers_verify_thr,
+                                        &thr[i]);
+        if (t[i] == NULL)
+            cms_signers_verify_cert(svs, i + 1);
+    }
+    cms_signers_verify_cert(svs, 0);
+
+    ret = 1;
+    for (i = 0; i < nthreads; i++) {
+        if (t[i] == NULL)
+            continue;
+        if (!ossl_crypto_thread_join(t[i], NULL))
+            ret = 0;
+        ossl_crypto_thread_clean(t[i]);
+    }
+    if (!ret)
+        ERR_raise(ERR_LIB_CMS, ERR_R_INTERNAL_ERROR);
+
+ err:
+    OPENSSL_free(thr);
+    OPENSSL_free(t);
+    return ret;
+}
+
 /* This strongly overlaps with PKCS7_verify() */
 int CMS_verify(CMS_ContentInfo *cms, STACK_OF(X509) *certs,
                X509_STORE *store, BIO *dcont, BIO *out, unsigned int flags)
@@ -315,6 +422,7 @@ int CMS_verify(CMS_ContentInfo *cms, STACK_OF(X509) *certs,
     BIO *cmsbio = NULL, *tmpin = NULL, *tmpout = NULL;
     int cadesVerify = (flags & CMS_CADES) != 0;
     const CMS_CTX *ctx = ossl_cms_get0_cmsctx(cms);
+    CMS_SIGNERS_VERIFY svs = { NULL };
 
     if (dcont == NULL && !check_content(cms))
         return 0;
@@ -362,13 +470,38 @@ int CMS_verify(CMS_ContentInfo *cms, STACK_OF(X509) *certs,
         cms_certs = CMS_get1_certs(cms);
         if (!(flags & CMS_NOCRL))
             crls = CMS_get1_crls(cms);
-        for (i = 0; i < scount; i++) {
-            si = sk_CMS_SignerInfo_value(sinfos, i);
-
-            if (!cms_signerinfo_verify_cert(si, store, cms_certs, crls,
-                                            si_chains ? &si_chains[i] : NULL,
-                                            ctx))
+        if (scount == 1
+                || ossl_get_avail_threads(ossl_cms_ctx_get0_libctx(ctx)) == 0) {
+            for (i = 0; i < scount; i++) {
+                si = sk_CMS_SignerInfo_value(sinfos, i);
+
+                if (!cms_signerinfo_verify_cert(si, store, cms_certs, crls,
+                                                si_chains ? &si_chains[i] : NULL,
+                                                ctx))
+                    goto err;
+            }
+        } else {
+            svs.num = scount;
+            svs.store = store;
+            svs.untrusted = cms_certs;
+            svs.crls = crls;
+            svs.cms_ctx = ctx;
+            svs.sv = OPENSSL_zalloc(scount * sizeof(*svs.sv));
+            if (svs.sv == NULL)
+                goto err;
+            for (i = 0; i < scount; i++) {
+                svs.sv[i].si = sk_CMS_SignerInfo_value(sinfos, i);
+                svs.sv[i].chain = si_chains ? &si_chains[i] : NULL;
+            }
+            if (!cms_signers_verify_mt(&svs))
                 goto err;
+            /* Report the first failure in signer order */
+            for (i = 0; i < scount; i++) {
+                if (!svs.sv[i].ret) {
+                    OSSL_ERR_STATE_restore(svs.sv[i].err);
+                    goto err;
+                }
+            }
         }
     }
 
@@ -481,6 +614,11 @@ int CMS_verify(CMS_ContentInfo *cms, STACK_OF(X509) *certs,
             OSSL_STACK_OF_X509_free(si_chains[i]);
         OPENSSL_free(si_chains);
     }
+    if (svs.sv != NULL) {
+        for (i = 0; i < scount; ++i)
+            OSSL_ERR_STATE_free(svs.sv[i].err);
+        OPENSSL_free(svs.sv);
+    }
     OSSL_STACK_OF_X509_free(cms_certs);
     sk_X509_CRL_pop_free(crls, X509_CRL_free);
 
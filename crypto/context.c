@@ -43,6 +43,9 @@ struct ossl_lib_ctx_st {
     void *threads;
 #endif
     void *rand_crngt;
+#ifndef OPENSSL_NO_EC
+    void *ec_gen_precomp;
+#endif
 #ifdef FIPS_MODULE
     void *thread_event_handler;
     void *fips_prov;
@@ -166,6 +169,12 @@ static int context_init(OSSL_LIB_CTX *ctx)
     if (ctx->drbg_nonce == NULL)
         goto err;
 
+#ifndef OPENSSL_NO_EC
+    ctx->ec_gen_precomp = ossl_ec_gen_precomp_cache_new(ctx);
+    if (ctx->ec_gen_precomp == NULL)
+        goto err;
+#endif
+
 #ifndef FIPS_MODULE
     ctx->self_test_cb = ossl_self_test_set_callback_new(ctx);
     if (ctx->self_test_cb == NULL)
@@ -300,6 +309,13 @@ static void context_deinit_objs(OSSL_LIB_CTX *ctx)
         ctx->drbg_nonce = NULL;
     }
 
+#ifndef OPENSSL_NO_EC
+    if (ctx->ec_gen_precomp != NULL) {
+        ossl_ec_gen_precomp_cache_free(ctx->ec_gen_precomp);
+        ctx->ec_gen_precomp = NULL;
+    }
+#endif
+
 #ifndef FIPS_MODULE
     if (ctx->self_test_cb != NULL) {
         ossl_self_test_set_callback_free(ctx->self_test_cb);
@@ -566,6 +582,10 @@ void *ossl_lib_ctx_get_data(OSSL_LIB_CTX *ctx, int index)
         return ctx->drbg;
     case OSSL_LIB_CTX_DRBG_NONCE_INDEX:
         return ctx->drbg_nonce;
+#ifndef OPENSSL_NO_EC
+    case OSSL_LIB_CTX_EC_GEN_PRECOMP_INDEX:
+        return ctx->ec_gen_precomp;
+#endif
 #ifndef FIPS_MODULE
     case OSSL_LIB_CTX_PROVIDER_CONF_INDEX:
         return ctx->provider_conf;
@@ -20,6 +20,7 @@
 #include <openssl/sha.h>
 
 #include "internal/numbers.h"
+#include "internal/thread_once.h"
 
 #if defined(X25519_ASM) && (defined(__x86_64) || defined(__x86_64__) || \
                             defined(_M_AMD64) || defined(_M_X64))
@@ -4528,6 +4529,24 @@ static const ge_precomp Bi[8] = {
     },
 };
 
+/* Ai = A,3A,5A,7A,9A,11A,13A,15A */
+static void ge_odd_multiples(ge_cached Ai[8], const ge_p3 *A)
+{
+    ge_p1p1 t;
+    ge_p3 u;
+    ge_p3 A2;
+    int i;
+
+    ge_p3_to_cached(&Ai[0], A);
+    ge_p3_dbl(&t, A);
+    ge_p1p1_to_p3(&A2, &t);
+    for (i = 1; i < 8; i++) {
+        ge_add(&t, &A2, &Ai[i - 1]);
+        ge_p1p1_to_p3(&u, &t);
+        ge_p3_to_cached(&Ai[i], &u);
+    }
+}
+
 /*
  * r = a * A + b * B
  *
@@ -4543,36 +4562,12 @@ static void ge_double_scalarmult_vartime(ge_p2 *r, const uint8_t *a,
     ge_cached Ai[8]; /* A,3A,5A,7A,9A,11A,13A,15A */
     ge_p1p1 t;
     ge_p3 u;
-    ge_p3 A2;
     int i;
 
     slide(aslide, a);
     slide(bslide, b);
 
-    ge_p3_to_cached(&Ai[0], A);
-    ge_p3_dbl(&t, A);
-    ge_p1p1_to_p3(&A2, &t);
-    ge_add(&t, &A2, &Ai[0]);
-    ge_p1p1_to_p3(&u, &t);
-    ge_p3_to_cached(&Ai[1], &u);
-    ge_add(&t, &A2, &Ai[1]);
-    ge_p1p1_to_p3(&u, &t);
-    ge_p3_to_cached(&Ai[2], &u);
-    ge_add(&t, &A2, &Ai[2]);
-    ge_p1p1_to_p3(&u, &t);
-    ge_p3_to_cached(&Ai[3], &u);
-    ge_add(&t, &A2, &Ai[3]);
-    ge_p1p1_to_p3(&u, &t);
-    ge_p3_to_cached(&Ai[4], &u);
-    ge_add(&t, &A2, &Ai[4]);
-    ge_p1p1_to_p3(&u, &t);
-    ge_p3_to_cached(&Ai[5], &u);
-    ge_add(&t, &A2, &Ai[5]);
-    ge_p1p1_to_p3(&u, &t);
-    ge_p3_to_cached(&Ai[6], &u);
-    ge_add(&t, &A2, &Ai[6]);
-    ge_p1p1_to_p3(&u, &t);
-    ge_p3_to_cached(&Ai[7], &u);
+    ge_odd_multiples(Ai, A);
 
     ge_p2_0(r);
 
@@ -4605,6 +4600,263 @@ static void ge_double_scalarmult_vartime(ge_p2 *r, const uint8_t *a,
     }
 }
 
+/*
+ * Larger tables used by keys with precomputation enabled, see
+ * ossl_ed25519_precomp_new(). They are built on first use.
+ *
+ * k25519LargePrecomp[i][j] = (j+1)*32^i*B, so that a scalar in signed radix
+ * 32 takes one addition per digit, 52 in all, and no doublings. B128i holds
+ * the odd multiples of 2^128*B, with which verification needs half as many
+ * doublings.
+ */
+#define LARGE_PRECOMP_DIGITS 52
+
+static ge_precomp k25519LargePrecomp[LARGE_PRECOMP_DIGITS][16];
+static ge_cached B128i[8];
+static CRYPTO_ONCE large_precomp_once = CRYPTO_ONCE_STATIC_INIT;
+
+struct ed25519_precomp_st {
+    ge_cached Ai[8];    /* -A,-3A,...,-15A */
+    ge_cached A128i[8]; /* the same for 2^128*-A */
+};
+
+/* h = 2^128 * p */
+static void ge_p3_mul_2_128(ge_p3 *h, const ge_p3 *p)
+{
+    ge_p1p1 r;
+    ge_p2 s;
+    int i;
+
+    ge_p3_to_p2(&s, p);
+    for (i = 0; i < 127; i++) {
+        ge_p2_dbl(&r, &s);
+        ge_p1p1_to_p2(&s, &r);
+    }
+    ge_p2_dbl(&r, &s);
+    ge_p1p1_to_p3(h, &r);
+}
+
+/* r[i] = p[i] for i < n <= 16, sharing a single inversion */
+static void ge_p3_batch_to_precomp(ge_precomp *r, const ge_p3 *p, int n)
+{
+    fe acc[16];
+    fe inv;
+    fe x;
+    fe y;
+    fe t;
+    uint8_t buf[32];
+    int i;
+
+    fe_copy(acc[0], p[0].Z);
+    for (i = 1; i < n; i++)
+        fe_mul(acc[i], acc[i - 1], p[i].Z);
+    fe_invert(inv, acc[n - 1]);
+
+    for (i = n - 1; i >= 0; i--) {
+        /* t = 1/Z[i], then inv = 1/(Z[0]...Z[i-1]) */
+        if (i > 0) {
+            fe_mul(t, inv, acc[i - 1]);
+            fe_mul(inv, inv, p[i].Z);
+        } else {
+            fe_copy(t, inv);
+        }
+        fe_mul(x, p[i].X, t);
+        fe_mul(y, p[i].Y, t);
+        fe_add(r[i].yplusx, y, x);
+        fe_sub(r[i].yminusx, y, x);
+        fe_mul(t, x, y);
+        fe_mul(r[i].xy2d, t, d2);
+
+        /* Fully reduce the entries, as in the static tables */
+        fe_tobytes(buf, r[i].yplusx);
+        fe_frombytes(r[i].yplusx, buf);
+        fe_tobytes(buf, r[i].yminusx);
+        fe_frombytes(r[i].yminusx, buf);
+        fe_tobytes(buf, r[i].xy2d);
+        fe_frombytes(r[i].xy2d, buf);
+    }
+}
+
+DEFINE_RUN_ONCE_STATIC(large_precomp_init)
+{
+    static const uint8_t one[32] = { 1 };
+    ge_p3 row[16];
+    ge_p3 P;
+    ge_cached Pc;
+    ge_p1p1 t;
+    int i, j;
+
+    /* P = 32^i * B */
+    ge_scalarmult_base(&P, one);
+    for (i = 0; i < LARGE_PRECOMP_DIGITS; i++) {
+        row[0] = P;
+        ge_p3_to_cached(&Pc, &P);
+        for (j = 1; j < 16; j++) {
+            ge_add(&t, &row[j - 1], &Pc);
+            ge_p1p1_to_p3(&row[j], &t);
+        }
+        ge_p3_batch_to_precomp(k25519LargePrecomp[i], row, 16);
+        ge_p3_dbl(&t, &row[15]);
+        ge_p1p1_to_p3(&P, &t);
+    }
+
+    ge_scalarmult_base(&P, one);
+    ge_p3_mul_2_128(&P, &P);
+    ge_odd_multiples(B128i, &P);
+    return 1;
+}
+
+static void table_select_large(ge_precomp *t, int pos, signed char b)
+{
+    ge_precomp minust;
+    uint8_t bnegative = negative(b);
+    uint8_t babs = b - ((uint8_t)((-bnegative) & b) << 1);
+    int j;
+
+    ge_precomp_0(t);
+    for (j = 0; j < 16; j++)
+        cmov(t, &k25519LargePrecomp[pos][j], equal(babs, j + 1));
+    fe_copy(minust.yplusx, t->yminusx);
+    fe_copy(minust.yminusx, t->yplusx);
+    fe_neg(minust.xy2d, t->xy2d);
+    cmov(t, &minust, bnegative);
+}
+
+/*
+ * ge_scalarmult_base() with k25519LargePrecomp.
+ *
+ * Preconditions:
+ *   a[31] <= 127
+ */
+static void ge_scalarmult_base_large(ge_p3 *h, const uint8_t *a)
+{
+    signed char e[LARGE_PRECOMP_DIGITS];
+    signed char carry;
+    ge_p1p1 r;
+    ge_precomp t;
+    int i, bit;
+
+    for (i = 0; i < LARGE_PRECOMP_DIGITS - 1; ++i) {
+        bit = 5 * i;
+        e[i] = ((a[bit / 8] | (bit / 8 < 31 ? a[bit / 8 + 1] << 8 : 0))
+                >> (bit % 8)) & 31;
+    }
+    /* each e[i] is between 0 and 31 */
+
+    carry = 0;
+    for (i = 0; i < LARGE_PRECOMP_DIGITS - 1; ++i) {
+        e[i] += carry;
+        carry = e[i] + 16;
+        carry >>= 5;
+        e[i] -= carry << 5;
+    }
+    e[LARGE_PRECOMP_DIGITS - 1] = carry;
+    /* each e[i] is between -16 and 15, the last one 0 or 1 */
+
+    ge_p3_0(h);
+    for (i = 0; i < LARGE_PRECOMP_DIGITS; ++i) {
+        table_select_large(&t, i, e[i]);
+        ge_madd(&r, h, &t);
+        ge_p1p1_to_p3(h, &r);
+    }
+
+    OPENSSL_cleanse(e, sizeof(e));
+}
+
+/*
+ * ge_double_scalarmult_vartime() for a precomputed A, splitting a and b into
+ * halves of 128 bits.
+ */
+static void ge_double_scalarmult_precomp(ge_p2 *r, const uint8_t *a,
+                                         const ED25519_PRECOMP *pre,
+                                         const uint8_t *b)
+{
+    signed char aslide[2][256];
+    signed char bslide[2][256];
+    uint8_t half[32];
+    const ge_cached *Ai[2];
+    const ge_precomp *Bp = Bi;
+    ge_p1p1 t;
+    ge_p3 u;
+    int i, k;
+
+    Ai[0] = pre->Ai;
+    Ai[1] = pre->A128i;
+    memset(half + 16, 0, 16);
+    memcpy(half, a, 16);
+    slide(aslide[0], half);
+    memcpy(half, a + 16, 16);
+    slide(aslide[1], half);
+    memcpy(half, b, 16);
+    slide(bslide[0], half);
+    memcpy(half, b + 16, 16);
+    slide(bslide[1], half);
+
+    ge_p2_0(r);
+
+    for (i = 255; i >= 0; --i) {
+        if (aslide[0][i] || aslide[1][i] || bslide[0][i] || bslide[1][i])
+            break;
+    }
+
+    for (; i >= 0; --i) {
+        ge_p2_dbl(&t, r);
+
+        for (k = 0; k < 2; k++) {
+            if (aslide[k][i] > 0) {
+                ge_p1p1_to_p3(&u, &t);
+                ge_add(&t, &u, &Ai[k][aslide[k][i] / 2]);
+            } else if (aslide[k][i] < 0) {
+                ge_p1p1_to_p3(&u, &t);
+                ge_sub(&t, &u, &Ai[k][(-aslide[k][i]) / 2]);
+            }
+        }
+
+        if (bslide[0][i] > 0) {
+            ge_p1p1_to_p3(&u, &t);
+            ge_madd(&t, &u, &Bp[bslide[0][i] / 2]);
+        } else if (bslide[0][i] < 0) {
+            ge_p1p1_to_p3(&u, &t);
+            ge_msub(&t, &u, &Bp[(-bslide[0][i]) / 2]);
+        }
+        if (bslide[1][i] > 0) {
+            ge_p1p1_to_p3(&u, &t);
+            ge_add(&t, &u, &B128i[bslide[1][i] / 2]);
+        } else if (bslide[1][i] < 0) {
+            ge_p1p1_to_p3(&u, &t);
+            ge_sub(&t, &u, &B128i[(-bslide[1][i]) / 2]);
+        }
+
+        ge_p1p1_to_p2(r, &t);
+    }
+}
+
+ED25519_PRECOMP *ossl_ed25519_precomp_new(const uint8_t public_key[32])
+{
+    ED25519_PRECOMP *pre;
+    ge_p3 A;
+
+    if (!RUN_ONCE(&large_precomp_once, large_precomp_init))
+        return NULL;
+    if (ge_frombytes_vartime(&A, public_key) != 0)
+        return NULL;
+    if ((pre = OPENSSL_malloc(sizeof(*pre))) == NULL)
+        return NULL;
+
+    /* Verification computes with -A */
+    fe_neg(A.X, A.X);
+    fe_neg(A.T, A.T);
+    ge_odd_multiples(pre->Ai, &A);
+    ge_p3_mul_2_128(&A, &A);
+    ge_odd_multiples(pre->A128i, &A);
+    return pre;
+}
+
+void ossl_ed25519_precomp_free(ED25519_PRECOMP *pre)
+{
+    OPENSSL_free(pre);
+}
+
 /*
  * The set of scalars is \Z/l
  * where l = 2^252 + 27742317777372353535851937790883648493.
@@ -5473,6 +5725,7 @@ static int hash_init_with_dom(EVP_MD_CTX *hash_ctx,
 int
 ossl_ed25519_sign(uint8_t *out_sig, const uint8_t *tbs, size_t tbs_len,
                   const uint8_t public_key[32], const uint8_t private_key[32],
+                  const ED25519_PRECOMP *precomp,
                   const uint8_t dom2flag, const uint8_t phflag, const uint8_t csflag,
                   const uint8_t *context, size_t context_len,
                   OSSL_LIB_CTX *libctx, const char *propq)
@@ -5516,7 +5769,10 @@ ossl_ed25519_sign(uint8_t *out_sig, const uint8_t *tbs, size_t tbs_len,
         goto err;
 
     x25519_sc_reduce(nonce);
-    ge_scalarmult_base(&R, nonce);
+    if (precomp != NULL)
+        ge_scalarmult_base_large(&R, nonce);
+    else
+        ge_scalarmult_base(&R, nonce);
     ge_p3_tobytes(out_sig, &R);
 
     if (!hash_init_with_dom(hash_ctx, sha512, dom2flag, phflag, context, context_len)
@@ -5543,6 +5799,7 @@ static const char allzeroes[15];
 int
 ossl_ed25519_verify(const uint8_t *tbs, size_t tbs_len,
                     const uint8_t signature[64], const uint8_t public_key[32],
+                    const ED25519_PRECOMP *precomp,
                     const uint8_t dom2flag, const uint8_t phflag, const uint8_t csflag,
                     const uint8_t *context, size_t context_len,
                     OSSL_LIB_CTX *libctx, const char *propq)
@@ -5604,12 +5861,13 @@ ossl_ed25519_verify(const uint8_t *tbs, size_t tbs_len,
             return 0;
     }
 
-    if (ge_frombytes_vartime(&A, public_key) != 0) {
-        return 0;
-    }
+    if (precomp == NULL) {
+        if (ge_frombytes_vartime(&A, public_key) != 0)
+            return 0;
 
-    fe_neg(A.X, A.X);
-    fe_neg(A.T, A.T);
+        fe_neg(A.X, A.X);
+        fe_neg(A.T, A.T);
+    }
 
     sha512 = EVP_MD_fetch(libctx, SN_sha512, propq);
     if (sha512 == NULL)
@@ -5627,7 +5885,10 @@ ossl_ed25519_verify(const uint8_t *tbs, size_t tbs_len,
 
     x25519_sc_reduce(h);
 
-    ge_double_scalarmult_vartime(&R, h, &A, s);
+    if (precomp != NULL)
+        ge_double_scalarmult_precomp(&R, h, precomp, s);
+    else
+        ge_double_scalarmult_vartime(&R, h, &A, s);
 
     ge_tobytes(rcheck, &R);
 
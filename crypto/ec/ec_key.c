@@ -26,6 +26,7 @@
 #include "prov/providercommon.h"
 #include "prov/ecx.h"
 #include "crypto/bn.h"
+#include "crypto/context.h"
 
 static int ecdsa_keygen_pairwise_test(EC_KEY *eckey, OSSL_CALLBACK *cb,
                                       void *cbarg);
@@ -68,6 +69,126 @@ EC_KEY *EC_KEY_new_by_curve_name(int nid)
 }
 #endif
 
+/*
+ * Number of verifications with a key after which multiples of its public key
+ * are precomputed for the following ones
+ */
+#define EC_KEY_VERIFY_PRECOMP_AFTER 16
+
+/*
+ * Multiples of the generator for ossl_ec_key_get_verify_precomp(), shared by
+ * all keys of a library context, so that each key only adds the table for
+ * its public key. Entries are never evicted, so the number of different
+ * groups is limited; keys of other groups aren't precomputed at all.
+ */
+#define EC_GEN_PRECOMP_MAX 8
+
+typedef struct {
+    CRYPTO_RWLOCK *lock;
+    size_t num;
+    EC_GROUP *group[EC_GEN_PRECOMP_MAX];
+    EC_PRE_COMP *pre[EC_GEN_PRECOMP_MAX];
+} EC_GEN_PRECOMP_CACHE;
+
+void *ossl_ec_gen_precomp_cache_new(OSSL_LIB_CTX *libctx)
+{
+    EC_GEN_PRECOMP_CACHE *cache = OPENSSL_zalloc(sizeof(*cache));
+
+    if (cache == NULL)
+        return NULL;
+    if ((cache->lock = CRYPTO_THREAD_lock_new()) == NULL) {
+        OPENSSL_free(cache);
+        return NULL;
+    }
+    return cache;
+}
+
+void ossl_ec_gen_precomp_cache_free(void *vcache)
+{
+    EC_GEN_PRECOMP_CACHE *cache = vcache;
+    size_t i;
+
+    if (cache == NULL)
+        return;
+    for (i = 0; i < cache->num; i++) {
+        EC_ec_pre_comp_free(cache->pre[i]);
+        EC_GROUP_free(cache->group[i]);
+    }
+    CRYPTO_THREAD_lock_free(cache->lock);
+    OPENSSL_free(cache);
+}
+
+/* The caller holds the lock of |cache| */
+static EC_PRE_COMP *ec_gen_precomp_find(EC_GEN_PRECOMP_CACHE *cache,
+                                        const EC_GROUP *group, BN_CTX *ctx)
+{
+    size_t i;
+
+    for (i = 0; i < cache->num; i++)
+        if (cache->group[i]->meth == group->meth
+            && cache->group[i]->curve_name == group->curve_name
+            && EC_GROUP_cmp(cache->group[i], group, ctx) == 0)
+            return EC_ec_pre_comp_dup(cache->pre[i]);
+    return NULL;
+}
+
+/*
+ * Get a reference to the multiples of the generator of |group|, from the
+ * group itself or from the cache of |libctx|, making them if there is room.
+ */
+static EC_PRE_COMP *ec_gen_precomp_get(OSSL_LIB_CTX *libctx,
+                                       const EC_GROUP *group, BN_CTX *ctx)
+{
+    EC_GEN_PRECOMP_CACHE *cache;
+    EC_GROUP *copy = NULL;
+    EC_PRE_COMP *pre;
+
+    if (HAVEPRECOMP(group, ec))
+        return EC_ec_pre_comp_dup(group->pre_comp.ec);
+
+    cache = ossl_lib_ctx_get_data(libctx, OSSL_LIB_CTX_EC_GEN_PRECOMP_INDEX);
+    if (cache == NULL || !CRYPTO_THREAD_read_lock(cache->lock))
+        return NULL;
+    pre = ec_gen_precomp_find(cache, group, ctx);
+    CRYPTO_THREAD_unlock(cache->lock);
+    if (pre != NULL)
+        return pre;
+
+    /*
+     * The table is made without holding the lock, for a copy of |group| that
+     * lives as long as the cache.
+     */
+    if ((copy = EC_GROUP_dup(group)) == NULL
+        || (pre = ossl_ec_wNAF_precompute_point(copy,
+                                                EC_GROUP_get0_generator(copy),
+                                                ctx)) == NULL
+        || !CRYPTO_THREAD_write_lock(cache->lock)) {
+        EC_ec_pre_comp_free(pre);
+        EC_GROUP_free(copy);
+        return NULL;
+    }
+    if (cache->num < EC_GEN_PRECOMP_MAX) {
+        cache->group[cache->num] = copy;
+        cache->pre[cache->num++] = pre;
+        copy = NULL;
+        pre = EC_ec_pre_comp_dup(pre);
+    } else {
+        EC_ec_pre_comp_free(pre);
+        pre = NULL;
+    }
+    CRYPTO_THREAD_unlock(cache->lock);
+    EC_GROUP_free(copy);
+    return pre;
+}
+
+static void ec_key_verify_precomp_reset(EC_KEY *key)
+{
+    EC_ec_pre_comp_free(key->verify_pre_comp[0]);
+    EC_ec_pre_comp_free(key->verify_pre_comp[1]);
+    key->verify_pre_comp[0] = key->verify_pre_comp[1] = NULL;
+    key->verify_count = 0;
+}
+
 void EC_KEY_free(EC_KEY *r)
 {
     int i;
@@ -95,6 +216,8 @@ void EC_KEY_free(EC_KEY *r)
     CRYPTO_free_ex_data(CRYPTO_EX_INDEX_EC_KEY, r, &r->ex_data);
 #endif
     CRYPTO_FREE_REF(&r->references);
+    ec_key_verify_precomp_reset(r);
+    CRYPTO_THREAD_lock_free(r->lock);
     EC_GROUP_free(r->group);
     EC_POINT_free(r->pub_key);
     BN_clear_free(r->priv_key);
@@ -121,6 +244,7 @@ EC_KEY *EC_KEY_copy(EC_KEY *dest, const EC_KEY *src)
 #endif
     }
     dest->libctx = src->libctx;
+    ec_key_verify_precomp_reset(dest);
     /* copy the parameters */
     if (src->group != NULL) {
         /* clear the old group */
@@ -767,6 +891,7 @@ int EC_KEY_set_group(EC_KEY *key, const EC_GROUP *group)
 {
     if (key->meth->set_group != NULL && key->meth->set_group(key, group) == 0)
         return 0;
+    ec_key_verify_precomp_reset(key);
     EC_GROUP_free(key->group);
     key->group = EC_GROUP_dup(group);
     if (key->group != NULL && EC_GROUP_get_curve_name(key->group) == NID_sm2)
@@ -886,6 +1011,7 @@ int EC_KEY_set_public_key(EC_KEY *key, const EC_POINT *pub_key)
     if (key->meth->set_public != NULL
         && key->meth->set_public(key, pub_key) == 0)
         return 0;
+    ec_key_verify_precomp_reset(key);
     EC_POINT_free(key->pub_key);
     key->pub_key = EC_POINT_dup(pub_key, key->group);
     key->dirty_cnt++;
@@ -970,6 +1096,7 @@ int EC_KEY_oct2key(EC_KEY *key, const unsigned char *buf, size_t len,
         key->pub_key = EC_POINT_new(key->group);
     if (key->pub_key == NULL)
         return 0;
+    ec_key_verify_precomp_reset(key);
     if (EC_POINT_oct2point(key->group, key->pub_key, buf, len, ctx) == 0)
         return 0;
     key->dirty_cnt++;
@@ -985,6 +1112,69 @@ int EC_KEY_oct2key(EC_KEY *key, const unsigned char *buf, size_t len,
     return 1;
 }
 
+/*
+ * Get references to precomputed multiples of the generator and of the public
+ * key of |key| in |pre| for ossl_ec_wNAF_mul_precomputed(). They are made by
+ * the verification that reaches EC_KEY_VERIFY_PRECOMP_AFTER uses of the key,
+ * so that keys used only a few times don't pay for them, and only for groups
+ * using the generic wNAF multiplication. Returns 0 if they aren't available,
+ * in which case the caller uses EC_POINT_mul() instead.
+ *
+ * The generator table is shared with every other key on the same curve, see
+ * ec_gen_precomp_get(). The public key table is the only per-key cost, 8
+ * points for each 8 bits of the order: some 115 KB for P-384 and 185 KB for
+ * P-521 on 64-bit platforms.
+ */
+int ossl_ec_key_get_verify_precomp(EC_KEY *key, EC_PRE_COMP *pre[2],
+                                   BN_CTX *ctx)
+{
+    const EC_GROUP *group = key->group;
+    EC_PRE_COMP *new_pre[2] = { NULL, NULL };
+    int count;
+
+    pre[0] = pre[1] = NULL;
+    if (group == NULL || key->pub_key == NULL || key->lock == NULL
+        || group->meth->mul != NULL
+        || group->meth->points_make_affine == NULL
+        || EC_GROUP_get0_generator(group) == NULL)
+        return 0;
+
+    if (!CRYPTO_THREAD_read_lock(key->lock))
+        return 0;
+    if (key->verify_pre_comp[1] != NULL) {
+        pre[0] = EC_ec_pre_comp_dup(key->verify_pre_comp[0]);
+        pre[1] = EC_ec_pre_comp_dup(key->verify_pre_comp[1]);
+    }
+    CRYPTO_THREAD_unlock(key->lock);
+    if (pre[1] != NULL)
+        return 1;
+
+    /* Only the verification that reaches the threshold makes them */
+    if (!CRYPTO_atomic_load_int(&key->verify_count, &count, key->lock)
+        || count >= EC_KEY_VERIFY_PRECOMP_AFTER
+        || !CRYPTO_atomic_add(&key->verify_count, 1, &count, key->lock)
+        || count != EC_KEY_VERIFY_PRECOMP_AFTER)
+        return 0;
+
+    /* Failing here is not an error, the verification just won't use them */
+    ERR_set_mark();
+    new_pre[0] = ec_gen_precomp_get(key->libctx, group, ctx);
+    if (new_pre[0] != NULL)
+        new_pre[1] = ossl_ec_wNAF_precompute_point(group, key->pub_key, ctx);
+    ERR_pop_to_mark();
+    if (new_pre[1] == NULL || !CRYPTO_THREAD_write_lock(key->lock)) {
+        EC_ec_pre_comp_free(new_pre[0]);
+        EC_ec_pre_comp_free(new_pre[1]);
+        return 0;
+    }
+    key->verify_pre_comp[0] = new_pre[0];
+    key->verify_pre_comp[1] = new_pre[1];
+    pre[0] = EC_ec_pre_comp_dup(new_pre[0]);
+    pre[1] = EC_ec_pre_comp_dup(new_pre[1]);
+    CRYPTO_THREAD_unlock(key->lock);
+    return 1;
+}
+
 size_t EC_KEY_priv2oct(const EC_KEY *eckey,
                        unsigned char *buf, size_t len)
 {
@@ -305,6 +305,14 @@ struct ec_key_st {
 
     /* Provider data */
     size_t dirty_cnt; /* If any key material changes, increment this */
+
+    /*
+     * Multiples of the generator and of pub_key for verification, made after
+     * a few uses: see ossl_ec_key_get_verify_precomp()
+     */
+    CRYPTO_RWLOCK *lock;
+    int verify_count;
+    EC_PRE_COMP *verify_pre_comp[2];
 };
 
 struct ec_point_st {
@@ -356,6 +364,12 @@ int ossl_ec_wNAF_mul(const EC_GROUP *group, EC_POINT *r, const BIGNUM *scalar,
                      size_t num, const EC_POINT *points[],
                      const BIGNUM *scalars[], BN_CTX *);
 int ossl_ec_wNAF_precompute_mult(EC_GROUP *group, BN_CTX *);
+EC_PRE_COMP *ossl_ec_wNAF_precompute_point(const EC_GROUP *group,
+                                           const EC_POINT *point, BN_CTX *ctx);
+int ossl_ec_wNAF_mul_precomputed(const EC_GROUP *group, EC_POINT *r,
+                                 size_t num, const EC_POINT *points[],
+                                 EC_PRE_COMP *pre[], const BIGNUM *scalars[],
+                                 BN_CTX *ctx);
 int ossl_ec_wNAF_have_precompute_mult(const EC_GROUP *group);
 
 /* method functions in ecp_smpl.c */
@@ -652,6 +666,8 @@ int ossl_ec_key_simple_oct2priv(EC_KEY *eckey, const unsigned char *buf,
 int ossl_ec_key_simple_generate_key(EC_KEY *eckey);
 int ossl_ec_key_simple_generate_public_key(EC_KEY *eckey);
 int ossl_ec_key_simple_check_key(const EC_KEY *eckey);
+int ossl_ec_key_get_verify_precomp(EC_KEY *key, EC_PRE_COMP *pre[2],
+                                   BN_CTX *ctx);
 
 #ifdef ECP_SM2P256_ASM
 /* Returns optimized methods for SM2 */
@@ -394,6 +394,89 @@ int ossl_ec_scalar_mul_ladder(const EC_GROUP *group, EC_POINT *r,
                   (b) >=   20 ? 2 : \
                   1))
 
+/*-
+ * Compute into |r| the sum of the |num| wNAF expansions in |wNAF|, where the
+ * digits of wNAF[i] select odd multiples of a point from val_sub[i]:
+ *    val_sub[i][0] :=     point
+ *    val_sub[i][1] := 3 * point
+ *    ...
+ */
+static int ec_wNAF_sum(const EC_GROUP *group, EC_POINT *r, size_t num,
+                       signed char *const *wNAF, const size_t *wNAF_len,
+                       size_t max_len, EC_POINT **const *val_sub, BN_CTX *ctx)
+{
+    size_t i;
+    int k;
+    int r_is_inverted = 0;
+    int r_is_at_infinity = 1;
+
+    for (k = max_len - 1; k >= 0; k--) {
+        if (!r_is_at_infinity) {
+            if (!EC_POINT_dbl(group, r, r, ctx))
+                return 0;
+        }
+
+        for (i = 0; i < num; i++) {
+            if (wNAF_len[i] > (size_t)k) {
+                int digit = wNAF[i][k];
+                int is_neg;
+
+                if (digit) {
+                    is_neg = digit < 0;
+
+                    if (is_neg)
+                        digit = -digit;
+
+                    if (is_neg != r_is_inverted) {
+                        if (!r_is_at_infinity) {
+                            if (!EC_POINT_invert(group, r, ctx))
+                                return 0;
+                        }
+                        r_is_inverted = !r_is_inverted;
+                    }
+
+                    /* digit > 0 */
+
+                    if (r_is_at_infinity) {
+                        if (!EC_POINT_copy(r, val_sub[i][digit >> 1]))
+                            return 0;
+
+                        /*-
+                         * Apply coordinate blinding for EC_POINT.
+                         *
+                         * The underlying EC_METHOD can optionally implement this function:
+                         * ossl_ec_point_blind_coordinates() returns 0 in case of errors or 1 on
+                         * success or if coordinate blinding is not implemented for this
+                         * group.
+                         */
+                        if (!ossl_ec_point_blind_coordinates(group, r, ctx)) {
+                            ERR_raise(ERR_LIB_EC, EC_R_POINT_COORDINATES_BLIND_FAILURE);
+                            return 0;
+                        }
+
+                        r_is_at_infinity = 0;
+                    } else {
+                        if (!EC_POINT_add
+                            (group, r, r, val_sub[i][digit >> 1], ctx))
+                            return 0;
+                    }
+                }
+            }
+        }
+    }
+
+    if (r_is_at_infinity) {
+        if (!EC_POINT_set_to_infinity(group, r))
+            return 0;
+    } else {
+        if (r_is_inverted)
+            if (!EC_POINT_invert(group, r, ctx))
+                return 0;
+    }
+
+    return 1;
+}
+
 /*-
  * Compute
  *      \sum scalars[i]*points[i],
@@ -411,9 +494,6 @@ int ossl_ec_wNAF_mul(const EC_GROUP *group, EC_POINT *r, const BIGNUM *scalar,
     size_t blocksize = 0, numblocks = 0; /* for wNAF splitting */
     size_t pre_points_per_block = 0;
     size_t i, j;
-    int k;
-    int r_is_inverted = 0;
-    int r_is_at_infinity = 1;
     size_t *wsize = NULL;       /* individual window sizes */
     signed char **wNAF = NULL;  /* individual wNAFs */
     size_t *wNAF_len = NULL;
@@ -706,71 +786,9 @@ int ossl_ec_wNAF_mul(const EC_GROUP *group, EC_POINT *r, const BIGNUM *scalar,
         || !group->meth->points_make_affine(group, num_val, val, ctx))
         goto err;
 
-    r_is_at_infinity = 1;
-
-    for (k = max_len - 1; k >= 0; k--) {
-        if (!r_is_at_infinity) {
-            if (!EC_POINT_dbl(group, r, r, ctx))
-                goto err;
-        }
-
-        for (i = 0; i < totalnum; i++) {
-            if (wNAF_len[i] > (size_t)k) {
-                int digit = wNAF[i][k];
-                int is_neg;
-
-                if (digit) {
-                    is_neg = digit < 0;
-
-                    if (is_neg)
-                        digit = -digit;
-
-                    if (is_neg != r_is_inverted) {
-                        if (!r_is_at_infinity) {
-                            if (!EC_POINT_invert(group, r, ctx))
-                                goto err;
-                        }
-                        r_is_inverted = !r_is_inverted;
-                    }
-
-                    /* digit > 0 */
-
-                    if (r_is_at_infinity) {
-                        if (!EC_POINT_copy(r, val_sub[i][digit >> 1]))
-                            goto err;
-
-                        /*-
-                         * Apply coordinate blinding for EC_POINT.
-                         *
-                         * The underlying EC_METHOD can optionally implement this function:
-                         * ossl_ec_point_blind_coordinates() returns 0 in case of errors or 1 on
-                         * success or if coordinate blinding is not implemented for this
-                         * group.
-                         */
-                        if (!ossl_ec_point_blind_coordinates(group, r, ctx)) {
-                            ERR_raise(ERR_LIB_EC, EC_R_POINT_COORDINATES_BLIND_FAILURE);
-                            goto err;
-                        }
-
-                        r_is_at_infinity = 0;
-                    } else {
-                        if (!EC_POINT_add
-                            (group, r, r, val_sub[i][digit >> 1], ctx))
-                            goto err;
-                    }
-                }
-            }
-        }
-    }
-
-    if (r_is_at_infinity) {
-        if (!EC_POINT_set_to_infinity(group, r))
-            goto err;
-    } else {
-        if (r_is_inverted)
-            if (!EC_POINT_invert(group, r, ctx))
-                goto err;
-    }
+    if (!ec_wNAF_sum(group, r, totalnum, wNAF, wNAF_len, max_len, val_sub,
+                     ctx))
+        goto err;
 
     ret = 1;
 
@@ -797,49 +815,41 @@ int ossl_ec_wNAF_mul(const EC_GROUP *group, EC_POINT *r, const BIGNUM *scalar,
 }
 
 /*-
- * ossl_ec_wNAF_precompute_mult()
- * creates an EC_PRE_COMP object with preprecomputed multiples of the generator
- * for use with wNAF splitting as implemented in ossl_ec_wNAF_mul().
+ * ossl_ec_wNAF_precompute_point()
+ * creates an EC_PRE_COMP object with precomputed multiples of 'point'
+ * for use with wNAF splitting as implemented in ossl_ec_wNAF_mul() and
+ * ossl_ec_wNAF_mul_precomputed().
  *
- * 'pre_comp->points' is an array of multiples of the generator
+ * 'pre_comp->points' is an array of multiples of the point
  * of the following form:
- * points[0] =     generator;
- * points[1] = 3 * generator;
+ * points[0] =     point;
+ * points[1] = 3 * point;
  * ...
- * points[2^(w-1)-1] =     (2^(w-1)-1) * generator;
- * points[2^(w-1)]   =     2^blocksize * generator;
- * points[2^(w-1)+1] = 3 * 2^blocksize * generator;
+ * points[2^(w-1)-1] =     (2^(w-1)-1) * point;
+ * points[2^(w-1)]   =     2^blocksize * point;
+ * points[2^(w-1)+1] = 3 * 2^blocksize * point;
  * ...
- * points[2^(w-1)*(numblocks-1)-1] = (2^(w-1)) *  2^(blocksize*(numblocks-2)) * generator
- * points[2^(w-1)*(numblocks-1)]   =              2^(blocksize*(numblocks-1)) * generator
+ * points[2^(w-1)*(numblocks-1)-1] = (2^(w-1)) *  2^(blocksize*(numblocks-2)) * point
+ * points[2^(w-1)*(numblocks-1)]   =              2^(blocksize*(numblocks-1)) * point
  * ...
- * points[2^(w-1)*numblocks-1]     = (2^(w-1)) *  2^(blocksize*(numblocks-1)) * generator
+ * points[2^(w-1)*numblocks-1]     = (2^(w-1)) *  2^(blocksize*(numblocks-1)) * point
  * points[2^(w-1)*numblocks]       = NULL
  */
-int ossl_ec_wNAF_precompute_mult(EC_GROUP *group, BN_CTX *ctx)
+EC_PRE_COMP *ossl_ec_wNAF_precompute_point(const EC_GROUP *group,
+                                           const EC_POINT *point, BN_CTX *ctx)
 {
-    const EC_POINT *generator;
     EC_POINT *tmp_point = NULL, *base = NULL, **var;
     const BIGNUM *order;
     size_t i, bits, w, pre_points_per_block, blocksize, numblocks, num;
     EC_POINT **points = NULL;
-    EC_PRE_COMP *pre_comp;
-    int ret = 0;
+    EC_PRE_COMP *pre_comp, *ret = NULL;
     int used_ctx = 0;
 #ifndef FIPS_MODULE
     BN_CTX *new_ctx = NULL;
 #endif
 
-    /* if there is an old EC_PRE_COMP object, throw it away */
-    EC_pre_comp_free(group);
     if ((pre_comp = ec_pre_comp_new(group)) == NULL)
-        return 0;
-
-    generator = EC_GROUP_get0_generator(group);
-    if (generator == NULL) {
-        ERR_raise(ERR_LIB_EC, EC_R_UNDEFINED_GENERATOR);
-        goto err;
-    }
+        return NULL;
 
 #ifndef FIPS_MODULE
     if (ctx == NULL)
@@ -900,7 +910,7 @@ int ossl_ec_wNAF_precompute_mult(EC_GROUP *group, BN_CTX *ctx)
         goto err;
     }
 
-    if (!EC_POINT_copy(base, generator))
+    if (!EC_POINT_copy(base, point))
         goto err;
 
     /* do the precomputation */
@@ -952,9 +962,8 @@ int ossl_ec_wNAF_precompute_mult(EC_GROUP *group, BN_CTX *ctx)
     pre_comp->points = points;
     points = NULL;
     pre_comp->num = num;
-    SETPRECOMP(group, ec, pre_comp);
+    ret = pre_comp;
     pre_comp = NULL;
-    ret = 1;
 
  err:
     if (used_ctx)
@@ -975,6 +984,111 @@ int ossl_ec_wNAF_precompute_mult(EC_GROUP *group, BN_CTX *ctx)
     return ret;
 }
 
+/*-
+ * ossl_ec_wNAF_precompute_mult()
+ * attaches precomputed multiples of the generator, as made by
+ * ossl_ec_wNAF_precompute_point(), to the group.
+ */
+int ossl_ec_wNAF_precompute_mult(EC_GROUP *group, BN_CTX *ctx)
+{
+    const EC_POINT *generator;
+    EC_PRE_COMP *pre_comp;
+
+    /* if there is an old EC_PRE_COMP object, throw it away */
+    EC_pre_comp_free(group);
+
+    generator = EC_GROUP_get0_generator(group);
+    if (generator == NULL) {
+        ERR_raise(ERR_LIB_EC, EC_R_UNDEFINED_GENERATOR);
+        return 0;
+    }
+
+    if ((pre_comp = ossl_ec_wNAF_precompute_point(group, generator, ctx))
+            == NULL)
+        return 0;
+    SETPRECOMP(group, ec, pre_comp);
+    return 1;
+}
+
+/*-
+ * Compute
+ *      \sum scalars[i]*points[i]
+ * using only the multiples of points[i] in pre[i], as made by
+ * ossl_ec_wNAF_precompute_point(), with every wNAF split in blocks so that
+ * there are only about 'blocksize' doublings. pre[i] may have been made for
+ * a different EC_GROUP object, but it must be equal to |group|. If any pre[i]
+ * doesn't match its point this falls back to ossl_ec_wNAF_mul(). Like that,
+ * this is not constant time so it is only for public scalars such as those of
+ * a signature verification, which must be reduced modulo the group order.
+ */
+int ossl_ec_wNAF_mul_precomputed(const EC_GROUP *group, EC_POINT *r,
+                                 size_t num, const EC_POINT *points[],
+                                 EC_PRE_COMP *pre[], const BIGNUM *scalars[],
+                                 BN_CTX *ctx)
+{
+    size_t totalnum = 0, max_len = 0, len, blocksize, i, b, n = 0;
+    signed char **wNAF = NULL;  /* wNAF blocks */
+    signed char *tmp_wNAF, *pp;
+    size_t *wNAF_len = NULL;
+    EC_POINT ***val_sub = NULL;
+    int ret = 0;
+
+    for (i = 0; i < num; i++) {
+        if (pre[i] == NULL || pre[i]->numblocks == 0
+            || EC_POINT_cmp(group, points[i], pre[i]->points[0], ctx) != 0)
+            return ossl_ec_wNAF_mul(group, r, NULL, num, points, scalars, ctx);
+        totalnum += pre[i]->numblocks;
+    }
+
+    /* include space for pivot */
+    wNAF = OPENSSL_zalloc((totalnum + 1) * sizeof(wNAF[0]));
+    wNAF_len = OPENSSL_malloc(totalnum * sizeof(wNAF_len[0]));
+    val_sub = OPENSSL_malloc(totalnum * sizeof(val_sub[0]));
+    if (wNAF == NULL || wNAF_len == NULL || val_sub == NULL)
+        goto err;
+
+    for (i = 0; i < num; i++) {
+        blocksize = pre[i]->blocksize;
+        tmp_wNAF = bn_compute_wNAF(scalars[i], pre[i]->w, &len);
+        if (tmp_wNAF == NULL)
+            goto err;
+
+        /* the last block gets whatever is left */
+        for (b = 0, pp = tmp_wNAF; len > 0; b++, n++) {
+            wNAF_len[n] = len;
+            if (len > blocksize && b < pre[i]->numblocks - 1)
+                wNAF_len[n] = blocksize;
+            wNAF[n] = OPENSSL_malloc(wNAF_len[n]);
+            if (wNAF[n] == NULL) {
+                OPENSSL_free(tmp_wNAF);
+                goto err;
+            }
+            memcpy(wNAF[n], pp, wNAF_len[n]);
+            if (wNAF_len[n] > max_len)
+                max_len = wNAF_len[n];
+            val_sub[n] = pre[i]->points + (b << (pre[i]->w - 1));
+            pp += wNAF_len[n];
+            len -= wNAF_len[n];
+        }
+        OPENSSL_free(tmp_wNAF);
+    }
+
+    ret = ec_wNAF_sum(group, r, n, wNAF, wNAF_len, max_len, val_sub, ctx);
+
+ err:
+    if (wNAF != NULL) {
+        signed char **w;
+
+        for (w = wNAF; *w != NULL; w++)
+            OPENSSL_free(*w);
+
+        OPENSSL_free(wNAF);
+    }
+    OPENSSL_free(wNAF_len);
+    OPENSSL_free(val_sub);
+    return ret;
+}
+
 int ossl_ec_wNAF_have_precompute_mult(const EC_GROUP *group)
 {
     return HAVEPRECOMP(group, ec);
@@ -427,6 +427,7 @@ int ossl_ecdsa_simple_verify_sig(const unsigned char *dgst, int dgst_len,
     const BIGNUM *order;
     BIGNUM *u1, *u2, *m, *X;
     EC_POINT *point = NULL;
+    EC_PRE_COMP *pre[2] = { NULL, NULL };
     const EC_GROUP *group;
     const EC_POINT *pub_key;
 
@@ -506,7 +507,20 @@ int ossl_ecdsa_simple_verify_sig(const unsigned char *dgst, int dgst_len,
         ERR_raise(ERR_LIB_EC, ERR_R_EC_LIB);
         goto err;
     }
-    if (!EC_POINT_mul(group, point, u1, pub_key, u2, ctx)) {
+    if (ossl_ec_key_get_verify_precomp(eckey, pre, ctx)) {
+        const EC_POINT *points[2];
+        const BIGNUM *scalars[2];
+
+        points[0] = EC_GROUP_get0_generator(group);
+        points[1] = pub_key;
+        scalars[0] = u1;
+        scalars[1] = u2;
+        if (!ossl_ec_wNAF_mul_precomputed(group, point, 2, points, pre,
+                                          scalars, ctx)) {
+            ERR_raise(ERR_LIB_EC, ERR_R_EC_LIB);
+            goto err;
+        }
+    } else if (!EC_POINT_mul(group, point, u1, pub_key, u2, ctx)) {
         ERR_raise(ERR_LIB_EC, ERR_R_EC_LIB);
         goto err;
     }
@@ -526,5 +540,7 @@ int ossl_ecdsa_simple_verify_sig(const unsigned char *dgst, int dgst_len,
     BN_CTX_end(ctx);
     BN_CTX_free(ctx);
     EC_POINT_free(point);
+    EC_ec_pre_comp_free(pre[0]);
+    EC_ec_pre_comp_free(pre[1]);
     return ret;
 }
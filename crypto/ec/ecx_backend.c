@@ -131,6 +131,9 @@ ECX_KEY *ossl_ecx_key_dup(const ECX_KEY *key, int selection)
         && key->haspubkey == 1) {
         memcpy(ret->pubkey, key->pubkey, sizeof(ret->pubkey));
         ret->haspubkey = 1;
+        if (key->precomp != NULL
+            && (ret->precomp = ossl_ed25519_precomp_new(ret->pubkey)) == NULL)
+            goto err;
     }
 
     if ((selection & OSSL_KEYMGMT_SELECT_PRIVATE_KEY) != 0
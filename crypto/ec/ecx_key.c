@@ -76,6 +76,7 @@ void ossl_ecx_key_free(ECX_KEY *key)
 
     OPENSSL_free(key->propq);
     OPENSSL_secure_clear_free(key->privkey, key->keylen);
+    ossl_ed25519_precomp_free(key->precomp);
     CRYPTO_FREE_REF(&key->references);
     OPENSSL_free(key);
 }
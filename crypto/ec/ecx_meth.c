@@ -822,7 +822,7 @@ static int pkey_ecd_digestsign25519(EVP_MD_CTX *ctx, unsigned char *sig,
     }
 
     if (ossl_ed25519_sign(sig, tbs, tbslen, edkey->pubkey, edkey->privkey,
-                          0, 0, 0,
+                          edkey->precomp, 0, 0, 0,
                           NULL, 0,
                           NULL, NULL) == 0)
         return 0;
@@ -872,7 +872,7 @@ static int pkey_ecd_digestverify25519(EVP_MD_CTX *ctx, const unsigned char *sig,
         return 0;
 
     return ossl_ed25519_verify(tbs, tbslen, sig, edkey->pubkey,
-                               0, 0, 0,
+                               edkey->precomp, 0, 0, 0,
                                NULL, 0,
                                edkey->libctx, edkey->propq);
 }
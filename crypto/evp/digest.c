@@ -736,6 +736,61 @@ int EVP_Digest(const void *data, size_t count,
     return ret;
 }
 
+int EVP_DigestBatch(const EVP_MD *type, size_t num,
+                    const unsigned char *in[], const size_t inlen[],
+                    unsigned char *out[], size_t outlen)
+{
+    EVP_MD *fetched = NULL;
+    EVP_MD_CTX *ctx = NULL;
+    size_t i;
+    int xof, ret = 0;
+
+    if (type == NULL) {
+        ERR_raise(ERR_LIB_EVP, EVP_R_NO_DIGEST_SET);
+        return 0;
+    }
+    xof = (EVP_MD_get_flags(type) & EVP_MD_FLAG_XOF) != 0;
+    if (!xof && outlen != (size_t)EVP_MD_get_size(type)) {
+        ERR_raise(ERR_LIB_EVP, EVP_R_INVALID_LENGTH);
+        return 0;
+    }
+    if (num == 0)
+        return 1;
+
+#ifndef FIPS_MODULE
+    /* Same implicit fetch as EVP_DigestInit_ex() does for legacy digests */
+    if (type->prov == NULL && type->type != NID_undef) {
+        ERR_set_mark();
+        fetched = EVP_MD_fetch(NULL, OBJ_nid2sn(type->type), "");
+        ERR_pop_to_mark();
+        if (fetched != NULL)
+            type = fetched;
+    }
+#endif
+
+    if (type->dbatch != NULL) {
+        ret = type->dbatch(ossl_provider_ctx(type->prov), num, in, inlen,
+                           out, outlen);
+        goto end;
+    }
+
+    if ((ctx = EVP_MD_CTX_new()) == NULL)
+        goto end;
+    EVP_MD_CTX_set_flags(ctx, EVP_MD_CTX_FLAG_ONESHOT);
+    for (i = 0; i < num; i++) {
+        if (!EVP_DigestInit_ex(ctx, type, NULL)
+            || !EVP_DigestUpdate(ctx, in[i], inlen[i])
+            || !(xof ? EVP_DigestFinalXOF(ctx, out[i], outlen)
+                     : EVP_DigestFinal_ex(ctx, out[i], NULL)))
+            goto end;
+    }
+    ret = 1;
+ end:
+    EVP_MD_CTX_free(ctx);
+    EVP_MD_free(fetched);
+    return ret;
+}
+
 int EVP_Q_digest(OSSL_LIB_CTX *libctx, const char *name, const char *propq,
                  const void *data, size_t datalen,
                  unsigned char *md, size_t *mdlen)
@@ -1070,6 +1125,10 @@ static void *evp_md_from_algorithm(int name_id,
                 md->digest = OSSL_FUNC_digest_digest(fns);
             /* We don't increment fnct for this as it is stand alone */
             break;
+        case OSSL_FUNC_DIGEST_BATCH:
+            if (md->dbatch == NULL)
+                md->dbatch = OSSL_FUNC_digest_batch(fns);
+            break;
         case OSSL_FUNC_DIGEST_FREECTX:
             if (md->freectx == NULL) {
                 md->freectx = OSSL_FUNC_digest_freectx(fns);
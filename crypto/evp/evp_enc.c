@@ -1039,6 +1039,114 @@ int EVP_DecryptFinal_ex(EVP_CIPHER_CTX *ctx, unsigned char *out, int *outl)
     return 1;
 }
 
+/*
+ * Seal or open one AEAD message through the regular EVP calls.  Used for
+ * contexts whose implementation has no batch entry point.
+ */
+static int evp_cipher_aead_one(EVP_CIPHER_CTX *ctx, const unsigned char *iv,
+                               const unsigned char *aad, size_t aadlen,
+                               unsigned char *out, const unsigned char *in,
+                               size_t inl, unsigned char *tag, size_t taglen)
+{
+    int outl, tmpl;
+
+    if (aadlen > INT_MAX || inl > INT_MAX || taglen > INT_MAX)
+        return 0;
+    if (!EVP_CipherInit_ex2(ctx, NULL, NULL, iv, -1, NULL))
+        return 0;
+    if (!ctx->encrypt
+            && EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_SET_TAG, (int)taglen,
+                                   tag) <= 0)
+        return 0;
+    /* CCM needs the total message length up front */
+    if (EVP_CIPHER_CTX_get_mode(ctx) == EVP_CIPH_CCM_MODE
+            && !EVP_CipherUpdate(ctx, NULL, &outl, NULL, (int)inl))
+        return 0;
+    if (aadlen > 0
+            && !EVP_CipherUpdate(ctx, NULL, &outl, aad, (int)aadlen))
+        return 0;
+    if (!EVP_CipherUpdate(ctx, out, &outl, in, (int)inl)
+            || !EVP_CipherFinal_ex(ctx, out + outl, &tmpl))
+        return 0;
+    if (ctx->encrypt
+            && EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_GET_TAG, (int)taglen,
+                                   tag) <= 0)
+        return 0;
+    return 1;
+}
+
+/* Number of provider contexts handed to a batch call at once */
+#define EVP_AEAD_BATCH_CHUNK 32
+
+int EVP_CipherAEADBatch(EVP_CIPHER_CTX *ctx[], size_t num,
+                        const unsigned char *iv[],
+                        const unsigned char *aad[], const size_t aadlen[],
+                        unsigned char *out[], const unsigned char *in[],
+                        const size_t inl[], unsigned char *tag[],
+                        size_t taglen, int ok[])
+{
+    void *algctx[EVP_AEAD_BATCH_CHUNK];
+    size_t i, n;
+    int ret = 1;
+
+    if (num == 0)
+        return 1;
+    if (ctx == NULL || iv == NULL || aad == NULL || aadlen == NULL
+            || out == NULL || in == NULL || inl == NULL || tag == NULL) {
+        ERR_raise(ERR_LIB_EVP, ERR_R_PASSED_NULL_PARAMETER);
+        return 0;
+    }
+
+    for (i = 0; i < num; i += n) {
+        const EVP_CIPHER *cipher = ctx[i] == NULL ? NULL : ctx[i]->cipher;
+
+        n = 1;
+        if (cipher == NULL) {
+            ERR_raise(ERR_LIB_EVP, EVP_R_NO_CIPHER_SET);
+            if (ok != NULL)
+                ok[i] = 0;
+            ret = 0;
+            continue;
+        }
+        if ((EVP_CIPHER_get_flags(cipher) & EVP_CIPH_FLAG_AEAD_CIPHER) == 0) {
+            ERR_raise(ERR_LIB_EVP, EVP_R_UNSUPPORTED_CIPHER);
+            if (ok != NULL)
+                ok[i] = 0;
+            ret = 0;
+            continue;
+        }
+
+        if (cipher->prov == NULL || cipher->aead_batch == NULL) {
+            int r = evp_cipher_aead_one(ctx[i], iv[i], aad[i], aadlen[i],
+                                        out[i], in[i], inl[i], tag[i],
+                                        taglen);
+
+            if (ok != NULL)
+                ok[i] = r;
+            ret &= r;
+            continue;
+        }
+
+        /*
+         * Hand a run of contexts served by the same implementation to the
+         * provider in one call so that it can interleave them.
+         */
+        algctx[0] = ctx[i]->algctx;
+        while (n < EVP_AEAD_BATCH_CHUNK && i + n < num
+               && ctx[i + n] != NULL && ctx[i + n]->cipher != NULL
+               && ctx[i + n]->cipher->prov == cipher->prov
+               && ctx[i + n]->cipher->aead_batch == cipher->aead_batch) {
+            algctx[n] = ctx[i + n]->algctx;
+            n++;
+        }
+        if (!cipher->aead_batch(algctx, n, iv + i, aad + i, aadlen + i,
+                                out + i, in + i, inl + i, tag + i, taglen,
+                                ok == NULL ? NULL : ok + i))
+            ret = 0;
+    }
+    return ret;
+}
+
 int EVP_CIPHER_CTX_set_key_length(EVP_CIPHER_CTX *c, int keylen)
 {
     if (c->cipher->prov != NULL) {
@@ -1672,6 +1780,11 @@ static void *evp_cipher_from_algorithm(const int name_id,
             cipher->settable_ctx_params =
                 OSSL_FUNC_cipher_settable_ctx_params(fns);
             break;
+        case OSSL_FUNC_CIPHER_AEAD_BATCH:
+            if (cipher->aead_batch != NULL)
+                break;
+            cipher->aead_batch = OSSL_FUNC_cipher_aead_batch(fns);
+            break;
         }
     }
     if ((fnciphcnt != 0 && fnciphcnt != 3 && fnciphcnt != 4)
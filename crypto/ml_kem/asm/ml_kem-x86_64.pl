@@ -0,0 +1,576 @@
+#! /usr/bin/env perl
+# Copyright 2024 The OpenSSL Project Authors. All Rights Reserved.
+#
+# Licensed under the Apache License 2.0 (the "License").  You may not use
+# this file except in compliance with the License.  You can obtain a copy
+# in the file LICENSE in the source distribution or at
+# https://www.openssl.org/source/license.html
+
+#
+# AVX2 number theoretic transforms for ML-KEM, FIPS 203 Algorithms 9
+# and 10, operating on 256 16-bit coefficients modulo q = 3329.
+#
+# Both functions take and return coefficients in [0, q), so that they
+# can be used interchangeably with the C code. Multiplications by the
+# twiddle factors are signed Montgomery multiplications with the
+# factors pre-scaled by 2^16, hence no extra factor is introduced.
+#
+# The first three layers of the forward transform (last three of the
+# inverse) are done on eight registers holding coefficients 32 apart,
+# in two passes. The remaining four layers are done on 32 coefficients
+# at a time, with the butterflies of length 8, 4 and 2 brought between
+# registers by vperm2i128, vpunpck[lh]qdq and shift-and-blend shuffles.
+# Each of these shuffles is its own inverse, which restores the natural
+# coefficient order before the results are stored.
+#
+# ossl_ml_kem_ntt_capable returns 1 if the processor and assembler
+# support AVX2 and 0 otherwise, in which case the caller is expected to
+# use the C code.
+
+# $output is the last argument if it looks like a file (it has an extension)
+# $flavour is the first argument if it doesn't look like a file
+$output = $#ARGV >= 0 && $ARGV[$#ARGV] =~ m|\.\w+$| ? pop : undef;
+$flavour = $#ARGV >= 0 && $ARGV[0] !~ m|\.| ? shift : undef;
+
+$win64=0; $win64=1 if ($flavour =~ /[nm]asm|mingw64/ || $output =~ /\.asm$/);
+
+$0 =~ m/(.*[\/\\])[^\/\\]+$/; $dir=$1;
+( $xlate="${dir}x86_64-xlate.pl" and -f $xlate ) or
+( $xlate="${dir}../../perlasm/x86_64-xlate.pl" and -f $xlate) or
+die "can't locate x86_64-xlate.pl";
+
+$avx=0;
+
+if (`$ENV{CC} -Wa,-v -c -o /dev/null -x assembler /dev/null 2>&1`
+		=~ /GNU assembler version ([2-9]\.[0-9]+)/) {
+	$avx = ($1>=2.19) + ($1>=2.22) + ($1>=2.25);
+}
+
+if (!$avx && $win64 && ($flavour =~ /nasm/ || $ENV{ASM} =~ /nasm/) &&
+	   `nasm -v 2>&1` =~ /NASM version ([2-9]\.[0-9]+)/) {
+	$avx = ($1>=2.09) + ($1>=2.10) + ($1>=2.12);
+}
+
+if (!$avx && $win64 && ($flavour =~ /masm/ || $ENV{ASM} =~ /ml64/) &&
+	   `ml64 2>&1` =~ /Version ([0-9]+)\./) {
+	$avx = ($1>=10) + ($1>=12);
+}
+
+if (!$avx && `$ENV{CC} -v 2>&1` =~ /((?:clang|LLVM) version|.*based on LLVM) ([0-9]+\.[0-9]+)/) {
+	$avx = ($2>=3.0) + ($2>3.0);
+}
+
+open OUT,"| \"$^X\" \"$xlate\" $flavour \"$output\""
+    or die "can't call $xlate: $!";
+*STDOUT=*OUT;
+
+my $q = 3329;
+my $qinv = 62209;		# q^-1 mod 2^16
+my $barrett = 20159;		# round(2^26 / q)
+my $f = 512;			# 2^16 / 128, scales inverse NTT
+
+sub bitrev7 {
+my $i=shift;
+my $r=0;
+    for (my $b=0; $b<7; $b++) { $r = ($r<<1) | (($i>>$b)&1); }
+    return $r;
+}
+
+# zeta^BitRev7(i) in Montgomery form, centred around 0
+my @zetas;
+for (my $i=0; $i<128; $i++) {
+    my $z=1;
+    for (my $e=0; $e<bitrev7($i); $e++) { $z = ($z*17) % $q; }
+    $z = ($z*65536) % $q;
+    $z -= $q if ($z > $q/2);
+    push @zetas,$z;
+}
+
+sub w16 { return sprintf("0x%04x",$_[0] & 0xffff); }
+sub zq { return ((($_[0] % 65536) * $qinv) % 65536); }
+
+# Emits the twiddle factors of a vector, followed by the same multiplied
+# by q^-1, each factor repeated $rep times
+sub zvec {
+my $rep=shift;
+my @z=map { ($_) x $rep } @_;
+    return "\t.value\t".join(",",map(w16($_),@z))."\n".
+           "\t.value\t".join(",",map(w16(zq($_)),@z))."\n";
+}
+
+my $xframe = $win64 ? 0xa8 : 8;
+
+$code.=<<___;
+.text
+
+.extern	OPENSSL_ia32cap_P
+
+.globl	ossl_ml_kem_ntt_capable
+.type	ossl_ml_kem_ntt_capable,\@abi-omnipotent
+.align	32
+ossl_ml_kem_ntt_capable:
+	xor	%eax,%eax
+___
+$code.=<<___ if ($avx>1);
+	mov	OPENSSL_ia32cap_P+8(%rip),%ecx
+	shr	\$5,%ecx			# avx2
+	and	\$1,%ecx
+	mov	%ecx,%eax
+___
+$code.=<<___;
+	ret
+.size	ossl_ml_kem_ntt_capable,.-ossl_ml_kem_ntt_capable
+___
+
+if ($avx>1) {{{
+my ($P,$Z)=("%rdi","%rax");
+my @R=map("%ymm$_",(0..7));
+my ($t0,$t1,$zeta,$zetaq)=map("%ymm$_",(8..11));
+my ($V,$Q)=("%ymm14","%ymm15");
+
+# $r = $a * zeta / 2^16 mod q, |$r| < q; $r may be $a
+sub montmul {
+my ($r,$a,$z,$zq,$t)=@_;
+	$code.=<<___;
+	vpmullw	$zq,$a,$t
+	vpmulhw	$z,$a,$r
+	vpmulhw	$Q,$t,$t
+	vpsubw	$t,$r,$r
+___
+}
+
+# $a = $a mod q in [0, q], for |$a| < 2^15
+sub reduce {
+my ($a,$t)=@_;
+	$code.=<<___;
+	vpmulhw	$V,$a,$t
+	vpsraw	\$10,$t,$t
+	vpmullw	$Q,$t,$t
+	vpsubw	$t,$a,$a
+___
+}
+
+# $a = $a - q if $a >= q
+sub csubq {
+my ($a,$t)=@_;
+	$code.=<<___;
+	vpsubw	$Q,$a,$a
+	vpsraw	\$15,$a,$t
+	vpand	$Q,$t,$t
+	vpaddw	$t,$a,$a
+___
+}
+
+# Cooley-Tukey butterfly, ($a, $b) = ($a + zeta * $b, $a - zeta * $b)
+sub ct_butterfly {
+my ($a,$b,$z,$zq)=@_;
+	&montmul($t0,$b,$z,$zq,$t1);
+	$code.=<<___;
+	vpsubw	$t0,$a,$b
+	vpaddw	$t0,$a,$a
+___
+}
+
+# Gentleman-Sande butterfly, ($a, $b) = ($a + $b, zeta * ($b - $a))
+sub gs_butterfly {
+my ($a,$b,$z,$zq)=@_;
+	$code.=<<___;
+	vpsubw	$a,$b,$t0
+	vpaddw	$b,$a,$a
+___
+	&reduce($a,$t1);
+	&montmul($b,$t0,$z,$zq,$t1);
+}
+
+sub bcast_zeta {
+my $i=shift;
+	$code.=<<___;
+	vpbroadcastw	`2*$i`($Z),$zeta
+	vpbroadcastw	`2*$i+256`($Z),$zetaq
+___
+}
+
+# Exchange 128-bit halves, ([x0,x1],[y0,y1]) <-> ([x0,y0],[x1,y1]),
+# and likewise 64-bit and 32-bit elements within 128-bit lanes. Each
+# returns the output registers.
+sub shuffle128 {
+my ($a,$b,$t)=@_;
+	$code.=<<___;
+	vperm2i128	\$0x20,$b,$a,$t
+	vperm2i128	\$0x31,$b,$a,$b
+___
+	return ($t,$b,$a);
+}
+
+sub shuffle64 {
+my ($a,$b,$t)=@_;
+	$code.=<<___;
+	vpunpcklqdq	$b,$a,$t
+	vpunpckhqdq	$b,$a,$b
+___
+	return ($t,$b,$a);
+}
+
+sub shuffle32 {
+my ($a,$b,$t)=@_;
+	$code.=<<___;
+	vpsllq	\$32,$b,$t
+	vpsrlq	\$32,$a,$t1
+	vpblendd	\$0xaa,$t,$a,$a
+	vpblendd	\$0xaa,$b,$t1,$b
+___
+	return ($a,$b,$t);
+}
+
+sub prologue {
+my $name=shift;
+	$code.=<<___;
+.globl	$name
+.type	$name,\@function,1
+.align	32
+$name:
+.cfi_startproc
+	mov	%rsp,%r9			# frame pointer
+.cfi_def_cfa_register	%r9
+	sub	\$$xframe,%rsp
+___
+	$code.=<<___ if ($win64);
+	movaps	%xmm6,-0xa8(%r9)
+	movaps	%xmm7,-0x98(%r9)
+	movaps	%xmm8,-0x88(%r9)
+	movaps	%xmm9,-0x78(%r9)
+	movaps	%xmm10,-0x68(%r9)
+	movaps	%xmm11,-0x58(%r9)
+	movaps	%xmm12,-0x48(%r9)
+	movaps	%xmm13,-0x38(%r9)
+	movaps	%xmm14,-0x28(%r9)
+	movaps	%xmm15,-0x18(%r9)
+___
+}
+
+sub epilogue {
+my ($name,$label)=@_;
+	$code.="	vzeroupper\n";
+	$code.=<<___ if ($win64);
+	movaps	-0xa8(%r9),%xmm6
+	movaps	-0x98(%r9),%xmm7
+	movaps	-0x88(%r9),%xmm8
+	movaps	-0x78(%r9),%xmm9
+	movaps	-0x68(%r9),%xmm10
+	movaps	-0x58(%r9),%xmm11
+	movaps	-0x48(%r9),%xmm12
+	movaps	-0x38(%r9),%xmm13
+	movaps	-0x28(%r9),%xmm14
+	movaps	-0x18(%r9),%xmm15
+___
+	$code.=<<___;
+	lea	(%r9),%rsp
+.cfi_def_cfa_register	%rsp
+$label:
+	ret
+.cfi_endproc
+.size	$name,.-$name
+___
+}
+
+######################################################################
+# void ossl_ml_kem_ntt_avx2(uint16_t p[256]);
+#
+# Coefficients grow by at most q per layer, |p[i]| < 8q after seven
+# layers, which fits signed 16 bits without intermediate reductions.
+&prologue("ossl_ml_kem_ntt_avx2");
+$code.=<<___;
+.Lntt_body:
+	vmovdqa	.Lq(%rip),$Q
+	vmovdqa	.Lbarrett(%rip),$V
+	lea	.Lzetas(%rip),$Z
+___
+for (my $pass=0; $pass<2; $pass++) {
+    for (my $m=0; $m<8; $m++) {
+	$code.="	vmovdqu	`64*$m+32*$pass`($P),$R[$m]\n";
+    }
+    &bcast_zeta(1);
+    for (my $m=0; $m<4; $m++) { &ct_butterfly($R[$m],$R[$m+4],$zeta,$zetaq); }
+    for (my $g=0; $g<2; $g++) {
+	&bcast_zeta(2+$g);
+	for (my $m=4*$g; $m<4*$g+2; $m++) {
+	    &ct_butterfly($R[$m],$R[$m+2],$zeta,$zetaq);
+	}
+    }
+    for (my $g=0; $g<4; $g++) {
+	&bcast_zeta(4+$g);
+	&ct_butterfly($R[2*$g],$R[2*$g+1],$zeta,$zetaq);
+    }
+    for (my $m=0; $m<8; $m++) {
+	$code.="	vmovdqu	$R[$m],`64*$m+32*$pass`($P)\n";
+    }
+}
+$code.="	lea	.Lzetas_ntt(%rip),$Z\n";
+for (my $b=0; $b<8; $b++) {
+    my ($x,$y,$t)=@R[0..2];
+    my @zv=map(sprintf("%d(%s)",192*$b+32*$_,$Z),(0..5));
+
+    $code.=<<___;
+	vmovdqu	`64*$b`($P),$x
+	vmovdqu	`64*$b+32`($P),$y
+	vpbroadcastw	.Lzetas+`2*(8+$b)`(%rip),$zeta
+	vpbroadcastw	.Lzetas+`2*(8+$b)+256`(%rip),$zetaq
+___
+    &ct_butterfly($x,$y,$zeta,$zetaq);
+    ($x,$y,$t)=&shuffle128($x,$y,$t);
+    &ct_butterfly($x,$y,@zv[0,1]);
+    ($x,$y,$t)=&shuffle64($x,$y,$t);
+    &ct_butterfly($x,$y,@zv[2,3]);
+    ($x,$y,$t)=&shuffle32($x,$y,$t);
+    &ct_butterfly($x,$y,@zv[4,5]);
+    ($x,$y,$t)=&shuffle32($x,$y,$t);
+    ($x,$y,$t)=&shuffle64($x,$y,$t);
+    ($x,$y,$t)=&shuffle128($x,$y,$t);
+    for my $r ($x,$y) {
+	&reduce($r,$t0);
+	&csubq($r,$t0);
+    }
+    $code.=<<___;
+	vmovdqu	$x,`64*$b`($P)
+	vmovdqu	$y,`64*$b+32`($P)
+___
+}
+&epilogue("ossl_ml_kem_ntt_avx2",".Lntt_epilogue");
+
+######################################################################
+# void ossl_ml_kem_inverse_ntt_avx2(uint16_t p[256]);
+#
+# Sums are reduced to [0, q] and differences are multiplied by the
+# twiddle factors, so all values stay within (-2q, 2q) between layers.
+# The final scaling by 128^-1 is merged into the last layer.
+&prologue("ossl_ml_kem_inverse_ntt_avx2");
+$code.=<<___;
+.Linvntt_body:
+	vmovdqa	.Lq(%rip),$Q
+	vmovdqa	.Lbarrett(%rip),$V
+	lea	.Lzetas_invntt(%rip),$Z
+___
+for (my $b=0; $b<8; $b++) {
+    my ($x,$y,$t)=@R[0..2];
+    my @zv=map(sprintf("%d(%s)",192*$b+32*$_,$Z),(0..5));
+
+    $code.=<<___;
+	vmovdqu	`64*$b`($P),$x
+	vmovdqu	`64*$b+32`($P),$y
+___
+    ($x,$y,$t)=&shuffle128($x,$y,$t);
+    ($x,$y,$t)=&shuffle64($x,$y,$t);
+    ($x,$y,$t)=&shuffle32($x,$y,$t);
+    &gs_butterfly($x,$y,@zv[4,5]);
+    ($x,$y,$t)=&shuffle32($x,$y,$t);
+    &gs_butterfly($x,$y,@zv[2,3]);
+    ($x,$y,$t)=&shuffle64($x,$y,$t);
+    &gs_butterfly($x,$y,@zv[0,1]);
+    ($x,$y,$t)=&shuffle128($x,$y,$t);
+    $code.=<<___;
+	vpbroadcastw	.Lzetas+`2*(15-$b)`(%rip),$zeta
+	vpbroadcastw	.Lzetas+`2*(15-$b)+256`(%rip),$zetaq
+___
+    &gs_butterfly($x,$y,$zeta,$zetaq);
+    $code.=<<___;
+	vmovdqu	$x,`64*$b`($P)
+	vmovdqu	$y,`64*$b+32`($P)
+___
+}
+$code.="	lea	.Lzetas(%rip),$Z\n";
+for (my $pass=0; $pass<2; $pass++) {
+    for (my $m=0; $m<8; $m++) {
+	$code.="	vmovdqu	`64*$m+32*$pass`($P),$R[$m]\n";
+    }
+    for (my $g=0; $g<4; $g++) {
+	&bcast_zeta(7-$g);
+	&gs_butterfly($R[2*$g],$R[2*$g+1],$zeta,$zetaq);
+    }
+    for (my $g=0; $g<2; $g++) {
+	&bcast_zeta(3-$g);
+	for (my $m=4*$g; $m<4*$g+2; $m++) {
+	    &gs_butterfly($R[$m],$R[$m+2],$zeta,$zetaq);
+	}
+    }
+    &bcast_zeta(1);
+    for (my $m=0; $m<4; $m++) { &gs_butterfly($R[$m],$R[$m+4],$zeta,$zetaq); }
+    $code.=<<___;
+	vmovdqa	.Lf(%rip),$zeta
+	vmovdqa	.Lf+32(%rip),$zetaq
+___
+    for (my $m=0; $m<8; $m++) {
+	&montmul($R[$m],$R[$m],$zeta,$zetaq,$t0);
+	$code.=<<___;
+	vpsraw	\$15,$R[$m],$t0
+	vpand	$Q,$t0,$t0
+	vpaddw	$t0,$R[$m],$R[$m]
+	vmovdqu	$R[$m],`64*$m+32*$pass`($P)
+___
+    }
+}
+&epilogue("ossl_ml_kem_inverse_ntt_avx2",".Linvntt_epilogue");
+}}} else {
+$code.=<<___;
+.globl	ossl_ml_kem_ntt_avx2
+.type	ossl_ml_kem_ntt_avx2,\@abi-omnipotent
+ossl_ml_kem_ntt_avx2:
+.globl	ossl_ml_kem_inverse_ntt_avx2
+.type	ossl_ml_kem_inverse_ntt_avx2,\@abi-omnipotent
+ossl_ml_kem_inverse_ntt_avx2:
+	.byte	0x0f,0x0b	# ud2
+	ret
+.size	ossl_ml_kem_ntt_avx2,.-ossl_ml_kem_ntt_avx2
+.size	ossl_ml_kem_inverse_ntt_avx2,.-ossl_ml_kem_inverse_ntt_avx2
+___
+}
+
+######################################################################
+# Twiddle factors. .Lzetas holds all 128 factors followed by the same
+# multiplied by q^-1. .Lzetas_ntt and .Lzetas_invntt hold, for each
+# block of 32 coefficients, the vectors of the butterflies of length 8,
+# 4 and 2, in the order the forward and inverse transforms use them.
+$code.=<<___;
+.align	64
+.Lq:
+	.value	`join(",",(w16($q))x16)`
+.Lbarrett:
+	.value	`join(",",(w16($barrett))x16)`
+.Lf:
+___
+$code.=zvec(16,$f);
+$code.=".Lzetas:\n";
+for (my $i=0; $i<128; $i+=16) {
+    $code.="\t.value\t".join(",",map(w16($_),@zetas[$i..$i+15]))."\n";
+}
+for (my $i=0; $i<128; $i+=16) {
+    $code.="\t.value\t".join(",",map(w16(zq($_)),@zetas[$i..$i+15]))."\n";
+}
+$code.=".Lzetas_ntt:\n";
+for (my $b=0; $b<8; $b++) {
+    $code.=zvec(8,@zetas[16+2*$b..17+2*$b]);
+    $code.=zvec(4,@zetas[32+4*$b..35+4*$b]);
+    $code.=zvec(2,@zetas[64+8*$b..71+8*$b]);
+}
+$code.=".Lzetas_invntt:\n";
+for (my $b=0; $b<8; $b++) {
+    $code.=zvec(8,map($zetas[31-2*$b-$_],(0..1)));
+    $code.=zvec(4,map($zetas[63-4*$b-$_],(0..3)));
+    $code.=zvec(2,map($zetas[127-8*$b-$_],(0..7)));
+}
+$code.=<<___;
+.asciz	"ML-KEM NTT for x86_64"
+___
+
+if ($win64 && $avx>1) {
+# EXCEPTION_DISPOSITION handler (EXCEPTION_RECORD *rec,ULONG64 frame,
+#		CONTEXT *context,DISPATCHER_CONTEXT *disp)
+$rec="%rcx";
+$frame="%rdx";
+$context="%r8";
+$disp="%r9";
+
+$code.=<<___;
+.extern	__imp_RtlVirtualUnwind
+.type	simd_handler,\@abi-omnipotent
+.align	16
+simd_handler:
+	push	%rsi
+	push	%rdi
+	push	%rbx
+	push	%rbp
+	push	%r12
+	push	%r13
+	push	%r14
+	push	%r15
+	pushfq
+	sub	\$64,%rsp
+
+	mov	120($context),%rax	# pull context->Rax
+	mov	248($context),%rbx	# pull context->Rip
+
+	mov	8($disp),%rsi		# disp->ImageBase
+	mov	56($disp),%r11		# disp->HandlerData
+
+	mov	0(%r11),%r10d		# HandlerData[0]
+	lea	(%rsi,%r10),%r10	# prologue label
+	cmp	%r10,%rbx		# context->Rip<prologue label
+	jb	.Lcommon_seh_tail
+
+	mov	192($context),%rax	# pull context->R9
+
+	mov	4(%r11),%r10d		# HandlerData[1]
+	lea	(%rsi,%r10),%r10	# epilogue label
+	cmp	%r10,%rbx		# context->Rip>=epilogue label
+	jae	.Lcommon_seh_tail
+
+	lea	-0xa8(%rax),%rsi
+	lea	512($context),%rdi	# &context.Xmm6
+	mov	\$20,%ecx
+	.long	0xa548f3fc		# cld; rep movsq
+
+.Lcommon_seh_tail:
+	mov	8(%rax),%rdi
+	mov	16(%rax),%rsi
+	mov	%rax,152($context)	# restore context->Rsp
+	mov	%rsi,168($context)	# restore context->Rsi
+	mov	%rdi,176($context)	# restore context->Rdi
+
+	mov	40($disp),%rdi		# disp->ContextRecord
+	mov	$context,%rsi		# context
+	mov	\$154,%ecx		# sizeof(CONTEXT)
+	.long	0xa548f3fc		# cld; rep movsq
+
+	mov	$disp,%rsi
+	xor	%rcx,%rcx		# arg1, UNW_FLAG_NHANDLER
+	mov	8(%rsi),%rdx		# arg2, disp->ImageBase
+	mov	0(%rsi),%r8		# arg3, disp->ControlPc
+	mov	16(%rsi),%r9		# arg4, disp->FunctionEntry
+	mov	40(%rsi),%r10		# disp->ContextRecord
+	lea	56(%rsi),%r11		# &disp->HandlerData
+	lea	24(%rsi),%r12		# &disp->EstablisherFrame
+	mov	%r10,32(%rsp)		# arg5
+	mov	%r11,40(%rsp)		# arg6
+	mov	%r12,48(%rsp)		# arg7
+	mov	%rcx,56(%rsp)		# arg8, (NULL)
+	call	*__imp_RtlVirtualUnwind(%rip)
+
+	mov	\$1,%eax		# ExceptionContinueSearch
+	add	\$64,%rsp
+	popfq
+	pop	%r15
+	pop	%r14
+	pop	%r13
+	pop	%r12
+	pop	%rbp
+	pop	%rbx
+	pop	%rdi
+	pop	%rsi
+	ret
+.size	simd_handler,.-simd_handler
+
+.section	.pdata
+.align	4
+	.rva	.LSEH_begin_ossl_ml_kem_ntt_avx2
+	.rva	.LSEH_end_ossl_ml_kem_ntt_avx2
+	.rva	.LSEH_info_ossl_ml_kem_ntt_avx2
+
+	.rva	.LSEH_begin_ossl_ml_kem_inverse_ntt_avx2
+	.rva	.LSEH_end_ossl_ml_kem_inverse_ntt_avx2
+	.rva	.LSEH_info_ossl_ml_kem_inverse_ntt_avx2
+
+.section	.xdata
+.align	8
+.LSEH_info_ossl_ml_kem_ntt_avx2:
+	.byte	9,0,0,0
+	.rva	simd_handler
+	.rva	.Lntt_body,.Lntt_epilogue		# HandlerData[]
+.LSEH_info_ossl_ml_kem_inverse_ntt_avx2:
+	.byte	9,0,0,0
+	.rva	simd_handler
+	.rva	.Linvntt_body,.Linvntt_epilogue		# HandlerData[]
+___
+}
+
+$code =~ s/\`([^\`]*)\`/eval($1)/gem;
+print $code;
+close STDOUT or die "error closing STDOUT: $!";
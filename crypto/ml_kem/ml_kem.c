@@ -0,0 +1,760 @@
+/*
+ * Copyright 2024 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+/*
+ * ML-KEM-768 as specified in FIPS 203.
+ *
+ * Polynomial coefficients are kept fully reduced modulo q, in both normal
+ * and NTT representation, so that the vectorised NTTs can be used
+ * interchangeably with the C ones. The matrix A is expanded once, when the
+ * public key is generated or parsed, and kept with the key, since both
+ * encapsulation and decapsulation (which re-encrypts) need it.
+ */
+
+#include <string.h>
+#include <openssl/crypto.h>
+#include "internal/constant_time.h"
+#include "internal/sha3.h"
+#include "crypto/ml_kem.h"
+
+#define DEGREE          256
+#define RANK            3
+#define ML_KEM_Q        3329
+#define ETA1            2
+#define ETA2            2
+#define DU              10
+#define DV              4
+#define SYMBYTES        32
+
+/* Size of a polynomial encoded with 12 bits per coefficient */
+#define POLY_BYTES      (DEGREE * 12 / 8)
+#define CBD_BYTES       (DEGREE * 2 * ETA1 / 8)
+#define CT_U_BYTES      (RANK * DEGREE * DU / 8)
+
+/* 128^-1 mod q */
+#define INVERSE_DEGREE  3303
+/* floor(2^32 / q), and its rounded up value for division in compress() */
+#define BARRETT_MULTIPLIER  1290167
+#define COMPRESS_MULTIPLIER 1290168
+
+/*
+ * Three SHAKE-128 blocks yield 336 candidates of which 256 are accepted
+ * with high probability. In the rare case they are not the rest of the
+ * polynomial is sampled from a separate sponge.
+ */
+#define SHAKE128_RATE       168
+#define SHAKE256_RATE       136
+#define MATRIX_XOF_BYTES    (3 * SHAKE128_RATE)
+
+typedef struct {
+    uint16_t c[DEGREE];
+} poly;
+
+struct ml_kem_key_st {
+    poly t[RANK];               /* NTT(t) */
+    poly a[RANK][RANK];         /* NTT(A), expanded from rho */
+    poly s[RANK];               /* NTT(s) */
+    unsigned char rho[SYMBYTES];
+    unsigned char pkhash[SYMBYTES];
+    unsigned char z[SYMBYTES];
+    int haspubkey;
+    int hasprvkey;
+};
+
+/* 17^BitRev7(i) mod q */
+static const uint16_t ntt_roots[128] = {
+    1, 1729, 2580, 3289, 2642, 630, 1897, 848,
+    1062, 1919, 193, 797, 2786, 3260, 569, 1746,
+    296, 2447, 1339, 1476, 3046, 56, 2240, 1333,
+    1426, 2094, 535, 2882, 2393, 2879, 1974, 821,
+    289, 331, 3253, 1756, 1197, 2304, 2277, 2055,
+    650, 1977, 2513, 632, 2865, 33, 1320, 1915,
+    2319, 1435, 807, 452, 1438, 2868, 1534, 2402,
+    2647, 2617, 1481, 648, 2474, 3110, 1227, 910,
+    17, 2761, 583, 2649, 1637, 723, 2288, 1100,
+    1409, 2662, 3281, 233, 756, 2156, 3015, 3050,
+    1703, 1651, 2789, 1789, 1847, 952, 1461, 2687,
+    939, 2308, 2437, 2388, 733, 2337, 268, 641,
+    1584, 2298, 2037, 3220, 375, 2549, 2090, 1645,
+    1063, 319, 2773, 757, 2099, 561, 2466, 2594,
+    2804, 1092, 403, 1026, 1143, 2150, 2775, 886,
+    1722, 1212, 1874, 1029, 2110, 2935, 885, 2154
+};
+
+/* 17^(2 * BitRev7(i) + 1) mod q */
+static const uint16_t mod_roots[128] = {
+    17, 3312, 2761, 568, 583, 2746, 2649, 680,
+    1637, 1692, 723, 2606, 2288, 1041, 1100, 2229,
+    1409, 1920, 2662, 667, 3281, 48, 233, 3096,
+    756, 2573, 2156, 1173, 3015, 314, 3050, 279,
+    1703, 1626, 1651, 1678, 2789, 540, 1789, 1540,
+    1847, 1482, 952, 2377, 1461, 1868, 2687, 642,
+    939, 2390, 2308, 1021, 2437, 892, 2388, 941,
+    733, 2596, 2337, 992, 268, 3061, 641, 2688,
+    1584, 1745, 2298, 1031, 2037, 1292, 3220, 109,
+    375, 2954, 2549, 780, 2090, 1239, 1645, 1684,
+    1063, 2266, 319, 3010, 2773, 556, 757, 2572,
+    2099, 1230, 561, 2768, 2466, 863, 2594, 735,
+    2804, 525, 1092, 2237, 403, 2926, 1026, 2303,
+    1143, 2186, 2150, 1179, 2775, 554, 886, 2443,
+    1722, 1607, 1212, 2117, 1874, 1455, 1029, 2300,
+    2110, 1219, 2935, 394, 885, 2444, 2154, 1175
+};
+
+#if defined(ML_KEM_ASM)
+int ossl_ml_kem_ntt_capable(void);
+void ossl_ml_kem_ntt_avx2(uint16_t p[DEGREE]);
+void ossl_ml_kem_inverse_ntt_avx2(uint16_t p[DEGREE]);
+#endif
+
+/* Returns x mod q for x < 2q, in constant time */
+static ossl_inline uint16_t reduce_once(uint16_t x)
+{
+    uint16_t sub = x - ML_KEM_Q;
+    uint16_t mask = 0 - (sub >> 15);
+
+    return (mask & x) | (~mask & sub);
+}
+
+/* Returns x mod q, in constant time */
+static ossl_inline uint16_t reduce(uint32_t x)
+{
+    uint32_t quot = (uint32_t)(((uint64_t)x * BARRETT_MULTIPLIER) >> 32);
+
+    return reduce_once((uint16_t)(x - quot * ML_KEM_Q));
+}
+
+static void poly_add(poly *r, const poly *b)
+{
+    int i;
+
+    for (i = 0; i < DEGREE; i++)
+        r->c[i] = reduce_once(r->c[i] + b->c[i]);
+}
+
+static void poly_sub(poly *r, const poly *b)
+{
+    int i;
+
+    for (i = 0; i < DEGREE; i++)
+        r->c[i] = reduce_once(r->c[i] + ML_KEM_Q - b->c[i]);
+}
+
+/* FIPS 203 Algorithm 9 */
+static void poly_ntt(poly *p)
+{
+    int len, start, j, k = 1;
+
+#if defined(ML_KEM_ASM)
+    if (ossl_ml_kem_ntt_capable()) {
+        ossl_ml_kem_ntt_avx2(p->c);
+        return;
+    }
+#endif
+    for (len = DEGREE / 2; len >= 2; len >>= 1) {
+        for (start = 0; start < DEGREE; start += 2 * len) {
+            const uint32_t zeta = ntt_roots[k++];
+
+            for (j = start; j < start + len; j++) {
+                uint16_t t = reduce(zeta * p->c[j + len]);
+
+                p->c[j + len] = reduce_once(p->c[j] + ML_KEM_Q - t);
+                p->c[j] = reduce_once(p->c[j] + t);
+            }
+        }
+    }
+}
+
+/* FIPS 203 Algorithm 10 */
+static void poly_inverse_ntt(poly *p)
+{
+    int len, start, j, k = 127;
+
+#if defined(ML_KEM_ASM)
+    if (ossl_ml_kem_ntt_capable()) {
+        ossl_ml_kem_inverse_ntt_avx2(p->c);
+        return;
+    }
+#endif
+    for (len = 2; len <= DEGREE / 2; len <<= 1) {
+        for (start = 0; start < DEGREE; start += 2 * len) {
+            const uint32_t zeta = ntt_roots[k--];
+
+            for (j = start; j < start + len; j++) {
+                uint16_t t = p->c[j];
+
+                p->c[j] = reduce_once(t + p->c[j + len]);
+                p->c[j + len] = reduce(zeta * (p->c[j + len] + ML_KEM_Q - t));
+            }
+        }
+    }
+    for (j = 0; j < DEGREE; j++)
+        p->c[j] = reduce((uint32_t)p->c[j] * INVERSE_DEGREE);
+}
+
+/*
+ * out = sum_i a[i] * b[i] in the NTT domain, FIPS 203 Algorithm 11 summed
+ * over the rank. The sums are accumulated before the single reduction.
+ */
+static void inner_product(poly *out, const poly *const a[RANK], const poly *b)
+{
+    int i, j;
+
+    for (i = 0; i < DEGREE / 2; i++) {
+        uint32_t c0 = 0, c1 = 0;
+
+        for (j = 0; j < RANK; j++) {
+            uint32_t a0 = a[j]->c[2 * i], a1 = a[j]->c[2 * i + 1];
+            uint32_t b0 = b[j].c[2 * i], b1 = b[j].c[2 * i + 1];
+
+            c0 += a0 * b0 + (uint32_t)reduce(a1 * b1) * mod_roots[i];
+            c1 += a0 * b1 + a1 * b0;
+        }
+        out->c[2 * i] = reduce(c0);
+        out->c[2 * i + 1] = reduce(c1);
+    }
+}
+
+/* ByteEncode_d of FIPS 203 Algorithm 5 */
+static void poly_encode(unsigned char *out, const poly *p, int bits)
+{
+    uint32_t acc = 0;
+    int i, accbits = 0;
+
+    for (i = 0; i < DEGREE; i++) {
+        acc |= (uint32_t)p->c[i] << accbits;
+        accbits += bits;
+        while (accbits >= 8) {
+            *out++ = (unsigned char)acc;
+            acc >>= 8;
+            accbits -= 8;
+        }
+    }
+}
+
+/*
+ * ByteDecode_d of FIPS 203 Algorithm 6. For 12 bit coefficients it fails
+ * if a value is not reduced modulo q, which is the modulus check required
+ * of encapsulation keys.
+ */
+static int poly_decode(poly *p, const unsigned char *in, int bits)
+{
+    uint32_t acc = 0, mask = (1U << bits) - 1;
+    int i, accbits = 0;
+
+    for (i = 0; i < DEGREE; i++) {
+        while (accbits < bits) {
+            acc |= (uint32_t)*in++ << accbits;
+            accbits += 8;
+        }
+        p->c[i] = (uint16_t)(acc & mask);
+        acc >>= bits;
+        accbits -= bits;
+        if (bits == 12 && p->c[i] >= ML_KEM_Q)
+            return 0;
+    }
+    return 1;
+}
+
+/* round(2^bits * x / q) mod 2^bits, without a division */
+static void poly_compress(poly *p, int bits)
+{
+    int i;
+
+    for (i = 0; i < DEGREE; i++) {
+        uint32_t x = ((uint32_t)p->c[i] << bits) + (ML_KEM_Q >> 1);
+
+        p->c[i] = (uint16_t)(((uint64_t)x * COMPRESS_MULTIPLIER) >> 32)
+                  & ((1 << bits) - 1);
+    }
+}
+
+/* round(q * y / 2^bits) */
+static void poly_decompress(poly *p, int bits)
+{
+    int i;
+
+    for (i = 0; i < DEGREE; i++)
+        p->c[i] = (uint16_t)(((uint32_t)p->c[i] * ML_KEM_Q
+                              + (1U << (bits - 1))) >> bits);
+}
+
+/* Rejection sampling of FIPS 203 Algorithm 7, continuing at coefficient n */
+static int sample_ntt_parse(poly *p, int n, const unsigned char *buf,
+                            size_t len)
+{
+    size_t i;
+
+    for (i = 0; i + 3 <= len && n < DEGREE; i += 3) {
+        uint16_t d1 = buf[i] | ((uint16_t)(buf[i + 1] & 0x0f) << 8);
+        uint16_t d2 = (buf[i + 1] >> 4) | ((uint16_t)buf[i + 2] << 4);
+
+        if (d1 < ML_KEM_Q)
+            p->c[n++] = d1;
+        if (d2 < ML_KEM_Q && n < DEGREE)
+            p->c[n++] = d2;
+    }
+    return n;
+}
+
+static int sample_ntt_slow(poly *p, const unsigned char *in, size_t inlen)
+{
+    KECCAK1600_CTX ctx;
+    unsigned char buf[SHAKE128_RATE];
+    int n = 0;
+
+    if (!ossl_sha3_init(&ctx, '\x1f', 128)
+            || !ossl_sha3_update(&ctx, in, inlen))
+        return 0;
+    while (n < DEGREE) {
+        if (!ossl_sha3_squeeze(&ctx, buf, sizeof(buf)))
+            return 0;
+        n = sample_ntt_parse(p, n, buf, sizeof(buf));
+    }
+    return 1;
+}
+
+/*
+ * A[i][j] = SampleNTT(rho || j || i), with the RANK * RANK SHAKE-128
+ * streams squeezed in parallel where the processor allows it.
+ */
+static int expand_matrix(poly a[RANK][RANK], const unsigned char rho[SYMBYTES])
+{
+    unsigned char in[RANK * RANK][SYMBYTES + 2];
+    unsigned char buf[RANK * RANK][MATRIX_XOF_BYTES];
+    const unsigned char *inp[RANK * RANK];
+    unsigned char *outp[RANK * RANK];
+    size_t inlen[RANK * RANK];
+    int i, j, n;
+
+    for (i = 0; i < RANK; i++) {
+        for (j = 0; j < RANK; j++) {
+            unsigned char *b = in[i * RANK + j];
+
+            memcpy(b, rho, SYMBYTES);
+            b[SYMBYTES] = (unsigned char)j;
+            b[SYMBYTES + 1] = (unsigned char)i;
+            inp[i * RANK + j] = b;
+            inlen[i * RANK + j] = SYMBYTES + 2;
+            outp[i * RANK + j] = buf[i * RANK + j];
+        }
+    }
+    if (!ossl_sha3_batch('\x1f', 128, RANK * RANK, inp, inlen, outp,
+                         MATRIX_XOF_BYTES))
+        return 0;
+
+    for (i = 0; i < RANK; i++) {
+        for (j = 0; j < RANK; j++) {
+            n = sample_ntt_parse(&a[i][j], 0, buf[i * RANK + j],
+                                 MATRIX_XOF_BYTES);
+            if (n < DEGREE
+                    && !sample_ntt_slow(&a[i][j], in[i * RANK + j],
+                                        SYMBYTES + 2))
+                return 0;
+        }
+    }
+    return 1;
+}
+
+/* SamplePolyCBD_2 of FIPS 203 Algorithm 8 */
+static void poly_cbd_eta2(poly *p, const unsigned char buf[CBD_BYTES])
+{
+    int i;
+
+    for (i = 0; i < DEGREE; i += 2) {
+        unsigned int b = buf[i / 2];
+        unsigned int x0 = (b & 1) + ((b >> 1) & 1);
+        unsigned int y0 = ((b >> 2) & 1) + ((b >> 3) & 1);
+        unsigned int x1 = ((b >> 4) & 1) + ((b >> 5) & 1);
+        unsigned int y1 = ((b >> 6) & 1) + ((b >> 7) & 1);
+
+        p->c[i] = reduce_once((uint16_t)(x0 + ML_KEM_Q - y0));
+        p->c[i + 1] = reduce_once((uint16_t)(x1 + ML_KEM_Q - y1));
+    }
+}
+
+/*
+ * p[i] = CBD(PRF(seed, i)) for i < num. Both eta1 and eta2 are 2 for
+ * ML-KEM-768, so all the SHAKE-256 streams are computed in one batch.
+ */
+static int sample_noise(poly *p, int num, const unsigned char seed[SYMBYTES])
+{
+    unsigned char in[2 * RANK + 1][SYMBYTES + 1];
+    unsigned char buf[2 * RANK + 1][CBD_BYTES];
+    const unsigned char *inp[2 * RANK + 1];
+    unsigned char *outp[2 * RANK + 1];
+    size_t inlen[2 * RANK + 1];
+    int i, ret;
+
+    for (i = 0; i < num; i++) {
+        memcpy(in[i], seed, SYMBYTES);
+        in[i][SYMBYTES] = (unsigned char)i;
+        inp[i] = in[i];
+        inlen[i] = SYMBYTES + 1;
+        outp[i] = buf[i];
+    }
+    ret = ossl_sha3_batch('\x1f', 256, (size_t)num, inp, inlen, outp,
+                          CBD_BYTES);
+    if (ret)
+        for (i = 0; i < num; i++)
+            poly_cbd_eta2(&p[i], buf[i]);
+    OPENSSL_cleanse(in, sizeof(in));
+    OPENSSL_cleanse(buf, sizeof(buf));
+    return ret;
+}
+
+static int hash_h(unsigned char out[SYMBYTES], const unsigned char *in,
+                  size_t inlen)
+{
+    KECCAK1600_CTX ctx;
+
+    return ossl_sha3_init(&ctx, '\x06', 256)
+        && ossl_sha3_update(&ctx, in, inlen)
+        && ossl_sha3_final(&ctx, out, SYMBYTES);
+}
+
+static int hash_g(unsigned char out[2 * SYMBYTES], const unsigned char *in,
+                  size_t inlen)
+{
+    KECCAK1600_CTX ctx;
+    int ret;
+
+    ret = ossl_sha3_init(&ctx, '\x06', 512)
+        && ossl_sha3_update(&ctx, in, inlen)
+        && ossl_sha3_final(&ctx, out, 2 * SYMBYTES);
+    OPENSSL_cleanse(&ctx, sizeof(ctx));
+    return ret;
+}
+
+/* J(z || ct), the implicit rejection secret */
+static int hash_j(unsigned char out[SYMBYTES], const unsigned char z[SYMBYTES],
+                  const unsigned char *ct, size_t ctlen)
+{
+    KECCAK1600_CTX ctx;
+    int ret;
+
+    ret = ossl_sha3_init(&ctx, '\x1f', 256)
+        && ossl_sha3_update(&ctx, z, SYMBYTES)
+        && ossl_sha3_update(&ctx, ct, ctlen)
+        && ossl_sha3_final(&ctx, out, SYMBYTES);
+    OPENSSL_cleanse(&ctx, sizeof(ctx));
+    return ret;
+}
+
+static void encode_public_key(const ML_KEM_KEY *key, unsigned char *out)
+{
+    int i;
+
+    for (i = 0; i < RANK; i++)
+        poly_encode(out + i * POLY_BYTES, &key->t[i], 12);
+    memcpy(out + RANK * POLY_BYTES, key->rho, SYMBYTES);
+}
+
+/* K-PKE.Encrypt of FIPS 203 Algorithm 14 */
+static int pke_encrypt(const ML_KEM_KEY *key, unsigned char *ct,
+                       const unsigned char m[SYMBYTES],
+                       const unsigned char r[SYMBYTES])
+{
+    poly noise[2 * RANK + 1], u, v, mu;
+    const poly *col[RANK];
+    int i, j;
+
+    /* y, e1 and e2 */
+    if (!sample_noise(noise, 2 * RANK + 1, r))
+        return 0;
+    for (i = 0; i < RANK; i++)
+        poly_ntt(&noise[i]);
+
+    for (i = 0; i < RANK; i++) {
+        for (j = 0; j < RANK; j++)
+            col[j] = &key->a[j][i];
+        inner_product(&u, col, noise);
+        poly_inverse_ntt(&u);
+        poly_add(&u, &noise[RANK + i]);
+        poly_compress(&u, DU);
+        poly_encode(ct + i * (DEGREE * DU / 8), &u, DU);
+    }
+
+    for (j = 0; j < RANK; j++)
+        col[j] = &key->t[j];
+    inner_product(&v, col, noise);
+    poly_inverse_ntt(&v);
+    poly_add(&v, &noise[2 * RANK]);
+    for (i = 0; i < DEGREE; i++) {
+        uint16_t bit = (m[i / 8] >> (i % 8)) & 1;
+
+        /* Decompress_1(bit) */
+        mu.c[i] = (0 - bit) & ((ML_KEM_Q + 1) / 2);
+    }
+    poly_add(&v, &mu);
+    poly_compress(&v, DV);
+    poly_encode(ct + CT_U_BYTES, &v, DV);
+
+    OPENSSL_cleanse(noise, sizeof(noise));
+    OPENSSL_cleanse(&mu, sizeof(mu));
+    return 1;
+}
+
+/* K-PKE.Decrypt of FIPS 203 Algorithm 15 */
+static void pke_decrypt(const ML_KEM_KEY *key, unsigned char m[SYMBYTES],
+                        const unsigned char *ct)
+{
+    poly u[RANK], v, w;
+    const poly *s[RANK];
+    int i;
+
+    for (i = 0; i < RANK; i++) {
+        poly_decode(&u[i], ct + i * (DEGREE * DU / 8), DU);
+        poly_decompress(&u[i], DU);
+        poly_ntt(&u[i]);
+        s[i] = &key->s[i];
+    }
+    poly_decode(&v, ct + CT_U_BYTES, DV);
+    poly_decompress(&v, DV);
+
+    inner_product(&w, s, u);
+    poly_inverse_ntt(&w);
+    poly_sub(&v, &w);
+    poly_compress(&v, 1);
+    poly_encode(m, &v, 1);
+
+    OPENSSL_cleanse(&v, sizeof(v));
+    OPENSSL_cleanse(&w, sizeof(w));
+}
+
+ML_KEM_KEY *ossl_ml_kem_key_new(void)
+{
+    return OPENSSL_zalloc(sizeof(ML_KEM_KEY));
+}
+
+ML_KEM_KEY *ossl_ml_kem_key_dup(const ML_KEM_KEY *key)
+{
+    ML_KEM_KEY *ret = OPENSSL_malloc(sizeof(*ret));
+
+    if (ret != NULL)
+        memcpy(ret, key, sizeof(*ret));
+    return ret;
+}
+
+void ossl_ml_kem_key_free(ML_KEM_KEY *key)
+{
+    OPENSSL_clear_free(key, sizeof(*key));
+}
+
+int ossl_ml_kem_have_pubkey(const ML_KEM_KEY *key)
+{
+    return key->haspubkey;
+}
+
+int ossl_ml_kem_have_prvkey(const ML_KEM_KEY *key)
+{
+    return key->hasprvkey;
+}
+
+int ossl_ml_kem_pubkey_cmp(const ML_KEM_KEY *key1, const ML_KEM_KEY *key2)
+{
+    if (!key1->haspubkey || !key2->haspubkey)
+        return 0;
+    return memcmp(key1->t, key2->t, sizeof(key1->t)) == 0
+        && memcmp(key1->rho, key2->rho, sizeof(key1->rho)) == 0;
+}
+
+/* ML-KEM.KeyGen_internal of FIPS 203 Algorithm 16 */
+int ossl_ml_kem_genkey(ML_KEM_KEY *key,
+                       const unsigned char seed[ML_KEM_SEED_BYTES])
+{
+    unsigned char in[SYMBYTES + 1], rhosigma[2 * SYMBYTES];
+    unsigned char ek[ML_KEM_768_PUBLIC_KEY_BYTES];
+    poly e[RANK];
+    const poly *row[RANK];
+    int i, j, ret = 0;
+
+    key->haspubkey = key->hasprvkey = 0;
+
+    /* (rho, sigma) = G(d || k) */
+    memcpy(in, seed, SYMBYTES);
+    in[SYMBYTES] = RANK;
+    if (!hash_g(rhosigma, in, sizeof(in)))
+        goto err;
+    memcpy(key->rho, rhosigma, SYMBYTES);
+    if (!expand_matrix(key->a, key->rho))
+        goto err;
+
+    {
+        poly se[2 * RANK];
+
+        if (!sample_noise(se, 2 * RANK, rhosigma + SYMBYTES)) {
+            OPENSSL_cleanse(se, sizeof(se));
+            goto err;
+        }
+        for (i = 0; i < RANK; i++) {
+            key->s[i] = se[i];
+            e[i] = se[RANK + i];
+        }
+        OPENSSL_cleanse(se, sizeof(se));
+    }
+    for (i = 0; i < RANK; i++) {
+        poly_ntt(&key->s[i]);
+        poly_ntt(&e[i]);
+    }
+    for (i = 0; i < RANK; i++) {
+        for (j = 0; j < RANK; j++)
+            row[j] = &key->a[i][j];
+        inner_product(&key->t[i], row, key->s);
+        poly_add(&key->t[i], &e[i]);
+    }
+
+    memcpy(key->z, seed + SYMBYTES, SYMBYTES);
+    encode_public_key(key, ek);
+    if (!hash_h(key->pkhash, ek, sizeof(ek)))
+        goto err;
+    key->haspubkey = key->hasprvkey = 1;
+    ret = 1;
+ err:
+    OPENSSL_cleanse(in, sizeof(in));
+    OPENSSL_cleanse(rhosigma, sizeof(rhosigma));
+    OPENSSL_cleanse(e, sizeof(e));
+    return ret;
+}
+
+int ossl_ml_kem_parse_public_key(ML_KEM_KEY *key,
+                                 const unsigned char *in, size_t inlen)
+{
+    int i;
+
+    key->haspubkey = key->hasprvkey = 0;
+    if (inlen != ML_KEM_768_PUBLIC_KEY_BYTES)
+        return 0;
+    for (i = 0; i < RANK; i++)
+        if (!poly_decode(&key->t[i], in + i * POLY_BYTES, 12))
+            return 0;
+    memcpy(key->rho, in + RANK * POLY_BYTES, SYMBYTES);
+    if (!expand_matrix(key->a, key->rho)
+            || !hash_h(key->pkhash, in, inlen))
+        return 0;
+    key->haspubkey = 1;
+    return 1;
+}
+
+/* The decapsulation key is dk_pke || ek || H(ek) || z */
+int ossl_ml_kem_parse_private_key(ML_KEM_KEY *key,
+                                  const unsigned char *in, size_t inlen)
+{
+    const unsigned char *ek = in + RANK * POLY_BYTES;
+    const unsigned char *h = ek + ML_KEM_768_PUBLIC_KEY_BYTES;
+    int i;
+
+    if (inlen != ML_KEM_768_PRIVATE_KEY_BYTES
+            || !ossl_ml_kem_parse_public_key(key, ek,
+                                             ML_KEM_768_PUBLIC_KEY_BYTES))
+        return 0;
+    if (CRYPTO_memcmp(key->pkhash, h, SYMBYTES) != 0) {
+        key->haspubkey = 0;
+        return 0;
+    }
+    for (i = 0; i < RANK; i++) {
+        if (!poly_decode(&key->s[i], in + i * POLY_BYTES, 12)) {
+            OPENSSL_cleanse(key->s, sizeof(key->s));
+            key->haspubkey = 0;
+            return 0;
+        }
+    }
+    memcpy(key->z, h + SYMBYTES, SYMBYTES);
+    key->hasprvkey = 1;
+    return 1;
+}
+
+int ossl_ml_kem_encode_public_key(const ML_KEM_KEY *key,
+                                  unsigned char *out, size_t outlen)
+{
+    if (!key->haspubkey || outlen != ML_KEM_768_PUBLIC_KEY_BYTES)
+        return 0;
+    encode_public_key(key, out);
+    return 1;
+}
+
+int ossl_ml_kem_encode_private_key(const ML_KEM_KEY *key,
+                                   unsigned char *out, size_t outlen)
+{
+    unsigned char *ek = out + RANK * POLY_BYTES;
+    int i;
+
+    if (!key->hasprvkey || outlen != ML_KEM_768_PRIVATE_KEY_BYTES)
+        return 0;
+    for (i = 0; i < RANK; i++)
+        poly_encode(out + i * POLY_BYTES, &key->s[i], 12);
+    encode_public_key(key, ek);
+    memcpy(ek + ML_KEM_768_PUBLIC_KEY_BYTES, key->pkhash, SYMBYTES);
+    memcpy(ek + ML_KEM_768_PUBLIC_KEY_BYTES + SYMBYTES, key->z, SYMBYTES);
+    return 1;
+}
+
+/* ML-KEM.Encaps_internal of FIPS 203 Algorithm 17 */
+int ossl_ml_kem_encap_seed(const ML_KEM_KEY *key,
+                           const unsigned char m[ML_KEM_ENCAP_SEED_BYTES],
+                           unsigned char *ct, size_t ctlen,
+                           unsigned char *ss, size_t sslen)
+{
+    unsigned char in[2 * SYMBYTES], kr[2 * SYMBYTES];
+    int ret = 0;
+
+    if (!key->haspubkey
+            || ctlen != ML_KEM_768_CIPHERTEXT_BYTES
+            || sslen != ML_KEM_SHARED_SECRET_BYTES)
+        return 0;
+
+    /* (K, r) = G(m || H(ek)) */
+    memcpy(in, m, SYMBYTES);
+    memcpy(in + SYMBYTES, key->pkhash, SYMBYTES);
+    if (hash_g(kr, in, sizeof(in))
+            && pke_encrypt(key, ct, m, kr + SYMBYTES)) {
+        memcpy(ss, kr, ML_KEM_SHARED_SECRET_BYTES);
+        ret = 1;
+    }
+    OPENSSL_cleanse(in, sizeof(in));
+    OPENSSL_cleanse(kr, sizeof(kr));
+    return ret;
+}
+
+/*
+ * ML-KEM.Decaps_internal of FIPS 203 Algorithm 18. An invalid ciphertext
+ * yields the implicit rejection secret J(z || c), selected in constant
+ * time.
+ */
+int ossl_ml_kem_decap(const ML_KEM_KEY *key,
+                      const unsigned char *ct, size_t ctlen,
+                      unsigned char *ss, size_t sslen)
+{
+    unsigned char in[2 * SYMBYTES], kr[2 * SYMBYTES], kbar[SYMBYTES];
+    unsigned char ct2[ML_KEM_768_CIPHERTEXT_BYTES];
+    unsigned char mask;
+    int i, ret = 0;
+
+    if (!key->hasprvkey
+            || ctlen != ML_KEM_768_CIPHERTEXT_BYTES
+            || sslen != ML_KEM_SHARED_SECRET_BYTES)
+        return 0;
+
+    pke_decrypt(key, in, ct);
+    memcpy(in + SYMBYTES, key->pkhash, SYMBYTES);
+    if (!hash_g(kr, in, sizeof(in))
+            || !pke_encrypt(key, ct2, in, kr + SYMBYTES)
+            || !hash_j(kbar, key->z, ct, ctlen))
+        goto err;
+
+    mask = constant_time_eq_8(CRYPTO_memcmp(ct, ct2, ctlen), 0);
+    for (i = 0; i < ML_KEM_SHARED_SECRET_BYTES; i++)
+        ss[i] = constant_time_select_8(mask, kr[i], kbar[i]);
+    ret = 1;
+ err:
+    OPENSSL_cleanse(in, sizeof(in));
+    OPENSSL_cleanse(kr, sizeof(kr));
+    OPENSSL_cleanse(kbar, sizeof(kbar));
+    return ret;
+}
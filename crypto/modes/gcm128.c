@@ -1609,6 +1609,198 @@ void CRYPTO_gcm128_tag(GCM128_CONTEXT *ctx, unsigned char *tag, size_t len)
            len <= sizeof(ctx->Xi.c) ? len : sizeof(ctx->Xi.c));
 }
 
+/*
+ * Number of messages, and of counter blocks per message, that are encrypted
+ * together by a single call to the ecb128_f in ossl_gcm128_crypt_batch().
+ */
+#define GCM_BATCH_LANES     8
+#define GCM_BATCH_BLOCKS    8
+
+/* GHASH |len| bytes into |Xi|, zero padding the last block */
+static void gcm_batch_ghash(const GCM128_CONTEXT *ctx, u64 Xi[2],
+                            const unsigned char *in, size_t len)
+{
+    u8 *x = (u8 *)Xi;
+    size_t i, n = len & ~(size_t)15;
+
+    if (n != 0 && ctx->funcs.ghash != NULL) {
+        ctx->funcs.ghash(Xi, ctx->Htable, in, n);
+        in += n;
+        len -= n;
+    }
+    while (len > 0) {
+        n = len < 16 ? len : 16;
+        for (i = 0; i < n; ++i)
+            x[i] ^= in[i];
+        ctx->funcs.gmult(Xi, ctx->Htable);
+        in += n;
+        len -= n;
+    }
+}
+
+static int gcm_batch_lanes(const GCM128_CONTEXT *ctx, ecb128_f ecb,
+                           size_t num, const unsigned char *iv[],
+                           const unsigned char *aad[], const size_t aadlen[],
+                           const unsigned char *in[], unsigned char *out[],
+                           const size_t len[], unsigned char *tag[],
+                           size_t taglen, int enc, int ok[])
+{
+    union {
+        u64 u[2];
+        u8 c[16];
+    } Xi[GCM_BATCH_LANES], EK0[GCM_BATCH_LANES];
+    union {
+        u64 u[2 * GCM_BATCH_LANES * GCM_BATCH_BLOCKS];
+        u8 c[16 * GCM_BATCH_LANES * GCM_BATCH_BLOCKS];
+    } buf;
+    size_t done[GCM_BATCH_LANES], start[GCM_BATCH_LANES], cnt[GCM_BATCH_LANES];
+    u32 ctr[GCM_BATCH_LANES];
+    size_t i, j, nblk, n, blocks, first = 1;
+    int ret = 1;
+
+    for (i = 0; i < num; ++i) {
+        Xi[i].u[0] = Xi[i].u[1] = 0;
+        gcm_batch_ghash(ctx, Xi[i].u, aad[i], aadlen[i]);
+        done[i] = 0;
+        ctr[i] = 1;
+    }
+
+    for (;;) {
+        /*
+         * Lay out the next counter blocks of all the messages, starting with
+         * their pre-counter block J0 in the first round, so that one call to
+         * |ecb| encrypts them all.
+         */
+        nblk = 0;
+        for (i = 0; i < num; ++i) {
+            start[i] = nblk;
+            blocks = (len[i] - done[i] + 15) / 16;
+            if (blocks > GCM_BATCH_BLOCKS - first)
+                blocks = GCM_BATCH_BLOCKS - first;
+            cnt[i] = blocks;
+            for (j = 0; j < blocks + first; ++j, ++nblk) {
+                u32 c = ctr[i] + (u32)j + (first ? 0 : 1);
+                u8 *p = buf.c + 16 * nblk;
+
+                memcpy(p, iv[i], 12);
+                p[12] = (u8)(c >> 24);
+                p[13] = (u8)(c >> 16);
+                p[14] = (u8)(c >> 8);
+                p[15] = (u8)c;
+            }
+        }
+        if (nblk == 0)
+            break;
+        (*ecb)(buf.c, buf.c, 16 * nblk, ctx->key, 1);
+
+        for (i = 0; i < num; ++i) {
+            const u8 *ks = buf.c + 16 * start[i];
+
+            if (first) {
+                memcpy(EK0[i].c, ks, 16);
+                ks += 16;
+            }
+            n = len[i] - done[i];
+            if (n > 16 * cnt[i])
+                n = 16 * cnt[i];
+            if (!enc)
+                gcm_batch_ghash(ctx, Xi[i].u, in[i] + done[i], n);
+            for (j = 0; j < n; ++j)
+                out[i][done[i] + j] = in[i][done[i] + j] ^ ks[j];
+            if (enc)
+                gcm_batch_ghash(ctx, Xi[i].u, out[i] + done[i], n);
+            done[i] += n;
+            ctr[i] += (u32)cnt[i];
+        }
+        first = 0;
+    }
+
+    for (i = 0; i < num; ++i) {
+        u64 alen = (u64)aadlen[i] << 3, clen = (u64)len[i] << 3;
+        u8 lens[16];
+
+        for (j = 0; j < 8; ++j) {
+            lens[j] = (u8)(alen >> (56 - 8 * j));
+            lens[8 + j] = (u8)(clen >> (56 - 8 * j));
+        }
+        gcm_batch_ghash(ctx, Xi[i].u, lens, sizeof(lens));
+        Xi[i].u[0] ^= EK0[i].u[0];
+        Xi[i].u[1] ^= EK0[i].u[1];
+
+        if (enc) {
+            memcpy(tag[i], Xi[i].c, taglen);
+            ok[i] = 1;
+        } else {
+            ok[i] = CRYPTO_memcmp(Xi[i].c, tag[i], taglen) == 0;
+            if (!ok[i]) {
+                OPENSSL_cleanse(out[i], len[i]);
+                ret = 0;
+            }
+        }
+    }
+
+    OPENSSL_cleanse(&buf, sizeof(buf));
+    OPENSSL_cleanse(EK0, sizeof(EK0));
+    return ret;
+}
+
+/*
+ * Encrypt (|enc| != 0) or decrypt |num| independent messages under the key
+ * of |ctx| with 96-bit IVs. The counter blocks of up to GCM_BATCH_LANES
+ * messages are encrypted together by |ecb|, which should process many
+ * blocks in parallel, so that the fixed cost of each message (its
+ * pre-counter block, the setup and the finalisation) is shared. Only the key
+ * and the hash table of |ctx| are used.
+ *
+ * On encryption the tags are written to |tag|, on decryption they are
+ * checked against |tag| and the output of a message that fails the check is
+ * cleared. |ok[i]| is set to 1 if message |i| was processed and, on
+ * decryption, authenticated. Returns 1 if that is so for all the messages
+ * and 0 otherwise.
+ */
+int ossl_gcm128_crypt_batch(const GCM128_CONTEXT *ctx, ecb128_f ecb,
+                            size_t num, const unsigned char *iv[],
+                            const unsigned char *aad[], const size_t aadlen[],
+                            const unsigned char *in[], unsigned char *out[],
+                            const size_t len[], unsigned char *tag[],
+                            size_t taglen, int enc, int ok[])
+{
+    size_t i, n;
+    int ret = 1;
+
+    if (taglen == 0 || taglen > 16)
+        return 0;
+
+    for (i = 0; i < num; i += n) {
+        size_t j;
+
+        n = num - i < GCM_BATCH_LANES ? num - i : GCM_BATCH_LANES;
+        for (j = i; j < i + n; ++j) {
+            /* Same limits as CRYPTO_gcm128_aad() and CRYPTO_gcm128_encrypt() */
+            if ((u64)aadlen[j] > (U64(1) << 61)
+                || (u64)len[j] > ((U64(1) << 36) - 32))
+                break;
+        }
+        if (j < i + n) {
+            ok[j] = 0;
+            ret = 0;
+            /* Process the messages before the bad one, then skip past it */
+            n = j - i;
+            if (n != 0 && !gcm_batch_lanes(ctx, ecb, n, iv + i, aad + i,
+                                           aadlen + i, in + i, out + i,
+                                           len + i, tag + i, taglen, enc,
+                                           ok + i))
+                ret = 0;
+            ++n;
+            continue;
+        }
+        if (!gcm_batch_lanes(ctx, ecb, n, iv + i, aad + i, aadlen + i, in + i,
+                             out + i, len + i, tag + i, taglen, enc, ok + i))
+            ret = 0;
+    }
+    return ret;
+}
+
 GCM128_CONTEXT *CRYPTO_gcm128_new(void *key, block128_f block)
 {
     GCM128_CONTEXT *ret;
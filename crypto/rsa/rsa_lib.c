@@ -1,5 +1,5 @@
 /*
- * Copyright 1995-2023 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 1995-2024 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -178,6 +178,9 @@ void RSA_free(RSA *r)
 #endif
     BN_BLINDING_free(r->blinding);
     BN_BLINDING_free(r->mt_blinding);
+    for (i = 0; i < r->thread_blinding_used; i++)
+        BN_BLINDING_free(r->thread_blinding[i]);
+    OPENSSL_free(r->thread_blinding);
     OPENSSL_free(r);
 }
 
@@ -1,5 +1,5 @@
 /*
- * Copyright 2006-2021 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2006-2024 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -14,6 +14,8 @@
 #include "crypto/rsa.h"
 
 #define RSA_MAX_PRIME_NUM       5
+/* Threads beyond this many share a locked blinding for each key */
+#define RSA_MAX_THREAD_BLINDINGS 64
 
 typedef struct rsa_prime_info_st {
     BIGNUM *r;
@@ -95,6 +97,17 @@ struct rsa_st {
     BN_MONT_CTX *_method_mod_q;
     BN_BLINDING *blinding;
     BN_BLINDING *mt_blinding;
+    /*
+     * Blinding owned by each of the other threads using the key, so that
+     * they need not share (and lock) mt_blinding. Entries are appended
+     * under |lock|, counted in thread_blinding_used, and then published to
+     * lock-free readers by incrementing thread_blinding_num.
+     */
+    BN_BLINDING **thread_blinding;
+    int thread_blinding_used;
+    int thread_blinding_num;
+    /* Set once all the Montgomery contexts above have been cached */
+    int mont_cached;
     CRYPTO_RWLOCK *lock;
 
     int dirty_cnt;
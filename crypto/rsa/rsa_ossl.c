@@ -1,5 +1,5 @@
 /*
- * Copyright 1995-2023 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 1995-2024 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -182,10 +182,94 @@ static int rsa_ossl_public_encrypt(int flen, const unsigned char *from,
     return r;
 }
 
+/*
+ * Returns nonzero once all the Montgomery contexts of |rsa| are cached, in
+ * which case they can be used without taking rsa->lock.
+ */
+static int rsa_mont_cached(RSA *rsa)
+{
+    int cached;
+
+    return CRYPTO_atomic_load_int(&rsa->mont_cached, &cached, rsa->lock)
+           && cached;
+}
+
+/*
+ * Finds the blinding the current thread added with rsa_add_thread_blinding().
+ * Entries are never removed or replaced before the key is freed, and are
+ * filled in before they are counted in rsa->thread_blinding_num, so the
+ * lookup needs no lock.
+ */
+static BN_BLINDING *rsa_find_thread_blinding(RSA *rsa)
+{
+    int i, num;
+
+    if (!CRYPTO_atomic_load_int(&rsa->thread_blinding_num, &num, rsa->lock))
+        return NULL;
+    for (i = 0; i < num; i++)
+        if (BN_BLINDING_is_current_thread(rsa->thread_blinding[i]))
+            return rsa->thread_blinding[i];
+    return NULL;
+}
+
+/*
+ * Gives the current thread a blinding of its own, unless the key already
+ * has RSA_MAX_THREAD_BLINDINGS of them.
+ */
+static BN_BLINDING *rsa_add_thread_blinding(RSA *rsa, BN_CTX *ctx)
+{
+    BN_BLINDING *ret;
+    int num, stored = 0;
+
+    if (!CRYPTO_atomic_load_int(&rsa->thread_blinding_num, &num, rsa->lock)
+            || num >= RSA_MAX_THREAD_BLINDINGS)
+        return NULL;
+
+    /* Do the expensive setup before taking the lock */
+    if ((ret = RSA_setup_blinding(rsa, ctx)) == NULL)
+        return NULL;
+
+    if (!CRYPTO_THREAD_write_lock(rsa->lock)) {
+        BN_BLINDING_free(ret);
+        return NULL;
+    }
+    if (rsa->thread_blinding == NULL)
+        rsa->thread_blinding =
+            OPENSSL_zalloc(RSA_MAX_THREAD_BLINDINGS
+                           * sizeof(*rsa->thread_blinding));
+    if (rsa->thread_blinding != NULL
+            && rsa->thread_blinding_used < RSA_MAX_THREAD_BLINDINGS) {
+        rsa->thread_blinding[rsa->thread_blinding_used++] = ret;
+        stored = 1;
+    }
+    CRYPTO_THREAD_unlock(rsa->lock);
+
+    if (!stored) {
+        BN_BLINDING_free(ret);
+        return NULL;
+    }
+
+    /*
+     * Publish the entry to rsa_find_thread_blinding(). This is done after
+     * releasing the lock, which CRYPTO_atomic_add() may need itself. If
+     * another thread has filled an earlier slot but not yet published it,
+     * our increment publishes that one instead, and its own increment will
+     * publish ours.
+     */
+    if (!CRYPTO_atomic_add(&rsa->thread_blinding_num, 1, &num, rsa->lock))
+        return NULL;
+    return ret;
+}
+
 static BN_BLINDING *rsa_get_blinding(RSA *rsa, int *local, BN_CTX *ctx)
 {
     BN_BLINDING *ret;
 
+    if ((ret = rsa_find_thread_blinding(rsa)) != NULL) {
+        *local = 1;
+        return ret;
+    }
+
     if (!CRYPTO_THREAD_read_lock(rsa->lock))
         return NULL;
 
@@ -212,6 +296,15 @@ static BN_BLINDING *rsa_get_blinding(RSA *rsa, int *local, BN_CTX *ctx)
 
         *local = 1;
     } else {
+        /* give this thread a blinding of its own if there is room */
+        CRYPTO_THREAD_unlock(rsa->lock);
+        if ((ret = rsa_add_thread_blinding(rsa, ctx)) != NULL) {
+            *local = 1;
+            return ret;
+        }
+        if (!CRYPTO_THREAD_read_lock(rsa->lock))
+            return NULL;
+
         /* resort to rsa->mt_blinding instead */
 
         /*
@@ -328,7 +421,7 @@ static int rsa_ossl_private_encrypt(int flen, const unsigned char *from,
         goto err;
     }
 
-    if (rsa->flags & RSA_FLAG_CACHE_PUBLIC)
+    if ((rsa->flags & RSA_FLAG_CACHE_PUBLIC) && !rsa_mont_cached(rsa))
         if (!BN_MONT_CTX_set_locked(&rsa->_method_mod_n, rsa->lock,
                                     rsa->n, ctx))
             goto err;
@@ -551,7 +644,7 @@ static int rsa_ossl_private_decrypt(int flen, const unsigned char *from,
         goto err;
     }
 
-    if (rsa->flags & RSA_FLAG_CACHE_PUBLIC)
+    if ((rsa->flags & RSA_FLAG_CACHE_PUBLIC) && !rsa_mont_cached(rsa))
         if (!BN_MONT_CTX_set_locked(&rsa->_method_mod_n, rsa->lock,
                                     rsa->n, ctx))
             goto err;
@@ -755,7 +848,7 @@ static int rsa_ossl_public_decrypt(int flen, const unsigned char *from,
 static int rsa_ossl_mod_exp(BIGNUM *r0, const BIGNUM *I, RSA *rsa, BN_CTX *ctx)
 {
     BIGNUM *r1, *m1, *vrfy;
-    int ret = 0, smooth = 0;
+    int ret = 0, smooth = 0, mont_cached;
 #ifndef FIPS_MODULE
     BIGNUM *r2, *m[RSA_MAX_PRIME_NUM - 2];
     int i, ex_primes = 0;
@@ -780,7 +873,13 @@ static int rsa_ossl_mod_exp(BIGNUM *r0, const BIGNUM *I, RSA *rsa, BN_CTX *ctx)
         goto err;
 #endif
 
-    if (rsa->flags & RSA_FLAG_CACHE_PRIVATE) {
+    /*
+     * Once every Montgomery context is in place they can be used without
+     * taking rsa->lock for each of them
+     */
+    mont_cached = rsa_mont_cached(rsa);
+
+    if ((rsa->flags & RSA_FLAG_CACHE_PRIVATE) && !mont_cached) {
         BIGNUM *factor = BN_new();
 
         if (factor == NULL)
@@ -813,18 +912,24 @@ static int rsa_ossl_mod_exp(BIGNUM *r0, const BIGNUM *I, RSA *rsa, BN_CTX *ctx)
          * We MUST free |factor| before any further use of the prime factors
          */
         BN_free(factor);
+    }
 
+    if (rsa->flags & RSA_FLAG_CACHE_PRIVATE)
         smooth = (rsa->meth->bn_mod_exp == BN_mod_exp_mont)
 #ifndef FIPS_MODULE
                  && (ex_primes == 0)
 #endif
                  && (BN_num_bits(rsa->q) == BN_num_bits(rsa->p));
-    }
 
-    if (rsa->flags & RSA_FLAG_CACHE_PUBLIC)
+    if ((rsa->flags & RSA_FLAG_CACHE_PUBLIC) && !mont_cached) {
         if (!BN_MONT_CTX_set_locked(&rsa->_method_mod_n, rsa->lock,
                                     rsa->n, ctx))
             goto err;
+        if ((rsa->flags & RSA_FLAG_CACHE_PRIVATE)
+                && !CRYPTO_atomic_add(&rsa->mont_cached, 1, &mont_cached,
+                                      rsa->lock))
+            goto err;
+    }
 
     if (smooth) {
         /*
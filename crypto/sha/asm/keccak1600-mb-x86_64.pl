@@ -0,0 +1,497 @@
+#! /usr/bin/env perl
+# Copyright 2024 The OpenSSL Project Authors. All Rights Reserved.
+#
+# Licensed under the Apache License 2.0 (the "License").  You may not use
+# this file except in compliance with the License.  You can obtain a copy
+# in the file LICENSE in the source distribution or at
+# https://www.openssl.org/source/license.html
+
+#
+# Multi-buffer Keccak-f[1600] permutations for x86_64, applying the
+# permutation to 4 or 8 independent states at once, one state per
+# 64-bit lane of AVX2 or AVX-512 register. States are interleaved,
+# i.e. lane x+5*y of state #i resides at A[x+5*y][i].
+#
+# ossl_keccak1600_x4_avx2 keeps the states in memory and alternates
+# between caller's buffer and a stack copy, two rounds per iteration.
+#
+# ossl_keccak1600_x8_avx512 keeps all 25 lanes in %zmm0-24. Rho and Pi
+# steps are register renames, and since Pi permutation has order 24,
+# fully unrolled 24 rounds end up with lanes in original registers.
+# Theta column parities and Chi step are vpternlogq.
+#
+# ossl_keccak1600_mb_capable returns the number of states that the
+# processor can permute at once, 8, 4 or 0 if neither code path is
+# usable, in which case caller is expected to fall back to single
+# state code.
+
+# $output is the last argument if it looks like a file (it has an extension)
+# $flavour is the first argument if it doesn't look like a file
+$output = $#ARGV >= 0 && $ARGV[$#ARGV] =~ m|\.\w+$| ? pop : undef;
+$flavour = $#ARGV >= 0 && $ARGV[0] !~ m|\.| ? shift : undef;
+
+$win64=0; $win64=1 if ($flavour =~ /[nm]asm|mingw64/ || $output =~ /\.asm$/);
+
+$0 =~ m/(.*[\/\\])[^\/\\]+$/; $dir=$1;
+( $xlate="${dir}x86_64-xlate.pl" and -f $xlate ) or
+( $xlate="${dir}../../perlasm/x86_64-xlate.pl" and -f $xlate) or
+die "can't locate x86_64-xlate.pl";
+
+$avx=0;
+
+if (`$ENV{CC} -Wa,-v -c -o /dev/null -x assembler /dev/null 2>&1`
+		=~ /GNU assembler version ([2-9]\.[0-9]+)/) {
+	$avx = ($1>=2.19) + ($1>=2.22) + ($1>=2.25);
+}
+
+if (!$avx && $win64 && ($flavour =~ /nasm/ || $ENV{ASM} =~ /nasm/) &&
+	   `nasm -v 2>&1` =~ /NASM version ([2-9]\.[0-9]+)/) {
+	$avx = ($1>=2.09) + ($1>=2.10) + ($1>=2.12);
+}
+
+if (!$avx && $win64 && ($flavour =~ /masm/ || $ENV{ASM} =~ /ml64/) &&
+	   `ml64 2>&1` =~ /Version ([0-9]+)\./) {
+	$avx = ($1>=10) + ($1>=12);
+}
+
+if (!$avx && `$ENV{CC} -v 2>&1` =~ /((?:clang|LLVM) version|.*based on LLVM) ([0-9]+\.[0-9]+)/) {
+	$avx = ($2>=3.0) + ($2>3.0);
+}
+
+open OUT,"| \"$^X\" \"$xlate\" $flavour \"$output\""
+    or die "can't call $xlate: $!";
+*STDOUT=*OUT;
+
+my @rhotates = ([  0,  1, 62, 28, 27 ],		# [y][x]
+                [ 36, 44,  6, 55, 20 ],
+                [  3, 10, 43, 25, 39 ],
+                [ 41, 45, 15, 21,  8 ],
+                [ 18,  2, 61, 56, 14 ]);
+
+my $xframe = $win64 ? 0xa8 : 8;
+
+$code.=<<___;
+.text
+
+.extern	OPENSSL_ia32cap_P
+
+.globl	ossl_keccak1600_mb_capable
+.type	ossl_keccak1600_mb_capable,\@abi-omnipotent
+.align	32
+ossl_keccak1600_mb_capable:
+	mov	OPENSSL_ia32cap_P+8(%rip),%ecx
+	xor	%eax,%eax
+___
+$code.=<<___ if ($avx>1);
+	mov	\$4,%edx
+	test	\$`1<<5`,%ecx			# avx2
+	cmovnz	%edx,%eax
+___
+$code.=<<___ if ($avx>2);
+	mov	\$8,%edx
+	test	\$`1<<16`,%ecx			# avx512f
+	cmovnz	%edx,%eax
+___
+$code.=<<___;
+	ret
+.size	ossl_keccak1600_mb_capable,.-ossl_keccak1600_mb_capable
+___
+
+if ($avx>1) {{{
+# void ossl_keccak1600_x4_avx2(uint64_t A[25][4]);
+my ($A,$T,$iotas)=("%rdi","%rsp","%rax");
+my @C=map("%ymm$_",(0..4));
+my @D=map("%ymm$_",(5..9));
+my ($t0,$iota)=("%ymm10","%ymm11");
+
+sub Round_avx2 {
+my ($src,$dst)=@_;
+
+	# Theta
+	for (my $x=0; $x<5; $x++) {
+	    $code.="	vmovdqu	`32*$x`($src),$C[$x]\n";
+	    for (my $y=1; $y<5; $y++) {
+		$code.="	vpxor	`32*($x+5*$y)`($src),$C[$x],$C[$x]\n";
+	    }
+	}
+	for (my $x=0; $x<5; $x++) {
+	    my ($prev,$next)=($C[($x+4)%5],$C[($x+1)%5]);
+	    $code.=<<___;
+	vpsrlq	\$63,$next,$t0
+	vpsllq	\$1,$next,$D[$x]
+	vpor	$t0,$D[$x],$D[$x]
+	vpxor	$prev,$D[$x],$D[$x]
+___
+	}
+
+	# Rho, Pi and Chi, one output plane at a time; lane x of plane y
+	# of Pi output is lane (x+3*y)%5 of plane x of the input
+	$code.="	vpbroadcastq	($iotas),$iota\n";
+	for (my $y=0; $y<5; $y++) {
+	    my @B=@C;
+	    for (my $x=0; $x<5; $x++) {
+		my $sx=($x+3*$y)%5;
+		my $r=$rhotates[$x][$sx];
+		$code.="	vpxor	`32*($sx+5*$x)`($src),$D[$sx],$B[$x]\n";
+		$code.=<<___ if ($r);
+	vpsllq	\$$r,$B[$x],$t0
+	vpsrlq	\$`64-$r`,$B[$x],$B[$x]
+	vpor	$t0,$B[$x],$B[$x]
+___
+	    }
+	    for (my $x=0; $x<5; $x++) {
+		$code.=<<___;
+	vpandn	$B[($x+2)%5],$B[($x+1)%5],$t0
+	vpxor	$B[$x],$t0,$t0
+___
+		$code.="	vpxor	$iota,$t0,$t0\n"	if ($x==0 && $y==0);
+		$code.="	vmovdqu	$t0,`32*($x+5*$y)`($dst)\n";
+	    }
+	}
+	$code.="	lea	8($iotas),$iotas\n";
+}
+
+$code.=<<___;
+.globl	ossl_keccak1600_x4_avx2
+.type	ossl_keccak1600_x4_avx2,\@function,1
+.align	32
+ossl_keccak1600_x4_avx2:
+.cfi_startproc
+	mov	%rsp,%r9			# frame pointer
+.cfi_def_cfa_register	%r9
+	sub	\$`800+$xframe`,%rsp
+___
+$code.=<<___ if ($win64);
+	movaps	%xmm6,-0xa8(%r9)
+	movaps	%xmm7,-0x98(%r9)
+	movaps	%xmm8,-0x88(%r9)
+	movaps	%xmm9,-0x78(%r9)
+	movaps	%xmm10,-0x68(%r9)
+	movaps	%xmm11,-0x58(%r9)
+	movaps	%xmm12,-0x48(%r9)
+	movaps	%xmm13,-0x38(%r9)
+	movaps	%xmm14,-0x28(%r9)
+	movaps	%xmm15,-0x18(%r9)
+___
+$code.=<<___;
+	and	\$-32,%rsp
+.Lx4_body:
+	lea	iotas(%rip),$iotas
+	mov	\$12,%ecx
+	jmp	.Loop_x4
+
+.align	32
+.Loop_x4:
+___
+	&Round_avx2($A,$T);
+	&Round_avx2($T,$A);
+$code.=<<___;
+	dec	%ecx
+	jnz	.Loop_x4
+
+	vzeroupper
+___
+$code.=<<___ if ($win64);
+	movaps	-0xa8(%r9),%xmm6
+	movaps	-0x98(%r9),%xmm7
+	movaps	-0x88(%r9),%xmm8
+	movaps	-0x78(%r9),%xmm9
+	movaps	-0x68(%r9),%xmm10
+	movaps	-0x58(%r9),%xmm11
+	movaps	-0x48(%r9),%xmm12
+	movaps	-0x38(%r9),%xmm13
+	movaps	-0x28(%r9),%xmm14
+	movaps	-0x18(%r9),%xmm15
+___
+$code.=<<___;
+	lea	(%r9),%rsp
+.cfi_def_cfa_register	%rsp
+.Lx4_epilogue:
+	ret
+.cfi_endproc
+.size	ossl_keccak1600_x4_avx2,.-ossl_keccak1600_x4_avx2
+___
+}}} else {
+$code.=<<___;
+.globl	ossl_keccak1600_x4_avx2
+.type	ossl_keccak1600_x4_avx2,\@abi-omnipotent
+ossl_keccak1600_x4_avx2:
+	.byte	0x0f,0x0b	# ud2
+	ret
+.size	ossl_keccak1600_x4_avx2,.-ossl_keccak1600_x4_avx2
+___
+}
+
+if ($avx>2) {{{
+# void ossl_keccak1600_x8_avx512(uint64_t A[25][8]);
+my ($A,$iotas)=("%rdi","%rax");
+my @A=map("%zmm$_",(0..24));	# @A[x+5*y]
+my @C=map("%zmm$_",(25..29));
+my ($t0,$t1)=("%zmm30","%zmm31");
+
+sub Round_avx512 {
+my $i=shift;
+
+	# Theta
+	for (my $x=0; $x<5; $x++) {
+	    $code.=<<___;
+	vpxorq		$A[$x+5],$A[$x],$C[$x]
+	vpternlogq	\$0x96,$A[$x+15],$A[$x+10],$C[$x]
+	vpxorq		$A[$x+20],$C[$x],$C[$x]
+___
+	}
+	for (my $x=0; $x<5; $x++) {
+	    $code.="	vprolq		\$1,$C[($x+1)%5],$t0\n";
+	    for (my $y=0; $y<5; $y++) {
+		$code.="	vpternlogq	\$0x96,$t0,$C[($x+4)%5],$A[$x+5*$y]\n";
+	    }
+	}
+
+	# Rho in place, then Pi by renaming, lane x,y moves to y,2*x+3*y
+	my @B;
+	for (my $y=0; $y<5; $y++) {
+	    for (my $x=0; $x<5; $x++) {
+		my $r=$rhotates[$y][$x];
+		$code.="	vprolq		\$$r,$A[$x+5*$y],$A[$x+5*$y]\n"	if ($r);
+		$B[$y+5*((2*$x+3*$y)%5)]=$A[$x+5*$y];
+	    }
+	}
+	@A=@B;
+
+	# Chi, a ^ (~b & c) is vpternlogq 0xd2
+	for (my $y=0; $y<5; $y++) {
+	    my @R=@A[5*$y..5*$y+4];
+	    $code.=<<___;
+	vmovdqa64	$R[0],$t0
+	vmovdqa64	$R[1],$t1
+	vpternlogq	\$0xd2,$R[2],$R[1],$R[0]
+	vpternlogq	\$0xd2,$R[3],$R[2],$R[1]
+	vpternlogq	\$0xd2,$R[4],$R[3],$R[2]
+	vpternlogq	\$0xd2,$t0,$R[4],$R[3]
+	vpternlogq	\$0xd2,$t1,$t0,$R[4]
+___
+	}
+
+	# Iota
+	$code.="	vpxorq		`8*$i`($iotas){1to8},$A[0],$A[0]\n";
+}
+
+$code.=<<___;
+.globl	ossl_keccak1600_x8_avx512
+.type	ossl_keccak1600_x8_avx512,\@function,1
+.align	32
+ossl_keccak1600_x8_avx512:
+.cfi_startproc
+	mov	%rsp,%r9			# frame pointer
+.cfi_def_cfa_register	%r9
+___
+$code.=<<___ if ($win64);
+	sub	\$$xframe,%rsp
+	movaps	%xmm6,-0xa8(%r9)
+	movaps	%xmm7,-0x98(%r9)
+	movaps	%xmm8,-0x88(%r9)
+	movaps	%xmm9,-0x78(%r9)
+	movaps	%xmm10,-0x68(%r9)
+	movaps	%xmm11,-0x58(%r9)
+	movaps	%xmm12,-0x48(%r9)
+	movaps	%xmm13,-0x38(%r9)
+	movaps	%xmm14,-0x28(%r9)
+	movaps	%xmm15,-0x18(%r9)
+___
+$code.=<<___;
+.Lx8_body:
+	lea	iotas(%rip),$iotas
+___
+for (my $i=0; $i<25; $i++) {
+	$code.="	vmovdqu64	`64*$i`($A),$A[$i]\n";
+}
+for (my $i=0; $i<24; $i++) {
+	&Round_avx512($i);
+}
+# Pi permutation has order 24, so that lanes are back in place
+for (my $i=0; $i<25; $i++) {
+	die "lane $i is in $A[$i]" if ($A[$i] ne "%zmm$i");
+	$code.="	vmovdqu64	$A[$i],`64*$i`($A)\n";
+}
+$code.=<<___;
+	vzeroupper
+___
+$code.=<<___ if ($win64);
+	movaps	-0xa8(%r9),%xmm6
+	movaps	-0x98(%r9),%xmm7
+	movaps	-0x88(%r9),%xmm8
+	movaps	-0x78(%r9),%xmm9
+	movaps	-0x68(%r9),%xmm10
+	movaps	-0x58(%r9),%xmm11
+	movaps	-0x48(%r9),%xmm12
+	movaps	-0x38(%r9),%xmm13
+	movaps	-0x28(%r9),%xmm14
+	movaps	-0x18(%r9),%xmm15
+___
+$code.=<<___;
+	lea	(%r9),%rsp
+.cfi_def_cfa_register	%rsp
+.Lx8_epilogue:
+	ret
+.cfi_endproc
+.size	ossl_keccak1600_x8_avx512,.-ossl_keccak1600_x8_avx512
+___
+}}} else {
+$code.=<<___;
+.globl	ossl_keccak1600_x8_avx512
+.type	ossl_keccak1600_x8_avx512,\@abi-omnipotent
+ossl_keccak1600_x8_avx512:
+	.byte	0x0f,0x0b	# ud2
+	ret
+.size	ossl_keccak1600_x8_avx512,.-ossl_keccak1600_x8_avx512
+___
+}
+
+$code.=<<___;
+.align	64
+iotas:
+	.quad	0x0000000000000001
+	.quad	0x0000000000008082
+	.quad	0x800000000000808a
+	.quad	0x8000000080008000
+	.quad	0x000000000000808b
+	.quad	0x0000000080000001
+	.quad	0x8000000080008081
+	.quad	0x8000000000008009
+	.quad	0x000000000000008a
+	.quad	0x0000000000000088
+	.quad	0x0000000080008009
+	.quad	0x000000008000000a
+	.quad	0x000000008000808b
+	.quad	0x800000000000008b
+	.quad	0x8000000000008089
+	.quad	0x8000000000008003
+	.quad	0x8000000000008002
+	.quad	0x8000000000000080
+	.quad	0x000000000000800a
+	.quad	0x800000008000000a
+	.quad	0x8000000080008081
+	.quad	0x8000000000008080
+	.quad	0x0000000080000001
+	.quad	0x8000000080008008
+.asciz	"Keccak-1600 multi-buffer permutation for x86_64"
+___
+
+if ($win64 && $avx>1) {
+# EXCEPTION_DISPOSITION handler (EXCEPTION_RECORD *rec,ULONG64 frame,
+#		CONTEXT *context,DISPATCHER_CONTEXT *disp)
+$rec="%rcx";
+$frame="%rdx";
+$context="%r8";
+$disp="%r9";
+
+$code.=<<___;
+.extern	__imp_RtlVirtualUnwind
+.type	simd_handler,\@abi-omnipotent
+.align	16
+simd_handler:
+	push	%rsi
+	push	%rdi
+	push	%rbx
+	push	%rbp
+	push	%r12
+	push	%r13
+	push	%r14
+	push	%r15
+	pushfq
+	sub	\$64,%rsp
+
+	mov	120($context),%rax	# pull context->Rax
+	mov	248($context),%rbx	# pull context->Rip
+
+	mov	8($disp),%rsi		# disp->ImageBase
+	mov	56($disp),%r11		# disp->HandlerData
+
+	mov	0(%r11),%r10d		# HandlerData[0]
+	lea	(%rsi,%r10),%r10	# prologue label
+	cmp	%r10,%rbx		# context->Rip<prologue label
+	jb	.Lcommon_seh_tail
+
+	mov	192($context),%rax	# pull context->R9
+
+	mov	4(%r11),%r10d		# HandlerData[1]
+	lea	(%rsi,%r10),%r10	# epilogue label
+	cmp	%r10,%rbx		# context->Rip>=epilogue label
+	jae	.Lcommon_seh_tail
+
+	lea	-0xa8(%rax),%rsi
+	lea	512($context),%rdi	# &context.Xmm6
+	mov	\$20,%ecx
+	.long	0xa548f3fc		# cld; rep movsq
+
+.Lcommon_seh_tail:
+	mov	8(%rax),%rdi
+	mov	16(%rax),%rsi
+	mov	%rax,152($context)	# restore context->Rsp
+	mov	%rsi,168($context)	# restore context->Rsi
+	mov	%rdi,176($context)	# restore context->Rdi
+
+	mov	40($disp),%rdi		# disp->ContextRecord
+	mov	$context,%rsi		# context
+	mov	\$154,%ecx		# sizeof(CONTEXT)
+	.long	0xa548f3fc		# cld; rep movsq
+
+	mov	$disp,%rsi
+	xor	%rcx,%rcx		# arg1, UNW_FLAG_NHANDLER
+	mov	8(%rsi),%rdx		# arg2, disp->ImageBase
+	mov	0(%rsi),%r8		# arg3, disp->ControlPc
+	mov	16(%rsi),%r9		# arg4, disp->FunctionEntry
+	mov	40(%rsi),%r10		# disp->ContextRecord
+	lea	56(%rsi),%r11		# &disp->HandlerData
+	lea	24(%rsi),%r12		# &disp->EstablisherFrame
+	mov	%r10,32(%rsp)		# arg5
+	mov	%r11,40(%rsp)		# arg6
+	mov	%r12,48(%rsp)		# arg7
+	mov	%rcx,56(%rsp)		# arg8, (NULL)
+	call	*__imp_RtlVirtualUnwind(%rip)
+
+	mov	\$1,%eax		# ExceptionContinueSearch
+	add	\$64,%rsp
+	popfq
+	pop	%r15
+	pop	%r14
+	pop	%r13
+	pop	%r12
+	pop	%rbp
+	pop	%rbx
+	pop	%rdi
+	pop	%rsi
+	ret
+.size	simd_handler,.-simd_handler
+
+.section	.pdata
+.align	4
+	.rva	.LSEH_begin_ossl_keccak1600_x4_avx2
+	.rva	.LSEH_end_ossl_keccak1600_x4_avx2
+	.rva	.LSEH_info_ossl_keccak1600_x4_avx2
+___
+$code.=<<___ if ($avx>2);
+	.rva	.LSEH_begin_ossl_keccak1600_x8_avx512
+	.rva	.LSEH_end_ossl_keccak1600_x8_avx512
+	.rva	.LSEH_info_ossl_keccak1600_x8_avx512
+___
+$code.=<<___;
+
+.section	.xdata
+.align	8
+.LSEH_info_ossl_keccak1600_x4_avx2:
+	.byte	9,0,0,0
+	.rva	simd_handler
+	.rva	.Lx4_body,.Lx4_epilogue			# HandlerData[]
+___
+$code.=<<___ if ($avx>2);
+.LSEH_info_ossl_keccak1600_x8_avx512:
+	.byte	9,0,0,0
+	.rva	simd_handler
+	.rva	.Lx8_body,.Lx8_epilogue			# HandlerData[]
+___
+}
+
+$code =~ s/\`([^\`]*)\`/eval($1)/gem;
+print $code;
+close STDOUT or die "error closing STDOUT: $!";
@@ -38,6 +38,12 @@
 # (iv)	presented improvement coefficients are asymptotic limits and
 #	in real-life application are somewhat lower, e.g. for 2KB
 #	fragments they range from 75% to 130% (on Haswell);
+#
+# January 2024
+#
+# Add 16-lane AVX-512 code path, ossl_sha256_multi_block_avx512, which
+# is called directly by ossl_sha256_batch. Working state and message schedule are kept in
+# registers, rotates and three-input logic are single instructions.
 
 # $output is the last argument if it looks like a file (it has an extension)
 # $flavour is the first argument if it doesn't look like a file
@@ -60,12 +66,12 @@ $avx=0;
 
 if (`$ENV{CC} -Wa,-v -c -o /dev/null -x assembler /dev/null 2>&1`
 		=~ /GNU assembler version ([2-9]\.[0-9]+)/) {
-	$avx = ($1>=2.19) + ($1>=2.22);
+	$avx = ($1>=2.19) + ($1>=2.22) + ($1>=2.25);
 }
 
 if (!$avx && $win64 && ($flavour =~ /nasm/ || $ENV{ASM} =~ /nasm/) &&
 	   `nasm -v 2>&1` =~ /NASM version ([2-9]\.[0-9]+)/) {
-	$avx = ($1>=2.09) + ($1>=2.10);
+	$avx = ($1>=2.09) + ($1>=2.10) + ($1>=2.12);
 }
 
 if (!$avx && $win64 && ($flavour =~ /masm/ || $ENV{ASM} =~ /ml64/) &&
@@ -1338,7 +1344,319 @@ $code.=<<___;
 .cfi_endproc
 .size	sha256_multi_block_avx2,.-sha256_multi_block_avx2
 ___
+						if ($avx>2) {
+# 16-lane AVX-512 flavour. Interface differs from sha256_multi_block
+# in that it always processes 16 lanes and context is
+#
+#     struct {	unsigned int A[16]; ... unsigned int H[16];	} *ctx;
+#     struct {	void *ptr; int blocks;	} inp[16];
+#
+# Working state and whole message schedule are kept in registers,
+# %zmm0-7 and %zmm16-31 respectively. Input pointers and per-lane
+# block counters live on stack, lanes that ran out of input are
+# pointed at K256 and masked off when context is updated.
+
+@V=($A,$B,$C,$D,$E,$F,$G,$H)=map("%zmm$_",(0..7));
+($t1,$t2,$t3)=map("%zmm$_",(8..10));
+($bswap,$cnt,$minus1)=map("%zmm$_",(11..13));
+@X=map("%zmm$_",(16..31));
+
+sub ROUND_00_15_avx512 {
+my ($i,$a,$b,$c,$d,$e,$f,$g,$h)=@_;
+
+$code.=<<___;
+	vpaddd		`32*($i%16)-128`($Tbl){1to16},$X[$i%16],$t1	# X[i]+K[i]
+	vprord		\$6,$e,$t2
+	vprord		\$11,$e,$t3
+	vpaddd		$t1,$h,$h
+	vprord		\$25,$e,$t1
+	vpternlogd	\$0x96,$t3,$t2,$t1		# Sigma1(e)
+	vmovdqa32	$e,$t2
+	vpternlogd	\$0xca,$g,$f,$t2		# Ch(e,f,g)
+	vpaddd		$t1,$h,$h
+	vpaddd		$t2,$h,$h			# h+=Sigma1(e)+Ch(e,f,g)
+	vprord		\$2,$a,$t1
+	vprord		\$13,$a,$t2
+	vpaddd		$h,$d,$d			# d+=h
+	vprord		\$22,$a,$t3
+	vpternlogd	\$0x96,$t3,$t2,$t1		# Sigma0(a)
+	vmovdqa32	$a,$t2
+	vpternlogd	\$0xe8,$c,$b,$t2		# Maj(a,b,c)
+	vpaddd		$t1,$h,$h
+	vpaddd		$t2,$h,$h			# h+=Sigma0(a)+Maj(a,b,c)
+___
+}
+
+sub ROUND_16_XX_avx512 {
+my $i=shift;
+my ($Xi,$X1,$X9,$X14)=map($X[($i+$_)%16],(0,1,9,14));
+
+$code.=<<___;
+	vprord		\$7,$X1,$t1
+	vprord		\$18,$X1,$t2
+	vpsrld		\$3,$X1,$t3
+	vpternlogd	\$0x96,$t3,$t2,$t1		# sigma0(X[i+1])
+	vpaddd		$X9,$Xi,$Xi			# X[i]+=X[i+9]
+	vprord		\$17,$X14,$t2
+	vpaddd		$t1,$Xi,$Xi
+	vprord		\$19,$X14,$t1
+	vpsrld		\$10,$X14,$t3
+	vpternlogd	\$0x96,$t3,$t2,$t1		# sigma1(X[i+14])
+	vpaddd		$t1,$Xi,$Xi
+___
+	&ROUND_00_15_avx512($i,@_);
+}
+
+# Transpose 16x16 matrix of 32-bit elements, @_ being rows and $t1
+# scratch register. Result is left in @X, with X[i] holding i-th
+# element of every row, and one of input registers becomes $t1.
+sub TRANSPOSE_16x16 {
+my @r=@_;
+my $t=$t1;
+my (@x,@y);
+
+    for (my $i=0;$i<16;$i+=2) {			# 32-bit interleave
+	$code.=<<___;
+	vpunpckldq	$r[$i+1],$r[$i],$t
+	vpunpckhdq	$r[$i+1],$r[$i],$r[$i+1]
+___
+	($r[$i],$t)=($t,$r[$i]);
+    }
+    for (my $g=0;$g<4;$g++) {			# 64-bit interleave
+	my ($lo01,$hi01,$lo23,$hi23)=@r[4*$g..4*$g+3];
+	$code.=<<___;
+	vpunpcklqdq	$lo23,$lo01,$t
+	vpunpckhqdq	$lo23,$lo01,$lo23
+	vpunpcklqdq	$hi23,$hi01,$lo01
+	vpunpckhqdq	$hi23,$hi01,$hi23
+___
+	$x[$g]=[$t,$lo23,$lo01,$hi23];
+	$t=$hi01;
+    }
+    for (my $m=0;$m<4;$m++) {			# 128-bit lanes
+	for (my $g=0;$g<4;$g+=2) {
+	    my ($p,$q)=($x[$g][$m],$x[$g+1][$m]);
+	    $code.=<<___;
+	vshufi32x4	\$0x88,$q,$p,$t
+	vshufi32x4	\$0xdd,$q,$p,$q
+___
+	    $y[$g][$m]=$t; $y[$g+1][$m]=$q;
+	    $t=$p;
+	}
+	for (my $j=0;$j<2;$j++) {
+	    my ($p,$q)=($y[0][$m],$y[2][$m]);
+	    ($p,$q)=($y[1][$m],$y[3][$m]) if ($j);
+	    $code.=<<___;
+	vshufi32x4	\$0x88,$q,$p,$t
+	vshufi32x4	\$0xdd,$q,$p,$q
+___
+	    $X[$m+4*$j]=$t; $X[$m+4*$j+8]=$q;
+	    $t=$p;
+	}
+    }
+    $t1=$t;
+}
+
+$code.=<<___;
+.globl	ossl_sha256_mb_avx512_capable
+.type	ossl_sha256_mb_avx512_capable,\@abi-omnipotent
+.align	32
+ossl_sha256_mb_avx512_capable:
+	mov	OPENSSL_ia32cap_P+8(%rip),%ecx
+	mov	\$`1<<30|1<<16`,%edx		# avx512bw + avx512f
+	xor	%eax,%eax
+	and	%edx,%ecx
+	cmp	%edx,%ecx
+	cmove	%ecx,%eax
+	ret
+.size	ossl_sha256_mb_avx512_capable,.-ossl_sha256_mb_avx512_capable
+
+.globl	ossl_sha256_multi_block_avx512
+.type	ossl_sha256_multi_block_avx512,\@function,2
+.align	32
+ossl_sha256_multi_block_avx512:
+.cfi_startproc
+	mov	%rsp,%rax
+.cfi_def_cfa_register	%rax
+	push	%rbx
+.cfi_push	%rbx
+	push	%rbp
+.cfi_push	%rbp
+	push	%r12
+.cfi_push	%r12
+	push	%r13
+.cfi_push	%r13
+	push	%r14
+.cfi_push	%r14
+	push	%r15
+.cfi_push	%r15
+___
+$code.=<<___ if ($win64);
+	lea	-0xa8(%rsp),%rsp
+	movaps	%xmm6,(%rsp)
+	movaps	%xmm7,0x10(%rsp)
+	movaps	%xmm8,0x20(%rsp)
+	movaps	%xmm9,0x30(%rsp)
+	movaps	%xmm10,0x40(%rsp)
+	movaps	%xmm11,0x50(%rsp)
+	movaps	%xmm12,-0x78(%rax)
+	movaps	%xmm13,-0x68(%rax)
+	movaps	%xmm14,-0x58(%rax)
+	movaps	%xmm15,-0x48(%rax)
+___
+$code.=<<___;
+	sub	\$`32*18`, %rsp
+	and	\$-256,%rsp
+	mov	%rax,`32*17`(%rsp)		# original %rsp
+.cfi_cfa_expression	%rsp+`32*17`,deref,+8
+.Lbody_avx512:
+	lea	K256+128(%rip),$Tbl
+	xor	%edx,%edx			# maximum number of blocks
+	xor	%ebx,%ebx
+___
+for($i=0;$i<16;$i++) {
+    $ptr_reg=&pointer_register($flavour,"%r8");
+    $code.=<<___;
+	# input pointer
+	mov	`$inp_elm_size*$i+0`($inp),$ptr_reg
+	# number of blocks
+	mov	`$inp_elm_size*$i+$ptr_size`($inp),%ecx
+	cmp	%edx,%ecx
+	cmovg	%ecx,%edx			# find maximum
+	test	%ecx,%ecx
+	cmovle	$Tbl,%r8			# cancel input
+	cmovle	%ebx,%ecx
+	mov	%r8,`8*$i`(%rsp)
+	mov	%ecx,`128+4*$i`(%rsp)		# initialize counters
+___
+}
+$code.=<<___;
+	test	%edx,%edx
+	jz	.Ldone_avx512
+
+	vbroadcasti32x4	.Lpbswap(%rip),$bswap
+	vpternlogd	\$0xff,$minus1,$minus1,$minus1
+	vmovdqu32	128(%rsp),$cnt
+	vptestmd	$cnt,$cnt,%k1		# active lanes
+	jmp	.Loop_avx512
+
+.align	32
+.Loop_avx512:
+___
+for($i=0;$i<16;$i++) {
+    $code.=<<___;
+	mov		`8*$i`(%rsp),%r8
+	mov		\$1,%ecx
+	vmovdqu32	(%r8),@X[$i]
+	lea		64(%r8),%r8
+	cmp		`128+4*$i`(%rsp),%ecx
+	cmovge		$Tbl,%r8			# cancel input
+	vpshufb		$bswap,@X[$i],@X[$i]
+	mov		%r8,`8*$i`(%rsp)
+___
+}
+	&TRANSPOSE_16x16(@X);
+$code.=<<___;
+	vmovdqu32	0x000($ctx),$A			# load context
+	vmovdqu32	0x040($ctx),$B
+	vmovdqu32	0x080($ctx),$C
+	vmovdqu32	0x0c0($ctx),$D
+	vmovdqu32	0x100($ctx),$E
+	vmovdqu32	0x140($ctx),$F
+	vmovdqu32	0x180($ctx),$G
+	vmovdqu32	0x1c0($ctx),$H
+___
+for($i=0;$i<16;$i++)	{ &ROUND_00_15_avx512($i,@V); unshift(@V,pop(@V)); }
+$code.=<<___;
+	mov	\$3,%ecx
+	jmp	.Loop_16_xx_avx512
+.align	32
+.Loop_16_xx_avx512:
+	lea	`32*16`($Tbl),$Tbl
+___
+for(;$i<32;$i++)	{ &ROUND_16_XX_avx512($i,@V); unshift(@V,pop(@V)); }
+$code.=<<___;
+	dec	%ecx
+	jnz	.Loop_16_xx_avx512
+
+	lea	K256+128(%rip),$Tbl
+	vpaddd		0x000($ctx),$A,$A
+	vpaddd		0x040($ctx),$B,$B
+	vpaddd		0x080($ctx),$C,$C
+	vpaddd		0x0c0($ctx),$D,$D
+	vpaddd		0x100($ctx),$E,$E
+	vpaddd		0x140($ctx),$F,$F
+	vpaddd		0x180($ctx),$G,$G
+	vpaddd		0x1c0($ctx),$H,$H
+	vmovdqu32	$A,0x000($ctx){%k1}		# update active lanes
+	vmovdqu32	$B,0x040($ctx){%k1}
+	vmovdqu32	$C,0x080($ctx){%k1}
+	vmovdqu32	$D,0x0c0($ctx){%k1}
+	vmovdqu32	$E,0x100($ctx){%k1}
+	vmovdqu32	$F,0x140($ctx){%k1}
+	vmovdqu32	$G,0x180($ctx){%k1}
+	vmovdqu32	$H,0x1c0($ctx){%k1}
+
+	vpaddd		$minus1,$cnt,${cnt}{%k1}	# counters--
+	vmovdqu32	$cnt,128(%rsp)
+	vptestmd	$cnt,$cnt,%k1
+	dec	%edx
+	jnz	.Loop_avx512
+
+.Ldone_avx512:
+	mov	`32*17`(%rsp),%rax		# original %rsp
+.cfi_def_cfa	%rax,8
+	vzeroupper
+___
+$code.=<<___ if ($win64);
+	movaps	-0xd8(%rax),%xmm6
+	movaps	-0xc8(%rax),%xmm7
+	movaps	-0xb8(%rax),%xmm8
+	movaps	-0xa8(%rax),%xmm9
+	movaps	-0x98(%rax),%xmm10
+	movaps	-0x88(%rax),%xmm11
+	movaps	-0x78(%rax),%xmm12
+	movaps	-0x68(%rax),%xmm13
+	movaps	-0x58(%rax),%xmm14
+	movaps	-0x48(%rax),%xmm15
+___
+$code.=<<___;
+	mov	-48(%rax),%r15
+.cfi_restore	%r15
+	mov	-40(%rax),%r14
+.cfi_restore	%r14
+	mov	-32(%rax),%r13
+.cfi_restore	%r13
+	mov	-24(%rax),%r12
+.cfi_restore	%r12
+	mov	-16(%rax),%rbp
+.cfi_restore	%rbp
+	mov	-8(%rax),%rbx
+.cfi_restore	%rbx
+	lea	(%rax),%rsp
+.cfi_def_cfa_register	%rsp
+.Lepilogue_avx512:
+	ret
+.cfi_endproc
+.size	ossl_sha256_multi_block_avx512,.-ossl_sha256_multi_block_avx512
+___
+						}
 					}	}}}
+$code.=<<___ if ($avx<=2);
+.globl	ossl_sha256_mb_avx512_capable
+.type	ossl_sha256_mb_avx512_capable,\@abi-omnipotent
+ossl_sha256_mb_avx512_capable:
+	xor	%eax,%eax
+	ret
+.size	ossl_sha256_mb_avx512_capable,.-ossl_sha256_mb_avx512_capable
+
+.globl	ossl_sha256_multi_block_avx512
+.type	ossl_sha256_multi_block_avx512,\@abi-omnipotent
+ossl_sha256_multi_block_avx512:
+	.byte	0x0f,0x0b	# ud2
+	ret
+.size	ossl_sha256_multi_block_avx512,.-ossl_sha256_multi_block_avx512
+___
 $code.=<<___;
 .align	256
 K256:
@@ -1561,6 +1879,11 @@ $code.=<<___ if ($avx>1);
 	.rva	.LSEH_end_sha256_multi_block_avx2
 	.rva	.LSEH_info_sha256_multi_block_avx2
 ___
+$code.=<<___ if ($avx>2);
+	.rva	.LSEH_begin_ossl_sha256_multi_block_avx512
+	.rva	.LSEH_end_ossl_sha256_multi_block_avx512
+	.rva	.LSEH_info_ossl_sha256_multi_block_avx512
+___
 $code.=<<___;
 .section	.xdata
 .align	8
@@ -1585,6 +1908,12 @@ $code.=<<___ if ($avx>1);
 	.rva	avx2_handler
 	.rva	.Lbody_avx2,.Lepilogue_avx2		# HandlerData[]
 ___
+$code.=<<___ if ($avx>2);
+.LSEH_info_ossl_sha256_multi_block_avx512:
+	.byte	9,0,0,0
+	.rva	avx2_handler
+	.rva	.Lbody_avx512,.Lepilogue_avx512		# HandlerData[]
+___
 }
 ####################################################################
 
@@ -0,0 +1,528 @@
+#! /usr/bin/env perl
+# Copyright 2024 The OpenSSL Project Authors. All Rights Reserved.
+#
+# Licensed under the Apache License 2.0 (the "License").  You may not use
+# this file except in compliance with the License.  You can obtain a copy
+# in the file LICENSE in the source distribution or at
+# https://www.openssl.org/source/license.html
+
+#
+# Multi-buffer SHA512 procedure processes 8 buffers in parallel by
+# placing buffer data to designated 64-bit lane of AVX-512 register.
+# Working state and whole message schedule are kept in registers,
+# %zmm0-7 and %zmm16-31 respectively. Rotates and three-input logic
+# functions are single instructions, so that a round takes 19
+# instructions for all 8 lanes, plus 11 for message expansion.
+#
+# There is no pre-AVX-512 code path. If assembler can't handle
+# AVX-512, or processor doesn't support it, ossl_sha512_mb_avx512_capable
+# returns 0 and caller is expected to fall back to sha512_block_data_order.
+
+# $output is the last argument if it looks like a file (it has an extension)
+# $flavour is the first argument if it doesn't look like a file
+$output = $#ARGV >= 0 && $ARGV[$#ARGV] =~ m|\.\w+$| ? pop : undef;
+$flavour = $#ARGV >= 0 && $ARGV[0] !~ m|\.| ? shift : undef;
+
+$win64=0; $win64=1 if ($flavour =~ /[nm]asm|mingw64/ || $output =~ /\.asm$/);
+
+$0 =~ m/(.*[\/\\])[^\/\\]+$/; $dir=$1;
+( $xlate="${dir}x86_64-xlate.pl" and -f $xlate ) or
+( $xlate="${dir}../../perlasm/x86_64-xlate.pl" and -f $xlate) or
+die "can't locate x86_64-xlate.pl";
+
+push(@INC,"${dir}","${dir}../../perlasm");
+require "x86_64-support.pl";
+
+$ptr_size=&pointer_size($flavour);
+
+$avx=0;
+
+if (`$ENV{CC} -Wa,-v -c -o /dev/null -x assembler /dev/null 2>&1`
+		=~ /GNU assembler version ([2-9]\.[0-9]+)/) {
+	$avx = ($1>=2.19) + ($1>=2.22) + ($1>=2.25);
+}
+
+if (!$avx && $win64 && ($flavour =~ /nasm/ || $ENV{ASM} =~ /nasm/) &&
+	   `nasm -v 2>&1` =~ /NASM version ([2-9]\.[0-9]+)/) {
+	$avx = ($1>=2.09) + ($1>=2.10) + ($1>=2.12);
+}
+
+if (!$avx && $win64 && ($flavour =~ /masm/ || $ENV{ASM} =~ /ml64/) &&
+	   `ml64 2>&1` =~ /Version ([0-9]+)\./) {
+	$avx = ($1>=10) + ($1>=12);
+}
+
+if (!$avx && `$ENV{CC} -v 2>&1` =~ /((?:clang|LLVM) version|.*based on LLVM) ([0-9]+\.[0-9]+)/) {
+	$avx = ($2>=3.0) + ($2>3.0);
+}
+
+open OUT,"| \"$^X\" \"$xlate\" $flavour \"$output\""
+    or die "can't call $xlate: $!";
+*STDOUT=*OUT;
+
+# void ossl_sha512_multi_block_avx512 (
+#     struct {	unsigned long long A[8];
+#		unsigned long long B[8];
+#		unsigned long long C[8];
+#		unsigned long long D[8];
+#		unsigned long long E[8];
+#		unsigned long long F[8];
+#		unsigned long long G[8];
+#		unsigned long long H[8];	} *ctx,
+#     struct {	void *ptr; int blocks;	} inp[8]);
+#
+$ctx="%rdi";	# 1st arg
+$inp="%rsi";	# 2nd arg
+$Tbl="%rbp";
+$inp_elm_size=2*$ptr_size;
+
+@V=($A,$B,$C,$D,$E,$F,$G,$H)=map("%zmm$_",(0..7));
+($t1,$t2,$t3)=map("%zmm$_",(8..10));
+($bswap,$cnt,$minus1)=map("%zmm$_",(11..13));
+@X=map("%zmm$_",(16..31));
+
+if ($avx>2) {
+
+sub ROUND_00_15 {
+my ($i,$a,$b,$c,$d,$e,$f,$g,$h)=@_;
+
+$code.=<<___;
+	vpaddq		`8*($i%16)-128`($Tbl){1to8},$X[$i%16],$t1	# X[i]+K[i]
+	vprorq		\$14,$e,$t2
+	vprorq		\$18,$e,$t3
+	vpaddq		$t1,$h,$h
+	vprorq		\$41,$e,$t1
+	vpternlogq	\$0x96,$t3,$t2,$t1		# Sigma1(e)
+	vmovdqa64	$e,$t2
+	vpternlogq	\$0xca,$g,$f,$t2		# Ch(e,f,g)
+	vpaddq		$t1,$h,$h
+	vpaddq		$t2,$h,$h			# h+=Sigma1(e)+Ch(e,f,g)
+	vprorq		\$28,$a,$t1
+	vprorq		\$34,$a,$t2
+	vpaddq		$h,$d,$d			# d+=h
+	vprorq		\$39,$a,$t3
+	vpternlogq	\$0x96,$t3,$t2,$t1		# Sigma0(a)
+	vmovdqa64	$a,$t2
+	vpternlogq	\$0xe8,$c,$b,$t2		# Maj(a,b,c)
+	vpaddq		$t1,$h,$h
+	vpaddq		$t2,$h,$h			# h+=Sigma0(a)+Maj(a,b,c)
+___
+}
+
+sub ROUND_16_XX {
+my $i=shift;
+my ($Xi,$X1,$X9,$X14)=map($X[($i+$_)%16],(0,1,9,14));
+
+$code.=<<___;
+	vprorq		\$1,$X1,$t1
+	vprorq		\$8,$X1,$t2
+	vpsrlq		\$7,$X1,$t3
+	vpternlogq	\$0x96,$t3,$t2,$t1		# sigma0(X[i+1])
+	vpaddq		$X9,$Xi,$Xi			# X[i]+=X[i+9]
+	vprorq		\$19,$X14,$t2
+	vpaddq		$t1,$Xi,$Xi
+	vprorq		\$61,$X14,$t1
+	vpsrlq		\$6,$X14,$t3
+	vpternlogq	\$0x96,$t3,$t2,$t1		# sigma1(X[i+14])
+	vpaddq		$t1,$Xi,$Xi
+___
+	&ROUND_00_15($i,@_);
+}
+
+# Transpose 8x8 matrix of 64-bit elements, @_ being rows and $t
+# scratch register. Returns scratch register followed by registers
+# holding i-th element of every row.
+sub TRANSPOSE_8x8 {
+my ($t,@r)=@_;
+my (@x,@y);
+
+    for (my $i=0;$i<8;$i+=2) {			# 64-bit interleave
+	$code.=<<___;
+	vpunpcklqdq	$r[$i+1],$r[$i],$t
+	vpunpckhqdq	$r[$i+1],$r[$i],$r[$i+1]
+___
+	($r[$i],$t)=($t,$r[$i]);
+    }
+    for (my $g=0;$g<2;$g++) {			# 128-bit lanes
+	my ($lo01,$hi01,$lo23,$hi23)=@r[4*$g..4*$g+3];
+	$code.=<<___;
+	vshufi64x2	\$0x88,$lo23,$lo01,$t
+	vshufi64x2	\$0xdd,$lo23,$lo01,$lo23
+	vshufi64x2	\$0x88,$hi23,$hi01,$lo01
+	vshufi64x2	\$0xdd,$hi23,$hi01,$hi23
+___
+	# elements 0/4, 1/5, 2/6 and 3/7 of four rows
+	$x[$g]=[$t,$lo01,$lo23,$hi23];
+	$t=$hi01;
+    }
+    for (my $m=0;$m<4;$m++) {
+	my ($p,$q)=($x[0][$m],$x[1][$m]);
+	$code.=<<___;
+	vshufi64x2	\$0x88,$q,$p,$t
+	vshufi64x2	\$0xdd,$q,$p,$q
+___
+	$y[$m]=$t; $y[$m+4]=$q;
+	$t=$p;
+    }
+
+    return ($t,@y);
+}
+
+$code.=<<___;
+.text
+
+.extern	OPENSSL_ia32cap_P
+
+.globl	ossl_sha512_mb_avx512_capable
+.type	ossl_sha512_mb_avx512_capable,\@abi-omnipotent
+.align	32
+ossl_sha512_mb_avx512_capable:
+	mov	OPENSSL_ia32cap_P+8(%rip),%ecx
+	mov	\$`1<<30|1<<16`,%edx		# avx512bw + avx512f
+	xor	%eax,%eax
+	and	%edx,%ecx
+	cmp	%edx,%ecx
+	cmove	%ecx,%eax
+	ret
+.size	ossl_sha512_mb_avx512_capable,.-ossl_sha512_mb_avx512_capable
+
+.globl	ossl_sha512_multi_block_avx512
+.type	ossl_sha512_multi_block_avx512,\@function,2
+.align	32
+ossl_sha512_multi_block_avx512:
+.cfi_startproc
+	mov	%rsp,%rax
+.cfi_def_cfa_register	%rax
+	push	%rbx
+.cfi_push	%rbx
+	push	%rbp
+.cfi_push	%rbp
+___
+$code.=<<___ if ($win64);
+	lea	-0xa8(%rsp),%rsp
+	movaps	%xmm6,(%rsp)
+	movaps	%xmm7,0x10(%rsp)
+	movaps	%xmm8,0x20(%rsp)
+	movaps	%xmm9,0x30(%rsp)
+	movaps	%xmm10,-0x78(%rax)
+	movaps	%xmm11,-0x68(%rax)
+	movaps	%xmm12,-0x58(%rax)
+	movaps	%xmm13,-0x48(%rax)
+	movaps	%xmm14,-0x38(%rax)
+	movaps	%xmm15,-0x28(%rax)
+___
+$code.=<<___;
+	sub	\$`16*18`,%rsp
+	and	\$-256,%rsp
+	mov	%rax,`16*17`(%rsp)		# original %rsp
+.cfi_cfa_expression	%rsp+`16*17`,deref,+8
+.Lbody:
+	lea	K512+128(%rip),$Tbl
+	xor	%edx,%edx			# maximum number of blocks
+	xor	%ebx,%ebx
+___
+for($i=0;$i<8;$i++) {
+    $ptr_reg=&pointer_register($flavour,"%r8");
+    $code.=<<___;
+	# input pointer
+	mov	`$inp_elm_size*$i+0`($inp),$ptr_reg
+	# number of blocks
+	mov	`$inp_elm_size*$i+$ptr_size`($inp),%ecx
+	cmp	%edx,%ecx
+	cmovg	%ecx,%edx			# find maximum
+	test	%ecx,%ecx
+	cmovle	$Tbl,%r8			# cancel input
+	cmovle	%ebx,%ecx
+	mov	%r8,`8*$i`(%rsp)
+	mov	%rcx,`64+8*$i`(%rsp)		# initialize counters
+___
+}
+$code.=<<___;
+	test	%edx,%edx
+	jz	.Ldone
+
+	vbroadcasti64x2	.Lbswap(%rip),$bswap
+	vpternlogq	\$0xff,$minus1,$minus1,$minus1
+	vmovdqu64	64(%rsp),$cnt
+	vptestmq	$cnt,$cnt,%k1		# active lanes
+	jmp	.Loop
+
+.align	32
+.Loop:
+___
+for($i=0;$i<8;$i++) {
+    $code.=<<___;
+	mov		`8*$i`(%rsp),%r8
+	mov		\$1,%ecx
+	vmovdqu64	0x00(%r8),@X[$i]
+	vmovdqu64	0x40(%r8),@X[$i+8]
+	lea		128(%r8),%r8
+	cmp		`64+8*$i`(%rsp),%rcx
+	cmovge		$Tbl,%r8			# cancel input
+	vpshufb		$bswap,@X[$i],@X[$i]
+	vpshufb		$bswap,@X[$i+8],@X[$i+8]
+	mov		%r8,`8*$i`(%rsp)
+___
+}
+	($t1,@X[0..7])=&TRANSPOSE_8x8($t1,@X[0..7]);
+	($t1,@X[8..15])=&TRANSPOSE_8x8($t1,@X[8..15]);
+$code.=<<___;
+	vmovdqu64	0x000($ctx),$A			# load context
+	vmovdqu64	0x040($ctx),$B
+	vmovdqu64	0x080($ctx),$C
+	vmovdqu64	0x0c0($ctx),$D
+	vmovdqu64	0x100($ctx),$E
+	vmovdqu64	0x140($ctx),$F
+	vmovdqu64	0x180($ctx),$G
+	vmovdqu64	0x1c0($ctx),$H
+___
+for($i=0;$i<16;$i++)	{ &ROUND_00_15($i,@V); unshift(@V,pop(@V)); }
+$code.=<<___;
+	mov	\$4,%ecx
+	jmp	.Loop_16_xx
+.align	32
+.Loop_16_xx:
+	lea	`8*16`($Tbl),$Tbl
+___
+for(;$i<32;$i++)	{ &ROUND_16_XX($i,@V); unshift(@V,pop(@V)); }
+$code.=<<___;
+	dec	%ecx
+	jnz	.Loop_16_xx
+
+	lea	K512+128(%rip),$Tbl
+	vpaddq		0x000($ctx),$A,$A
+	vpaddq		0x040($ctx),$B,$B
+	vpaddq		0x080($ctx),$C,$C
+	vpaddq		0x0c0($ctx),$D,$D
+	vpaddq		0x100($ctx),$E,$E
+	vpaddq		0x140($ctx),$F,$F
+	vpaddq		0x180($ctx),$G,$G
+	vpaddq		0x1c0($ctx),$H,$H
+	vmovdqu64	$A,0x000($ctx){%k1}		# update active lanes
+	vmovdqu64	$B,0x040($ctx){%k1}
+	vmovdqu64	$C,0x080($ctx){%k1}
+	vmovdqu64	$D,0x0c0($ctx){%k1}
+	vmovdqu64	$E,0x100($ctx){%k1}
+	vmovdqu64	$F,0x140($ctx){%k1}
+	vmovdqu64	$G,0x180($ctx){%k1}
+	vmovdqu64	$H,0x1c0($ctx){%k1}
+
+	vpaddq		$minus1,$cnt,${cnt}{%k1}	# counters--
+	vmovdqu64	$cnt,64(%rsp)
+	vptestmq	$cnt,$cnt,%k1
+	dec	%edx
+	jnz	.Loop
+
+.Ldone:
+	mov	`16*17`(%rsp),%rax		# original %rsp
+.cfi_def_cfa	%rax,8
+	vzeroupper
+___
+$code.=<<___ if ($win64);
+	movaps	-0xb8(%rax),%xmm6
+	movaps	-0xa8(%rax),%xmm7
+	movaps	-0x98(%rax),%xmm8
+	movaps	-0x88(%rax),%xmm9
+	movaps	-0x78(%rax),%xmm10
+	movaps	-0x68(%rax),%xmm11
+	movaps	-0x58(%rax),%xmm12
+	movaps	-0x48(%rax),%xmm13
+	movaps	-0x38(%rax),%xmm14
+	movaps	-0x28(%rax),%xmm15
+___
+$code.=<<___;
+	mov	-16(%rax),%rbp
+.cfi_restore	%rbp
+	mov	-8(%rax),%rbx
+.cfi_restore	%rbx
+	lea	(%rax),%rsp
+.cfi_def_cfa_register	%rsp
+.Lepilogue:
+	ret
+.cfi_endproc
+.size	ossl_sha512_multi_block_avx512,.-ossl_sha512_multi_block_avx512
+
+.align	64
+K512:
+	.quad	0x428a2f98d728ae22,0x7137449123ef65cd
+	.quad	0xb5c0fbcfec4d3b2f,0xe9b5dba58189dbbc
+	.quad	0x3956c25bf348b538,0x59f111f1b605d019
+	.quad	0x923f82a4af194f9b,0xab1c5ed5da6d8118
+	.quad	0xd807aa98a3030242,0x12835b0145706fbe
+	.quad	0x243185be4ee4b28c,0x550c7dc3d5ffb4e2
+	.quad	0x72be5d74f27b896f,0x80deb1fe3b1696b1
+	.quad	0x9bdc06a725c71235,0xc19bf174cf692694
+	.quad	0xe49b69c19ef14ad2,0xefbe4786384f25e3
+	.quad	0x0fc19dc68b8cd5b5,0x240ca1cc77ac9c65
+	.quad	0x2de92c6f592b0275,0x4a7484aa6ea6e483
+	.quad	0x5cb0a9dcbd41fbd4,0x76f988da831153b5
+	.quad	0x983e5152ee66dfab,0xa831c66d2db43210
+	.quad	0xb00327c898fb213f,0xbf597fc7beef0ee4
+	.quad	0xc6e00bf33da88fc2,0xd5a79147930aa725
+	.quad	0x06ca6351e003826f,0x142929670a0e6e70
+	.quad	0x27b70a8546d22ffc,0x2e1b21385c26c926
+	.quad	0x4d2c6dfc5ac42aed,0x53380d139d95b3df
+	.quad	0x650a73548baf63de,0x766a0abb3c77b2a8
+	.quad	0x81c2c92e47edaee6,0x92722c851482353b
+	.quad	0xa2bfe8a14cf10364,0xa81a664bbc423001
+	.quad	0xc24b8b70d0f89791,0xc76c51a30654be30
+	.quad	0xd192e819d6ef5218,0xd69906245565a910
+	.quad	0xf40e35855771202a,0x106aa07032bbd1b8
+	.quad	0x19a4c116b8d2d0c8,0x1e376c085141ab53
+	.quad	0x2748774cdf8eeb99,0x34b0bcb5e19b48a8
+	.quad	0x391c0cb3c5c95a63,0x4ed8aa4ae3418acb
+	.quad	0x5b9cca4f7763e373,0x682e6ff3d6b2b8a3
+	.quad	0x748f82ee5defb2fc,0x78a5636f43172f60
+	.quad	0x84c87814a1f0ab72,0x8cc702081a6439ec
+	.quad	0x90befffa23631e28,0xa4506cebde82bde9
+	.quad	0xbef9a3f7b2c67915,0xc67178f2e372532b
+	.quad	0xca273eceea26619c,0xd186b8c721c0c207
+	.quad	0xeada7dd6cde0eb1e,0xf57d4f7fee6ed178
+	.quad	0x06f067aa72176fba,0x0a637dc5a2c898a6
+	.quad	0x113f9804bef90dae,0x1b710b35131c471b
+	.quad	0x28db77f523047d84,0x32caab7b40c72493
+	.quad	0x3c9ebe0a15c9bebc,0x431d67c49c100d4c
+	.quad	0x4cc5d4becb3e42b6,0x597f299cfc657e2a
+	.quad	0x5fcb6fab3ad6faec,0x6c44198c4a475817
+.Lbswap:
+	.quad	0x0001020304050607,0x08090a0b0c0d0e0f	# byte swap
+	.asciz	"SHA512 multi-block transform for x86_64 with AVX-512"
+___
+
+if ($win64) {
+# EXCEPTION_DISPOSITION handler (EXCEPTION_RECORD *rec,ULONG64 frame,
+#		CONTEXT *context,DISPATCHER_CONTEXT *disp)
+$rec="%rcx";
+$frame="%rdx";
+$context="%r8";
+$disp="%r9";
+
+$code.=<<___;
+.extern	__imp_RtlVirtualUnwind
+.type	se_handler,\@abi-omnipotent
+.align	16
+se_handler:
+	push	%rsi
+	push	%rdi
+	push	%rbx
+	push	%rbp
+	push	%r12
+	push	%r13
+	push	%r14
+	push	%r15
+	pushfq
+	sub	\$64,%rsp
+
+	mov	120($context),%rax	# pull context->Rax
+	mov	248($context),%rbx	# pull context->Rip
+
+	mov	8($disp),%rsi		# disp->ImageBase
+	mov	56($disp),%r11		# disp->HandlerData
+
+	mov	0(%r11),%r10d		# HandlerData[0]
+	lea	(%rsi,%r10),%r10	# end of prologue label
+	cmp	%r10,%rbx		# context->Rip<.Lbody
+	jb	.Lin_prologue
+
+	mov	152($context),%rax	# pull context->Rsp
+
+	mov	4(%r11),%r10d		# HandlerData[1]
+	lea	(%rsi,%r10),%r10	# epilogue label
+	cmp	%r10,%rbx		# context->Rip>=.Lepilogue
+	jae	.Lin_prologue
+
+	mov	`16*17`(%rax),%rax	# pull saved stack pointer
+
+	mov	-8(%rax),%rbx
+	mov	-16(%rax),%rbp
+	mov	%rbx,144($context)	# restore context->Rbx
+	mov	%rbp,160($context)	# restore context->Rbp
+
+	lea	-24-10*16(%rax),%rsi
+	lea	512($context),%rdi	# &context.Xmm6
+	mov	\$20,%ecx
+	.long	0xa548f3fc		# cld; rep movsq
+
+.Lin_prologue:
+	mov	8(%rax),%rdi
+	mov	16(%rax),%rsi
+	mov	%rax,152($context)	# restore context->Rsp
+	mov	%rsi,168($context)	# restore context->Rsi
+	mov	%rdi,176($context)	# restore context->Rdi
+
+	mov	40($disp),%rdi		# disp->ContextRecord
+	mov	$context,%rsi		# context
+	mov	\$154,%ecx		# sizeof(CONTEXT)
+	.long	0xa548f3fc		# cld; rep movsq
+
+	mov	$disp,%rsi
+	xor	%rcx,%rcx		# arg1, UNW_FLAG_NHANDLER
+	mov	8(%rsi),%rdx		# arg2, disp->ImageBase
+	mov	0(%rsi),%r8		# arg3, disp->ControlPc
+	mov	16(%rsi),%r9		# arg4, disp->FunctionEntry
+	mov	40(%rsi),%r10		# disp->ContextRecord
+	lea	56(%rsi),%r11		# &disp->HandlerData
+	lea	24(%rsi),%r12		# &disp->EstablisherFrame
+	mov	%r10,32(%rsp)		# arg5
+	mov	%r11,40(%rsp)		# arg6
+	mov	%r12,48(%rsp)		# arg7
+	mov	%rcx,56(%rsp)		# arg8, (NULL)
+	call	*__imp_RtlVirtualUnwind(%rip)
+
+	mov	\$1,%eax		# ExceptionContinueSearch
+	add	\$64,%rsp
+	popfq
+	pop	%r15
+	pop	%r14
+	pop	%r13
+	pop	%r12
+	pop	%rbp
+	pop	%rbx
+	pop	%rdi
+	pop	%rsi
+	ret
+.size	se_handler,.-se_handler
+
+.section	.pdata
+.align	4
+	.rva	.LSEH_begin_ossl_sha512_multi_block_avx512
+	.rva	.LSEH_end_ossl_sha512_multi_block_avx512
+	.rva	.LSEH_info_ossl_sha512_multi_block_avx512
+
+.section	.xdata
+.align	8
+.LSEH_info_ossl_sha512_multi_block_avx512:
+	.byte	9,0,0,0
+	.rva	se_handler
+	.rva	.Lbody,.Lepilogue			# HandlerData[]
+___
+}
+
+} else {
+# Fallback for old assembler
+$code.=<<___;
+.text
+
+.globl	ossl_sha512_mb_avx512_capable
+.type	ossl_sha512_mb_avx512_capable,\@abi-omnipotent
+ossl_sha512_mb_avx512_capable:
+	xor	%eax,%eax
+	ret
+.size	ossl_sha512_mb_avx512_capable,.-ossl_sha512_mb_avx512_capable
+
+.globl	ossl_sha512_multi_block_avx512
+.type	ossl_sha512_multi_block_avx512,\@abi-omnipotent
+ossl_sha512_multi_block_avx512:
+	.byte	0x0f,0x0b	# ud2
+	ret
+.size	ossl_sha512_multi_block_avx512,.-ossl_sha512_multi_block_avx512
+___
+}
+
+foreach (split("\n",$code)) {
+	s/\`([^\`]*)\`/eval($1)/ge;
+
+	print $_,"\n";
+}
+
+close STDOUT or die "error closing STDOUT: $!";
@@ -15,6 +15,7 @@
 
 #include <openssl/opensslconf.h>
 
+#include <limits.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -423,3 +424,163 @@ static void sha256_block_data_order(SHA256_CTX *ctx, const void *in,
 
 # endif
 #endif                         /* SHA256_ASM */
+
+#ifdef SHA_MB_ASM
+# include "internal/cryptlib.h"
+
+# define SHA256_MB_LANES 16
+/* The 8-lane code relies on pshufb, the AVX-512 code implies SSSE3 */
+# define SHA256_MB_SSSE3_CAPABLE (OPENSSL_ia32cap_P[1] & (1 << (41 - 32)))
+
+typedef struct {
+    const unsigned char *ptr;
+    int blocks;
+} SHA256_MB_DESC;
+
+int ossl_sha256_mb_avx512_capable(void);
+void ossl_sha256_multi_block_avx512(SHA_LONG *ctx, const SHA256_MB_DESC *inp);
+void sha256_multi_block(SHA_LONG *ctx, const SHA256_MB_DESC *inp, int num);
+
+typedef struct {
+    const unsigned char *p;     /* next block of message or of pad */
+    size_t left;                /* blocks left before pad or digest */
+    size_t idx;                 /* message index */
+    int pad;                    /* set once |p| points at |buf| */
+    unsigned char buf[2 * SHA_CBLOCK];
+} SHA256_MB_LANE;
+
+static void sha256_mb_pad(SHA256_MB_LANE *ln, size_t len)
+{
+    size_t rem = len % SHA_CBLOCK;
+    size_t n = rem < SHA_CBLOCK - 8 ? SHA_CBLOCK : 2 * SHA_CBLOCK;
+    uint64_t bits = (uint64_t)len << 3;
+    int i;
+
+    memcpy(ln->buf, ln->p, rem);
+    ln->buf[rem] = 0x80;
+    memset(ln->buf + rem + 1, 0, n - rem - 1 - 8);
+    for (i = 1; i <= 8; i++, bits >>= 8)
+        ln->buf[n - i] = (unsigned char)bits;
+    ln->p = ln->buf;
+    ln->left = n / SHA_CBLOCK;
+    ln->pad = 1;
+}
+
+/*
+ * Drive the multi-buffer transform. Active lanes are kept packed at the
+ * bottom of the state, because the pre-AVX-512 transform gives up on all
+ * lanes once it meets a group of lanes without input. Each round hashes
+ * as many blocks as the shortest active lane has left, after which lanes
+ * that ran out of message switch to their padding, and lanes that ran out
+ * of padding output the digest and are refilled with the next message.
+ */
+static void sha256_mb(const SHA256_CTX *init, size_t num,
+                      const unsigned char *in[], const size_t inlen[],
+                      unsigned char *md[], int lanes)
+{
+    SHA256_MB_LANE lane[SHA256_MB_LANES];
+    SHA256_MB_LANE *slot[SHA256_MB_LANES];
+    SHA256_MB_DESC desc[SHA256_MB_LANES];
+    SHA_LONG h[8 * SHA256_MB_LANES];
+    size_t next = 0, n;
+    int active = 0, l, j;
+
+    for (l = 0; l < lanes; l++)
+        slot[l] = &lane[l];
+
+    for (;;) {
+        while (active < lanes && next < num) {
+            SHA256_MB_LANE *ln = slot[active];
+
+            for (j = 0; j < 8; j++)
+                h[j * lanes + active] = init->h[j];
+            ln->idx = next;
+            ln->p = in[next];
+            ln->left = inlen[next] / SHA_CBLOCK;
+            ln->pad = 0;
+            if (ln->left == 0)
+                sha256_mb_pad(ln, inlen[next]);
+            next++;
+            active++;
+        }
+        if (active == 0)
+            break;
+
+        n = slot[0]->left;
+        for (l = 1; l < active; l++)
+            if (slot[l]->left < n)
+                n = slot[l]->left;
+        if (n > INT_MAX)
+            n = INT_MAX;
+        for (l = 0; l < lanes; l++) {
+            desc[l].ptr = l < active ? slot[l]->p : NULL;
+            desc[l].blocks = l < active ? (int)n : 0;
+        }
+
+        if (lanes == 16)
+            ossl_sha256_multi_block_avx512(h, desc);
+        else
+            sha256_multi_block(h, desc, lanes / 4);
+
+        for (l = active - 1; l >= 0; l--) {
+            SHA256_MB_LANE *ln = slot[l];
+
+            ln->p += n * SHA_CBLOCK;
+            if ((ln->left -= n) != 0)
+                continue;
+            if (!ln->pad) {
+                sha256_mb_pad(ln, inlen[ln->idx]);
+                continue;
+            }
+            for (j = 0; j < (int)init->md_len; j++)
+                md[ln->idx][j] =
+                    (unsigned char)(h[(j / 4) * lanes + l] >> (24 - 8 * (j % 4)));
+
+            /* Move the topmost active lane down into the freed one */
+            active--;
+            for (j = 0; j < 8; j++)
+                h[j * lanes + l] = h[j * lanes + active];
+            slot[l] = slot[active];
+            slot[active] = ln;
+        }
+    }
+
+    OPENSSL_cleanse(lane, sizeof(lane));
+    OPENSSL_cleanse(h, sizeof(h));
+}
+#endif
+
+/*
+ * Hash |num| independent messages, starting each from the state in |init|,
+ * which must have been freshly set up by SHA256_Init(), SHA224_Init() or
+ * ossl_sha256_192_init(). The digest of in[i] is written to md[i].
+ */
+int ossl_sha256_batch(const SHA256_CTX *init, size_t num,
+                      const unsigned char *in[], const size_t inlen[],
+                      unsigned char *md[])
+{
+    SHA256_CTX c;
+    size_t i;
+
+    if (init->md_len > SHA256_DIGEST_LENGTH)
+        return 0;
+
+#ifdef SHA_MB_ASM
+    if (num > 1 && init->num == 0 && init->Nl == 0 && init->Nh == 0
+            && SHA256_MB_SSSE3_CAPABLE) {
+        sha256_mb(init, num, in, inlen, md,
+                  ossl_sha256_mb_avx512_capable() ? 16 : 8);
+        return 1;
+    }
+#endif
+
+    for (i = 0; i < num; i++) {
+        c = *init;
+        if (!SHA256_Update(&c, in[i], inlen[i]) || !SHA256_Final(md[i], &c)) {
+            OPENSSL_cleanse(&c, sizeof(c));
+            return 0;
+        }
+    }
+    OPENSSL_cleanse(&c, sizeof(c));
+    return 1;
+}
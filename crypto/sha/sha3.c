@@ -1,5 +1,5 @@
 /*
- * Copyright 2017-2020 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2017-2024 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -8,6 +8,7 @@
  */
 
 #include <string.h>
+#include <openssl/crypto.h>
 #include "internal/sha3.h"
 
 void SHA3_squeeze(uint64_t A[5][5], unsigned char *out, size_t len, size_t r, int next);
@@ -199,3 +200,149 @@ int ossl_sha3_squeeze(KECCAK1600_CTX *ctx, unsigned char *out, size_t outlen)
 
     return 1;
 }
+
+#ifdef KECCAK1600_MB_ASM
+# define KECCAK1600_MB_LANES 8
+
+int ossl_keccak1600_mb_capable(void);
+void ossl_keccak1600_x4_avx2(uint64_t A[25][4]);
+void ossl_keccak1600_x8_avx512(uint64_t A[25][8]);
+
+typedef struct {
+    const unsigned char *p;     /* unabsorbed part of the message */
+    size_t left;                /* its length */
+    unsigned char *out;         /* where to squeeze next */
+    size_t outleft;             /* how much more to squeeze */
+    int state;                  /* XOF_STATE_INIT if lane is unused */
+} KECCAK1600_MB_LANE;
+
+/*
+ * Drive the multi-state permutation. States are interleaved, so that lane
+ * i of state l is A[i * lanes + l]. Every round each busy state absorbs
+ * its next block, or its padded last block, or nothing if it is being
+ * squeezed, then all states are permuted together. States that have been
+ * squeezed dry are reset and refilled with the next message.
+ */
+static void sha3_mb(unsigned char pad, size_t bsz, size_t num,
+                    const unsigned char *in[], const size_t inlen[],
+                    unsigned char *out[], size_t outlen, size_t lanes)
+{
+    uint64_t A[25 * KECCAK1600_MB_LANES];
+    KECCAK1600_MB_LANE lane[KECCAK1600_MB_LANES];
+    unsigned char buf[KECCAK1600_WIDTH / 8 - 32];
+    const unsigned char *blk;
+    size_t next = 0, active, l, i, n;
+    uint64_t w;
+
+    memset(lane, 0, sizeof(lane));
+    for (;;) {
+        active = 0;
+        for (l = 0; l < lanes; l++) {
+            KECCAK1600_MB_LANE *ln = &lane[l];
+
+            if (ln->state == XOF_STATE_INIT && next < num) {
+                for (i = 0; i < 25; i++)
+                    A[i * lanes + l] = 0;
+                ln->p = in[next];
+                ln->left = inlen[next];
+                ln->out = out[next];
+                ln->outleft = outlen;
+                ln->state = XOF_STATE_ABSORB;
+                next++;
+            }
+            if (ln->state == XOF_STATE_INIT)
+                continue;
+            active++;
+            if (ln->state != XOF_STATE_ABSORB)
+                continue;
+
+            if (ln->left >= bsz) {
+                blk = ln->p;
+                ln->p += bsz;
+                ln->left -= bsz;
+            } else {
+                /* Pad the data with 10*1, as ossl_sha3_final() does */
+                memcpy(buf, ln->p, ln->left);
+                memset(buf + ln->left, 0, bsz - ln->left);
+                buf[ln->left] = pad;
+                buf[bsz - 1] |= 0x80;
+                blk = buf;
+                ln->state = XOF_STATE_SQUEEZE;
+            }
+            /* x86_64 is little-endian, so lanes are loaded as they are */
+            for (i = 0; i < bsz / 8; i++) {
+                memcpy(&w, blk + 8 * i, 8);
+                A[i * lanes + l] ^= w;
+            }
+        }
+        if (active == 0)
+            break;
+
+        if (lanes == 8)
+            ossl_keccak1600_x8_avx512((uint64_t (*)[8])A);
+        else
+            ossl_keccak1600_x4_avx2((uint64_t (*)[4])A);
+
+        for (l = 0; l < lanes; l++) {
+            KECCAK1600_MB_LANE *ln = &lane[l];
+
+            if (ln->state != XOF_STATE_SQUEEZE)
+                continue;
+            n = ln->outleft < bsz ? ln->outleft : bsz;
+            ln->outleft -= n;
+            for (i = 0; n > 0; i++) {
+                size_t k = n < 8 ? n : 8;
+
+                w = A[i * lanes + l];
+                memcpy(ln->out, &w, k);
+                ln->out += k;
+                n -= k;
+            }
+            if (ln->outleft == 0)
+                ln->state = XOF_STATE_INIT;
+        }
+    }
+
+    OPENSSL_cleanse(A, sizeof(A));
+    OPENSSL_cleanse(buf, sizeof(buf));
+}
+#endif
+
+/*
+ * Hash |num| independent messages with the Keccak sponge of capacity
+ * 2 * |bitlen| and domain padding |pad|, squeezing |outlen| bytes of
+ * each. The output of in[i] is written to out[i].
+ */
+int ossl_sha3_batch(unsigned char pad, size_t bitlen, size_t num,
+                    const unsigned char *in[], const size_t inlen[],
+                    unsigned char *out[], size_t outlen)
+{
+    KECCAK1600_CTX ctx;
+    size_t i;
+
+    if (!ossl_sha3_init(&ctx, pad, bitlen))
+        return 0;
+
+#ifdef KECCAK1600_MB_ASM
+    if (num > 1) {
+        int lanes = ossl_keccak1600_mb_capable();
+
+        if (lanes > 0) {
+            sha3_mb(pad, ctx.block_size, num, in, inlen, out, outlen,
+                    (size_t)lanes);
+            return 1;
+        }
+    }
+#endif
+
+    for (i = 0; i < num; i++) {
+        ossl_sha3_reset(&ctx);
+        if (!ossl_sha3_update(&ctx, in[i], inlen[i])
+                || !ossl_sha3_final(&ctx, out[i], outlen)) {
+            OPENSSL_cleanse(&ctx, sizeof(ctx));
+            return 0;
+        }
+    }
+    OPENSSL_cleanse(&ctx, sizeof(ctx));
+    return 1;
+}
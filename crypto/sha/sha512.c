@@ -49,6 +49,7 @@
  * inappropriate for platforms which don't support it, most notably
  * 16-bit platforms.
  */
+#include <limits.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -867,3 +868,154 @@ static void sha512_block_data_order(SHA512_CTX *ctx, const void *in,
 # endif
 
 #endif                         /* SHA512_ASM */
+
+#ifdef SHA_MB_ASM
+# define SHA512_MB_LANES 8
+
+typedef struct {
+    const unsigned char *ptr;
+    int blocks;
+} SHA512_MB_DESC;
+
+int ossl_sha512_mb_avx512_capable(void);
+void ossl_sha512_multi_block_avx512(SHA_LONG64 *ctx,
+                                    const SHA512_MB_DESC *inp);
+
+typedef struct {
+    const unsigned char *p;     /* next block of message or of pad */
+    size_t left;                /* blocks left before pad or digest */
+    size_t idx;                 /* message index */
+    int pad;                    /* set once |p| points at |buf| */
+    unsigned char buf[2 * SHA512_CBLOCK];
+} SHA512_MB_LANE;
+
+static void sha512_mb_pad(SHA512_MB_LANE *ln, size_t len)
+{
+    size_t rem = len % SHA512_CBLOCK;
+    size_t n = rem < SHA512_CBLOCK - 16 ? SHA512_CBLOCK : 2 * SHA512_CBLOCK;
+    SHA_LONG64 bits = (SHA_LONG64)len << 3;
+    int i;
+
+    memcpy(ln->buf, ln->p, rem);
+    ln->buf[rem] = 0x80;
+    memset(ln->buf + rem + 1, 0, n - rem - 1 - 8);
+    for (i = 1; i <= 8; i++, bits >>= 8)
+        ln->buf[n - i] = (unsigned char)bits;
+    ln->buf[n - 9] = (unsigned char)((SHA_LONG64)len >> 61);
+    ln->p = ln->buf;
+    ln->left = n / SHA512_CBLOCK;
+    ln->pad = 1;
+}
+
+/*
+ * Same scheduling as in sha256_mb(): each round hashes as many blocks as
+ * the shortest active lane has left, and lanes that are done are refilled
+ * with the next message.
+ */
+static void sha512_mb(const SHA512_CTX *init, size_t num,
+                      const unsigned char *in[], const size_t inlen[],
+                      unsigned char *md[])
+{
+    SHA512_MB_LANE lane[SHA512_MB_LANES];
+    SHA512_MB_LANE *slot[SHA512_MB_LANES];
+    SHA512_MB_DESC desc[SHA512_MB_LANES];
+    SHA_LONG64 h[8 * SHA512_MB_LANES];
+    size_t next = 0, n;
+    int active = 0, l, j;
+
+    for (l = 0; l < SHA512_MB_LANES; l++)
+        slot[l] = &lane[l];
+
+    for (;;) {
+        while (active < SHA512_MB_LANES && next < num) {
+            SHA512_MB_LANE *ln = slot[active];
+
+            for (j = 0; j < 8; j++)
+                h[j * SHA512_MB_LANES + active] = init->h[j];
+            ln->idx = next;
+            ln->p = in[next];
+            ln->left = inlen[next] / SHA512_CBLOCK;
+            ln->pad = 0;
+            if (ln->left == 0)
+                sha512_mb_pad(ln, inlen[next]);
+            next++;
+            active++;
+        }
+        if (active == 0)
+            break;
+
+        n = slot[0]->left;
+        for (l = 1; l < active; l++)
+            if (slot[l]->left < n)
+                n = slot[l]->left;
+        if (n > INT_MAX)
+            n = INT_MAX;
+        for (l = 0; l < SHA512_MB_LANES; l++) {
+            desc[l].ptr = l < active ? slot[l]->p : NULL;
+            desc[l].blocks = l < active ? (int)n : 0;
+        }
+
+        ossl_sha512_multi_block_avx512(h, desc);
+
+        for (l = active - 1; l >= 0; l--) {
+            SHA512_MB_LANE *ln = slot[l];
+
+            ln->p += n * SHA512_CBLOCK;
+            if ((ln->left -= n) != 0)
+                continue;
+            if (!ln->pad) {
+                sha512_mb_pad(ln, inlen[ln->idx]);
+                continue;
+            }
+            for (j = 0; j < (int)init->md_len; j++)
+                md[ln->idx][j] =
+                    (unsigned char)(h[(j / 8) * SHA512_MB_LANES + l]
+                                    >> (56 - 8 * (j % 8)));
+
+            active--;
+            for (j = 0; j < 8; j++)
+                h[j * SHA512_MB_LANES + l] = h[j * SHA512_MB_LANES + active];
+            slot[l] = slot[active];
+            slot[active] = ln;
+        }
+    }
+
+    OPENSSL_cleanse(lane, sizeof(lane));
+    OPENSSL_cleanse(h, sizeof(h));
+}
+#endif
+
+/*
+ * Hash |num| independent messages, starting each from the state in |init|,
+ * which must have been freshly set up by SHA512_Init(), SHA384_Init(),
+ * sha512_224_init() or sha512_256_init(). The digest of in[i] is written
+ * to md[i].
+ */
+int ossl_sha512_batch(const SHA512_CTX *init, size_t num,
+                      const unsigned char *in[], const size_t inlen[],
+                      unsigned char *md[])
+{
+    SHA512_CTX c;
+    size_t i;
+
+    if (init->md_len > SHA512_DIGEST_LENGTH)
+        return 0;
+
+#ifdef SHA_MB_ASM
+    if (num > 1 && init->num == 0 && init->Nl == 0 && init->Nh == 0
+            && ossl_sha512_mb_avx512_capable()) {
+        sha512_mb(init, num, in, inlen, md);
+        return 1;
+    }
+#endif
+
+    for (i = 0; i < num; i++) {
+        c = *init;
+        if (!SHA512_Update(&c, in[i], inlen[i]) || !SHA512_Final(md[i], &c)) {
+            OPENSSL_cleanse(&c, sizeof(c));
+            return 0;
+        }
+    }
+    OPENSSL_cleanse(&c, sizeof(c));
+    return 1;
+}
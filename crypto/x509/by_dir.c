@@ -224,29 +224,19 @@ static int get_cert_by_subject_ex(X509_LOOKUP *xl, X509_LOOKUP_TYPE type,
                                   OSSL_LIB_CTX *libctx, const char *propq)
 {
     BY_DIR *ctx;
-    union {
-        X509 st_x509;
-        X509_CRL crl;
-    } data;
     int ok = 0;
     int i, j, k;
     unsigned long h;
     BUF_MEM *b = NULL;
-    X509_OBJECT stmp, *tmp;
+    X509_OBJECT *tmp;
     const char *postfix = "";
 
     if (name == NULL)
         return 0;
 
-    stmp.type = type;
-    if (type == X509_LU_X509) {
-        data.st_x509.cert_info.subject = (X509_NAME *)name; /* won't modify it */
-        stmp.data.x509 = &data.st_x509;
-    } else if (type == X509_LU_CRL) {
-        data.crl.crl.issuer = (X509_NAME *)name; /* won't modify it */
-        stmp.data.crl = &data.crl;
+    if (type == X509_LU_CRL) {
         postfix = "r";
-    } else {
+    } else if (type != X509_LU_X509) {
         ERR_raise(ERR_LIB_X509, X509_R_WRONG_LOOKUP_TYPE);
         goto finish;
     }
@@ -341,21 +331,11 @@ static int get_cert_by_subject_ex(X509_LOOKUP *xl, X509_LOOKUP_TYPE type,
             k++;
         }
 
-        /*
-         * we have added it to the cache so now pull it out again
-         *
-         * Note: quadratic time find here since the objects won't generally be
-         *       sorted and sorting the would result in O(n^2 log n) complexity.
-         */
-        if (k > 0) {
-            if (!X509_STORE_lock(xl->store_ctx))
-                goto finish;
-            j = sk_X509_OBJECT_find(xl->store_ctx->objs, &stmp);
-            tmp = sk_X509_OBJECT_value(xl->store_ctx->objs, j);
-            X509_STORE_unlock(xl->store_ctx);
-        } else {
+        /* we have added it to the cache so now pull it out again */
+        if (k > 0)
+            tmp = ossl_x509_store_get0_by_subject(xl->store_ctx, type, name);
+        else
             tmp = NULL;
-        }
         /*
          * If a CRL, update the last file suffix added for this.
          * We don't need to add an entry if k is 0 as this is the initial value.
@@ -419,14 +399,6 @@ static int get_cert_by_subject_ex(X509_LOOKUP *xl, X509_LOOKUP_TYPE type,
         }
     }
  finish:
-    /* If we changed anything, resort the objects for faster lookup */
-    if (!sk_X509_OBJECT_is_sorted(xl->store_ctx->objs)) {
-        if (X509_STORE_lock(xl->store_ctx)) {
-            sk_X509_OBJECT_sort(xl->store_ctx->objs);
-            X509_STORE_unlock(xl->store_ctx);
-        }
-    }
-
     BUF_MEM_free(b);
     return ok;
 }
@@ -0,0 +1,575 @@
+/*
+ * Copyright 2024 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "internal/e_os.h"
+#include "internal/cryptlib.h"
+#include <openssl/buffer.h>
+#include <openssl/x509.h>
+#include "crypto/x509.h"
+#include "x509_local.h"
+
+#if defined(OPENSSL_SYS_UNIX) && !defined(OPENSSL_NO_POSIX_IO)
+# include <sys/types.h>
+# include <sys/stat.h>
+# include <sys/mman.h>
+# include <fcntl.h>
+# include <unistd.h>
+# define SNAPSHOT_MMAP
+#endif
+
+/*-
+ * A snapshot is a binary file holding the DER encodings of a set of trusted
+ * certificates and CRLs together with an index on their subject (issuer for
+ * CRLs) names, so that it can be attached to an X509_STORE without decoding
+ * anything up front.  Objects are only decoded, and added to the store, when
+ * a name they are indexed under is looked up.  Where possible the file is
+ * mapped into memory, so processes using the same snapshot share its pages.
+ * Reading a mapping past the end of a file that was truncated meanwhile
+ * raises SIGBUS, so the header and entries of a mapped file are read with
+ * pread() rather than through the mapping, and the size of the file is
+ * checked before each DER encoding is read from it.
+ *
+ * All integers are unsigned 32-bit big-endian values:
+ *
+ *   header:  "OSSLSNP1" | number of entries | 0
+ *   entries: name hash | type | offset | length
+ *   data:    DER encodings, each referenced by exactly one entry
+ *
+ * The entries are sorted on (type, name hash).  The name hash is the 32-bit
+ * FNV-1a hash of the canonical encoding of the name.
+ */
+
+#define SNAPSHOT_MAGIC          "OSSLSNP1"
+#define SNAPSHOT_HDR_LEN        16
+#define SNAPSHOT_ENTRY_LEN      16
+#define SNAPSHOT_TYPE_CERT      1
+#define SNAPSHOT_TYPE_CRL       2
+
+typedef struct by_snap_file_st {
+    unsigned char *data;
+    size_t len;
+    int mapped;
+    /* The mapped file, kept open to check its size */
+    int fd;
+    uint32_t num;
+    /*
+     * Private copy of the entries, checked once when the file is added.  A
+     * mapped file can change underneath us, so offsets and lengths are never
+     * read from the mapping itself.
+     */
+    unsigned char *index;
+    /* Whether entry |i| has been decoded and added to the store */
+    unsigned char *loaded;
+} BY_SNAP_FILE;
+
+DEFINE_STACK_OF(BY_SNAP_FILE)
+
+typedef struct by_snap_st {
+    STACK_OF(BY_SNAP_FILE) *files;
+    CRYPTO_RWLOCK *lock;
+} BY_SNAP;
+
+static uint32_t snap_get32(const unsigned char *p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16)
+        | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static unsigned char *snap_put32(unsigned char *p, uint32_t v)
+{
+    *p++ = (unsigned char)(v >> 24);
+    *p++ = (unsigned char)(v >> 16);
+    *p++ = (unsigned char)(v >> 8);
+    *p++ = (unsigned char)v;
+    return p;
+}
+
+static int snap_name_hash(const X509_NAME *name, uint32_t *hash)
+{
+    uint32_t h = 2166136261U;
+    int i;
+
+    /* Ensure canonical encoding is present and up to date */
+    if ((name->canon_enc == NULL || name->modified)
+            && i2d_X509_NAME((X509_NAME *)name, NULL) < 0)
+        return 0;
+    for (i = 0; i < name->canon_enclen; i++)
+        h = (h ^ name->canon_enc[i]) * 16777619U;
+    *hash = h;
+    return 1;
+}
+
+static uint64_t snap_key(uint32_t type, uint32_t hash)
+{
+    return ((uint64_t)type << 32) | hash;
+}
+
+static uint64_t snap_entry_key(const BY_SNAP_FILE *f, uint32_t i)
+{
+    const unsigned char *e = f->index + (size_t)i * SNAPSHOT_ENTRY_LEN;
+
+    return snap_key(snap_get32(e + 4), snap_get32(e));
+}
+
+static void snap_file_free(BY_SNAP_FILE *f)
+{
+    if (f == NULL)
+        return;
+#ifdef SNAPSHOT_MMAP
+    if (f->mapped) {
+        munmap(f->data, f->len);
+        close(f->fd);
+    } else
+#endif
+        OPENSSL_free(f->data);
+    OPENSSL_free(f->index);
+    OPENSSL_free(f->loaded);
+    OPENSSL_free(f);
+}
+
+static int snap_read_file(BY_SNAP_FILE *f, const char *file)
+{
+    BIO *in;
+    BUF_MEM *buf = NULL;
+    unsigned char tmp[4096];
+    int n, ok = 0;
+
+#ifdef SNAPSHOT_MMAP
+    {
+        struct stat st;
+        int fd = open(file, O_RDONLY);
+
+        if (fd >= 0) {
+            void *p = MAP_FAILED;
+
+            if (fstat(fd, &st) == 0 && st.st_size > 0
+                    && (uintmax_t)st.st_size <= SIZE_MAX)
+                p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED,
+                         fd, 0);
+            if (p != MAP_FAILED) {
+                f->data = p;
+                f->len = (size_t)st.st_size;
+                f->mapped = 1;
+                f->fd = fd;
+                return 1;
+            }
+            close(fd);
+        }
+    }
+#endif
+
+    if ((in = BIO_new_file(file, "rb")) == NULL) {
+        ERR_raise(ERR_LIB_X509, ERR_R_BIO_LIB);
+        return 0;
+    }
+    if ((buf = BUF_MEM_new()) == NULL)
+        goto err;
+    while ((n = BIO_read(in, tmp, sizeof(tmp))) > 0) {
+        size_t len = buf->length;
+
+        if (!BUF_MEM_grow(buf, len + n))
+            goto err;
+        memcpy(buf->data + len, tmp, n);
+    }
+    f->len = buf->length;
+    f->data = (unsigned char *)buf->data;
+    buf->data = NULL;
+    ok = 1;
+ err:
+    BUF_MEM_free(buf);
+    BIO_free(in);
+    return ok;
+}
+
+/*
+ * Copy |len| bytes at |off| in |f| to |out|.  A mapped file is read with
+ * pread(), which fails instead of raising SIGBUS if the file is now shorter.
+ */
+static int snap_copy(const BY_SNAP_FILE *f, size_t off, size_t len,
+                     unsigned char *out)
+{
+    if (off > f->len || len > f->len - off)
+        return 0;
+#ifdef SNAPSHOT_MMAP
+    if (f->mapped) {
+        ssize_t n;
+
+        while (len > 0) {
+            if ((n = pread(f->fd, out, len, (off_t)off)) <= 0)
+                return 0;
+            out += n;
+            off += n;
+            len -= n;
+        }
+        return 1;
+    }
+#endif
+    memcpy(out, f->data + off, len);
+    return 1;
+}
+
+/*
+ * Check that the DER encoding at |off| of |len| bytes can still be read from
+ * |f|, which isn't the case any more if a mapped file was truncated.
+ */
+static int snap_readable(const BY_SNAP_FILE *f, size_t off, size_t len)
+{
+#ifdef SNAPSHOT_MMAP
+    struct stat st;
+
+    if (f->mapped
+            && (fstat(f->fd, &st) != 0
+                || st.st_size < (off_t)off + (off_t)len))
+        return 0;
+#endif
+    return 1;
+}
+
+/* Copy the index and check that the header and all entries are well-formed */
+static int snap_check(BY_SNAP_FILE *f)
+{
+    uint32_t i, off, len;
+    const unsigned char *e;
+    unsigned char hdr[SNAPSHOT_HDR_LEN];
+    size_t data_start;
+
+    if (!snap_copy(f, 0, sizeof(hdr), hdr)
+            || memcmp(hdr, SNAPSHOT_MAGIC, 8) != 0)
+        return 0;
+    f->num = snap_get32(hdr + 8);
+    if (f->num > (f->len - SNAPSHOT_HDR_LEN) / SNAPSHOT_ENTRY_LEN)
+        return 0;
+    if (f->num == 0)
+        return 1;
+    data_start = SNAPSHOT_HDR_LEN + (size_t)f->num * SNAPSHOT_ENTRY_LEN;
+    f->index = OPENSSL_malloc(data_start - SNAPSHOT_HDR_LEN);
+    if (f->index == NULL
+            || !snap_copy(f, SNAPSHOT_HDR_LEN, data_start - SNAPSHOT_HDR_LEN,
+                          f->index))
+        return 0;
+
+    for (i = 0; i < f->num; i++) {
+        e = f->index + (size_t)i * SNAPSHOT_ENTRY_LEN;
+        off = snap_get32(e + 8);
+        len = snap_get32(e + 12);
+        if (snap_get32(e + 4) != SNAPSHOT_TYPE_CERT
+                && snap_get32(e + 4) != SNAPSHOT_TYPE_CRL)
+            return 0;
+        if (off < data_start || off > f->len || len > f->len - off)
+            return 0;
+        if (i > 0 && snap_entry_key(f, i - 1) > snap_entry_key(f, i))
+            return 0;
+    }
+    return 1;
+}
+
+static int snap_add_file(X509_LOOKUP *ctx, const char *file)
+{
+    BY_SNAP *snap = X509_LOOKUP_get_method_data(ctx);
+    BY_SNAP_FILE *f;
+    int ok;
+
+    if (file == NULL) {
+        ERR_raise(ERR_LIB_X509, ERR_R_PASSED_NULL_PARAMETER);
+        return 0;
+    }
+    if ((f = OPENSSL_zalloc(sizeof(*f))) == NULL)
+        return 0;
+    if (!snap_read_file(f, file))
+        goto err;
+    if (!snap_check(f)) {
+        ERR_raise_data(ERR_LIB_X509, X509_R_INVALID_SNAPSHOT, "%s", file);
+        goto err;
+    }
+    if (f->num > 0 && (f->loaded = OPENSSL_zalloc(f->num)) == NULL)
+        goto err;
+
+    if (!CRYPTO_THREAD_write_lock(snap->lock))
+        goto err;
+    ok = sk_BY_SNAP_FILE_push(snap->files, f) > 0;
+    CRYPTO_THREAD_unlock(snap->lock);
+    if (ok)
+        return 1;
+    ERR_raise(ERR_LIB_X509, ERR_R_CRYPTO_LIB);
+ err:
+    snap_file_free(f);
+    return 0;
+}
+
+static int by_snap_new(X509_LOOKUP *ctx)
+{
+    BY_SNAP *snap = OPENSSL_zalloc(sizeof(*snap));
+
+    if (snap == NULL)
+        return 0;
+    if ((snap->files = sk_BY_SNAP_FILE_new_null()) == NULL
+            || (snap->lock = CRYPTO_THREAD_lock_new()) == NULL) {
+        ERR_raise(ERR_LIB_X509, ERR_R_CRYPTO_LIB);
+        sk_BY_SNAP_FILE_free(snap->files);
+        OPENSSL_free(snap);
+        return 0;
+    }
+    X509_LOOKUP_set_method_data(ctx, snap);
+    return 1;
+}
+
+static void by_snap_free(X509_LOOKUP *ctx)
+{
+    BY_SNAP *snap = X509_LOOKUP_get_method_data(ctx);
+
+    if (snap == NULL)
+        return;
+    sk_BY_SNAP_FILE_pop_free(snap->files, snap_file_free);
+    CRYPTO_THREAD_lock_free(snap->lock);
+    OPENSSL_free(snap);
+}
+
+static int by_snap_ctrl(X509_LOOKUP *ctx, int cmd, const char *argp,
+                        long argl, char **retp)
+{
+    switch (cmd) {
+    case X509_L_ADD_SNAPSHOT:
+        return snap_add_file(ctx, argp);
+    }
+    return 0;
+}
+
+/*
+ * Decode entry |i| of |f| and add it to the store, the caller holds the write
+ * lock
+ */
+static void snap_load_entry(X509_LOOKUP *ctx, BY_SNAP_FILE *f, uint32_t i,
+                            OSSL_LIB_CTX *libctx, const char *propq)
+{
+    const unsigned char *e = f->index + (size_t)i * SNAPSHOT_ENTRY_LEN;
+    const unsigned char *p = f->data + snap_get32(e + 8);
+    long len = (long)snap_get32(e + 12);
+    X509_STORE *store = X509_LOOKUP_get_store(ctx);
+
+    f->loaded[i] = 1;
+    if (!snap_readable(f, snap_get32(e + 8), (size_t)len))
+        return;
+    ERR_set_mark();
+    if (snap_get32(e + 4) == SNAPSHOT_TYPE_CERT) {
+        X509 *x = X509_new_ex(libctx, propq);
+
+        if (x != NULL && d2i_X509(&x, &p, len) != NULL)
+            X509_STORE_add_cert(store, x);
+        X509_free(x);
+    } else {
+        X509_CRL *crl = X509_CRL_new_ex(libctx, propq);
+
+        if (crl != NULL && d2i_X509_CRL(&crl, &p, len) != NULL)
+            X509_STORE_add_crl(store, crl);
+        X509_CRL_free(crl);
+    }
+    /* Malformed entries are skipped, like a file that can't be read */
+    ERR_pop_to_mark();
+}
+
+/*
+ * Find the entries indexed under |key|.  Returns 1 if any of them still has
+ * to be decoded.  With |load| set, which requires the write lock, they are
+ * decoded and added to the store instead.
+ */
+static int snap_find(X509_LOOKUP *ctx, uint64_t key, int load,
+                     OSSL_LIB_CTX *libctx, const char *propq)
+{
+    BY_SNAP *snap = X509_LOOKUP_get_method_data(ctx);
+    uint32_t lo, hi, mid;
+    int i, found = 0;
+
+    for (i = 0; i < sk_BY_SNAP_FILE_num(snap->files); i++) {
+        BY_SNAP_FILE *f = sk_BY_SNAP_FILE_value(snap->files, i);
+
+        for (lo = 0, hi = f->num; lo < hi;) {
+            mid = lo + (hi - lo) / 2;
+            if (snap_entry_key(f, mid) < key)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        for (; lo < f->num && snap_entry_key(f, lo) == key; lo++) {
+            if (f->loaded[lo])
+                continue;
+            if (!load)
+                return 1;
+            snap_load_entry(ctx, f, lo, libctx, propq);
+            found = 1;
+        }
+    }
+    return found;
+}
+
+static int by_snap_subject_ex(X509_LOOKUP *ctx, X509_LOOKUP_TYPE type,
+                              const X509_NAME *name, X509_OBJECT *ret,
+                              OSSL_LIB_CTX *libctx, const char *propq)
+{
+    BY_SNAP *snap = X509_LOOKUP_get_method_data(ctx);
+    X509_OBJECT *tmp;
+    uint32_t hash;
+    uint64_t key;
+    int pending;
+
+    if (type != X509_LU_X509 && type != X509_LU_CRL) {
+        ERR_raise(ERR_LIB_X509, X509_R_WRONG_LOOKUP_TYPE);
+        return 0;
+    }
+    if (name == NULL || !snap_name_hash(name, &hash))
+        return 0;
+    key = snap_key(type == X509_LU_X509 ? SNAPSHOT_TYPE_CERT
+                                        : SNAPSHOT_TYPE_CRL, hash);
+
+    /*
+     * Most lookups find nothing left to decode, so search under the read lock
+     * first.  The write lock is held while decoding, so that a concurrent
+     * lookup of the same name doesn't return before the objects are in the
+     * store.
+     */
+    if (!CRYPTO_THREAD_read_lock(snap->lock))
+        return 0;
+    pending = snap_find(ctx, key, 0, libctx, propq);
+    CRYPTO_THREAD_unlock(snap->lock);
+    if (pending) {
+        if (!CRYPTO_THREAD_write_lock(snap->lock))
+            return 0;
+        (void)snap_find(ctx, key, 1, libctx, propq);
+        CRYPTO_THREAD_unlock(snap->lock);
+    }
+
+    tmp = ossl_x509_store_get0_by_subject(X509_LOOKUP_get_store(ctx), type,
+                                          name);
+    if (tmp == NULL)
+        return 0;
+    ret->type = tmp->type;
+    ret->data = tmp->data;
+    return 1;
+}
+
+static int by_snap_subject(X509_LOOKUP *ctx, X509_LOOKUP_TYPE type,
+                           const X509_NAME *name, X509_OBJECT *ret)
+{
+    return by_snap_subject_ex(ctx, type, name, ret, NULL, NULL);
+}
+
+static X509_LOOKUP_METHOD x509_snapshot_lookup = {
+    "Load certs and CRLs from snapshots",
+    by_snap_new,                /* new_item */
+    by_snap_free,               /* free */
+    NULL,                       /* init */
+    NULL,                       /* shutdown */
+    by_snap_ctrl,               /* ctrl */
+    by_snap_subject,            /* get_by_subject */
+    NULL,                       /* get_by_issuer_serial */
+    NULL,                       /* get_by_fingerprint */
+    NULL,                       /* get_by_alias */
+    by_snap_subject_ex,         /* get_by_subject_ex */
+    NULL,                       /* ctrl_ex */
+};
+
+X509_LOOKUP_METHOD *X509_LOOKUP_snapshot(void)
+{
+    return &x509_snapshot_lookup;
+}
+
+typedef struct {
+    uint64_t key;
+    unsigned char *der;
+    uint32_t len;
+} SNAP_OUT_ENTRY;
+
+static int snap_out_entry_cmp(const void *a, const void *b)
+{
+    uint64_t ka = ((const SNAP_OUT_ENTRY *)a)->key;
+    uint64_t kb = ((const SNAP_OUT_ENTRY *)b)->key;
+
+    return ka < kb ? -1 : ka > kb;
+}
+
+int X509_STORE_write_snapshot(X509_STORE *xs, BIO *out)
+{
+    STACK_OF(X509_OBJECT) *objs = X509_STORE_get1_objects(xs);
+    SNAP_OUT_ENTRY *ents = NULL;
+    unsigned char hdr[SNAPSHOT_HDR_LEN], ent[SNAPSHOT_ENTRY_LEN], *p;
+    uint32_t type, hash, num = 0;
+    uint64_t off;
+    const X509_NAME *name;
+    int i, derlen, ret = 0;
+
+    if (objs == NULL)
+        return 0;
+    if (sk_X509_OBJECT_num(objs) > 0
+            && (ents = OPENSSL_zalloc(sizeof(*ents)
+                                      * sk_X509_OBJECT_num(objs))) == NULL)
+        goto err;
+
+    for (i = 0; i < sk_X509_OBJECT_num(objs); i++) {
+        X509_OBJECT *obj = sk_X509_OBJECT_value(objs, i);
+        SNAP_OUT_ENTRY *e = &ents[num];
+
+        switch (X509_OBJECT_get_type(obj)) {
+        case X509_LU_X509:
+            type = SNAPSHOT_TYPE_CERT;
+            name = X509_get_subject_name(X509_OBJECT_get0_X509(obj));
+            derlen = i2d_X509(X509_OBJECT_get0_X509(obj), &e->der);
+            break;
+        case X509_LU_CRL:
+            type = SNAPSHOT_TYPE_CRL;
+            name = X509_CRL_get_issuer(X509_OBJECT_get0_X509_CRL(obj));
+            derlen = i2d_X509_CRL(X509_OBJECT_get0_X509_CRL(obj), &e->der);
+            break;
+        default:
+            continue;
+        }
+        if (derlen <= 0 || !snap_name_hash(name, &hash)) {
+            ERR_raise(ERR_LIB_X509, ERR_R_ASN1_LIB);
+            goto err;
+        }
+        e->key = snap_key(type, hash);
+        e->len = (uint32_t)derlen;
+        num++;
+    }
+    qsort(ents, num, sizeof(*ents), snap_out_entry_cmp);
+
+    memcpy(hdr, SNAPSHOT_MAGIC, 8);
+    p = snap_put32(hdr + 8, num);
+    snap_put32(p, 0);
+    if (BIO_write(out, hdr, sizeof(hdr)) != (int)sizeof(hdr))
+        goto err;
+
+    off = SNAPSHOT_HDR_LEN + (uint64_t)num * SNAPSHOT_ENTRY_LEN;
+    for (i = 0; i < (int)num; i++) {
+        if (off + ents[i].len > UINT32_MAX) {
+            ERR_raise(ERR_LIB_X509, X509_R_INVALID_SNAPSHOT);
+            goto err;
+        }
+        p = snap_put32(ent, (uint32_t)ents[i].key);
+        p = snap_put32(p, (uint32_t)(ents[i].key >> 32));
+        p = snap_put32(p, (uint32_t)off);
+        snap_put32(p, ents[i].len);
+        if (BIO_write(out, ent, sizeof(ent)) != (int)sizeof(ent))
+            goto err;
+        off += ents[i].len;
+    }
+    for (i = 0; i < (int)num; i++)
+        if (BIO_write(out, ents[i].der, (int)ents[i].len) != (int)ents[i].len)
+            goto err;
+    ret = 1;
+
+ err:
+    if (ents != NULL)
+        for (i = 0; i < sk_X509_OBJECT_num(objs); i++)
+            OPENSSL_free(ents[i].der);
+    OPENSSL_free(ents);
+    sk_X509_OBJECT_pop_free(objs, X509_OBJECT_free);
+    return ret;
+}
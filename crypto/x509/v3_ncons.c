@@ -34,6 +34,7 @@ static int do_i2r_name_constraints(const X509V3_EXT_METHOD *method,
 static int print_nc_ipadd(BIO *bp, ASN1_OCTET_STRING *ip);
 
 static int nc_match(GENERAL_NAME *gen, NAME_CONSTRAINTS *nc);
+static int nc_match_index(GENERAL_NAME *gen, X509_NC_INDEX *idx);
 static int nc_match_single(int effective_type, GENERAL_NAME *sub,
                            GENERAL_NAME *gen);
 static int nc_dn(const X509_NAME *sub, const X509_NAME *nm);
@@ -70,6 +71,41 @@ ASN1_SEQUENCE(NAME_CONSTRAINTS) = {
 IMPLEMENT_ASN1_ALLOC_FUNCTIONS(GENERAL_SUBTREE)
 IMPLEMENT_ASN1_ALLOC_FUNCTIONS(NAME_CONSTRAINTS)
 
+/*
+ * An index of the dNSName and iPAddress subtrees of a NAME_CONSTRAINTS, built
+ * once when the extensions of a CA certificate are cached. Each subtree is
+ * kept in a hash table, so a name is matched with a few lookups rather than
+ * by comparing it with every subtree in turn. Subtrees of other types, and of
+ * types with subtrees the index can't represent, are left in |rest|, which is
+ * checked as before.
+ */
+typedef struct {
+    int type;                   /* GEN_DNS or GEN_IPADD */
+    int excluded;
+    int mask;                   /* Index of the mask of an iPAddress */
+    int length;
+    const unsigned char *data;  /* dNSName or masked iPAddress */
+    unsigned long hash;         /* See nc_index_hash() */
+} NC_INDEX_ENTRY;
+
+DEFINE_LHASH_OF_EX(NC_INDEX_ENTRY);
+
+typedef struct {
+    int length;
+    unsigned char mask[16];
+} NC_INDEX_MASK;
+
+struct x509_nc_index_st {
+    /* Subtrees that aren't indexed, in their original order */
+    NAME_CONSTRAINTS rest;
+    LHASH_OF(NC_INDEX_ENTRY) *entries;
+    /* Number of permitted and excluded subtrees indexed */
+    int dns_indexed, dns_count[2], dns_all[2];
+    int ip_indexed, ip_count[2];
+    int mask_count;
+    NC_INDEX_MASK *masks;
+};
+
 
 #define IA5_OFFSET_LEN(ia5base, offset) \
     ((ia5base)->length - ((unsigned char *)(offset) - (ia5base)->data))
@@ -244,6 +280,15 @@ static int add_lengths(int *out, int a, int b)
     return !err;
 }
 
+/*
+ * Match |gen| against |nc|, or against its index |idx| if there is one.
+ */
+static int nc_match_any(GENERAL_NAME *gen, NAME_CONSTRAINTS *nc,
+                        X509_NC_INDEX *idx)
+{
+    return idx != NULL ? nc_match_index(gen, idx) : nc_match(gen, nc);
+}
+
 /*-
  * Check a certificate conforms to a specified set of constraints.
  * Return values:
@@ -256,9 +301,32 @@ static int add_lengths(int *out, int a, int b)
  *  X509_V_ERR_UNSUPPORTED_NAME_SYNTAX: bad or unsupported syntax of name
  */
 
-int NAME_CONSTRAINTS_check(X509 *x, NAME_CONSTRAINTS *nc)
+/*
+ * The number of labels in the dNSNames of |x|, each of which costs index
+ * lookups on top of the work that is charged for every name.
+ */
+static int nc_index_dns_labels(X509 *x, X509_NC_INDEX *idx)
 {
-    int r, i, name_count, constraint_count;
+    GENERAL_NAME *gen;
+    int i, j, labels = 0;
+
+    if (!idx->dns_indexed)
+        return 0;
+    for (i = 0; i < sk_GENERAL_NAME_num(x->altname); i++) {
+        gen = sk_GENERAL_NAME_value(x->altname, i);
+        if (gen->type != GEN_DNS)
+            continue;
+        labels++;
+        for (j = 0; j < gen->d.dNSName->length; j++)
+            if (gen->d.dNSName->data[j] == '.' && ++labels > NAME_CHECK_MAX)
+                return -1;
+    }
+    return labels;
+}
+
+static int nc_check(X509 *x, NAME_CONSTRAINTS *nc, X509_NC_INDEX *idx)
+{
+    int r, i, name_count, constraint_count, labels = 0;
     X509_NAME *nm;
 
     nm = X509_get_subject_name(x);
@@ -266,13 +334,17 @@ int NAME_CONSTRAINTS_check(X509 *x, NAME_CONSTRAINTS *nc)
     /*
      * Guard against certificates with an excessive number of names or
      * constraints causing a computationally expensive name constraints check.
+     * An index doesn't change which certificates are accepted, but dot-heavy
+     * dNSNames cost a lookup per label, so those are charged as well.
      */
     if (!add_lengths(&name_count, X509_NAME_entry_count(nm),
                      sk_GENERAL_NAME_num(x->altname))
         || !add_lengths(&constraint_count,
                         sk_GENERAL_SUBTREE_num(nc->permittedSubtrees),
                         sk_GENERAL_SUBTREE_num(nc->excludedSubtrees))
-        || (name_count > 0 && constraint_count > NAME_CHECK_MAX / name_count))
+        || (name_count > 0 && constraint_count > NAME_CHECK_MAX / name_count)
+        || (idx != NULL && (labels = nc_index_dns_labels(x, idx)) < 0)
+        || labels > NAME_CHECK_MAX - name_count * constraint_count)
         return X509_V_ERR_UNSPECIFIED;
 
     if (X509_NAME_entry_count(nm) > 0) {
@@ -280,7 +352,7 @@ int NAME_CONSTRAINTS_check(X509 *x, NAME_CONSTRAINTS *nc)
         gntmp.type = GEN_DIRNAME;
         gntmp.d.directoryName = nm;
 
-        r = nc_match(&gntmp, nc);
+        r = nc_match_any(&gntmp, nc, idx);
 
         if (r != X509_V_OK)
             return r;
@@ -300,7 +372,7 @@ int NAME_CONSTRAINTS_check(X509 *x, NAME_CONSTRAINTS *nc)
             if (gntmp.d.rfc822Name->type != V_ASN1_IA5STRING)
                 return X509_V_ERR_UNSUPPORTED_NAME_SYNTAX;
 
-            r = nc_match(&gntmp, nc);
+            r = nc_match_any(&gntmp, nc, idx);
 
             if (r != X509_V_OK)
                 return r;
@@ -310,7 +382,7 @@ int NAME_CONSTRAINTS_check(X509 *x, NAME_CONSTRAINTS *nc)
 
     for (i = 0; i < sk_GENERAL_NAME_num(x->altname); i++) {
         GENERAL_NAME *gen = sk_GENERAL_NAME_value(x->altname, i);
-        r = nc_match(gen, nc);
+        r = nc_match_any(gen, nc, idx);
         if (r != X509_V_OK)
             return r;
     }
@@ -319,6 +391,11 @@ int NAME_CONSTRAINTS_check(X509 *x, NAME_CONSTRAINTS *nc)
 
 }
 
+int NAME_CONSTRAINTS_check(X509 *x, NAME_CONSTRAINTS *nc)
+{
+    return nc_check(x, nc, NULL);
+}
+
 static int cn2dnsid(ASN1_STRING *cn, unsigned char **dnsid, size_t *idlen)
 {
     int utf8_length;
@@ -415,7 +492,7 @@ static int cn2dnsid(ASN1_STRING *cn, unsigned char **dnsid, size_t *idlen)
 /*
  * Check CN against DNS-ID name constraints.
  */
-int NAME_CONSTRAINTS_check_CN(X509 *x, NAME_CONSTRAINTS *nc)
+static int nc_check_CN(X509 *x, NAME_CONSTRAINTS *nc, X509_NC_INDEX *idx)
 {
     int r, i;
     const X509_NAME *nm = X509_get_subject_name(x);
@@ -449,7 +526,7 @@ int NAME_CONSTRAINTS_check_CN(X509 *x, NAME_CONSTRAINTS *nc)
 
         stmp.length = idlen;
         stmp.data = idval;
-        r = nc_match(&gntmp, nc);
+        r = nc_match_any(&gntmp, nc, idx);
         OPENSSL_free(idval);
         if (r != X509_V_OK)
             return r;
@@ -457,6 +534,25 @@ int NAME_CONSTRAINTS_check_CN(X509 *x, NAME_CONSTRAINTS *nc)
     return X509_V_OK;
 }
 
+int NAME_CONSTRAINTS_check_CN(X509 *x, NAME_CONSTRAINTS *nc)
+{
+    return nc_check_CN(x, nc, NULL);
+}
+
+/*
+ * Check |x| against the name constraints of |issuer|, using their index if
+ * one was built when the extensions of |issuer| were cached.
+ */
+int ossl_x509_check_name_constraints(X509 *x, X509 *issuer)
+{
+    return nc_check(x, issuer->nc, issuer->nc_index);
+}
+
+int ossl_x509_check_name_constraints_CN(X509 *x, X509 *issuer)
+{
+    return nc_check_CN(x, issuer->nc, issuer->nc_index);
+}
+
 /*
  * Return nonzero if the GeneralSubtree has valid 'minimum' field
  * (must be absent or 0) and valid 'maximum' field (must be absent).
@@ -839,3 +935,312 @@ static int nc_ip(ASN1_OCTET_STRING *ip, ASN1_OCTET_STRING *base)
     return X509_V_OK;
 
 }
+
+/*
+ * Name constraint index. dNSName subtrees match a name that ends with them
+ * (case insensitively) at a label boundary, so a name is looked up as a whole
+ * and by each of its suffixes starting at or right after a '.'. An empty
+ * dNSName matches everything and is recorded in |dns_all| instead. iPAddress
+ * subtrees are stored masked, and a name is looked up masked by each distinct
+ * mask.
+ *
+ * The data is hashed from its last byte to its first, so the hashes of all
+ * the suffixes of a dNSName come from a single pass over it.
+ */
+
+#define NC_HASH_INIT 2166136261UL
+
+static unsigned long nc_hash_byte(unsigned long h, int type, unsigned char c)
+{
+    if (type == GEN_DNS && c >= 0x41 /* A */ && c <= 0x5A /* Z */)
+        c += 0x20;
+    return (h ^ c) * 16777619UL;
+}
+
+/* The hash of an entry given the hash |h| of its data */
+static unsigned long nc_index_hash(unsigned long h, int type, int excluded,
+                                   int mask)
+{
+    return h ^ ((unsigned long)type << 8) ^ ((unsigned long)excluded << 16)
+        ^ ((unsigned long)mask << 20);
+}
+
+static unsigned long nc_data_hash(int type, const unsigned char *data,
+                                  int length)
+{
+    unsigned long h = NC_HASH_INIT;
+
+    while (length-- > 0)
+        h = nc_hash_byte(h, type, data[length]);
+    return h;
+}
+
+static unsigned long nc_index_entry_hash(const NC_INDEX_ENTRY *e)
+{
+    return e->hash;
+}
+
+static int nc_index_entry_cmp(const NC_INDEX_ENTRY *a, const NC_INDEX_ENTRY *b)
+{
+    if (a->type != b->type || a->excluded != b->excluded
+            || a->mask != b->mask || a->length != b->length)
+        return 1;
+    if (a->type == GEN_DNS)
+        return ia5ncasecmp((const char *)a->data, (const char *)b->data,
+                           a->length);
+    return memcmp(a->data, b->data, a->length);
+}
+
+static void nc_index_entry_free(NC_INDEX_ENTRY *e)
+{
+    OPENSSL_free(e);
+}
+
+void ossl_x509_nc_index_free(X509_NC_INDEX *idx)
+{
+    if (idx == NULL)
+        return;
+    sk_GENERAL_SUBTREE_free(idx->rest.permittedSubtrees);
+    sk_GENERAL_SUBTREE_free(idx->rest.excludedSubtrees);
+    lh_NC_INDEX_ENTRY_doall(idx->entries, nc_index_entry_free);
+    lh_NC_INDEX_ENTRY_free(idx->entries);
+    OPENSSL_free(idx->masks);
+    OPENSSL_free(idx);
+}
+
+/*
+ * Whether all the subtrees of |type| can be indexed. The result of matching
+ * them must not depend on the order in which they're checked, so none may
+ * have a minimum or maximum that nc_match() rejects, or an iPAddress of the
+ * wrong length.
+ */
+static int nc_index_type_ok(NAME_CONSTRAINTS *nc, int type)
+{
+    STACK_OF(GENERAL_SUBTREE) *trees[2];
+    GENERAL_SUBTREE *sub;
+    int i, j;
+
+    trees[0] = nc->permittedSubtrees;
+    trees[1] = nc->excludedSubtrees;
+    for (j = 0; j < 2; j++) {
+        for (i = 0; i < sk_GENERAL_SUBTREE_num(trees[j]); i++) {
+            sub = sk_GENERAL_SUBTREE_value(trees[j], i);
+            if (sub->base->type != type)
+                continue;
+            if (!nc_minmax_valid(sub))
+                return 0;
+            if (type == GEN_IPADD && sub->base->d.iPAddress->length != 8
+                    && sub->base->d.iPAddress->length != 32)
+                return 0;
+        }
+    }
+    return 1;
+}
+
+static int nc_index_add(X509_NC_INDEX *idx, int type, int excluded, int mask,
+                        const unsigned char *data, int length)
+{
+    NC_INDEX_ENTRY *e, *old;
+    unsigned char *p;
+
+    /* The data is stored in the same allocation as the entry */
+    if ((e = OPENSSL_malloc(sizeof(*e) + length)) == NULL)
+        return 0;
+    p = (unsigned char *)(e + 1);
+    memcpy(p, data, length);
+    e->type = type;
+    e->excluded = excluded;
+    e->mask = mask;
+    e->length = length;
+    e->data = p;
+    e->hash = nc_index_hash(nc_data_hash(type, data, length), type, excluded,
+                            mask);
+    old = lh_NC_INDEX_ENTRY_insert(idx->entries, e);
+    if (old != NULL) {
+        OPENSSL_free(old);
+    } else if (lh_NC_INDEX_ENTRY_error(idx->entries)) {
+        OPENSSL_free(e);
+        return 0;
+    }
+    return 1;
+}
+
+static int nc_index_add_ip(X509_NC_INDEX *idx, int excluded,
+                           ASN1_OCTET_STRING *base)
+{
+    unsigned char masked[16];
+    NC_INDEX_MASK *m;
+    int i, len = base->length / 2;
+
+    for (i = 0; i < idx->mask_count; i++)
+        if (idx->masks[i].length == len
+                && memcmp(idx->masks[i].mask, base->data + len, len) == 0)
+            break;
+    m = &idx->masks[i];
+    if (i == idx->mask_count) {
+        /* There are at most as many masks as iPAddress subtrees */
+        idx->mask_count++;
+        m->length = len;
+        memcpy(m->mask, base->data + len, len);
+    }
+    for (i = 0; i < len; i++)
+        masked[i] = base->data[i] & base->data[len + i];
+    return nc_index_add(idx, GEN_IPADD, excluded, (int)(m - idx->masks),
+                        masked, len);
+}
+
+X509_NC_INDEX *ossl_x509_nc_index_new(NAME_CONSTRAINTS *nc)
+{
+    X509_NC_INDEX *idx;
+    STACK_OF(GENERAL_SUBTREE) *trees[2], **rest[2];
+    GENERAL_SUBTREE *sub;
+    GENERAL_NAME *base;
+    int i, j, n;
+
+    if ((idx = OPENSSL_zalloc(sizeof(*idx))) == NULL)
+        return NULL;
+    trees[0] = nc->permittedSubtrees;
+    trees[1] = nc->excludedSubtrees;
+    rest[0] = &idx->rest.permittedSubtrees;
+    rest[1] = &idx->rest.excludedSubtrees;
+    n = sk_GENERAL_SUBTREE_num(trees[0]);
+    if (n < 0)
+        n = 0;
+    if (sk_GENERAL_SUBTREE_num(trees[1]) > 0)
+        n += sk_GENERAL_SUBTREE_num(trees[1]);
+
+    idx->dns_indexed = nc_index_type_ok(nc, GEN_DNS);
+    idx->ip_indexed = nc_index_type_ok(nc, GEN_IPADD);
+    if ((idx->entries = lh_NC_INDEX_ENTRY_new(nc_index_entry_hash,
+                                              nc_index_entry_cmp)) == NULL
+            || (idx->ip_indexed
+                && n > 0
+                && (idx->masks = OPENSSL_malloc(sizeof(*idx->masks) * n))
+                   == NULL))
+        goto err;
+
+    for (j = 0; j < 2; j++) {
+        for (i = 0; i < sk_GENERAL_SUBTREE_num(trees[j]); i++) {
+            sub = sk_GENERAL_SUBTREE_value(trees[j], i);
+            base = sub->base;
+            if (base->type == GEN_DNS && idx->dns_indexed) {
+                idx->dns_count[j]++;
+                if (base->d.dNSName->length == 0)
+                    idx->dns_all[j] = 1;
+                else if (!nc_index_add(idx, GEN_DNS, j, 0,
+                                       base->d.dNSName->data,
+                                       base->d.dNSName->length))
+                    goto err;
+            } else if (base->type == GEN_IPADD && idx->ip_indexed) {
+                idx->ip_count[j]++;
+                if (!nc_index_add_ip(idx, j, base->d.iPAddress))
+                    goto err;
+            } else {
+                if (*rest[j] == NULL
+                        && (*rest[j] = sk_GENERAL_SUBTREE_new_null()) == NULL)
+                    goto err;
+                if (!sk_GENERAL_SUBTREE_push(*rest[j], sub))
+                    goto err;
+            }
+        }
+    }
+    return idx;
+
+ err:
+    ossl_x509_nc_index_free(idx);
+    return NULL;
+}
+
+/* Look up |data|, whose hash as computed by nc_data_hash() is |h| */
+static int nc_index_find(X509_NC_INDEX *idx, int type, int excluded, int mask,
+                         const unsigned char *data, int length,
+                         unsigned long h)
+{
+    NC_INDEX_ENTRY key;
+
+    key.type = type;
+    key.excluded = excluded;
+    key.mask = mask;
+    key.length = length;
+    key.data = data;
+    key.hash = nc_index_hash(h, type, excluded, mask);
+    return lh_NC_INDEX_ENTRY_retrieve(idx->entries, &key) != NULL;
+}
+
+static int nc_dns_index(X509_NC_INDEX *idx, ASN1_IA5STRING *dns, int excluded)
+{
+    const unsigned char *p = dns->data;
+    unsigned long h = NC_HASH_INIT;
+    int i, len = dns->length;
+
+    if (idx->dns_all[excluded])
+        return 1;
+    /*
+     * Walk the name backwards, so that |h| is always the hash of the suffix
+     * after |i|. Only suffixes at a label boundary are looked up, and entries
+     * are only compared in full when the hash and length match.
+     */
+    for (i = len - 1; i >= 0; i--) {
+        if (p[i] == '.' && i + 1 < len
+                && nc_index_find(idx, GEN_DNS, excluded, 0, p + i + 1,
+                                 len - i - 1, h))
+            return 1;
+        h = nc_hash_byte(h, GEN_DNS, p[i]);
+        if (p[i] == '.'
+                && nc_index_find(idx, GEN_DNS, excluded, 0, p + i, len - i, h))
+            return 1;
+    }
+    return nc_index_find(idx, GEN_DNS, excluded, 0, p, len, h);
+}
+
+static int nc_ip_index(X509_NC_INDEX *idx, ASN1_OCTET_STRING *ip, int excluded)
+{
+    unsigned char masked[16];
+    const NC_INDEX_MASK *m;
+    int i, j;
+
+    for (i = 0; i < idx->mask_count; i++) {
+        m = &idx->masks[i];
+        if (m->length != ip->length)
+            continue;
+        for (j = 0; j < ip->length; j++)
+            masked[j] = ip->data[j] & m->mask[j];
+        if (nc_index_find(idx, GEN_IPADD, excluded, i, masked, ip->length,
+                          nc_data_hash(GEN_IPADD, masked, ip->length)))
+            return 1;
+    }
+    return 0;
+}
+
+/*
+ * Match |gen| like nc_match() would match it against the NAME_CONSTRAINTS that
+ * |idx| was built from.
+ */
+static int nc_match_index(GENERAL_NAME *gen, X509_NC_INDEX *idx)
+{
+    switch (gen->type) {
+    case GEN_DNS:
+        if (!idx->dns_indexed)
+            break;
+        if (idx->dns_count[0] > 0 && !nc_dns_index(idx, gen->d.dNSName, 0))
+            return X509_V_ERR_PERMITTED_VIOLATION;
+        if (idx->dns_count[1] > 0 && nc_dns_index(idx, gen->d.dNSName, 1))
+            return X509_V_ERR_EXCLUDED_VIOLATION;
+        return X509_V_OK;
+
+    case GEN_IPADD:
+        if (!idx->ip_indexed)
+            break;
+        if (idx->ip_count[0] == 0 && idx->ip_count[1] == 0)
+            return X509_V_OK;
+        /* Invalid if not IPv4 or IPv6 */
+        if (gen->d.iPAddress->length != 4 && gen->d.iPAddress->length != 16)
+            return X509_V_ERR_UNSUPPORTED_NAME_SYNTAX;
+        if (idx->ip_count[0] > 0 && !nc_ip_index(idx, gen->d.iPAddress, 0))
+            return X509_V_ERR_PERMITTED_VIOLATION;
+        if (idx->ip_count[1] > 0 && nc_ip_index(idx, gen->d.iPAddress, 1))
+            return X509_V_ERR_EXCLUDED_VIOLATION;
+        return X509_V_OK;
+    }
+    return nc_match(gen, &idx->rest);
+}
@@ -571,6 +571,9 @@ int ossl_x509v3_cache_extensions(X509 *x)
     x->nc = X509_get_ext_d2i(x, NID_name_constraints, &i, NULL);
     if (x->nc == NULL && i != -1)
         x->ex_flags |= EXFLAG_INVALID;
+    /* Without an index the name constraints are just checked more slowly */
+    if (x->nc != NULL)
+        x->nc_index = ossl_x509_nc_index_new(x->nc);
 
     /* Handle CRL distribution point entries */
     res = setup_crldp(x);
@@ -61,6 +61,18 @@ int X509_STORE_load_file(X509_STORE *ctx, const char *file)
     return X509_STORE_load_file_ex(ctx, file, NULL, NULL);
 }
 
+int X509_STORE_load_snapshot(X509_STORE *ctx, const char *file)
+{
+    X509_LOOKUP *lookup;
+
+    if (file == NULL
+        || (lookup = X509_STORE_add_lookup(ctx, X509_LOOKUP_snapshot())) == NULL
+        || X509_LOOKUP_add_snapshot(lookup, file) <= 0)
+        return 0;
+
+    return 1;
+}
+
 int X509_STORE_load_path(X509_STORE *ctx, const char *path)
 {
     X509_LOOKUP *lookup;
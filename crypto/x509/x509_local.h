@@ -7,6 +7,7 @@
  * https://www.openssl.org/source/license.html
  */
 
+#include <openssl/lhash.h>
 #include "internal/refcount.h"
 
 #define X509V3_conf_add_error_name_value(val) \
@@ -106,6 +107,11 @@ struct x509_lookup_st {
     X509_STORE *store_ctx;      /* who owns us */
 };
 
+typedef struct x509_object_bucket_st X509_OBJECT_BUCKET;
+DEFINE_LHASH_OF_EX(X509_OBJECT_BUCKET);
+typedef struct x509_vcache_entry_st X509_VCACHE_ENTRY;
+DEFINE_LHASH_OF_EX(X509_VCACHE_ENTRY);
+
 /*
  * This is used to hold everything.  It is used for all certificate
  * validation.  Once we have a certificate chain, the 'verify' function is
@@ -115,6 +121,8 @@ struct x509_store_st {
     /* The following is a cache of trusted certs */
     int cache;                  /* if true, stash any hits */
     STACK_OF(X509_OBJECT) *objs; /* Cache of all objects */
+    /* The objects in |objs| indexed by type and subject (issuer for CRLs) */
+    LHASH_OF(X509_OBJECT_BUCKET) *objs_idx;
     /* These are external lookup methods */
     STACK_OF(X509_LOOKUP) *get_cert_methods;
     X509_VERIFY_PARAM *param;
@@ -146,6 +154,11 @@ struct x509_store_st {
     CRYPTO_EX_DATA ex_data;
     CRYPTO_REF_COUNT references;
     CRYPTO_RWLOCK *lock;
+    /* Cache of successfully verified chains, NULL unless enabled */
+    LHASH_OF(X509_VCACHE_ENTRY) *vcache;
+    size_t vcache_max;
+    /* Bumped whenever the store changes and the cache is flushed */
+    uint64_t vcache_gen;
 };
 
 typedef struct lookup_dir_hashes_st BY_DIR_HASH;
@@ -156,4 +169,10 @@ typedef STACK_OF(X509_NAME_ENTRY) STACK_OF_X509_NAME_ENTRY;
 DEFINE_STACK_OF(STACK_OF_X509_NAME_ENTRY)
 
 int ossl_x509_likely_issued(X509 *issuer, X509 *subject);
+X509_OBJECT *ossl_x509_store_get0_by_subject(X509_STORE *store,
+                                             X509_LOOKUP_TYPE type,
+                                             const X509_NAME *name);
+int ossl_x509_vcache_get(X509_STORE_CTX *ctx);
+void ossl_x509_vcache_bound(X509_STORE_CTX *ctx, const ASN1_TIME *tm);
+void ossl_x509_vcache_add(X509_STORE_CTX *ctx);
 int ossl_x509_signing_allowed(const X509 *issuer, const X509 *subject);
@@ -15,6 +15,18 @@
 #include <openssl/x509v3.h>
 #include "x509_local.h"
 
+static void vcache_flush(X509_STORE *xs);
+
+/* FNV-1a, good enough for name encodings and digests */
+static unsigned long x509_lu_hash(const unsigned char *data, size_t len)
+{
+    unsigned long h = 2166136261UL;
+
+    while (len-- > 0)
+        h = (h ^ *data++) * 16777619UL;
+    return h;
+}
+
 X509_LOOKUP *X509_LOOKUP_new(X509_LOOKUP_METHOD *method)
 {
     X509_LOOKUP *ret = OPENSSL_zalloc(sizeof(*ret));
@@ -179,6 +191,173 @@ static int x509_object_cmp(const X509_OBJECT *const *a,
     return ret;
 }
 
+/*
+ * All objects of one type with the same subject (or CRL issuer) name, in the
+ * order in which they were added to the store.  The bucket keeps its own
+ * references, so that it stays valid whatever is done with the stack
+ * returned by X509_STORE_get0_objects().
+ */
+struct x509_object_bucket_st {
+    X509_LOOKUP_TYPE type;
+    unsigned char *canon;       /* Canonical encoding of the name */
+    int canonlen;
+    unsigned long hash;
+    STACK_OF(X509_OBJECT) *objs;
+};
+
+static unsigned long x509_object_bucket_hash(const X509_OBJECT_BUCKET *a)
+{
+    return a->hash;
+}
+
+static int x509_object_bucket_cmp(const X509_OBJECT_BUCKET *a,
+                                  const X509_OBJECT_BUCKET *b)
+{
+    if (a->type != b->type)
+        return a->type - b->type;
+    if (a->canonlen != b->canonlen)
+        return a->canonlen - b->canonlen;
+    return a->canonlen == 0 ? 0 : memcmp(a->canon, b->canon, a->canonlen);
+}
+
+static void x509_object_bucket_free(X509_OBJECT_BUCKET *b)
+{
+    if (b == NULL)
+        return;
+    sk_X509_OBJECT_pop_free(b->objs, X509_OBJECT_free);
+    OPENSSL_free(b->canon);
+    OPENSSL_free(b);
+}
+
+/* Set up |tmpl| for looking up objects of |type| named |name| */
+static int x509_object_bucket_init(X509_OBJECT_BUCKET *tmpl,
+                                   X509_LOOKUP_TYPE type, const X509_NAME *name)
+{
+    /* Ensure canonical encoding is present and up to date */
+    if (name == NULL
+        || ((name->canon_enc == NULL || name->modified)
+            && i2d_X509_NAME((X509_NAME *)name, NULL) < 0))
+        return 0;
+    tmpl->type = type;
+    tmpl->canon = name->canon_enc;
+    tmpl->canonlen = name->canon_enclen;
+    tmpl->hash = x509_lu_hash(tmpl->canon, tmpl->canonlen) ^ type;
+    tmpl->objs = NULL;
+    return 1;
+}
+
+/* The caller must hold the store lock, for reading at least */
+static X509_OBJECT_BUCKET *x509_object_bucket_get(X509_STORE *store,
+                                                  X509_LOOKUP_TYPE type,
+                                                  const X509_NAME *name)
+{
+    X509_OBJECT_BUCKET tmpl;
+
+    if (!x509_object_bucket_init(&tmpl, type, name))
+        return NULL;
+    return lh_X509_OBJECT_BUCKET_retrieve(store->objs_idx, &tmpl);
+}
+
+/*
+ * Returns the first object of |type| named |name| in |store|, or NULL.  The
+ * object stays valid as long as the store, but no reference is taken.
+ */
+X509_OBJECT *ossl_x509_store_get0_by_subject(X509_STORE *store,
+                                             X509_LOOKUP_TYPE type,
+                                             const X509_NAME *name)
+{
+    X509_OBJECT_BUCKET *b;
+    X509_OBJECT *ret = NULL;
+
+    if (!x509_store_read_lock(store))
+        return NULL;
+    if ((b = x509_object_bucket_get(store, type, name)) != NULL)
+        ret = sk_X509_OBJECT_value(b->objs, 0);
+    X509_STORE_unlock(store);
+    return ret;
+}
+
+static const X509_NAME *x509_object_name(const X509_OBJECT *obj)
+{
+    switch (obj->type) {
+    case X509_LU_X509:
+        return X509_get_subject_name(obj->data.x509);
+    case X509_LU_CRL:
+        return X509_CRL_get_issuer(obj->data.crl);
+    default:
+        return NULL;
+    }
+}
+
+/* Index |obj|, which has just been added to |store->objs|, under the lock */
+static int x509_object_bucket_add(X509_STORE *store, X509_OBJECT *obj)
+{
+    X509_OBJECT_BUCKET tmpl, *b;
+    X509_OBJECT *ref;
+    int new_bucket = 0;
+
+    if (!x509_object_bucket_init(&tmpl, obj->type, x509_object_name(obj)))
+        return 0;
+    if ((b = lh_X509_OBJECT_BUCKET_retrieve(store->objs_idx, &tmpl)) == NULL) {
+        if ((b = OPENSSL_zalloc(sizeof(*b))) == NULL)
+            return 0;
+        *b = tmpl;
+        b->canon = NULL;
+        if ((b->canonlen > 0
+             && (b->canon = OPENSSL_memdup(tmpl.canon, tmpl.canonlen)) == NULL)
+            || (b->objs = sk_X509_OBJECT_new_null()) == NULL) {
+            x509_object_bucket_free(b);
+            return 0;
+        }
+        new_bucket = 1;
+    }
+    if ((ref = X509_OBJECT_new()) == NULL)
+        goto err;
+    ref->type = obj->type;
+    ref->data = obj->data;
+    if (!X509_OBJECT_up_ref_count(ref)) {
+        ref->type = X509_LU_NONE;
+        X509_OBJECT_free(ref);
+        goto err;
+    }
+    if (!sk_X509_OBJECT_push(b->objs, ref)) {
+        X509_OBJECT_free(ref);
+        goto err;
+    }
+    if (new_bucket) {
+        lh_X509_OBJECT_BUCKET_insert(store->objs_idx, b);
+        if (lh_X509_OBJECT_BUCKET_error(store->objs_idx) != 0) {
+            x509_object_bucket_free(b);
+            return 0;
+        }
+    }
+    return 1;
+
+ err:
+    if (new_bucket)
+        x509_object_bucket_free(b);
+    return 0;
+}
+
+/* Find an object in |b| that is the same as |x|, the caller holds the lock */
+static X509_OBJECT *x509_object_bucket_match(const X509_OBJECT_BUCKET *b,
+                                             const X509_OBJECT *x)
+{
+    int i;
+    X509_OBJECT *obj;
+
+    for (i = 0; i < sk_X509_OBJECT_num(b->objs); i++) {
+        obj = sk_X509_OBJECT_value(b->objs, i);
+        if (x->type == X509_LU_X509) {
+            if (!X509_cmp(obj->data.x509, x->data.x509))
+                return obj;
+        } else if (X509_CRL_match(obj->data.crl, x->data.crl) == 0) {
+            return obj;
+        }
+    }
+    return NULL;
+}
+
 X509_STORE *X509_STORE_new(void)
 {
     X509_STORE *ret = OPENSSL_zalloc(sizeof(*ret));
@@ -189,6 +368,12 @@ X509_STORE *X509_STORE_new(void)
         ERR_raise(ERR_LIB_X509, ERR_R_CRYPTO_LIB);
         goto err;
     }
+    if ((ret->objs_idx = lh_X509_OBJECT_BUCKET_new(x509_object_bucket_hash,
+                                                   x509_object_bucket_cmp))
+            == NULL) {
+        ERR_raise(ERR_LIB_X509, ERR_R_CRYPTO_LIB);
+        goto err;
+    }
     ret->cache = 1;
     if ((ret->get_cert_methods = sk_X509_LOOKUP_new_null()) == NULL) {
         ERR_raise(ERR_LIB_X509, ERR_R_CRYPTO_LIB);
@@ -217,6 +402,7 @@ X509_STORE *X509_STORE_new(void)
 err:
     X509_VERIFY_PARAM_free(ret->param);
     sk_X509_OBJECT_free(ret->objs);
+    lh_X509_OBJECT_BUCKET_free(ret->objs_idx);
     sk_X509_LOOKUP_free(ret->get_cert_methods);
     CRYPTO_THREAD_lock_free(ret->lock);
     OPENSSL_free(ret);
@@ -245,6 +431,10 @@ void X509_STORE_free(X509_STORE *xs)
     }
     sk_X509_LOOKUP_free(sk);
     sk_X509_OBJECT_pop_free(xs->objs, X509_OBJECT_free);
+    lh_X509_OBJECT_BUCKET_doall(xs->objs_idx, x509_object_bucket_free);
+    lh_X509_OBJECT_BUCKET_free(xs->objs_idx);
+    vcache_flush(xs);
+    lh_X509_VCACHE_ENTRY_free(xs->vcache);
 
     CRYPTO_free_ex_data(CRYPTO_EX_INDEX_X509_STORE, xs, &xs->ex_data);
     X509_VERIFY_PARAM_free(xs->param);
@@ -333,22 +523,7 @@ static int ossl_x509_store_ctx_get_by_subject(const X509_STORE_CTX *ctx,
     stmp.type = X509_LU_NONE;
     stmp.data.ptr = NULL;
 
-    if (!x509_store_read_lock(store))
-        return 0;
-    /* Should already be sorted...but just in case */
-    if (!sk_X509_OBJECT_is_sorted(store->objs)) {
-        X509_STORE_unlock(store);
-        /* Take a write lock instead of a read lock */
-        if (!X509_STORE_lock(store))
-            return 0;
-        /*
-         * Another thread might have sorted it in the meantime. But if so,
-         * sk_X509_OBJECT_sort() exits early.
-         */
-        sk_X509_OBJECT_sort(store->objs);
-    }
-    tmp = X509_OBJECT_retrieve_by_subject(store->objs, type, name);
-    X509_STORE_unlock(store);
+    tmp = ossl_x509_store_get0_by_subject(store, type, name);
 
     if (tmp == NULL || type == X509_LU_CRL) {
         for (i = 0; i < sk_X509_LOOKUP_num(store->get_cert_methods); i++) {
@@ -386,6 +561,7 @@ int X509_STORE_CTX_get_by_subject(const X509_STORE_CTX *ctx,
 static int x509_store_add(X509_STORE *store, void *x, int crl)
 {
     X509_OBJECT *obj;
+    X509_OBJECT_BUCKET *b;
     int ret = 0, added = 0;
 
     if (x == NULL)
@@ -413,12 +589,21 @@ static int x509_store_add(X509_STORE *store, void *x, int crl)
         return 0;
     }
 
-    if (X509_OBJECT_retrieve_match(store->objs, obj)) {
+    b = x509_object_bucket_get(store, obj->type, x509_object_name(obj));
+    if (b != NULL && x509_object_bucket_match(b, obj) != NULL) {
         ret = 1;
-    } else {
-        added = sk_X509_OBJECT_push(store->objs, obj);
+    } else if ((added = sk_X509_OBJECT_push(store->objs, obj)) != 0) {
+        if (!x509_object_bucket_add(store, obj)) {
+            (void)sk_X509_OBJECT_pop(store->objs);
+            added = 0;
+        }
         ret = added != 0;
     }
+    if (added != 0) {
+        /* A new trust anchor or CRL may change any earlier verification */
+        vcache_flush(store);
+        store->vcache_gen++;
+    }
     X509_STORE_unlock(store);
 
     if (added == 0)             /* obj not pushed */
@@ -651,21 +836,21 @@ STACK_OF(X509) *X509_STORE_get1_all_certs(X509_STORE *store)
 STACK_OF(X509) *X509_STORE_CTX_get1_certs(X509_STORE_CTX *ctx,
                                           const X509_NAME *nm)
 {
-    int i, idx, cnt;
+    int i;
     STACK_OF(X509) *sk = NULL;
     X509 *x;
     X509_OBJECT *obj;
+    X509_OBJECT_BUCKET *b;
     X509_STORE *store = ctx->store;
 
     if (store == NULL)
         return sk_X509_new_null();
 
-    if (!X509_STORE_lock(store))
+    if (!x509_store_read_lock(store))
         return NULL;
 
-    sk_X509_OBJECT_sort(store->objs);
-    idx = x509_object_idx_cnt(store->objs, X509_LU_X509, nm, &cnt);
-    if (idx < 0) {
+    b = x509_object_bucket_get(store, X509_LU_X509, nm);
+    if (b == NULL) {
         /*
          * Nothing found in cache: do lookup to possibly add new objects to
          * cache
@@ -681,11 +866,10 @@ STACK_OF(X509) *X509_STORE_CTX_get1_certs(X509_STORE_CTX *ctx,
             return i < 0 ? NULL : sk_X509_new_null();
         }
         X509_OBJECT_free(xobj);
-        if (!X509_STORE_lock(store))
+        if (!x509_store_read_lock(store))
             return NULL;
-        sk_X509_OBJECT_sort(store->objs);
-        idx = x509_object_idx_cnt(store->objs, X509_LU_X509, nm, &cnt);
-        if (idx < 0) {
+        b = x509_object_bucket_get(store, X509_LU_X509, nm);
+        if (b == NULL) {
             sk = sk_X509_new_null();
             goto end;
         }
@@ -694,8 +878,8 @@ STACK_OF(X509) *X509_STORE_CTX_get1_certs(X509_STORE_CTX *ctx,
     sk = sk_X509_new_null();
     if (sk == NULL)
         goto end;
-    for (i = 0; i < cnt; i++, idx++) {
-        obj = sk_X509_OBJECT_value(store->objs, idx);
+    for (i = 0; i < sk_X509_OBJECT_num(b->objs); i++) {
+        obj = sk_X509_OBJECT_value(b->objs, i);
         x = obj->data.x509;
         if (!X509_add_cert(sk, x, X509_ADD_FLAG_UP_REF)) {
             X509_STORE_unlock(store);
@@ -712,10 +896,11 @@ STACK_OF(X509) *X509_STORE_CTX_get1_certs(X509_STORE_CTX *ctx,
 STACK_OF(X509_CRL) *X509_STORE_CTX_get1_crls(const X509_STORE_CTX *ctx,
                                              const X509_NAME *nm)
 {
-    int i = 1, idx, cnt;
+    int i = 1;
     STACK_OF(X509_CRL) *sk = sk_X509_CRL_new_null();
     X509_CRL *x;
     X509_OBJECT *obj, *xobj = X509_OBJECT_new();
+    X509_OBJECT_BUCKET *b;
     X509_STORE *store = ctx->store;
 
     /* Always do lookup to possibly add new CRLs to cache */
@@ -730,19 +915,18 @@ STACK_OF(X509_CRL) *X509_STORE_CTX_get1_crls(const X509_STORE_CTX *ctx,
     X509_OBJECT_free(xobj);
     if (i == 0)
         return sk;
-    if (!X509_STORE_lock(store)) {
+    if (!x509_store_read_lock(store)) {
         sk_X509_CRL_free(sk);
         return NULL;
     }
-    sk_X509_OBJECT_sort(store->objs);
-    idx = x509_object_idx_cnt(store->objs, X509_LU_CRL, nm, &cnt);
-    if (idx < 0) {
+    b = x509_object_bucket_get(store, X509_LU_CRL, nm);
+    if (b == NULL) {
         X509_STORE_unlock(store);
         return sk;
     }
 
-    for (i = 0; i < cnt; i++, idx++) {
-        obj = sk_X509_OBJECT_value(store->objs, idx);
+    for (i = 0; i < sk_X509_OBJECT_num(b->objs); i++) {
+        obj = sk_X509_OBJECT_value(b->objs, i);
         x = obj->data.crl;
         if (!X509_CRL_up_ref(x)) {
             X509_STORE_unlock(store);
@@ -802,8 +986,9 @@ int X509_STORE_CTX_get1_issuer(X509 **issuer, X509_STORE_CTX *ctx, X509 *x)
 {
     const X509_NAME *xn;
     X509_OBJECT *obj = X509_OBJECT_new(), *pobj = NULL;
+    X509_OBJECT_BUCKET *b;
     X509_STORE *store = ctx->store;
-    int i, ok, idx, ret, nmatch = 0;
+    int i, ok, ret;
 
     if (obj == NULL)
         return -1;
@@ -834,20 +1019,16 @@ int X509_STORE_CTX_get1_issuer(X509 **issuer, X509_STORE_CTX *ctx, X509 *x)
     if (store == NULL)
         return 0;
 
-    /* Find index of first currently valid cert accepted by 'check_issued' */
+    /* Find the first currently valid cert accepted by 'check_issued' */
     ret = 0;
-    if (!X509_STORE_lock(store))
+    if (!x509_store_read_lock(store))
         return 0;
 
-    sk_X509_OBJECT_sort(store->objs);
-    idx = x509_object_idx_cnt(store->objs, X509_LU_X509, xn, &nmatch);
-    if (idx != -1) { /* should be true as we've had at least one match */
+    b = x509_object_bucket_get(store, X509_LU_X509, xn);
+    if (b != NULL) { /* should be true as we've had at least one match */
         /* Look through all matching certs for suitable issuer */
-        for (i = idx; i < idx + nmatch; i++) {
-            pobj = sk_X509_OBJECT_value(store->objs, i);
-            /* See if we've run past the matches */
-            if (pobj->type != X509_LU_X509)
-                break;
+        for (i = 0; i < sk_X509_OBJECT_num(b->objs); i++) {
+            pobj = sk_X509_OBJECT_value(b->objs, i);
             if (ctx->check_issued(ctx, x, pobj->data.x509)) {
                 ret = 1;
                 /* If times check fine, exit with match, else keep looking. */
@@ -1050,3 +1231,275 @@ X509_STORE *X509_STORE_CTX_get0_store(const X509_STORE_CTX *ctx)
 {
     return ctx->store;
 }
+
+/*
+ * Cache of successfully verified chains.  The key is made of the verification
+ * parameters that influence chain building and checking, followed by the
+ * SHA256 digests of the target certificate and of the untrusted certificates
+ * in the order they were supplied.  Those certificates are kept in |certs|
+ * and compared in full before a result is reused, so that a digest
+ * collision can't give one certificate the result of another.
+ */
+struct x509_vcache_entry_st {
+    unsigned char *key;
+    size_t keylen;
+    unsigned long hash;
+    STACK_OF(X509) *certs;
+    STACK_OF(X509) *chain;
+    int num_untrusted;
+    time_t expiry;
+};
+
+struct vcache_key_hdr_st {
+    unsigned long flags;
+    int purpose;
+    int trust;
+    int depth;
+    int auth_level;
+    int num_certs;
+};
+
+static unsigned long vcache_entry_hash(const X509_VCACHE_ENTRY *a)
+{
+    return a->hash;
+}
+
+static int vcache_entry_cmp(const X509_VCACHE_ENTRY *a,
+                            const X509_VCACHE_ENTRY *b)
+{
+    if (a->keylen != b->keylen)
+        return a->keylen < b->keylen ? -1 : 1;
+    return memcmp(a->key, b->key, a->keylen);
+}
+
+static void vcache_entry_free(X509_VCACHE_ENTRY *ent)
+{
+    if (ent == NULL)
+        return;
+    OPENSSL_free(ent->key);
+    OSSL_STACK_OF_X509_free(ent->certs);
+    OSSL_STACK_OF_X509_free(ent->chain);
+    OPENSSL_free(ent);
+}
+
+static unsigned char *vcache_key(X509_STORE_CTX *ctx, size_t *plen)
+{
+    struct vcache_key_hdr_st hdr;
+    int i, n = sk_X509_num(ctx->untrusted);
+    size_t len;
+    unsigned int mdlen;
+    unsigned char *key, *p;
+    EVP_MD *md;
+
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.flags = ctx->param->flags;
+    hdr.purpose = ctx->param->purpose;
+    hdr.trust = ctx->param->trust;
+    hdr.depth = ctx->param->depth;
+    hdr.auth_level = ctx->param->auth_level;
+    hdr.num_certs = n + 1;
+
+    len = sizeof(hdr) + (size_t)(n + 1) * SHA256_DIGEST_LENGTH;
+    if ((md = EVP_MD_fetch(ctx->libctx, SN_sha256, ctx->propq)) == NULL)
+        return NULL;
+    if ((key = OPENSSL_malloc(len)) == NULL)
+        goto err;
+    memcpy(key, &hdr, sizeof(hdr));
+    p = key + sizeof(hdr);
+    for (i = -1; i < n; i++) {
+        X509 *x = i < 0 ? ctx->cert : sk_X509_value(ctx->untrusted, i);
+
+        if (!ossl_x509v3_cache_extensions(x)
+                || (x->ex_flags & EXFLAG_NO_FINGERPRINT) != 0
+                || !X509_digest(x, md, p, &mdlen)
+                || mdlen != SHA256_DIGEST_LENGTH)
+            goto err;
+        p += SHA256_DIGEST_LENGTH;
+    }
+    EVP_MD_free(md);
+    *plen = len;
+    return key;
+
+ err:
+    EVP_MD_free(md);
+    OPENSSL_free(key);
+    return NULL;
+}
+
+/* Check that |ent| was made for the same certificates as |ctx| */
+static int vcache_same_certs(const X509_VCACHE_ENTRY *ent,
+                             X509_STORE_CTX *ctx)
+{
+    int i, n = sk_X509_num(ctx->untrusted);
+
+    if (sk_X509_num(ent->certs) != n + 1
+            || X509_cmp(sk_X509_value(ent->certs, 0), ctx->cert) != 0)
+        return 0;
+    for (i = 0; i < n; i++)
+        if (X509_cmp(sk_X509_value(ent->certs, i + 1),
+                     sk_X509_value(ctx->untrusted, i)) != 0)
+            return 0;
+    return 1;
+}
+
+/* The caller must hold the store lock */
+static void vcache_flush(X509_STORE *xs)
+{
+    if (xs->vcache == NULL)
+        return;
+    lh_X509_VCACHE_ENTRY_doall(xs->vcache, vcache_entry_free);
+    lh_X509_VCACHE_ENTRY_flush(xs->vcache);
+}
+
+/*
+ * Look up the chain for |ctx| in the verified chain cache of its store.
+ * Returns 1 and sets up ctx->chain on a hit, 0 otherwise.  On a miss the
+ * lookup key is kept in |ctx| so that the result can be added afterwards.
+ */
+int ossl_x509_vcache_get(X509_STORE_CTX *ctx)
+{
+    X509_STORE *xs = ctx->store;
+    X509_VCACHE_ENTRY tmpl, *ent;
+    STACK_OF(X509) *chain = NULL;
+    int num_untrusted = 0;
+    time_t now = time(NULL);
+    int enabled;
+
+    if (xs == NULL || !CRYPTO_THREAD_read_lock(xs->lock))
+        return 0;
+    enabled = xs->vcache != NULL;
+    CRYPTO_THREAD_unlock(xs->lock);
+    if (!enabled)
+        return 0;
+
+    ctx->vcache_key = vcache_key(ctx, &ctx->vcache_keylen);
+    if (ctx->vcache_key == NULL)
+        return 0;
+
+    tmpl.key = ctx->vcache_key;
+    tmpl.keylen = ctx->vcache_keylen;
+    tmpl.hash = x509_lu_hash(tmpl.key, tmpl.keylen);
+
+    if (!CRYPTO_THREAD_read_lock(xs->lock))
+        goto miss;
+    if (xs->vcache == NULL) {
+        CRYPTO_THREAD_unlock(xs->lock);
+        goto miss;
+    }
+    ctx->vcache_gen = xs->vcache_gen;
+    ent = lh_X509_VCACHE_ENTRY_retrieve(xs->vcache, &tmpl);
+    if (ent != NULL && ent->expiry > now && vcache_same_certs(ent, ctx)) {
+        chain = X509_chain_up_ref(ent->chain);
+        num_untrusted = ent->num_untrusted;
+    }
+    CRYPTO_THREAD_unlock(xs->lock);
+
+    if (chain == NULL)
+        return 0;
+    OSSL_STACK_OF_X509_free(ctx->chain);
+    ctx->chain = chain;
+    ctx->num_untrusted = num_untrusted;
+    OPENSSL_free(ctx->vcache_key);
+    ctx->vcache_key = NULL;
+    return 1;
+
+ miss:
+    OPENSSL_free(ctx->vcache_key);
+    ctx->vcache_key = NULL;
+    return 0;
+}
+
+/*
+ * Limit the time a cached result for |ctx| may be reused to |tm|, which is the
+ * end of the validity period of a certificate or CRL it depends on.
+ */
+void ossl_x509_vcache_bound(X509_STORE_CTX *ctx, const ASN1_TIME *tm)
+{
+    int days, secs;
+    time_t t;
+
+    if (ctx->vcache_key == NULL)
+        return;
+    if (!ASN1_TIME_diff(&days, &secs, NULL, tm)) {
+        OPENSSL_free(ctx->vcache_key);
+        ctx->vcache_key = NULL;
+        return;
+    }
+    t = time(NULL) + (time_t)days * 86400 + secs;
+    if (ctx->vcache_expiry == 0 || t < ctx->vcache_expiry)
+        ctx->vcache_expiry = t;
+}
+
+/* Add the chain that has just been verified in |ctx| to the cache */
+void ossl_x509_vcache_add(X509_STORE_CTX *ctx)
+{
+    X509_STORE *xs = ctx->store;
+    X509_VCACHE_ENTRY *ent, *old;
+    int i;
+
+    for (i = 0; i < sk_X509_num(ctx->chain); i++)
+        ossl_x509_vcache_bound(ctx, X509_get0_notAfter(sk_X509_value(ctx->chain,
+                                                                     i)));
+    if (ctx->vcache_key == NULL || ctx->vcache_expiry <= time(NULL))
+        return;
+    if ((ent = OPENSSL_zalloc(sizeof(*ent))) == NULL)
+        return;
+    if ((ent->chain = X509_chain_up_ref(ctx->chain)) == NULL
+            || (ent->certs = X509_chain_up_ref(ctx->untrusted)) == NULL
+            || !X509_add_cert(ent->certs, ctx->cert,
+                              X509_ADD_FLAG_UP_REF | X509_ADD_FLAG_PREPEND)) {
+        vcache_entry_free(ent);
+        return;
+    }
+    ent->key = ctx->vcache_key;
+    ent->keylen = ctx->vcache_keylen;
+    ent->hash = x509_lu_hash(ent->key, ent->keylen);
+    ent->num_untrusted = ctx->num_untrusted;
+    ent->expiry = ctx->vcache_expiry;
+    ctx->vcache_key = NULL;
+
+    if (!X509_STORE_lock(xs)) {
+        vcache_entry_free(ent);
+        return;
+    }
+    /* Don't add anything verified against a store that has changed since */
+    if (xs->vcache != NULL && xs->vcache_gen == ctx->vcache_gen) {
+        if (lh_X509_VCACHE_ENTRY_num_items(xs->vcache) >= xs->vcache_max)
+            vcache_flush(xs);
+        old = lh_X509_VCACHE_ENTRY_insert(xs->vcache, ent);
+        if (old != NULL || lh_X509_VCACHE_ENTRY_error(xs->vcache) == 0)
+            ent = NULL;
+        vcache_entry_free(old);
+    }
+    X509_STORE_unlock(xs);
+    vcache_entry_free(ent);
+}
+
+int X509_STORE_set_verify_cache_size(X509_STORE *xs, size_t max_entries)
+{
+    int ret = 1;
+
+    if (!X509_STORE_lock(xs))
+        return 0;
+    if (max_entries == 0) {
+        vcache_flush(xs);
+        lh_X509_VCACHE_ENTRY_free(xs->vcache);
+        xs->vcache = NULL;
+    } else {
+        if (xs->vcache == NULL) {
+            xs->vcache = lh_X509_VCACHE_ENTRY_new(vcache_entry_hash,
+                                                  vcache_entry_cmp);
+            if (xs->vcache == NULL) {
+                ERR_raise(ERR_LIB_X509, ERR_R_CRYPTO_LIB);
+                ret = 0;
+            }
+        } else if (lh_X509_VCACHE_ENTRY_num_items(xs->vcache) > max_entries) {
+            vcache_flush(xs);
+        }
+    }
+    if (ret)
+        xs->vcache_max = max_entries;
+    xs->vcache_gen++;
+    X509_STORE_unlock(xs);
+    return ret;
+}
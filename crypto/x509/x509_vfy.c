@@ -56,6 +56,8 @@ static int check_name_constraints(X509_STORE_CTX *ctx);
 static int check_id(X509_STORE_CTX *ctx);
 static int check_trust(X509_STORE_CTX *ctx, int num_untrusted);
 static int check_revocation(X509_STORE_CTX *ctx);
+static int check_crl(X509_STORE_CTX *ctx, X509_CRL *crl);
+static int cert_crl(X509_STORE_CTX *ctx, X509_CRL *crl, X509 *x);
 static int check_cert(X509_STORE_CTX *ctx);
 static int check_policy(X509_STORE_CTX *ctx);
 static int get_issuer_sk(X509 **issuer, X509_STORE_CTX *ctx, X509 *x);
@@ -228,6 +230,82 @@ static int verify_rpk(X509_STORE_CTX *ctx)
 }
 
 
+/*
+ * Whether a successful result for |ctx| may be taken from or added to the
+ * verified chain cache of the store: only if the chain is built and checked
+ * entirely by the built-in functions, against the current time and without
+ * policy checks whose results would need to be kept as well.
+ */
+static int vcache_usable(const X509_STORE_CTX *ctx)
+{
+    return ctx->store != NULL
+        && ctx->parent == NULL
+        && ctx->error == X509_V_OK
+        && ctx->crls == NULL
+        && ctx->verify == internal_verify
+        && ctx->get_issuer == X509_STORE_CTX_get1_issuer
+        && ctx->check_issued == check_issued
+        && ctx->check_revocation == check_revocation
+        && ctx->get_crl == NULL
+        && ctx->check_crl == check_crl
+        && ctx->cert_crl == cert_crl
+        && ctx->lookup_certs == X509_STORE_CTX_get1_certs
+        && ctx->lookup_crls == X509_STORE_CTX_get1_crls
+        && (ctx->param->flags
+            & (X509_V_FLAG_USE_CHECK_TIME | X509_V_FLAG_POLICY_CHECK)) == 0;
+}
+
+/*
+ * Wraps the verify callback while verifying a chain that may be cached.  A
+ * result that relies on the callback overriding an error can't be reused.
+ */
+static int vcache_verify_cb(int ok, X509_STORE_CTX *ctx)
+{
+    /* CRL path validation runs in a child context with the same callback */
+    X509_STORE_CTX *top = ctx->parent != NULL ? ctx->parent : ctx;
+
+    if (!ok) {
+        OPENSSL_free(top->vcache_key);
+        top->vcache_key = NULL;
+    }
+    return top->vcache_verify_cb(ok, ctx);
+}
+
+static int verify_chain_cached(X509_STORE_CTX *ctx)
+{
+    int n, ok;
+
+    if (ossl_x509_vcache_get(ctx)) {
+        /* Host name etc. checks are not part of the cached result */
+        if ((ok = check_id(ctx)) <= 0)
+            return ok;
+
+        /* Signal success at each depth, as internal_verify() does */
+        for (n = sk_X509_num(ctx->chain) - 1; n >= 0; n--) {
+            ctx->current_issuer =
+                sk_X509_value(ctx->chain,
+                              n + 1 < sk_X509_num(ctx->chain) ? n + 1 : n);
+            ctx->current_cert = sk_X509_value(ctx->chain, n);
+            ctx->error_depth = n;
+            if (!ctx->verify_cb(1, ctx))
+                return 0;
+        }
+        return 1;
+    }
+    if (ctx->vcache_key == NULL)
+        return verify_chain(ctx);
+
+    ctx->vcache_verify_cb = ctx->verify_cb;
+    ctx->verify_cb = vcache_verify_cb;
+    ok = verify_chain(ctx);
+    ctx->verify_cb = ctx->vcache_verify_cb;
+    ctx->vcache_verify_cb = NULL;
+
+    if (ok > 0 && ctx->error == X509_V_OK)
+        ossl_x509_vcache_add(ctx);
+    return ok;
+}
+
 /*-
  * Returns -1 on internal error.
  * Sadly, returns 0 also on internal error in ctx->verify_cb().
@@ -355,7 +433,12 @@ static int x509_verify_x509(X509_STORE_CTX *ctx)
     CB_FAIL_IF(!check_cert_key_level(ctx, ctx->cert),
                ctx, ctx->cert, 0, X509_V_ERR_EE_KEY_TOO_SMALL);
 
-    ret = DANETLS_ENABLED(ctx->dane) ? dane_verify(ctx) : verify_chain(ctx);
+    if (DANETLS_ENABLED(ctx->dane))
+        ret = dane_verify(ctx);
+    else if (vcache_usable(ctx))
+        ret = verify_chain_cached(ctx);
+    else
+        ret = verify_chain(ctx);
 
     /*
      * Safety-net.  If we are returning an error, we must also set ctx->error,
@@ -795,10 +878,10 @@ static int check_name_constraints(X509_STORE_CTX *ctx)
          * to be obeyed.
          */
         for (j = sk_X509_num(ctx->chain) - 1; j > i; j--) {
-            NAME_CONSTRAINTS *nc = sk_X509_value(ctx->chain, j)->nc;
+            X509 *xi = sk_X509_value(ctx->chain, j);
 
-            if (nc) {
-                int rv = NAME_CONSTRAINTS_check(x, nc);
+            if (xi->nc != NULL) {
+                int rv = ossl_x509_check_name_constraints(x, xi);
                 int ret = 1;
 
                 /* If EE certificate check commonName too */
@@ -808,7 +891,7 @@ static int check_name_constraints(X509_STORE_CTX *ctx)
                     && ((ctx->param->hostflags
                          & X509_CHECK_FLAG_ALWAYS_CHECK_SUBJECT) != 0
                         || (ret = has_san_id(x, GEN_DNS)) == 0))
-                    rv = NAME_CONSTRAINTS_check_CN(x, nc);
+                    rv = ossl_x509_check_name_constraints_CN(x, xi);
                 if (ret < 0)
                     return ret;
 
@@ -1112,8 +1195,12 @@ static int check_crl_time(X509_STORE_CTX *ctx, X509_CRL *crl, int notify)
         }
     }
 
-    if (notify)
+    if (notify) {
         ctx->current_crl = NULL;
+        if (X509_CRL_get0_nextUpdate(crl) != NULL)
+            ossl_x509_vcache_bound(ctx->parent != NULL ? ctx->parent : ctx,
+                                   X509_CRL_get0_nextUpdate(crl));
+    }
 
     return 1;
 }
@@ -2456,6 +2543,8 @@ int X509_STORE_CTX_init(X509_STORE_CTX *ctx, X509_STORE *store, X509 *x509,
     ctx->dane = NULL;
     ctx->bare_ta_signed = 0;
     ctx->rpk = NULL;
+    ctx->vcache_expiry = 0;
+    ctx->vcache_verify_cb = NULL;
     /* Zero ex_data to make sure we're cleanup-safe */
     memset(&ctx->ex_data, 0, sizeof(ctx->ex_data));
 
@@ -2594,6 +2683,8 @@ void X509_STORE_CTX_cleanup(X509_STORE_CTX *ctx)
     ctx->tree = NULL;
     OSSL_STACK_OF_X509_free(ctx->chain);
     ctx->chain = NULL;
+    OPENSSL_free(ctx->vcache_key);
+    ctx->vcache_key = NULL;
     CRYPTO_free_ex_data(CRYPTO_EX_INDEX_X509_STORE_CTX, ctx, &(ctx->ex_data));
     memset(&ctx->ex_data, 0, sizeof(ctx->ex_data));
 }
@@ -67,6 +67,7 @@ int X509_CRL_sort(X509_CRL *c)
         r = sk_X509_REVOKED_value(c->crl.revoked, i);
         r->sequence = i;
     }
+    ossl_x509_crl_build_serial_idx(c);
     c->crl.enc.modified = 1;
     return 1;
 }
@@ -30,12 +30,19 @@
 
 int X509_verify(X509 *a, EVP_PKEY *r)
 {
+    int ret;
+
     if (X509_ALGOR_cmp(&a->sig_alg, &a->cert_info.signature) != 0)
         return 0;
+    if (ossl_x509_sig_verified(a, r))
+        return 1;
 
-    return ASN1_item_verify_ex(ASN1_ITEM_rptr(X509_CINF), &a->sig_alg,
-                               &a->signature, &a->cert_info,
-                               a->distinguishing_id, r, a->libctx, a->propq);
+    ret = ASN1_item_verify_ex(ASN1_ITEM_rptr(X509_CINF), &a->sig_alg,
+                              &a->signature, &a->cert_info,
+                              a->distinguishing_id, r, a->libctx, a->propq);
+    if (ret > 0)
+        ossl_x509_set_sig_verified(a, r);
+    return ret;
 }
 
 int X509_REQ_verify_ex(X509_REQ *a, EVP_PKEY *r, OSSL_LIB_CTX *libctx,
@@ -174,6 +174,7 @@ static int crl_cb(int operation, ASN1_VALUE **pval, const ASN1_ITEM *it,
         ASN1_INTEGER_free(crl->crl_number);
         ASN1_INTEGER_free(crl->base_crl_number);
         sk_GENERAL_NAMES_pop_free(crl->issuers, GENERAL_NAMES_free);
+        OPENSSL_free(crl->serial_idx);
         /* fall through */
 
     case ASN1_OP_NEW_POST:
@@ -187,6 +188,8 @@ static int crl_cb(int operation, ASN1_VALUE **pval, const ASN1_ITEM *it,
         crl->issuers = NULL;
         crl->crl_number = NULL;
         crl->base_crl_number = NULL;
+        crl->serial_idx = NULL;
+        crl->serial_idx_num = 0;
         break;
 
     case ASN1_OP_D2I_POST:
@@ -252,6 +255,8 @@ static int crl_cb(int operation, ASN1_VALUE **pval, const ASN1_ITEM *it,
         if (!crl_set_issuers(crl))
             return 0;
 
+        ossl_x509_crl_build_serial_idx(crl);
+
         if (crl->meth->crl_init) {
             if (crl->meth->crl_init(crl) == 0)
                 return 0;
@@ -270,6 +275,7 @@ static int crl_cb(int operation, ASN1_VALUE **pval, const ASN1_ITEM *it,
         ASN1_INTEGER_free(crl->crl_number);
         ASN1_INTEGER_free(crl->base_crl_number);
         sk_GENERAL_NAMES_pop_free(crl->issuers, GENERAL_NAMES_free);
+        OPENSSL_free(crl->serial_idx);
         OPENSSL_free(crl->propq);
         break;
     case ASN1_OP_DUP_POST:
@@ -284,6 +290,69 @@ static int crl_cb(int operation, ASN1_VALUE **pval, const ASN1_ITEM *it,
     return 1;
 }
 
+/*
+ * Looking up a serial number in a large CRL used to require sorting the
+ * revoked entries with full ASN1_INTEGER comparisons first.  Instead a compact
+ * index of fixed width digests of the serial numbers is built when the CRL is
+ * decoded.  Equal digests are resolved by comparing the actual serials.
+ *
+ * Applications can change the stack returned by X509_CRL_get_REVOKED(), so
+ * an entry is only used if it is still at position |pos| of the stack.
+ */
+struct x509_crl_serial_idx_st {
+    uint64_t key;
+    X509_REVOKED *rev;
+    int pos;
+};
+
+/* 64-bit FNV-1a of the sign and magnitude of |serial| */
+static uint64_t crl_serial_key(const ASN1_INTEGER *serial)
+{
+    uint64_t h = 0xcbf29ce484222325ULL;
+    int i;
+
+    h = (h ^ (serial->type == V_ASN1_NEG_INTEGER)) * 0x100000001b3ULL;
+    for (i = 0; i < serial->length; i++)
+        h = (h ^ serial->data[i]) * 0x100000001b3ULL;
+    return h;
+}
+
+static int crl_serial_idx_cmp(const void *a, const void *b)
+{
+    uint64_t ka = ((const struct x509_crl_serial_idx_st *)a)->key;
+    uint64_t kb = ((const struct x509_crl_serial_idx_st *)b)->key;
+
+    return ka < kb ? -1 : ka > kb;
+}
+
+/*
+ * (Re)build the index of |crl|.  Failure isn't fatal: lookups then fall back
+ * to sorting the revoked entries.
+ */
+void ossl_x509_crl_build_serial_idx(X509_CRL *crl)
+{
+    STACK_OF(X509_REVOKED) *revoked = crl->crl.revoked;
+    int i, num = sk_X509_REVOKED_num(revoked);
+
+    OPENSSL_free(crl->serial_idx);
+    crl->serial_idx = NULL;
+    crl->serial_idx_num = 0;
+    if (num <= 0)
+        return;
+    crl->serial_idx = OPENSSL_malloc(sizeof(*crl->serial_idx) * num);
+    if (crl->serial_idx == NULL)
+        return;
+    for (i = 0; i < num; i++) {
+        X509_REVOKED *rev = sk_X509_REVOKED_value(revoked, i);
+
+        crl->serial_idx[i].key = crl_serial_key(&rev->serialNumber);
+        crl->serial_idx[i].rev = rev;
+        crl->serial_idx[i].pos = i;
+    }
+    qsort(crl->serial_idx, num, sizeof(*crl->serial_idx), crl_serial_idx_cmp);
+    crl->serial_idx_num = num;
+}
+
 /* Convert IDP into a more convenient form */
 
 static int setup_idp(X509_CRL *crl, ISSUING_DIST_POINT *idp)
@@ -370,6 +439,10 @@ int X509_CRL_add0_revoked(X509_CRL *crl, X509_REVOKED *rev)
         return 0;
     }
     inf->enc.modified = 1;
+    /* The index no longer covers all entries */
+    OPENSSL_free(crl->serial_idx);
+    crl->serial_idx = NULL;
+    crl->serial_idx_num = 0;
     return 1;
 }
 
@@ -431,6 +504,15 @@ static int crl_revoked_issuer_match(X509_CRL *crl, const X509_NAME *nm,
 
 }
 
+static int crl_revoked_found(X509_REVOKED **ret, X509_REVOKED *rev)
+{
+    if (ret)
+        *ret = rev;
+    if (rev->reason == CRL_REASON_REMOVE_FROM_CRL)
+        return 2;
+    return 1;
+}
+
 static int def_crl_lookup(X509_CRL *crl,
                           X509_REVOKED **ret, const ASN1_INTEGER *serial,
                           const X509_NAME *issuer)
@@ -441,6 +523,35 @@ static int def_crl_lookup(X509_CRL *crl,
     if (crl->crl.revoked == NULL)
         return 0;
 
+    if (crl->serial_idx != NULL
+            && crl->serial_idx_num == sk_X509_REVOKED_num(crl->crl.revoked)) {
+        uint64_t key = crl_serial_key(serial);
+        int lo = 0, hi = crl->serial_idx_num;
+
+        /* Find the first entry with a key that is not smaller */
+        while (lo < hi) {
+            idx = lo + (hi - lo) / 2;
+            if (crl->serial_idx[idx].key < key)
+                lo = idx + 1;
+            else
+                hi = idx;
+        }
+        for (idx = lo; idx < crl->serial_idx_num
+                 && crl->serial_idx[idx].key == key; idx++) {
+            rev = sk_X509_REVOKED_value(crl->crl.revoked,
+                                        crl->serial_idx[idx].pos);
+            /* The stack was changed since the index was built */
+            if (rev != crl->serial_idx[idx].rev)
+                goto search;
+            if (ASN1_INTEGER_cmp(&rev->serialNumber, serial) == 0
+                    && crl_revoked_issuer_match(crl, issuer, rev))
+                return crl_revoked_found(ret, rev);
+        }
+        return 0;
+    }
+
+ search:
+
     /*
      * Sort revoked into serial number order if not already sorted. Do this
      * under a lock to avoid race condition.
@@ -460,13 +571,8 @@ static int def_crl_lookup(X509_CRL *crl,
         rev = sk_X509_REVOKED_value(crl->crl.revoked, idx);
         if (ASN1_INTEGER_cmp(&rev->serialNumber, serial))
             return 0;
-        if (crl_revoked_issuer_match(crl, issuer, rev)) {
-            if (ret)
-                *ret = rev;
-            if (rev->reason == CRL_REASON_REMOVE_FROM_CRL)
-                return 2;
-            return 1;
-        }
+        if (crl_revoked_issuer_match(crl, issuer, rev))
+            return crl_revoked_found(ret, rev);
     }
     return 0;
 }
@@ -35,9 +35,6 @@ static void x509_name_ex_free(ASN1_VALUE **val, const ASN1_ITEM *it);
 
 static int x509_name_encode(X509_NAME *a);
 static int x509_name_canon(X509_NAME *a);
-static int asn1_string_canon(ASN1_STRING *out, const ASN1_STRING *in);
-static int i2d_name_canon(const STACK_OF(STACK_OF_X509_NAME_ENTRY) * intname,
-                          unsigned char **in);
 
 static int x509_name_ex_print(BIO *out, const ASN1_VALUE **pval,
                               int indent,
@@ -181,6 +178,13 @@ static int x509_name_ex_d2i(ASN1_VALUE **val,
         goto err;
     memcpy(nm.x->bytes->data, q, p - q);
 
+    /* Size the entries stack up front rather than growing it per entry */
+    for (i = 0, j = 0; i < sk_STACK_OF_X509_NAME_ENTRY_num(intname.s); i++)
+        j += sk_X509_NAME_ENTRY_num(sk_STACK_OF_X509_NAME_ENTRY_value(intname.s,
+                                                                      i));
+    if (!sk_X509_NAME_ENTRY_reserve(nm.x->entries, j))
+        goto err;
+
     /* Convert internal representation to X509_NAME structure */
     for (i = 0; i < sk_STACK_OF_X509_NAME_ENTRY_num(intname.s); i++) {
         entries = sk_STACK_OF_X509_NAME_ENTRY_value(intname.s, i);
@@ -296,92 +300,6 @@ static int x509_name_ex_print(BIO *out, const ASN1_VALUE **pval,
     return 2;
 }
 
-/*
- * This function generates the canonical encoding of the Name structure. In
- * it all strings are converted to UTF8, leading, trailing and multiple
- * spaces collapsed, converted to lower case and the leading SEQUENCE header
- * removed. In future we could also normalize the UTF8 too. By doing this
- * comparison of Name structures can be rapidly performed by just using
- * memcmp() of the canonical encoding. By omitting the leading SEQUENCE name
- * constraints of type dirName can also be checked with a simple memcmp().
- * NOTE: For empty X509_NAME (NULL-DN), canon_enclen == 0 && canon_enc == NULL
- */
-
-static int x509_name_canon(X509_NAME *a)
-{
-    unsigned char *p;
-    STACK_OF(STACK_OF_X509_NAME_ENTRY) *intname;
-    STACK_OF(X509_NAME_ENTRY) *entries = NULL;
-    X509_NAME_ENTRY *entry, *tmpentry = NULL;
-    int i, set = -1, ret = 0, len;
-
-    OPENSSL_free(a->canon_enc);
-    a->canon_enc = NULL;
-    /* Special case: empty X509_NAME => null encoding */
-    if (sk_X509_NAME_ENTRY_num(a->entries) == 0) {
-        a->canon_enclen = 0;
-        return 1;
-    }
-    intname = sk_STACK_OF_X509_NAME_ENTRY_new_null();
-    if (intname == NULL) {
-        ERR_raise(ERR_LIB_X509, ERR_R_CRYPTO_LIB);
-        goto err;
-    }
-    for (i = 0; i < sk_X509_NAME_ENTRY_num(a->entries); i++) {
-        entry = sk_X509_NAME_ENTRY_value(a->entries, i);
-        if (entry->set != set) {
-            entries = sk_X509_NAME_ENTRY_new_null();
-            if (entries == NULL)
-                goto err;
-            if (!sk_STACK_OF_X509_NAME_ENTRY_push(intname, entries)) {
-                sk_X509_NAME_ENTRY_free(entries);
-                ERR_raise(ERR_LIB_X509, ERR_R_CRYPTO_LIB);
-                goto err;
-            }
-            set = entry->set;
-        }
-        tmpentry = X509_NAME_ENTRY_new();
-        if (tmpentry == NULL) {
-            ERR_raise(ERR_LIB_X509, ERR_R_ASN1_LIB);
-            goto err;
-        }
-        tmpentry->object = OBJ_dup(entry->object);
-        if (tmpentry->object == NULL) {
-            ERR_raise(ERR_LIB_X509, ERR_R_OBJ_LIB);
-            goto err;
-        }
-        if (!asn1_string_canon(tmpentry->value, entry->value))
-            goto err;
-        if (!sk_X509_NAME_ENTRY_push(entries, tmpentry)) {
-            ERR_raise(ERR_LIB_X509, ERR_R_CRYPTO_LIB);
-            goto err;
-        }
-        tmpentry = NULL;
-    }
-
-    /* Finally generate encoding */
-    len = i2d_name_canon(intname, NULL);
-    if (len < 0)
-        goto err;
-    a->canon_enclen = len;
-
-    p = OPENSSL_malloc(a->canon_enclen);
-    if (p == NULL)
-        goto err;
-
-    a->canon_enc = p;
-
-    i2d_name_canon(intname, &p);
-
-    ret = 1;
-
- err:
-    X509_NAME_ENTRY_free(tmpentry);
-    sk_STACK_OF_X509_NAME_ENTRY_pop_free(intname,
-                                         local_sk_X509_NAME_ENTRY_pop_free);
-    return ret;
-}
-
 /* Bitmap of all the types of string that will be canonicalized. */
 
 #define ASN1_MASK_CANON \
@@ -389,33 +307,19 @@ static int x509_name_canon(X509_NAME *a)
         | B_ASN1_PRINTABLESTRING | B_ASN1_T61STRING | B_ASN1_IA5STRING \
         | B_ASN1_VISIBLESTRING)
 
-static int asn1_string_canon(ASN1_STRING *out, const ASN1_STRING *in)
+/*
+ * Convert the UTF8 string |s| of length |len| to canonical form in place and
+ * return the new length.
+ */
+static int utf8_string_canon(unsigned char *s, int len)
 {
-    unsigned char *to, *from;
-    int len, i;
-
-    /* If type not in bitmask just copy string across */
-    if (!(ASN1_tag2bit(in->type) & ASN1_MASK_CANON)) {
-        if (!ASN1_STRING_copy(out, in))
-            return 0;
-        return 1;
-    }
-
-    out->type = V_ASN1_UTF8STRING;
-    out->length = ASN1_STRING_to_UTF8(&out->data, in);
-    if (out->length == -1)
-        return 0;
-
-    to = out->data;
-    from = to;
-
-    len = out->length;
+    unsigned char *to, *from = s;
+    int i;
 
     /*
-     * Convert string in place to canonical form. Ultimately we may need to
-     * handle a wider range of characters but for now ignore anything with
-     * MSB set and rely on the ossl_isspace() to fail on bad characters without
-     * needing isascii or range checks as well.
+     * Ultimately we may need to handle a wider range of characters but for
+     * now ignore anything with MSB set and rely on the ossl_isspace() to fail
+     * on bad characters without needing isascii or range checks as well.
      */
 
     /* Ignore leading spaces */
@@ -432,7 +336,7 @@ static int asn1_string_canon(ASN1_STRING *out, const ASN1_STRING *in)
         len--;
     }
 
-    to = out->data;
+    to = s;
 
     i = 0;
     while (i < len) {
@@ -462,29 +366,237 @@ static int asn1_string_canon(ASN1_STRING *out, const ASN1_STRING *in)
         }
     }
 
-    out->length = to - out->data;
+    return to - s;
+}
+
+/* Single byte string types whose ASCII content is unchanged by UTF8 conversion */
+#define ASN1_MASK_CANON_ASCII \
+        (B_ASN1_UTF8STRING | B_ASN1_PRINTABLESTRING | B_ASN1_T61STRING \
+        | B_ASN1_IA5STRING | B_ASN1_VISIBLESTRING)
 
+static int asn1_string_is_ascii(const ASN1_STRING *in)
+{
+    int i;
+
+    if (!(ASN1_tag2bit(in->type) & ASN1_MASK_CANON_ASCII))
+        return 0;
+    for (i = 0; i < in->length; i++)
+        if (!ossl_isascii(in->data[i]))
+            return 0;
     return 1;
+}
+
+/*
+ * Scratch space for building the canonical encoding, which lives on the stack
+ * unless the name is unusually large.
+ */
+#define NAME_CANON_LOCAL_BUF    512
+#define NAME_CANON_LOCAL_ENTRIES 16
+
+typedef struct {
+    unsigned char *data;
+    size_t length;
+    size_t max;
+    unsigned char local[NAME_CANON_LOCAL_BUF];
+} NAME_CANON_BUF;
+
+/* Make room for |len| more bytes, advancing the length */
+static unsigned char *name_canon_buf_grow(NAME_CANON_BUF *buf, size_t len)
+{
+    unsigned char *p;
+    size_t n;
+
+    if (len > X509_NAME_MAX - buf->length) {
+        ERR_raise(ERR_LIB_X509, ERR_R_PASSED_INVALID_ARGUMENT);
+        return NULL;
+    }
+    if (buf->length + len > buf->max) {
+        n = (buf->length + len) * 2;
+        if (buf->data == buf->local) {
+            if ((p = OPENSSL_malloc(n)) == NULL)
+                return NULL;
+            memcpy(p, buf->data, buf->length);
+        } else if ((p = OPENSSL_realloc(buf->data, n)) == NULL) {
+            return NULL;
+        }
+        buf->data = p;
+        buf->max = n;
+    }
+    p = buf->data + buf->length;
+    buf->length += len;
+    return p;
+}
+
+typedef struct {
+    size_t off;
+    const unsigned char *der;
+    int len;
+    int set;
+} NAME_CANON_ENTRY;
+
+/*
+ * Append the encoding of |ne| with its value in canonical form to |buf|,
+ * recording where it is in |ce|.
+ */
+static int name_entry_canon(NAME_CANON_BUF *buf, const X509_NAME_ENTRY *ne,
+                            NAME_CANON_ENTRY *ce)
+{
+    const ASN1_STRING *in = ne->value;
+    unsigned char *utf8 = NULL, *p, *val;
+    size_t off = buf->length;
+    int objlen, vlen, seqlen, ret = 0;
+
+    if ((objlen = i2d_ASN1_OBJECT(ne->object, NULL)) <= 0)
+        return 0;
+
+    if (!(ASN1_tag2bit(in->type) & ASN1_MASK_CANON)) {
+        /* If type not in bitmask just copy string across */
+        if ((vlen = i2d_ASN1_PRINTABLE(in, NULL)) <= 0)
+            return 0;
+        seqlen = objlen + vlen;
+        if ((p = name_canon_buf_grow(buf, ASN1_object_size(1, seqlen,
+                                                           V_ASN1_SEQUENCE)))
+                == NULL)
+            return 0;
+        ASN1_put_object(&p, 1, seqlen, V_ASN1_SEQUENCE, V_ASN1_UNIVERSAL);
+        i2d_ASN1_OBJECT(ne->object, &p);
+        i2d_ASN1_PRINTABLE(in, &p);
+        goto done;
+    }
+
+    /*
+     * Strings that are plain ASCII are canonicalized directly, anything else
+     * is converted to UTF8 first.
+     */
+    if (asn1_string_is_ascii(in)) {
+        val = in->data;
+        vlen = in->length;
+    } else {
+        if ((vlen = ASN1_STRING_to_UTF8(&utf8, in)) < 0)
+            return 0;
+        val = utf8;
+    }
+
+    /*
+     * The canonical value is never longer than |vlen|, so it is built at the
+     * end of the space reserved for the worst case and moved into place once
+     * its length, and so the length of the headers, is known.
+     */
+    seqlen = objlen + ASN1_object_size(0, vlen, V_ASN1_UTF8STRING);
+    if (name_canon_buf_grow(buf, ASN1_object_size(1, seqlen,
+                                                  V_ASN1_SEQUENCE)) == NULL)
+        goto err;
+    p = buf->data + buf->length - vlen;
+    memcpy(p, val, vlen);
+    vlen = utf8_string_canon(p, vlen);
+    val = p;
+
+    seqlen = objlen + ASN1_object_size(0, vlen, V_ASN1_UTF8STRING);
+    p = buf->data + off;
+    ASN1_put_object(&p, 1, seqlen, V_ASN1_SEQUENCE, V_ASN1_UNIVERSAL);
+    i2d_ASN1_OBJECT(ne->object, &p);
+    ASN1_put_object(&p, 0, vlen, V_ASN1_UTF8STRING, V_ASN1_UNIVERSAL);
+    memmove(p, val, vlen);
+    buf->length = p + vlen - buf->data;
+
+ done:
+    ce->off = off;
+    ce->len = (int)(buf->length - off);
+    ce->set = ne->set;
+    ret = 1;
+ err:
+    OPENSSL_free(utf8);
+    return ret;
+}
+
+/* Order of elements in a DER encoded SET OF */
+static int name_canon_entry_cmp(const void *a, const void *b)
+{
+    const NAME_CANON_ENTRY *ca = a, *cb = b;
+    int cmp = memcmp(ca->der, cb->der, ca->len < cb->len ? ca->len : cb->len);
 
+    if (cmp != 0)
+        return cmp;
+    return ca->len - cb->len;
 }
 
-static int i2d_name_canon(const STACK_OF(STACK_OF_X509_NAME_ENTRY) * _intname,
-                          unsigned char **in)
+/*
+ * This function generates the canonical encoding of the Name structure. In
+ * it all strings are converted to UTF8, leading, trailing and multiple
+ * spaces collapsed, converted to lower case and the leading SEQUENCE header
+ * removed. In future we could also normalize the UTF8 too. By doing this
+ * comparison of Name structures can be rapidly performed by just using
+ * memcmp() of the canonical encoding. By omitting the leading SEQUENCE name
+ * constraints of type dirName can also be checked with a simple memcmp().
+ * NOTE: For empty X509_NAME (NULL-DN), canon_enclen == 0 && canon_enc == NULL
+ */
+
+static int x509_name_canon(X509_NAME *a)
 {
-    int i, len, ltmp;
-    const ASN1_VALUE *v;
-    STACK_OF(ASN1_VALUE) *intname = (STACK_OF(ASN1_VALUE) *)_intname;
+    NAME_CANON_BUF buf;
+    NAME_CANON_ENTRY local_ces[NAME_CANON_LOCAL_ENTRIES], *ces = local_ces;
+    unsigned char *p;
+    int i, j, n, rdnlen, len, ret = 0;
 
+    OPENSSL_free(a->canon_enc);
+    a->canon_enc = NULL;
+    /* Special case: empty X509_NAME => null encoding */
+    if ((n = sk_X509_NAME_ENTRY_num(a->entries)) == 0) {
+        a->canon_enclen = 0;
+        return 1;
+    }
+
+    /*
+     * Encode all entries into one buffer, rather than building a canonical
+     * copy of the name out of separately allocated objects.
+     */
+    buf.data = buf.local;
+    buf.length = 0;
+    buf.max = sizeof(buf.local);
+    if (n > NAME_CANON_LOCAL_ENTRIES
+            && (ces = OPENSSL_malloc(sizeof(*ces) * n)) == NULL)
+        goto err;
+    for (i = 0; i < n; i++)
+        if (!name_entry_canon(&buf, sk_X509_NAME_ENTRY_value(a->entries, i),
+                              &ces[i]))
+            goto err;
+    for (i = 0; i < n; i++)
+        ces[i].der = buf.data + ces[i].off;
+
+    /*
+     * Each RDN is a SET of its entries, and the leading SEQUENCE header of
+     * the name is omitted.
+     */
     len = 0;
-    for (i = 0; i < sk_ASN1_VALUE_num(intname); i++) {
-        v = sk_ASN1_VALUE_value(intname, i);
-        ltmp = ASN1_item_ex_i2d(&v, in,
-                                ASN1_ITEM_rptr(X509_NAME_ENTRIES), -1, -1);
-        if (ltmp < 0)
-            return ltmp;
-        len += ltmp;
+    for (i = 0; i < n; i = j) {
+        for (rdnlen = 0, j = i; j < n && ces[j].set == ces[i].set; j++)
+            rdnlen += ces[j].len;
+        len += ASN1_object_size(1, rdnlen, V_ASN1_SET);
+        if (j - i > 1)
+            qsort(&ces[i], j - i, sizeof(*ces), name_canon_entry_cmp);
     }
-    return len;
+
+    if ((p = OPENSSL_malloc(len)) == NULL)
+        goto err;
+    a->canon_enc = p;
+    a->canon_enclen = len;
+    for (i = 0; i < n; i = j) {
+        for (rdnlen = 0, j = i; j < n && ces[j].set == ces[i].set; j++)
+            rdnlen += ces[j].len;
+        ASN1_put_object(&p, 1, rdnlen, V_ASN1_SET, V_ASN1_UNIVERSAL);
+        for (; i < j; i++) {
+            memcpy(p, ces[i].der, ces[i].len);
+            p += ces[i].len;
+        }
+    }
+    ret = 1;
+
+ err:
+    if (buf.data != buf.local)
+        OPENSSL_free(buf.data);
+    if (ces != local_ces)
+        OPENSSL_free(ces);
+    return ret;
 }
 
 int X509_NAME_set(X509_NAME **xn, const X509_NAME *name)
@@ -27,6 +27,7 @@
 #include <openssl/encoder.h>
 #include "internal/provider.h"
 #include "internal/sizes.h"
+#include "internal/tsan_assist.h"
 
 struct X509_pubkey_st {
     X509_ALGOR *algor;
@@ -40,6 +41,13 @@ struct X509_pubkey_st {
 
     /* Flag to force legacy keys */
     unsigned int flag_force_legacy : 1;
+
+    /*
+     * Keys read by d2i are only decoded into |pkey| when first used, which
+     * is guarded by |lock|.  |pkey_pending| is set until then.
+     */
+    CRYPTO_RWLOCK *lock;
+    volatile int pkey_pending;
 };
 
 static int x509_pubkey_decode(EVP_PKEY **pk, const X509_PUBKEY *key);
@@ -91,6 +99,7 @@ static void x509_pubkey_ex_free(ASN1_VALUE **pval, const ASN1_ITEM *it)
         X509_ALGOR_free(pubkey->algor);
         ASN1_BIT_STRING_free(pubkey->public_key);
         EVP_PKEY_free(pubkey->pkey);
+        CRYPTO_THREAD_lock_free(pubkey->lock);
         OPENSSL_free(pubkey->propq);
         OPENSSL_free(pubkey);
         *pval = NULL;
@@ -127,18 +136,66 @@ static int x509_pubkey_ex_new_ex(ASN1_VALUE **pval, const ASN1_ITEM *it,
     return ret != NULL;
 }
 
+/*
+ * Structural checks of the key bits that are cheap enough to make when the
+ * key is read by d2i, before the key is decoded into an EVP_PKEY.  Keys are
+ * always whole octets.  The keys of some algorithms are themselves a single
+ * DER object, with nothing following it, and some have a fixed length.
+ */
+static int x509_pubkey_check(const X509_PUBKEY *pubkey)
+{
+    const ASN1_BIT_STRING *bits = pubkey->public_key;
+    const unsigned char *p = bits->data;
+    long len;
+    int tag, xclass, inf;
+
+    if ((bits->flags & ASN1_STRING_FLAG_BITS_LEFT) != 0
+            && (bits->flags & 0x07) != 0) {
+        ERR_raise(ERR_LIB_ASN1, ASN1_R_INVALID_BIT_STRING_BITS_LEFT);
+        return 0;
+    }
+
+    switch (OBJ_obj2nid(pubkey->algor->algorithm)) {
+    case NID_rsaEncryption:
+    case NID_rsassaPss:
+    case NID_dsa:
+    case NID_dhKeyAgreement:
+    case NID_dhpublicnumber:
+        inf = ASN1_get_object(&p, &len, &tag, &xclass, bits->length);
+        if ((inf & 0x80) != 0 || inf == 0x21
+                || p + len != bits->data + bits->length)
+            break;
+        return 1;
+    case NID_X25519:
+    case NID_ED25519:
+        if (bits->length == 32)
+            return 1;
+        break;
+    case NID_X448:
+        if (bits->length == 56)
+            return 1;
+        break;
+    case NID_ED448:
+        if (bits->length == 57)
+            return 1;
+        break;
+    default:
+        if (bits->length > 0)
+            return 1;
+        break;
+    }
+    ERR_raise(ERR_LIB_X509, X509_R_PUBLIC_KEY_DECODE_ERROR);
+    return 0;
+}
+
 static int x509_pubkey_ex_d2i_ex(ASN1_VALUE **pval,
                                  const unsigned char **in, long len,
                                  const ASN1_ITEM *it, int tag, int aclass,
                                  char opt, ASN1_TLC *ctx, OSSL_LIB_CTX *libctx,
                                  const char *propq)
 {
-    const unsigned char *in_saved = *in;
-    size_t publen;
     X509_PUBKEY *pubkey;
     int ret;
-    OSSL_DECODER_CTX *dctx = NULL;
-    unsigned char *tmpbuf = NULL;
 
     if (*pval == NULL && !x509_pubkey_ex_new_ex(pval, it, libctx, propq))
         return 0;
@@ -153,15 +210,39 @@ static int x509_pubkey_ex_d2i_ex(ASN1_VALUE **pval,
                                 tag, aclass, opt, ctx)) <= 0)
         return ret;
 
-    publen = *in - in_saved;
-    if (!ossl_assert(publen > 0)) {
-        ERR_raise(ERR_LIB_ASN1, ERR_R_INTERNAL_ERROR);
-        return 0;
-    }
-
     pubkey = (X509_PUBKEY *)*pval;
     EVP_PKEY_free(pubkey->pkey);
     pubkey->pkey = NULL;
+    pubkey->pkey_pending = 0;
+
+    if (!x509_pubkey_check(pubkey))
+        return 0;
+
+    /*
+     * Decoding the key into an EVP_PKEY is expensive and many users of
+     * decoded certificates never look at it, so it is deferred until the
+     * key is first retrieved with X509_PUBKEY_get0().  Only the checks above
+     * are made now.
+     */
+    if (pubkey->lock == NULL
+            && (pubkey->lock = CRYPTO_THREAD_lock_new()) == NULL) {
+        ERR_raise(ERR_LIB_ASN1, ERR_R_CRYPTO_LIB);
+        return 0;
+    }
+    pubkey->pkey_pending = 1;
+    return 1;
+}
+
+/*
+ * Decode the key read by d2i, the caller holds the write lock.
+ * Returns 1 when done, even if the key couldn't be decoded, and 0 on a
+ * fatal error.
+ */
+static int x509_pubkey_decode_pending(X509_PUBKEY *pubkey)
+{
+    OSSL_DECODER_CTX *dctx = NULL;
+    unsigned char *der = NULL;
+    int ret;
 
     /*
      * Opportunistically decode the key but remove any non fatal errors
@@ -177,33 +258,31 @@ static int x509_pubkey_ex_d2i_ex(ASN1_VALUE **pval,
     if ((ret = x509_pubkey_decode(&pubkey->pkey, pubkey)) == -1) {
         /* -1 indicates a fatal error, like malloc failure */
         ERR_clear_last_mark();
-        goto end;
+        return 0;
     }
 
     /* Try to decode it into an EVP_PKEY with OSSL_DECODER */
     if (ret <= 0 && !pubkey->flag_force_legacy) {
         const unsigned char *p;
         char txtoidname[OSSL_MAX_NAME_SIZE];
-        size_t slen = publen;
+        size_t slen;
+        int derlen;
 
         /*
-        * The decoders don't know how to handle anything other than Universal
-        * class so we modify the data accordingly.
-        */
-        if (aclass != V_ASN1_UNIVERSAL) {
-            tmpbuf = OPENSSL_memdup(in_saved, publen);
-            if (tmpbuf == NULL)
-                return 0;
-            in_saved = tmpbuf;
-            *tmpbuf = V_ASN1_CONSTRUCTED | V_ASN1_SEQUENCE;
-        }
-        p = in_saved;
-
-        if (OBJ_obj2txt(txtoidname, sizeof(txtoidname),
-                        pubkey->algor->algorithm, 0) <= 0) {
+         * The decoders don't know how to handle anything other than Universal
+         * class, so the key is re-encoded rather than kept from d2i.
+         */
+        derlen = ASN1_item_i2d((ASN1_VALUE *)pubkey, &der,
+                               ASN1_ITEM_rptr(X509_PUBKEY_INTERNAL));
+        if (derlen <= 0
+            || OBJ_obj2txt(txtoidname, sizeof(txtoidname),
+                           pubkey->algor->algorithm, 0) <= 0) {
             ERR_clear_last_mark();
-            goto end;
+            return 0;
         }
+        p = der;
+        slen = (size_t)derlen;
+
         if ((dctx =
              OSSL_DECODER_CTX_new_for_pkey(&pubkey->pkey,
                                            "DER", "SubjectPublicKeyInfo",
@@ -214,24 +293,49 @@ static int x509_pubkey_ex_d2i_ex(ASN1_VALUE **pval,
              * As said higher up, we're being opportunistic.  In other words,
              * we don't care if we fail.
              */
-            if (OSSL_DECODER_from_data(dctx, &p, &slen)) {
-                if (slen != 0) {
-                    /*
-                     * If we successfully decoded then we *must* consume all the
-                     * bytes.
-                     */
-                    ERR_clear_last_mark();
-                    ERR_raise(ERR_LIB_ASN1, EVP_R_DECODE_ERROR);
-                    goto end;
-                }
+            if (OSSL_DECODER_from_data(dctx, &p, &slen) && slen != 0) {
+                /*
+                 * If we successfully decoded then we *must* consume all the
+                 * bytes.
+                 */
+                EVP_PKEY_free(pubkey->pkey);
+                pubkey->pkey = NULL;
             }
     }
 
     ERR_pop_to_mark();
-    ret = 1;
- end:
     OSSL_DECODER_CTX_free(dctx);
-    OPENSSL_free(tmpbuf);
+    OPENSSL_free(der);
+    return 1;
+}
+
+static int x509_pubkey_decode_once(X509_PUBKEY *pubkey)
+{
+    int ret = 1;
+
+#ifdef tsan_ld_acq
+    /* Fast lock-free check, |pkey_pending| is cleared with a release store */
+    if (!tsan_ld_acq((TSAN_QUALIFIER int *)&pubkey->pkey_pending))
+        return 1;
+#endif
+
+    if (pubkey->lock == NULL)
+        return 1;
+    if (!CRYPTO_THREAD_write_lock(pubkey->lock))
+        return 0;
+    if (pubkey->pkey_pending) {
+        ret = x509_pubkey_decode_pending(pubkey);
+#ifdef tsan_st_rel
+        /*
+         * The release store makes |pkey| visible before the lock-free
+         * check above can succeed.
+         */
+        tsan_st_rel((TSAN_QUALIFIER int *)&pubkey->pkey_pending, 0);
+#else
+        pubkey->pkey_pending = 0;
+#endif
+    }
+    CRYPTO_THREAD_unlock(pubkey->lock);
     return ret;
 }
 
@@ -282,9 +386,11 @@ X509_PUBKEY *X509_PUBKEY_new_ex(OSSL_LIB_CTX *libctx, const char *propq)
  */
 X509_PUBKEY *X509_PUBKEY_dup(const X509_PUBKEY *a)
 {
-    X509_PUBKEY *pubkey = OPENSSL_zalloc(sizeof(*pubkey));
+    X509_PUBKEY *pubkey;
 
-    if (pubkey == NULL)
+    if (!x509_pubkey_decode_once((X509_PUBKEY *)a))
+        return NULL;
+    if ((pubkey = OPENSSL_zalloc(sizeof(*pubkey))) == NULL)
         return NULL;
     if (!x509_pubkey_set0_libctx(pubkey, a->libctx, a->propq)) {
         ERR_raise(ERR_LIB_X509, ERR_R_X509_LIB);
@@ -387,6 +493,7 @@ int X509_PUBKEY_set(X509_PUBKEY **x, EVP_PKEY *pkey)
         EVP_PKEY_free(pk->pkey);
 
     pk->pkey = pkey;
+    pk->pkey_pending = 0;
     return 1;
 
  error:
@@ -459,6 +566,9 @@ EVP_PKEY *X509_PUBKEY_get0(const X509_PUBKEY *key)
         return NULL;
     }
 
+    if (!x509_pubkey_decode_once((X509_PUBKEY *)key))
+        return NULL;
+
     if (key->pkey == NULL) {
         /* We failed to decode the key when we loaded it, or it was never set */
         ERR_raise(ERR_LIB_EVP, EVP_R_DECODE_ERROR);
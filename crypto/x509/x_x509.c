@@ -49,11 +49,13 @@ static int x509_cb(int operation, ASN1_VALUE **pval, const ASN1_ITEM *it,
         ossl_policy_cache_free(ret->policy_cache);
         GENERAL_NAMES_free(ret->altname);
         NAME_CONSTRAINTS_free(ret->nc);
+        ossl_x509_nc_index_free(ret->nc_index);
 #ifndef OPENSSL_NO_RFC3779
         sk_IPAddressFamily_pop_free(ret->rfc3779_addr, IPAddressFamily_free);
         ASIdentifiers_free(ret->rfc3779_asid);
 #endif
         ASN1_OCTET_STRING_free(ret->distinguishing_id);
+        EVP_PKEY_free(ret->sig_verified_key);
 
         /* fall through */
 
@@ -70,11 +72,13 @@ static int x509_cb(int operation, ASN1_VALUE **pval, const ASN1_ITEM *it,
         ret->policy_cache = NULL;
         ret->altname = NULL;
         ret->nc = NULL;
+        ret->nc_index = NULL;
 #ifndef OPENSSL_NO_RFC3779
         ret->rfc3779_addr = NULL;
         ret->rfc3779_asid = NULL;
 #endif
         ret->distinguishing_id = NULL;
+        ret->sig_verified_key = NULL;
         ret->aux = NULL;
         ret->crldp = NULL;
         if (!CRYPTO_new_ex_data(CRYPTO_EX_INDEX_X509, ret, &ret->ex_data))
@@ -90,11 +94,13 @@ static int x509_cb(int operation, ASN1_VALUE **pval, const ASN1_ITEM *it,
         ossl_policy_cache_free(ret->policy_cache);
         GENERAL_NAMES_free(ret->altname);
         NAME_CONSTRAINTS_free(ret->nc);
+        ossl_x509_nc_index_free(ret->nc_index);
 #ifndef OPENSSL_NO_RFC3779
         sk_IPAddressFamily_pop_free(ret->rfc3779_addr, IPAddressFamily_free);
         ASIdentifiers_free(ret->rfc3779_asid);
 #endif
         ASN1_OCTET_STRING_free(ret->distinguishing_id);
+        EVP_PKEY_free(ret->sig_verified_key);
         OPENSSL_free(ret->propq);
         break;
 
@@ -308,9 +314,45 @@ void X509_set0_distinguishing_id(X509 *x, ASN1_OCTET_STRING *d_id)
 {
     ASN1_OCTET_STRING_free(x->distinguishing_id);
     x->distinguishing_id = d_id;
+    /* The identifier is part of what the signature covers */
+    ossl_x509_set_sig_verified(x, NULL);
 }
 
 ASN1_OCTET_STRING *X509_get0_distinguishing_id(X509 *x)
 {
     return x->distinguishing_id;
 }
+
+/*
+ * Whether the signature of |x| is known to have been made with |pkey|.  A
+ * certificate shared by many chains, such as an intermediate CA, then only
+ * needs to have its signature verified once.  Nothing is remembered once the
+ * certificate has been modified, as its signature then needs to be redone.
+ */
+int ossl_x509_sig_verified(X509 *x, EVP_PKEY *pkey)
+{
+    int ret = 0;
+
+    if (pkey == NULL || x->cert_info.enc.modified
+            || !CRYPTO_THREAD_read_lock(x->lock))
+        return 0;
+    if (x->sig_verified_key != NULL)
+        ret = x->sig_verified_key == pkey
+            || EVP_PKEY_eq(x->sig_verified_key, pkey) == 1;
+    CRYPTO_THREAD_unlock(x->lock);
+    return ret;
+}
+
+/* Remember that the signature of |x| was made with |pkey|, or forget it */
+void ossl_x509_set_sig_verified(X509 *x, EVP_PKEY *pkey)
+{
+    if (pkey != NULL && (x->cert_info.enc.modified || !EVP_PKEY_up_ref(pkey)))
+        return;
+    if (!CRYPTO_THREAD_write_lock(x->lock)) {
+        EVP_PKEY_free(pkey);
+        return;
+    }
+    EVP_PKEY_free(x->sig_verified_key);
+    x->sig_verified_key = pkey;
+    CRYPTO_THREAD_unlock(x->lock);
+}
@@ -262,6 +262,26 @@ size_t aesni_gcm_decrypt(const unsigned char *in, unsigned char *out, size_t len
                          const void *key, unsigned char ivec[16], u64 *Xi);
 void gcm_ghash_avx(u64 Xi[2], const u128 Htable[16], const u8 *in, size_t len);
 
+/* AVX512F + VAES + VPCLMULQDQ, see crypto/modes/asm/aes-gcm-avx512.pl */
+int ossl_vaes_vpclmulqdq_capable(void);
+#   define AESNI_AVX512_CAPABLE ossl_vaes_vpclmulqdq_capable()
+
+void ossl_aes_ctr32_encrypt_blocks_avx512(const unsigned char *in,
+                                          unsigned char *out,
+                                          size_t blocks,
+                                          const void *key,
+                                          const unsigned char *ivec);
+void ossl_aes_xts_encrypt_avx512(const unsigned char *in,
+                                 unsigned char *out,
+                                 size_t length,
+                                 const AES_KEY *key1, const AES_KEY *key2,
+                                 const unsigned char iv[16]);
+void ossl_aes_xts_decrypt_avx512(const unsigned char *in,
+                                 unsigned char *out,
+                                 size_t length,
+                                 const AES_KEY *key1, const AES_KEY *key2,
+                                 const unsigned char iv[16]);
+
 #   define AES_gcm_encrypt aesni_gcm_encrypt
 #   define AES_gcm_decrypt aesni_gcm_decrypt
 #   define AES_GCM_ASM(ctx)    (ctx->ctr == aesni_ctr32_encrypt_blocks && \
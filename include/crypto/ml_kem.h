@@ -0,0 +1,65 @@
+/*
+ * Copyright 2024 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+/* Internal ML-KEM functions for other submodules: not for application use */
+
+#ifndef OSSL_CRYPTO_ML_KEM_H
+# define OSSL_CRYPTO_ML_KEM_H
+# pragma once
+
+# include <openssl/opensslconf.h>
+
+# ifndef OPENSSL_NO_ML_KEM
+
+#  include <stddef.h>
+#  include <openssl/e_os2.h>
+
+#  define ML_KEM_768_PUBLIC_KEY_BYTES   1184
+#  define ML_KEM_768_PRIVATE_KEY_BYTES  2400
+#  define ML_KEM_768_CIPHERTEXT_BYTES   1088
+#  define ML_KEM_SHARED_SECRET_BYTES    32
+
+/* The key generation seed d || z and the encapsulation seed m */
+#  define ML_KEM_SEED_BYTES             64
+#  define ML_KEM_ENCAP_SEED_BYTES       32
+
+/* Module dimension and NIST security category 3 */
+#  define ML_KEM_768_BITS               768
+#  define ML_KEM_768_SECURITY_BITS      192
+
+typedef struct ml_kem_key_st ML_KEM_KEY;
+
+ML_KEM_KEY *ossl_ml_kem_key_new(void);
+ML_KEM_KEY *ossl_ml_kem_key_dup(const ML_KEM_KEY *key);
+void ossl_ml_kem_key_free(ML_KEM_KEY *key);
+int ossl_ml_kem_have_pubkey(const ML_KEM_KEY *key);
+int ossl_ml_kem_have_prvkey(const ML_KEM_KEY *key);
+int ossl_ml_kem_pubkey_cmp(const ML_KEM_KEY *key1, const ML_KEM_KEY *key2);
+
+int ossl_ml_kem_genkey(ML_KEM_KEY *key,
+                       const unsigned char seed[ML_KEM_SEED_BYTES]);
+int ossl_ml_kem_parse_public_key(ML_KEM_KEY *key,
+                                 const unsigned char *in, size_t inlen);
+int ossl_ml_kem_parse_private_key(ML_KEM_KEY *key,
+                                  const unsigned char *in, size_t inlen);
+int ossl_ml_kem_encode_public_key(const ML_KEM_KEY *key,
+                                  unsigned char *out, size_t outlen);
+int ossl_ml_kem_encode_private_key(const ML_KEM_KEY *key,
+                                   unsigned char *out, size_t outlen);
+
+int ossl_ml_kem_encap_seed(const ML_KEM_KEY *key,
+                           const unsigned char m[ML_KEM_ENCAP_SEED_BYTES],
+                           unsigned char *ct, size_t ctlen,
+                           unsigned char *ss, size_t sslen);
+int ossl_ml_kem_decap(const ML_KEM_KEY *key,
+                      const unsigned char *ct, size_t ctlen,
+                      unsigned char *ss, size_t sslen);
+
+# endif /* OPENSSL_NO_ML_KEM */
+#endif /* OSSL_CRYPTO_ML_KEM_H */
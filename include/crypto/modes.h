@@ -143,6 +143,12 @@ void ossl_gcm_init_4bit(u128 Htable[16], const u64 H[2]);
 void ossl_gcm_ghash_4bit(u64 Xi[2], const u128 Htable[16],
                          const u8 *inp, size_t len);
 void ossl_gcm_gmult_4bit(u64 Xi[2], const u128 Htable[16]);
+int ossl_gcm128_crypt_batch(const GCM128_CONTEXT *ctx, ecb128_f ecb,
+                            size_t num, const unsigned char *iv[],
+                            const unsigned char *aad[], const size_t aadlen[],
+                            const unsigned char *in[], unsigned char *out[],
+                            const size_t len[], unsigned char *tag[],
+                            size_t taglen, int enc, int ok[]);
 
 /*
  * The maximum permitted number of cipher blocks per data unit in XTS mode.
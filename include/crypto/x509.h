@@ -122,6 +122,9 @@ struct X509_crl_st {
     const X509_CRL_METHOD *meth;
     void *meth_data;
     CRYPTO_RWLOCK *lock;
+    /* Revoked entries ordered by a digest of their serial number */
+    struct x509_crl_serial_idx_st *serial_idx;
+    int serial_idx_num;
 
     OSSL_LIB_CTX *libctx;
     char *propq;
@@ -171,6 +174,8 @@ struct x509_cinf_st {
     ASN1_ENCODING enc;
 };
 
+typedef struct x509_nc_index_st X509_NC_INDEX;
+
 struct x509_st {
     X509_CINF cert_info;
     X509_ALGOR sig_alg;
@@ -191,6 +196,7 @@ struct x509_st {
     STACK_OF(DIST_POINT) *crldp;
     STACK_OF(GENERAL_NAME) *altname;
     NAME_CONSTRAINTS *nc;
+    X509_NC_INDEX *nc_index;
 # ifndef OPENSSL_NO_RFC3779
     STACK_OF(IPAddressFamily) *rfc3779_addr;
     struct ASIdentifiers_st *rfc3779_asid;
@@ -205,6 +211,9 @@ struct x509_st {
 
     OSSL_LIB_CTX *libctx;
     char *propq;
+
+    /* The key with which the signature was last successfully verified */
+    EVP_PKEY *sig_verified_key;
 } /* X509 */ ;
 
 /*
@@ -283,6 +292,16 @@ struct x509_store_ctx_st {      /* X509_STORE_CTX */
 
     OSSL_LIB_CTX *libctx;
     char *propq;
+
+    /* Verified chain cache lookup key, NULL if the result can't be cached */
+    unsigned char *vcache_key;
+    size_t vcache_keylen;
+    /* Store generation the key was looked up in */
+    uint64_t vcache_gen;
+    /* Time until which the result may be reused, 0 if not yet bounded */
+    time_t vcache_expiry;
+    /* Application callback, wrapped while the result may be cached */
+    int (*vcache_verify_cb) (int ok, X509_STORE_CTX *ctx);
 };
 
 /* PKCS#8 private key info structure */
@@ -315,10 +334,17 @@ int ossl_x509_set1_time(int *modified, ASN1_TIME **ptm, const ASN1_TIME *tm);
 int ossl_x509_print_ex_brief(BIO *bio, X509 *cert, unsigned long neg_cflags);
 int ossl_x509v3_cache_extensions(X509 *x);
 int ossl_x509_init_sig_info(X509 *x);
+int ossl_x509_sig_verified(X509 *x, EVP_PKEY *pkey);
+void ossl_x509_set_sig_verified(X509 *x, EVP_PKEY *pkey);
+X509_NC_INDEX *ossl_x509_nc_index_new(NAME_CONSTRAINTS *nc);
+void ossl_x509_nc_index_free(X509_NC_INDEX *idx);
+int ossl_x509_check_name_constraints(X509 *x, X509 *issuer);
+int ossl_x509_check_name_constraints_CN(X509 *x, X509 *issuer);
 
 int ossl_x509_set0_libctx(X509 *x, OSSL_LIB_CTX *libctx, const char *propq);
 int ossl_x509_crl_set0_libctx(X509_CRL *x, OSSL_LIB_CTX *libctx,
                               const char *propq);
+void ossl_x509_crl_build_serial_idx(X509_CRL *crl);
 int ossl_x509_req_set0_libctx(X509_REQ *x, OSSL_LIB_CTX *libctx,
                               const char *propq);
 int ossl_asn1_item_digest_ex(const ASN1_ITEM *it, const EVP_MD *type,
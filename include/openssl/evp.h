@@ -724,6 +724,9 @@ __owur int EVP_Digest(const void *data, size_t count,
 __owur int EVP_Q_digest(OSSL_LIB_CTX *libctx, const char *name,
                         const char *propq, const void *data, size_t datalen,
                         unsigned char *md, size_t *mdlen);
+__owur int EVP_DigestBatch(const EVP_MD *type, size_t num,
+                           const unsigned char *in[], const size_t inlen[],
+                           unsigned char *out[], size_t outlen);
 
 __owur int EVP_MD_CTX_copy(EVP_MD_CTX *out, const EVP_MD_CTX *in);
 __owur int EVP_DigestInit(EVP_MD_CTX *ctx, const EVP_MD *type);
@@ -805,6 +808,13 @@ __owur int EVP_CipherFinal(EVP_CIPHER_CTX *ctx, unsigned char *outm,
                            int *outl);
 __owur int EVP_CipherFinal_ex(EVP_CIPHER_CTX *ctx, unsigned char *outm,
                               int *outl);
+__owur int EVP_CipherAEADBatch(EVP_CIPHER_CTX *ctx[], size_t num,
+                               const unsigned char *iv[],
+                               const unsigned char *aad[],
+                               const size_t aadlen[],
+                               unsigned char *out[], const unsigned char *in[],
+                               const size_t inl[], unsigned char *tag[],
+                               size_t taglen, int ok[]);
 
 __owur int EVP_SignFinal(EVP_MD_CTX *ctx, unsigned char *md, unsigned int *s,
                          EVP_PKEY *pkey);
@@ -38,6 +38,7 @@
 # define X509_R_INVALID_DIRECTORY                         113
 # define X509_R_INVALID_DISTPOINT                         143
 # define X509_R_INVALID_FIELD_NAME                        119
+# define X509_R_INVALID_SNAPSHOT                          145
 # define X509_R_INVALID_TRUST                             123
 # define X509_R_ISSUER_MISMATCH                           129
 # define X509_R_KEY_TYPE_MISMATCH                         115
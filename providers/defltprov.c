@@ -1,5 +1,5 @@
 /*
- * Copyright 2019-2023 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2019-2024 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -435,6 +435,14 @@ static const OSSL_ALGORITHM deflt_asym_kem[] = {
     { PROV_NAMES_X448, "provider=default", ossl_ecx_asym_kem_functions },
 # endif
     { PROV_NAMES_EC, "provider=default", ossl_ec_asym_kem_functions },
+#endif
+#ifndef OPENSSL_NO_ML_KEM
+    { PROV_NAMES_ML_KEM_768, "provider=default",
+      ossl_ml_kem_768_asym_kem_functions },
+# ifndef OPENSSL_NO_ECX
+    { PROV_NAMES_X25519MLKEM768, "provider=default",
+      ossl_ml_kem_768_asym_kem_functions },
+# endif
 #endif
     { NULL, NULL, NULL }
 };
@@ -489,6 +497,14 @@ static const OSSL_ALGORITHM deflt_keymgmt[] = {
 #ifndef OPENSSL_NO_SM2
     { PROV_NAMES_SM2, "provider=default", ossl_sm2_keymgmt_functions,
       PROV_DESCS_SM2 },
+#endif
+#ifndef OPENSSL_NO_ML_KEM
+    { PROV_NAMES_ML_KEM_768, "provider=default",
+      ossl_ml_kem_768_keymgmt_functions, PROV_DESCS_ML_KEM_768 },
+# ifndef OPENSSL_NO_ECX
+    { PROV_NAMES_X25519MLKEM768, "provider=default",
+      ossl_x25519_ml_kem_768_keymgmt_functions, PROV_DESCS_X25519MLKEM768 },
+# endif
 #endif
     { NULL, NULL, NULL }
 };
@@ -104,6 +104,15 @@ static int cipher_hw_aesni_xts_initkey(PROV_CIPHER_CTX *ctx,
 {
     PROV_AES_XTS_CTX *xctx = (PROV_AES_XTS_CTX *)ctx;
 
+# ifdef AESNI_AVX512_CAPABLE
+    if (AESNI_AVX512_CAPABLE) {
+        XTS_SET_KEY_FN(aesni_set_encrypt_key, aesni_set_decrypt_key,
+                       aesni_encrypt, aesni_decrypt,
+                       ossl_aes_xts_encrypt_avx512,
+                       ossl_aes_xts_decrypt_avx512);
+        return 1;
+    }
+# endif
     XTS_SET_KEY_FN(aesni_set_encrypt_key, aesni_set_decrypt_key,
                    aesni_encrypt, aesni_decrypt,
                    aesni_xts_encrypt, aesni_xts_decrypt);
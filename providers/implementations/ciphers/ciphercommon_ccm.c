@@ -321,6 +321,49 @@ int ossl_ccm_cipher(void *vctx, unsigned char *out, size_t *outl, size_t outsize
     return 1;
 }
 
+/*
+ * Seal or open |num| independent messages, message i with the key, the
+ * direction and the nonce and tag lengths of vctx[i]. CCM has no interleaved
+ * implementation, so they are simply processed one after another.
+ */
+int ossl_ccm_aead_batch(void *vctx[], size_t num, const unsigned char *iv[],
+                        const unsigned char *aad[], const size_t aadlen[],
+                        unsigned char *out[], const unsigned char *in[],
+                        const size_t inl[], unsigned char *tag[],
+                        size_t taglen, int ok[])
+{
+    size_t i;
+    int res, ret = 1;
+
+    if (!ossl_prov_is_running())
+        return 0;
+
+    for (i = 0; i < num; i++) {
+        PROV_CCM_CTX *ctx = (PROV_CCM_CTX *)vctx[i];
+        const PROV_CCM_HW *hw = ctx->hw;
+
+        res = ctx->key_set
+              && ctx->tls_aad_len == UNINITIALISED_SIZET
+              && taglen == ctx->m
+              && hw->setiv(ctx, iv[i], ccm_get_ivlen(ctx), inl[i])
+              && (aadlen[i] == 0 || hw->setaad(ctx, aad[i], aadlen[i]))
+              && (ctx->enc
+                  ? hw->auth_encrypt(ctx, in[i], out[i], inl[i], tag[i],
+                                     taglen)
+                  : hw->auth_decrypt(ctx, in[i], out[i], inl[i], tag[i],
+                                     taglen));
+        /* Don't reuse the nonce */
+        ctx->iv_set = 0;
+        ctx->len_set = 0;
+        ctx->tag_set = 0;
+        if (!res)
+            ret = 0;
+        if (ok != NULL)
+            ok[i] = res;
+    }
+    return ret;
+}
+
 /* Copy the buffered iv */
 static int ccm_set_iv(PROV_CCM_CTX *ctx, size_t mlen)
 {
@@ -384,6 +384,134 @@ int ossl_gcm_cipher(void *vctx,
     return 1;
 }
 
+/*
+ * Messages up to this length are worth encrypting in interleaved lanes, longer
+ * ones run faster through the stitched single stream code.
+ */
+#define GCM_BATCH_MAX_LEN   1024
+#define GCM_BATCH_CHUNK     32
+
+static int gcm_batch_capable(const PROV_GCM_CTX *ctx)
+{
+    return ctx->ecb != NULL && ctx->ivlen == GCM_IV_DEFAULT_SIZE;
+}
+
+/* Process one message of a batch through the usual hw methods */
+static int gcm_aead_one(PROV_GCM_CTX *ctx, const unsigned char *iv,
+                        const unsigned char *aad, size_t aadlen,
+                        unsigned char *out, const unsigned char *in,
+                        size_t inl, unsigned char *tag, size_t taglen)
+{
+    const PROV_GCM_HW *hw = ctx->hw;
+
+    if (!hw->setiv(ctx, iv, ctx->ivlen)
+        || (aadlen > 0 && !hw->aadupdate(ctx, aad, aadlen))
+        || (inl > 0 && !hw->cipherupdate(ctx, in, inl, out)))
+        return 0;
+
+    if (ctx->enc) {
+        if (!hw->cipherfinal(ctx, ctx->buf))
+            return 0;
+        memcpy(tag, ctx->buf, taglen);
+    } else {
+        ctx->taglen = taglen;
+        if (!hw->cipherfinal(ctx, tag)) {
+            OPENSSL_cleanse(out, inl);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/*
+ * Seal or open |num| independent messages, message i with the key and the
+ * direction of vctx[i] and an IV of that context's IV length. Messages that
+ * share a context with a hardware ECB function and 96-bit IVs go through
+ * ossl_gcm128_crypt_batch() together, the others are processed one at a time.
+ */
+int ossl_gcm_aead_batch(void *vctx[], size_t num, const unsigned char *iv[],
+                        const unsigned char *aad[], const size_t aadlen[],
+                        unsigned char *out[], const unsigned char *in[],
+                        const size_t inl[], unsigned char *tag[],
+                        size_t taglen, int ok[])
+{
+    const unsigned char *b_iv[GCM_BATCH_CHUNK], *b_aad[GCM_BATCH_CHUNK];
+    const unsigned char *b_in[GCM_BATCH_CHUNK];
+    unsigned char *b_out[GCM_BATCH_CHUNK], *b_tag[GCM_BATCH_CHUNK];
+    size_t b_aadlen[GCM_BATCH_CHUNK], b_inl[GCM_BATCH_CHUNK];
+    size_t b_idx[GCM_BATCH_CHUNK];
+    int b_ok[GCM_BATCH_CHUNK], res[GCM_BATCH_CHUNK];
+    unsigned char handled[GCM_BATCH_CHUNK];
+    size_t base, n, i, j, k;
+    int ret = 1;
+
+    if (!ossl_prov_is_running())
+        return 0;
+
+    if (taglen == 0 || taglen > GCM_TAG_MAX_SIZE) {
+        ERR_raise(ERR_LIB_PROV, PROV_R_INVALID_TAG_LENGTH);
+        return 0;
+    }
+
+    for (base = 0; base < num; base += n) {
+        n = num - base < GCM_BATCH_CHUNK ? num - base : GCM_BATCH_CHUNK;
+        memset(handled, 0, n);
+
+        for (i = 0; i < n; i++) {
+            PROV_GCM_CTX *ctx = (PROV_GCM_CTX *)vctx[base + i];
+
+            if (handled[i])
+                continue;
+            handled[i] = 1;
+
+            if (!ctx->key_set || ctx->tls_aad_len != UNINITIALISED_SIZET) {
+                res[i] = 0;
+                continue;
+            }
+            ctx->iv_state = IV_STATE_FINISHED; /* Don't reuse the IV */
+
+            if (!gcm_batch_capable(ctx) || inl[base + i] > GCM_BATCH_MAX_LEN) {
+                res[i] = gcm_aead_one(ctx, iv[base + i], aad[base + i],
+                                      aadlen[base + i], out[base + i],
+                                      in[base + i], inl[base + i],
+                                      tag[base + i], taglen);
+                continue;
+            }
+
+            /* Gather the other short messages that use the same context */
+            for (j = i, k = 0; j < n; j++) {
+                if (vctx[base + j] != ctx
+                    || (j != i
+                        && (handled[j] || inl[base + j] > GCM_BATCH_MAX_LEN)))
+                    continue;
+                handled[j] = 1;
+                b_idx[k] = j;
+                b_iv[k] = iv[base + j];
+                b_aad[k] = aad[base + j];
+                b_aadlen[k] = aadlen[base + j];
+                b_in[k] = in[base + j];
+                b_out[k] = out[base + j];
+                b_inl[k] = inl[base + j];
+                b_tag[k] = tag[base + j];
+                k++;
+            }
+            ossl_gcm128_crypt_batch(&ctx->gcm, ctx->ecb, k, b_iv, b_aad,
+                                    b_aadlen, b_in, b_out, b_inl, b_tag,
+                                    taglen, ctx->enc, b_ok);
+            for (j = 0; j < k; j++)
+                res[b_idx[j]] = b_ok[j];
+        }
+
+        for (i = 0; i < n; i++) {
+            if (!res[i])
+                ret = 0;
+            if (ok != NULL)
+                ok[base + i] = res[i];
+        }
+    }
+    return ret;
+}
+
 /*
  * See SP800-38D (GCM) Section 8 "Uniqueness requirement on IVS and keys"
  *
@@ -1,5 +1,5 @@
 /*
- * Copyright 2019-2023 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2019-2024 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -515,17 +515,51 @@ const OSSL_DISPATCH ossl_##name##_functions[] = {                              \
 #define PROV_FUNC_SHA3_DIGEST(name, bitlen, blksize, dgstsize, flags)          \
     PROV_FUNC_SHA3_DIGEST_COMMON(name, bitlen, blksize, dgstsize, flags),      \
     { OSSL_FUNC_DIGEST_INIT, (void (*)(void))keccak_init },                    \
+    { OSSL_FUNC_DIGEST_BATCH, (void (*)(void))name##_batch },                  \
     PROV_DISPATCH_FUNC_DIGEST_CONSTRUCT_END
 
-#define PROV_FUNC_SHAKE_DIGEST(name, bitlen, blksize, dgstsize, flags)         \
+#define PROV_FUNC_SHAKE_DIGEST_COMMON(name, bitlen, blksize, dgstsize, flags)  \
     PROV_FUNC_SHA3_DIGEST_COMMON(name, bitlen, blksize, dgstsize, flags),      \
     { OSSL_FUNC_DIGEST_SQUEEZE, (void (*)(void))shake_squeeze },               \
     { OSSL_FUNC_DIGEST_INIT, (void (*)(void))keccak_init_params },             \
     { OSSL_FUNC_DIGEST_SET_CTX_PARAMS, (void (*)(void))shake_set_ctx_params }, \
     { OSSL_FUNC_DIGEST_SETTABLE_CTX_PARAMS,                                    \
-     (void (*)(void))shake_settable_ctx_params },                              \
+     (void (*)(void))shake_settable_ctx_params }
+
+#define PROV_FUNC_SHAKE_DIGEST(name, bitlen, blksize, dgstsize, flags)         \
+    PROV_FUNC_SHAKE_DIGEST_COMMON(name, bitlen, blksize, dgstsize, flags),     \
+    { OSSL_FUNC_DIGEST_BATCH, (void (*)(void))name##_batch },                  \
     PROV_DISPATCH_FUNC_DIGEST_CONSTRUCT_END
 
+#define PROV_FUNC_KMAC_DIGEST(name, bitlen, blksize, dgstsize, flags)          \
+    PROV_FUNC_SHAKE_DIGEST_COMMON(name, bitlen, blksize, dgstsize, flags),     \
+    PROV_DISPATCH_FUNC_DIGEST_CONSTRUCT_END
+
+/*
+ * The batch functions hash independent messages in parallel where the
+ * processor allows it. Fixed size digests write |dgstsize| bytes for each
+ * message, SHAKE writes as many as the caller asks for in |outsz|.
+ */
+#define SHA3_batch(name, bitlen, pad, dgstsize)                                \
+static OSSL_FUNC_digest_batch_fn name##_batch;                                 \
+static int name##_batch(void *provctx, size_t num,                             \
+                        const unsigned char *in[], const size_t inl[],         \
+                        unsigned char *out[], size_t outsz)                    \
+{                                                                              \
+    return ossl_prov_is_running() && outsz >= dgstsize                         \
+           && ossl_sha3_batch(pad, bitlen, num, in, inl, out, dgstsize);       \
+}
+
+#define SHAKE_batch(name, bitlen, pad)                                         \
+static OSSL_FUNC_digest_batch_fn name##_batch;                                 \
+static int name##_batch(void *provctx, size_t num,                             \
+                        const unsigned char *in[], const size_t inl[],         \
+                        unsigned char *out[], size_t outsz)                    \
+{                                                                              \
+    return ossl_prov_is_running()                                              \
+           && ossl_sha3_batch(pad, bitlen, num, in, inl, out, outsz);          \
+}
+
 static void keccak_freectx(void *vctx)
 {
     KECCAK1600_CTX *ctx = (KECCAK1600_CTX *)vctx;
@@ -574,26 +608,29 @@ static int shake_set_ctx_params(void *vctx, const OSSL_PARAM params[])
 
 #define IMPLEMENT_SHA3_functions(bitlen)                                       \
     SHA3_newctx(sha3, SHA3_##bitlen, sha3_##bitlen, bitlen, '\x06')            \
+    SHA3_batch(sha3_##bitlen, bitlen, '\x06', SHA3_MDSIZE(bitlen))             \
     PROV_FUNC_SHA3_DIGEST(sha3_##bitlen, bitlen,                               \
                           SHA3_BLOCKSIZE(bitlen), SHA3_MDSIZE(bitlen),         \
                           SHA3_FLAGS)
 
 #define IMPLEMENT_KECCAK_functions(bitlen)                                     \
     SHA3_newctx(keccak, KECCAK_##bitlen, keccak_##bitlen, bitlen, '\x01')      \
+    SHA3_batch(keccak_##bitlen, bitlen, '\x01', SHA3_MDSIZE(bitlen))           \
     PROV_FUNC_SHA3_DIGEST(keccak_##bitlen, bitlen,                             \
                           SHA3_BLOCKSIZE(bitlen), SHA3_MDSIZE(bitlen),         \
                           SHA3_FLAGS)
 
 #define IMPLEMENT_SHAKE_functions(bitlen)                                      \
     SHAKE_newctx(shake, SHAKE_##bitlen, shake_##bitlen, bitlen, '\x1f')        \
+    SHAKE_batch(shake_##bitlen, bitlen, '\x1f')                                \
     PROV_FUNC_SHAKE_DIGEST(shake_##bitlen, bitlen,                             \
                           SHA3_BLOCKSIZE(bitlen), SHA3_MDSIZE(bitlen),         \
                           SHAKE_FLAGS)
 #define IMPLEMENT_KMAC_functions(bitlen)                                       \
     KMAC_newctx(keccak_kmac_##bitlen, bitlen, '\x04')                          \
-    PROV_FUNC_SHAKE_DIGEST(keccak_kmac_##bitlen, bitlen,                       \
-                           SHA3_BLOCKSIZE(bitlen), KMAC_MDSIZE(bitlen),        \
-                           KMAC_FLAGS)
+    PROV_FUNC_KMAC_DIGEST(keccak_kmac_##bitlen, bitlen,                        \
+                          SHA3_BLOCKSIZE(bitlen), KMAC_MDSIZE(bitlen),         \
+                          KMAC_FLAGS)
 
 /* ossl_sha3_224_functions */
 IMPLEMENT_SHA3_functions(224)
@@ -79,6 +79,7 @@ typedef struct prov_gcm_ctx_st {
     const PROV_GCM_HW *hw;  /* hardware specific methods */
     GCM128_CONTEXT gcm;
     ctr128_f ctr;
+    ecb128_f ecb;               /* Set if batches can use interleaved lanes */
 } PROV_GCM_CTX;
 
 PROV_CIPHER_FUNC(int, GCM_setkey, (PROV_GCM_CTX *ctx, const unsigned char *key,
@@ -111,6 +112,7 @@ OSSL_FUNC_cipher_set_ctx_params_fn ossl_gcm_set_ctx_params;
 OSSL_FUNC_cipher_cipher_fn ossl_gcm_cipher;
 OSSL_FUNC_cipher_update_fn ossl_gcm_stream_update;
 OSSL_FUNC_cipher_final_fn ossl_gcm_stream_final;
+OSSL_FUNC_cipher_aead_batch_fn ossl_gcm_aead_batch;
 void ossl_gcm_initctx(void *provctx, PROV_GCM_CTX *ctx, size_t keybits,
                       const PROV_GCM_HW *hw);
 
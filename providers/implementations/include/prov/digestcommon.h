@@ -1,5 +1,5 @@
 /*
- * Copyright 2019-2021 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2019-2024 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -114,6 +114,37 @@ PROV_DISPATCH_FUNC_DIGEST_CONSTRUCT_START(name, CTX, blksize, dgstsize, flags, \
     { OSSL_FUNC_DIGEST_SET_CTX_PARAMS, (void (*)(void))set_ctx_params },       \
 PROV_DISPATCH_FUNC_DIGEST_CONSTRUCT_END
 
+# define PROV_FUNC_DIGEST_BATCH(name, CTX, dgstsize, init, batch)              \
+static OSSL_FUNC_digest_batch_fn name##_batch;                                 \
+static int name##_batch(ossl_unused void *provctx, size_t num,                 \
+                        const unsigned char *in[], const size_t inl[],         \
+                        unsigned char *out[], size_t outsz)                    \
+{                                                                              \
+    CTX ctx;                                                                   \
+    int ret;                                                                   \
+                                                                               \
+    if (!ossl_prov_is_running() || outsz < dgstsize || !init(&ctx))            \
+        return 0;                                                              \
+    ret = batch(&ctx, num, in, inl, out);                                      \
+    OPENSSL_cleanse(&ctx, sizeof(ctx));                                        \
+    return ret;                                                                \
+}
+
+# define IMPLEMENT_digest_functions_with_batch(                                \
+    name, CTX, blksize, dgstsize, flags, init, upd, fin, batch)                \
+static OSSL_FUNC_digest_init_fn name##_internal_init;                          \
+static int name##_internal_init(void *ctx,                                     \
+                                ossl_unused const OSSL_PARAM params[])         \
+{                                                                              \
+    return ossl_prov_is_running() && init(ctx);                                \
+}                                                                              \
+PROV_FUNC_DIGEST_BATCH(name, CTX, dgstsize, init, batch)                       \
+PROV_DISPATCH_FUNC_DIGEST_CONSTRUCT_START(name, CTX, blksize, dgstsize, flags, \
+                                          upd, fin),                           \
+    { OSSL_FUNC_DIGEST_INIT, (void (*)(void))name##_internal_init },           \
+    { OSSL_FUNC_DIGEST_BATCH, (void (*)(void))name##_batch },                  \
+PROV_DISPATCH_FUNC_DIGEST_CONSTRUCT_END
+
 
 const OSSL_PARAM *ossl_digest_default_gettable_params(void *provctx);
 int ossl_digest_default_get_params(OSSL_PARAM params[], size_t blksz,
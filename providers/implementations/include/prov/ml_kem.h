@@ -0,0 +1,39 @@
+/*
+ * Copyright 2024 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+#include <openssl/types.h>
+#include "crypto/ml_kem.h"
+
+#ifndef OPENSSL_NO_ML_KEM
+
+# define ML_KEM_X25519_KEYLEN 32
+
+/*
+ * Key data of ML-KEM-768 and of the X25519MLKEM768 hybrid, which adds an
+ * X25519 key. The hybrid public keys, ciphertexts and shared secrets are
+ * those of ML-KEM-768 followed by the X25519 ones.
+ */
+typedef struct {
+    OSSL_LIB_CTX *libctx;
+    ML_KEM_KEY *key;
+    int hybrid;
+    unsigned char xpub[ML_KEM_X25519_KEYLEN];
+    unsigned char xpriv[ML_KEM_X25519_KEYLEN];
+} PROV_ML_KEM_KEY;
+
+# define ML_KEM_PUBLIC_KEY_BYTES(k) \
+    (ML_KEM_768_PUBLIC_KEY_BYTES + ((k)->hybrid ? ML_KEM_X25519_KEYLEN : 0))
+# define ML_KEM_PRIVATE_KEY_BYTES(k) \
+    (ML_KEM_768_PRIVATE_KEY_BYTES + ((k)->hybrid ? ML_KEM_X25519_KEYLEN : 0))
+# define ML_KEM_CIPHERTEXT_BYTES(k) \
+    (ML_KEM_768_CIPHERTEXT_BYTES + ((k)->hybrid ? ML_KEM_X25519_KEYLEN : 0))
+# define ML_KEM_SECRET_BYTES(k) \
+    (ML_KEM_SHARED_SECRET_BYTES + ((k)->hybrid ? ML_KEM_X25519_KEYLEN : 0))
+
+#endif
@@ -1,5 +1,5 @@
 /*
- * Copyright 2021-2023 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2021-2024 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -330,6 +330,10 @@
 #define PROV_DESCS_ED25519 "OpenSSL ED25519 implementation"
 #define PROV_NAMES_ED448 "ED448:1.3.101.113"
 #define PROV_DESCS_ED448 "OpenSSL ED448 implementation"
+#define PROV_NAMES_ML_KEM_768 "ML-KEM-768:MLKEM768:2.16.840.1.101.3.4.4.2"
+#define PROV_DESCS_ML_KEM_768 "OpenSSL ML-KEM-768 implementation"
+#define PROV_NAMES_X25519MLKEM768 "X25519MLKEM768"
+#define PROV_DESCS_X25519MLKEM768 "OpenSSL X25519MLKEM768 hybrid implementation"
 #define PROV_NAMES_DH "DH:dhKeyAgreement:1.2.840.113549.1.3.1"
 #define PROV_DESCS_DH "OpenSSL PKCS#3 DH implementation"
 #define PROV_NAMES_DHX "DHX:X9.42 DH:dhpublicnumber:1.2.840.10046.2.1"
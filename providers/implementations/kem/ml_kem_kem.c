@@ -0,0 +1,265 @@
+/*
+ * Copyright 2024 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+/*
+ * ML-KEM-768 (FIPS 203) and the X25519MLKEM768 hybrid used by TLS 1.3.
+ * The hybrid concatenates the ML-KEM-768 ciphertext and shared secret with
+ * an ephemeral X25519 public key and the X25519 shared secret.
+ */
+
+#include <string.h>
+#include <openssl/crypto.h>
+#include <openssl/core_dispatch.h>
+#include <openssl/core_names.h>
+#include <openssl/evp.h>
+#include <openssl/params.h>
+#include <openssl/err.h>
+#include <openssl/rand.h>
+#include <openssl/proverr.h>
+#include "crypto/ecx.h"
+#include "prov/provider_ctx.h"
+#include "prov/implementations.h"
+#include "prov/providercommon.h"
+#include "prov/ml_kem.h"
+
+#define ML_KEM_MAX_IKME_BYTES (ML_KEM_ENCAP_SEED_BYTES + ML_KEM_X25519_KEYLEN)
+
+typedef struct {
+    OSSL_LIB_CTX *libctx;
+    PROV_ML_KEM_KEY *key;
+    int op;
+    unsigned char ikme[ML_KEM_MAX_IKME_BYTES];
+    size_t ikmelen;
+} PROV_ML_KEM_CTX;
+
+static OSSL_FUNC_kem_newctx_fn ml_kem_newctx;
+static OSSL_FUNC_kem_freectx_fn ml_kem_freectx;
+static OSSL_FUNC_kem_dupctx_fn ml_kem_dupctx;
+static OSSL_FUNC_kem_encapsulate_init_fn ml_kem_encapsulate_init;
+static OSSL_FUNC_kem_encapsulate_fn ml_kem_encapsulate;
+static OSSL_FUNC_kem_decapsulate_init_fn ml_kem_decapsulate_init;
+static OSSL_FUNC_kem_decapsulate_fn ml_kem_decapsulate;
+static OSSL_FUNC_kem_set_ctx_params_fn ml_kem_set_ctx_params;
+static OSSL_FUNC_kem_settable_ctx_params_fn ml_kem_settable_ctx_params;
+
+static void *ml_kem_newctx(void *provctx)
+{
+    PROV_ML_KEM_CTX *ctx;
+
+    if (!ossl_prov_is_running())
+        return NULL;
+
+    if ((ctx = OPENSSL_zalloc(sizeof(*ctx))) == NULL)
+        return NULL;
+    ctx->libctx = PROV_LIBCTX_OF(provctx);
+    return ctx;
+}
+
+static void ml_kem_freectx(void *vctx)
+{
+    OPENSSL_clear_free(vctx, sizeof(PROV_ML_KEM_CTX));
+}
+
+/*
+ * The key is owned by the EVP_PKEY the operation was started with, which
+ * outlives the context, so a duplicate simply shares it.
+ */
+static void *ml_kem_dupctx(void *vctx)
+{
+    if (!ossl_prov_is_running())
+        return NULL;
+    return OPENSSL_memdup(vctx, sizeof(PROV_ML_KEM_CTX));
+}
+
+static int ml_kem_init(void *vctx, int op, void *vkey,
+                       const OSSL_PARAM params[])
+{
+    PROV_ML_KEM_CTX *ctx = vctx;
+    PROV_ML_KEM_KEY *key = vkey;
+
+    if (!ossl_prov_is_running() || ctx == NULL || key == NULL)
+        return 0;
+
+    if (op == EVP_PKEY_OP_ENCAPSULATE) {
+        if (!ossl_ml_kem_have_pubkey(key->key)) {
+            ERR_raise(ERR_LIB_PROV, PROV_R_NOT_A_PUBLIC_KEY);
+            return 0;
+        }
+    } else if (!ossl_ml_kem_have_prvkey(key->key)) {
+        ERR_raise(ERR_LIB_PROV, PROV_R_NOT_A_PRIVATE_KEY);
+        return 0;
+    }
+    ctx->key = key;
+    ctx->op = op;
+    return ml_kem_set_ctx_params(ctx, params);
+}
+
+static int ml_kem_encapsulate_init(void *vctx, void *vkey,
+                                   const OSSL_PARAM params[])
+{
+    return ml_kem_init(vctx, EVP_PKEY_OP_ENCAPSULATE, vkey, params);
+}
+
+static int ml_kem_decapsulate_init(void *vctx, void *vkey,
+                                   const OSSL_PARAM params[])
+{
+    return ml_kem_init(vctx, EVP_PKEY_OP_DECAPSULATE, vkey, params);
+}
+
+static int ml_kem_set_ctx_params(void *vctx, const OSSL_PARAM params[])
+{
+    PROV_ML_KEM_CTX *ctx = vctx;
+    const OSSL_PARAM *p;
+
+    if (ctx == NULL)
+        return 0;
+    if (params == NULL)
+        return 1;
+
+    p = OSSL_PARAM_locate_const(params, OSSL_KEM_PARAM_IKME);
+    if (p != NULL) {
+        void *vp = ctx->ikme;
+
+        ctx->ikmelen = 0;
+        if (!OSSL_PARAM_get_octet_string(p, &vp, sizeof(ctx->ikme),
+                                         &ctx->ikmelen))
+            return 0;
+    }
+    return 1;
+}
+
+static const OSSL_PARAM known_settable_ml_kem_ctx_params[] = {
+    OSSL_PARAM_octet_string(OSSL_KEM_PARAM_IKME, NULL, 0),
+    OSSL_PARAM_END
+};
+
+static const OSSL_PARAM *ml_kem_settable_ctx_params(ossl_unused void *vctx,
+                                                    ossl_unused void *provctx)
+{
+    return known_settable_ml_kem_ctx_params;
+}
+
+static int ml_kem_encapsulate(void *vctx, unsigned char *out, size_t *outlen,
+                              unsigned char *secret, size_t *secretlen)
+{
+    PROV_ML_KEM_CTX *ctx = vctx;
+    const PROV_ML_KEM_KEY *key = ctx->key;
+    unsigned char seed[ML_KEM_MAX_IKME_BYTES];
+    size_t ctlen = ML_KEM_CIPHERTEXT_BYTES(key);
+    size_t sslen = ML_KEM_SECRET_BYTES(key);
+    size_t seedlen = ML_KEM_ENCAP_SEED_BYTES
+                     + (key->hybrid ? ML_KEM_X25519_KEYLEN : 0);
+    int ret = 0;
+
+    if (out == NULL) {
+        if (outlen == NULL && secretlen == NULL)
+            return 0;
+        if (outlen != NULL)
+            *outlen = ctlen;
+        if (secretlen != NULL)
+            *secretlen = sslen;
+        return 1;
+    }
+    if (secret == NULL || outlen == NULL || secretlen == NULL)
+        return 0;
+    if (*outlen < ctlen || *secretlen < sslen) {
+        ERR_raise(ERR_LIB_PROV, PROV_R_OUTPUT_BUFFER_TOO_SMALL);
+        return 0;
+    }
+
+    if (ctx->ikmelen != 0) {
+        if (ctx->ikmelen != seedlen) {
+            ERR_raise(ERR_LIB_PROV, PROV_R_INVALID_INPUT_LENGTH);
+            return 0;
+        }
+        memcpy(seed, ctx->ikme, seedlen);
+    } else if (RAND_priv_bytes_ex(ctx->libctx, seed, seedlen, 0) <= 0) {
+        return 0;
+    }
+
+    if (!ossl_ml_kem_encap_seed(key->key, seed,
+                                out, ML_KEM_768_CIPHERTEXT_BYTES,
+                                secret, ML_KEM_SHARED_SECRET_BYTES))
+        goto err;
+#ifndef OPENSSL_NO_ECX
+    if (key->hybrid) {
+        const unsigned char *xpriv = seed + ML_KEM_ENCAP_SEED_BYTES;
+
+        ossl_x25519_public_from_private(out + ML_KEM_768_CIPHERTEXT_BYTES,
+                                        xpriv);
+        if (!ossl_x25519(secret + ML_KEM_SHARED_SECRET_BYTES, xpriv,
+                         key->xpub)) {
+            ERR_raise(ERR_LIB_PROV, PROV_R_FAILED_DURING_DERIVATION);
+            OPENSSL_cleanse(secret, sslen);
+            goto err;
+        }
+    }
+#endif
+    *outlen = ctlen;
+    *secretlen = sslen;
+    ret = 1;
+ err:
+    OPENSSL_cleanse(seed, sizeof(seed));
+    return ret;
+}
+
+static int ml_kem_decapsulate(void *vctx, unsigned char *out, size_t *outlen,
+                              const unsigned char *in, size_t inlen)
+{
+    PROV_ML_KEM_CTX *ctx = vctx;
+    const PROV_ML_KEM_KEY *key = ctx->key;
+    size_t sslen = ML_KEM_SECRET_BYTES(key);
+
+    if (outlen == NULL)
+        return 0;
+    if (out == NULL) {
+        *outlen = sslen;
+        return 1;
+    }
+    if (*outlen < sslen) {
+        ERR_raise(ERR_LIB_PROV, PROV_R_OUTPUT_BUFFER_TOO_SMALL);
+        return 0;
+    }
+    if (inlen != ML_KEM_CIPHERTEXT_BYTES(key)) {
+        ERR_raise(ERR_LIB_PROV, PROV_R_INVALID_INPUT_LENGTH);
+        return 0;
+    }
+
+    if (!ossl_ml_kem_decap(key->key, in, ML_KEM_768_CIPHERTEXT_BYTES,
+                           out, ML_KEM_SHARED_SECRET_BYTES))
+        return 0;
+#ifndef OPENSSL_NO_ECX
+    if (key->hybrid
+            && !ossl_x25519(out + ML_KEM_SHARED_SECRET_BYTES, key->xpriv,
+                            in + ML_KEM_768_CIPHERTEXT_BYTES)) {
+        ERR_raise(ERR_LIB_PROV, PROV_R_FAILED_DURING_DERIVATION);
+        OPENSSL_cleanse(out, sslen);
+        return 0;
+    }
+#endif
+    *outlen = sslen;
+    return 1;
+}
+
+const OSSL_DISPATCH ossl_ml_kem_768_asym_kem_functions[] = {
+    { OSSL_FUNC_KEM_NEWCTX, (void (*)(void))ml_kem_newctx },
+    { OSSL_FUNC_KEM_ENCAPSULATE_INIT,
+      (void (*)(void))ml_kem_encapsulate_init },
+    { OSSL_FUNC_KEM_ENCAPSULATE, (void (*)(void))ml_kem_encapsulate },
+    { OSSL_FUNC_KEM_DECAPSULATE_INIT,
+      (void (*)(void))ml_kem_decapsulate_init },
+    { OSSL_FUNC_KEM_DECAPSULATE, (void (*)(void))ml_kem_decapsulate },
+    { OSSL_FUNC_KEM_FREECTX, (void (*)(void))ml_kem_freectx },
+    { OSSL_FUNC_KEM_DUPCTX, (void (*)(void))ml_kem_dupctx },
+    { OSSL_FUNC_KEM_SET_CTX_PARAMS,
+      (void (*)(void))ml_kem_set_ctx_params },
+    { OSSL_FUNC_KEM_SETTABLE_CTX_PARAMS,
+      (void (*)(void))ml_kem_settable_ctx_params },
+    OSSL_DISPATCH_END
+};
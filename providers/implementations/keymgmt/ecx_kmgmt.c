@@ -331,6 +331,12 @@ static int x448_get_params(void *key, OSSL_PARAM params[])
 
 static int ed25519_get_params(void *key, OSSL_PARAM params[])
 {
+    ECX_KEY *ecx = key;
+    OSSL_PARAM *p;
+
+    if ((p = OSSL_PARAM_locate(params, OSSL_PKEY_PARAM_PRECOMPUTE)) != NULL
+        && !OSSL_PARAM_set_int(p, ecx->precomp != NULL))
+        return 0;
     return ecx_get_params(key, params, ED25519_BITS, ED25519_SECURITY_BITS,
                           ED25519_SIGSIZE)
         && ed_get_params(key, params);
@@ -371,9 +377,18 @@ static const OSSL_PARAM *x448_gettable_params(void *provctx)
     return ecx_gettable_params;
 }
 
+static const OSSL_PARAM ed25519_gettable_params_list[] = {
+    OSSL_PARAM_int(OSSL_PKEY_PARAM_BITS, NULL),
+    OSSL_PARAM_int(OSSL_PKEY_PARAM_SECURITY_BITS, NULL),
+    OSSL_PARAM_int(OSSL_PKEY_PARAM_MAX_SIZE, NULL),
+    OSSL_PARAM_int(OSSL_PKEY_PARAM_PRECOMPUTE, NULL),
+    ECX_KEY_TYPES(),
+    OSSL_PARAM_END
+};
+
 static const OSSL_PARAM *ed25519_gettable_params(void *provctx)
 {
-    return ed_gettable_params;
+    return ed25519_gettable_params_list;
 }
 
 static const OSSL_PARAM *ed448_gettable_params(void *provctx)
@@ -435,6 +450,32 @@ static int x448_set_params(void *key, const OSSL_PARAM params[])
 
 static int ed25519_set_params(void *key, const OSSL_PARAM params[])
 {
+    ECX_KEY *ecxkey = key;
+    const OSSL_PARAM *p;
+    int precompute;
+
+    if (params == NULL)
+        return 1;
+
+    p = OSSL_PARAM_locate_const(params, OSSL_PKEY_PARAM_PRECOMPUTE);
+    if (p != NULL) {
+        if (!OSSL_PARAM_get_int(p, &precompute))
+            return 0;
+        if (!precompute) {
+            ossl_ed25519_precomp_free(ecxkey->precomp);
+            ecxkey->precomp = NULL;
+        } else if (ecxkey->precomp == NULL) {
+            if (!ecxkey->haspubkey) {
+                ERR_raise(ERR_LIB_PROV, PROV_R_NOT_A_PUBLIC_KEY);
+                return 0;
+            }
+            ecxkey->precomp = ossl_ed25519_precomp_new(ecxkey->pubkey);
+            if (ecxkey->precomp == NULL) {
+                ERR_raise(ERR_LIB_PROV, PROV_R_INVALID_KEY);
+                return 0;
+            }
+        }
+    }
     return 1;
 }
 
@@ -463,9 +504,14 @@ static const OSSL_PARAM *x448_settable_params(void *provctx)
     return ecx_settable_params;
 }
 
+static const OSSL_PARAM ed25519_settable_params_list[] = {
+    OSSL_PARAM_int(OSSL_PKEY_PARAM_PRECOMPUTE, NULL),
+    OSSL_PARAM_END
+};
+
 static const OSSL_PARAM *ed25519_settable_params(void *provctx)
 {
-    return ed_settable_params;
+    return ed25519_settable_params_list;
 }
 
 static const OSSL_PARAM *ed448_settable_params(void *provctx)
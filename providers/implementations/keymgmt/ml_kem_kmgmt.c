@@ -0,0 +1,589 @@
+/*
+ * Copyright 2024 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+#include <string.h>
+#include <openssl/core_dispatch.h>
+#include <openssl/core_names.h>
+#include <openssl/params.h>
+#include <openssl/err.h>
+#include <openssl/proverr.h>
+#include <openssl/rand.h>
+#include "internal/param_build_set.h"
+#include <openssl/param_build.h>
+#include "crypto/ecx.h"
+#include "prov/implementations.h"
+#include "prov/providercommon.h"
+#include "prov/provider_ctx.h"
+#include "prov/ml_kem.h"
+
+static OSSL_FUNC_keymgmt_new_fn ml_kem_768_new_key;
+static OSSL_FUNC_keymgmt_free_fn ml_kem_free_key;
+static OSSL_FUNC_keymgmt_gen_init_fn ml_kem_768_gen_init;
+static OSSL_FUNC_keymgmt_gen_set_params_fn ml_kem_gen_set_params;
+static OSSL_FUNC_keymgmt_gen_settable_params_fn ml_kem_gen_settable_params;
+static OSSL_FUNC_keymgmt_gen_fn ml_kem_gen;
+static OSSL_FUNC_keymgmt_gen_cleanup_fn ml_kem_gen_cleanup;
+static OSSL_FUNC_keymgmt_get_params_fn ml_kem_get_params;
+static OSSL_FUNC_keymgmt_gettable_params_fn ml_kem_gettable_params;
+static OSSL_FUNC_keymgmt_set_params_fn ml_kem_set_params;
+static OSSL_FUNC_keymgmt_settable_params_fn ml_kem_settable_params;
+static OSSL_FUNC_keymgmt_has_fn ml_kem_has;
+static OSSL_FUNC_keymgmt_match_fn ml_kem_match;
+static OSSL_FUNC_keymgmt_import_fn ml_kem_import;
+static OSSL_FUNC_keymgmt_import_types_fn ml_kem_imexport_types;
+static OSSL_FUNC_keymgmt_export_fn ml_kem_export;
+static OSSL_FUNC_keymgmt_export_types_fn ml_kem_imexport_types;
+static OSSL_FUNC_keymgmt_dup_fn ml_kem_dup;
+#ifndef OPENSSL_NO_ECX
+static OSSL_FUNC_keymgmt_new_fn x25519_ml_kem_768_new_key;
+static OSSL_FUNC_keymgmt_gen_init_fn x25519_ml_kem_768_gen_init;
+#endif
+
+struct ml_kem_gen_ctx {
+    OSSL_LIB_CTX *libctx;
+    int selection;
+    int hybrid;
+    unsigned char seed[ML_KEM_SEED_BYTES + ML_KEM_X25519_KEYLEN];
+    size_t seedlen;
+};
+
+static PROV_ML_KEM_KEY *ml_kem_key_new(OSSL_LIB_CTX *libctx, int hybrid)
+{
+    PROV_ML_KEM_KEY *key;
+
+    if ((key = OPENSSL_zalloc(sizeof(*key))) == NULL)
+        return NULL;
+    if ((key->key = ossl_ml_kem_key_new()) == NULL) {
+        OPENSSL_free(key);
+        return NULL;
+    }
+    key->libctx = libctx;
+    key->hybrid = hybrid;
+    return key;
+}
+
+static void *ml_kem_768_new_key(void *provctx)
+{
+    if (!ossl_prov_is_running())
+        return NULL;
+    return ml_kem_key_new(PROV_LIBCTX_OF(provctx), 0);
+}
+
+#ifndef OPENSSL_NO_ECX
+static void *x25519_ml_kem_768_new_key(void *provctx)
+{
+    if (!ossl_prov_is_running())
+        return NULL;
+    return ml_kem_key_new(PROV_LIBCTX_OF(provctx), 1);
+}
+#endif
+
+static void ml_kem_free_key(void *keydata)
+{
+    PROV_ML_KEM_KEY *key = keydata;
+
+    if (key == NULL)
+        return;
+    ossl_ml_kem_key_free(key->key);
+    OPENSSL_clear_free(key, sizeof(*key));
+}
+
+static int ml_kem_has(const void *keydata, int selection)
+{
+    const PROV_ML_KEM_KEY *key = keydata;
+    int ok = 0;
+
+    if (ossl_prov_is_running() && key != NULL) {
+        /* ML-KEM keys have no domain parameters beyond their type */
+        ok = 1;
+
+        if ((selection & OSSL_KEYMGMT_SELECT_PUBLIC_KEY) != 0)
+            ok = ok && ossl_ml_kem_have_pubkey(key->key);
+
+        if ((selection & OSSL_KEYMGMT_SELECT_PRIVATE_KEY) != 0)
+            ok = ok && ossl_ml_kem_have_prvkey(key->key);
+    }
+    return ok;
+}
+
+static int ml_kem_match(const void *keydata1, const void *keydata2,
+                        int selection)
+{
+    const PROV_ML_KEM_KEY *key1 = keydata1;
+    const PROV_ML_KEM_KEY *key2 = keydata2;
+
+    if (!ossl_prov_is_running())
+        return 0;
+
+    if (key1->hybrid != key2->hybrid)
+        return 0;
+
+    /*
+     * The public key is always present alongside the private one and is
+     * fully determined by it, so comparing public keys covers both.
+     */
+    if ((selection & OSSL_KEYMGMT_SELECT_KEYPAIR) != 0) {
+        if (!ossl_ml_kem_have_pubkey(key1->key)
+                || !ossl_ml_kem_have_pubkey(key2->key)
+                || !ossl_ml_kem_pubkey_cmp(key1->key, key2->key))
+            return 0;
+        if (key1->hybrid
+                && CRYPTO_memcmp(key1->xpub, key2->xpub,
+                                 ML_KEM_X25519_KEYLEN) != 0)
+            return 0;
+    }
+    return 1;
+}
+
+static int ml_kem_set_public(PROV_ML_KEM_KEY *key,
+                             const unsigned char *in, size_t inlen)
+{
+    if (inlen != ML_KEM_PUBLIC_KEY_BYTES(key)
+            || !ossl_ml_kem_parse_public_key(key->key, in,
+                                             ML_KEM_768_PUBLIC_KEY_BYTES)) {
+        ERR_raise(ERR_LIB_PROV, PROV_R_INVALID_KEY);
+        return 0;
+    }
+    OPENSSL_cleanse(key->xpriv, sizeof(key->xpriv));
+    if (key->hybrid)
+        memcpy(key->xpub, in + ML_KEM_768_PUBLIC_KEY_BYTES,
+               ML_KEM_X25519_KEYLEN);
+    return 1;
+}
+
+static int ml_kem_set_private(PROV_ML_KEM_KEY *key,
+                              const unsigned char *in, size_t inlen)
+{
+    if (inlen != ML_KEM_PRIVATE_KEY_BYTES(key)
+            || !ossl_ml_kem_parse_private_key(key->key, in,
+                                              ML_KEM_768_PRIVATE_KEY_BYTES)) {
+        ERR_raise(ERR_LIB_PROV, PROV_R_INVALID_KEY);
+        return 0;
+    }
+#ifndef OPENSSL_NO_ECX
+    if (key->hybrid) {
+        memcpy(key->xpriv, in + ML_KEM_768_PRIVATE_KEY_BYTES,
+               ML_KEM_X25519_KEYLEN);
+        ossl_x25519_public_from_private(key->xpub, key->xpriv);
+    }
+#endif
+    return 1;
+}
+
+static int ml_kem_get_public(const PROV_ML_KEM_KEY *key,
+                             unsigned char *out, size_t outlen)
+{
+    if (outlen != ML_KEM_PUBLIC_KEY_BYTES(key)
+            || !ossl_ml_kem_encode_public_key(key->key, out,
+                                              ML_KEM_768_PUBLIC_KEY_BYTES))
+        return 0;
+    if (key->hybrid)
+        memcpy(out + ML_KEM_768_PUBLIC_KEY_BYTES, key->xpub,
+               ML_KEM_X25519_KEYLEN);
+    return 1;
+}
+
+static int ml_kem_get_private(const PROV_ML_KEM_KEY *key,
+                              unsigned char *out, size_t outlen)
+{
+    if (outlen != ML_KEM_PRIVATE_KEY_BYTES(key)
+            || !ossl_ml_kem_encode_private_key(key->key, out,
+                                               ML_KEM_768_PRIVATE_KEY_BYTES))
+        return 0;
+    if (key->hybrid)
+        memcpy(out + ML_KEM_768_PRIVATE_KEY_BYTES, key->xpriv,
+               ML_KEM_X25519_KEYLEN);
+    return 1;
+}
+
+static int ml_kem_import(void *keydata, int selection,
+                         const OSSL_PARAM params[])
+{
+    PROV_ML_KEM_KEY *key = keydata;
+    const OSSL_PARAM *pub, *priv;
+
+    if (!ossl_prov_is_running() || key == NULL)
+        return 0;
+
+    if ((selection & OSSL_KEYMGMT_SELECT_KEYPAIR) == 0)
+        return 0;
+
+    pub = OSSL_PARAM_locate_const(params, OSSL_PKEY_PARAM_PUB_KEY);
+    priv = OSSL_PARAM_locate_const(params, OSSL_PKEY_PARAM_PRIV_KEY);
+
+    if (priv != NULL
+            && (selection & OSSL_KEYMGMT_SELECT_PRIVATE_KEY) != 0) {
+        if (priv->data_type != OSSL_PARAM_OCTET_STRING
+                || !ml_kem_set_private(key, priv->data, priv->data_size))
+            return 0;
+        /* Any public key given must match the one in the private key */
+        if (pub != NULL) {
+            unsigned char buf[ML_KEM_768_PUBLIC_KEY_BYTES
+                              + ML_KEM_X25519_KEYLEN];
+
+            if (pub->data_type != OSSL_PARAM_OCTET_STRING
+                    || pub->data_size != ML_KEM_PUBLIC_KEY_BYTES(key)
+                    || !ml_kem_get_public(key, buf, pub->data_size)
+                    || memcmp(buf, pub->data, pub->data_size) != 0) {
+                ERR_raise(ERR_LIB_PROV, PROV_R_INVALID_KEY);
+                return 0;
+            }
+        }
+        return 1;
+    }
+    if (pub == NULL || pub->data_type != OSSL_PARAM_OCTET_STRING)
+        return 0;
+    return ml_kem_set_public(key, pub->data, pub->data_size);
+}
+
+static int key_to_params(const PROV_ML_KEM_KEY *key, OSSL_PARAM_BLD *tmpl,
+                         OSSL_PARAM params[], int include_private)
+{
+    unsigned char *buf;
+    size_t len;
+    int ret = 0;
+
+    if (key == NULL)
+        return 0;
+
+    len = ML_KEM_PRIVATE_KEY_BYTES(key);
+    if ((buf = OPENSSL_secure_malloc(len)) == NULL)
+        return 0;
+
+    if (ossl_ml_kem_have_pubkey(key->key)) {
+        len = ML_KEM_PUBLIC_KEY_BYTES(key);
+        if (!ml_kem_get_public(key, buf, len)
+                || !ossl_param_build_set_octet_string(tmpl, params,
+                                                      OSSL_PKEY_PARAM_PUB_KEY,
+                                                      buf, len))
+            goto err;
+    }
+    if (include_private && ossl_ml_kem_have_prvkey(key->key)) {
+        len = ML_KEM_PRIVATE_KEY_BYTES(key);
+        if (!ml_kem_get_private(key, buf, len)
+                || !ossl_param_build_set_octet_string(tmpl, params,
+                                                      OSSL_PKEY_PARAM_PRIV_KEY,
+                                                      buf, len))
+            goto err;
+    }
+    ret = 1;
+ err:
+    OPENSSL_secure_clear_free(buf, ML_KEM_PRIVATE_KEY_BYTES(key));
+    return ret;
+}
+
+static int ml_kem_export(void *keydata, int selection, OSSL_CALLBACK *param_cb,
+                         void *cbarg)
+{
+    PROV_ML_KEM_KEY *key = keydata;
+    OSSL_PARAM_BLD *tmpl;
+    OSSL_PARAM *params = NULL;
+    int ret = 0;
+
+    if (!ossl_prov_is_running() || key == NULL)
+        return 0;
+
+    if ((selection & OSSL_KEYMGMT_SELECT_KEYPAIR) == 0)
+        return 0;
+
+    tmpl = OSSL_PARAM_BLD_new();
+    if (tmpl == NULL)
+        return 0;
+
+    if (!key_to_params(key, tmpl, NULL,
+                       (selection & OSSL_KEYMGMT_SELECT_PRIVATE_KEY) != 0))
+        goto err;
+
+    params = OSSL_PARAM_BLD_to_param(tmpl);
+    if (params == NULL)
+        goto err;
+
+    ret = param_cb(params, cbarg);
+    OSSL_PARAM_free(params);
+ err:
+    OSSL_PARAM_BLD_free(tmpl);
+    return ret;
+}
+
+#define ML_KEM_KEY_TYPES()                                      \
+OSSL_PARAM_octet_string(OSSL_PKEY_PARAM_PUB_KEY, NULL, 0),      \
+OSSL_PARAM_octet_string(OSSL_PKEY_PARAM_PRIV_KEY, NULL, 0)
+
+static const OSSL_PARAM ml_kem_key_types[] = {
+    ML_KEM_KEY_TYPES(),
+    OSSL_PARAM_END
+};
+
+static const OSSL_PARAM *ml_kem_imexport_types(int selection)
+{
+    if ((selection & OSSL_KEYMGMT_SELECT_KEYPAIR) != 0)
+        return ml_kem_key_types;
+    return NULL;
+}
+
+static int ml_kem_get_params(void *keydata, OSSL_PARAM params[])
+{
+    PROV_ML_KEM_KEY *key = keydata;
+    OSSL_PARAM *p;
+
+    if ((p = OSSL_PARAM_locate(params, OSSL_PKEY_PARAM_BITS)) != NULL
+        && !OSSL_PARAM_set_int(p, ML_KEM_768_BITS))
+        return 0;
+    if ((p = OSSL_PARAM_locate(params, OSSL_PKEY_PARAM_SECURITY_BITS)) != NULL
+        && !OSSL_PARAM_set_int(p, ML_KEM_768_SECURITY_BITS))
+        return 0;
+    if ((p = OSSL_PARAM_locate(params, OSSL_PKEY_PARAM_MAX_SIZE)) != NULL
+        && !OSSL_PARAM_set_size_t(p, ML_KEM_CIPHERTEXT_BYTES(key)))
+        return 0;
+    if ((p = OSSL_PARAM_locate(params,
+                               OSSL_PKEY_PARAM_ENCODED_PUBLIC_KEY)) != NULL) {
+        if (p->data_type != OSSL_PARAM_OCTET_STRING)
+            return 0;
+        p->return_size = ML_KEM_PUBLIC_KEY_BYTES(key);
+        if (p->data != NULL) {
+            if (p->data_size < p->return_size
+                    || !ml_kem_get_public(key, p->data, p->return_size))
+                return 0;
+        }
+    }
+    return key_to_params(key, NULL, params, 1);
+}
+
+static const OSSL_PARAM ml_kem_gettable_params_list[] = {
+    OSSL_PARAM_int(OSSL_PKEY_PARAM_BITS, NULL),
+    OSSL_PARAM_int(OSSL_PKEY_PARAM_SECURITY_BITS, NULL),
+    OSSL_PARAM_size_t(OSSL_PKEY_PARAM_MAX_SIZE, NULL),
+    OSSL_PARAM_octet_string(OSSL_PKEY_PARAM_ENCODED_PUBLIC_KEY, NULL, 0),
+    ML_KEM_KEY_TYPES(),
+    OSSL_PARAM_END
+};
+
+static const OSSL_PARAM *ml_kem_gettable_params(void *provctx)
+{
+    return ml_kem_gettable_params_list;
+}
+
+static int ml_kem_set_params(void *keydata, const OSSL_PARAM params[])
+{
+    PROV_ML_KEM_KEY *key = keydata;
+    const OSSL_PARAM *p;
+
+    p = OSSL_PARAM_locate_const(params, OSSL_PKEY_PARAM_ENCODED_PUBLIC_KEY);
+    if (p != NULL) {
+        if (p->data_type != OSSL_PARAM_OCTET_STRING
+                || !ml_kem_set_public(key, p->data, p->data_size))
+            return 0;
+    }
+    return 1;
+}
+
+static const OSSL_PARAM ml_kem_settable_params_list[] = {
+    OSSL_PARAM_octet_string(OSSL_PKEY_PARAM_ENCODED_PUBLIC_KEY, NULL, 0),
+    OSSL_PARAM_END
+};
+
+static const OSSL_PARAM *ml_kem_settable_params(void *provctx)
+{
+    return ml_kem_settable_params_list;
+}
+
+static void *ml_kem_gen_init_int(void *provctx, int selection,
+                                 const OSSL_PARAM params[], int hybrid)
+{
+    struct ml_kem_gen_ctx *gctx = NULL;
+
+    if (!ossl_prov_is_running())
+        return NULL;
+
+    if ((gctx = OPENSSL_zalloc(sizeof(*gctx))) != NULL) {
+        gctx->libctx = PROV_LIBCTX_OF(provctx);
+        gctx->selection = selection;
+        gctx->hybrid = hybrid;
+    }
+    if (!ml_kem_gen_set_params(gctx, params)) {
+        ml_kem_gen_cleanup(gctx);
+        gctx = NULL;
+    }
+    return gctx;
+}
+
+static void *ml_kem_768_gen_init(void *provctx, int selection,
+                                 const OSSL_PARAM params[])
+{
+    return ml_kem_gen_init_int(provctx, selection, params, 0);
+}
+
+#ifndef OPENSSL_NO_ECX
+static void *x25519_ml_kem_768_gen_init(void *provctx, int selection,
+                                        const OSSL_PARAM params[])
+{
+    return ml_kem_gen_init_int(provctx, selection, params, 1);
+}
+#endif
+
+static int ml_kem_gen_set_params(void *genctx, const OSSL_PARAM params[])
+{
+    struct ml_kem_gen_ctx *gctx = genctx;
+    const OSSL_PARAM *p;
+
+    if (gctx == NULL)
+        return 0;
+
+    p = OSSL_PARAM_locate_const(params, OSSL_PKEY_PARAM_GROUP_NAME);
+    if (p != NULL) {
+        /*
+         * As with X25519 we allow setting a group name, but only to the one
+         * (TLS or algorithm) name the key type supports.
+         */
+        if (p->data_type != OSSL_PARAM_UTF8_STRING
+                || (gctx->hybrid
+                    ? OPENSSL_strcasecmp(p->data, "X25519MLKEM768") != 0
+                    : (OPENSSL_strcasecmp(p->data, "ML-KEM-768") != 0
+                       && OPENSSL_strcasecmp(p->data, "MLKEM768") != 0))) {
+            ERR_raise(ERR_LIB_PROV, ERR_R_PASSED_INVALID_ARGUMENT);
+            return 0;
+        }
+    }
+    p = OSSL_PARAM_locate_const(params, OSSL_PKEY_PARAM_ML_KEM_SEED);
+    if (p != NULL) {
+        void *vp = gctx->seed;
+        size_t expected = ML_KEM_SEED_BYTES
+                          + (gctx->hybrid ? ML_KEM_X25519_KEYLEN : 0);
+
+        if (!OSSL_PARAM_get_octet_string(p, &vp, sizeof(gctx->seed),
+                                         &gctx->seedlen)
+                || gctx->seedlen != expected) {
+            gctx->seedlen = 0;
+            ERR_raise(ERR_LIB_PROV, PROV_R_INVALID_SEED_LENGTH);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static const OSSL_PARAM *ml_kem_gen_settable_params(ossl_unused void *genctx,
+                                                    ossl_unused void *provctx)
+{
+    static OSSL_PARAM settable[] = {
+        OSSL_PARAM_utf8_string(OSSL_PKEY_PARAM_GROUP_NAME, NULL, 0),
+        OSSL_PARAM_octet_string(OSSL_PKEY_PARAM_ML_KEM_SEED, NULL, 0),
+        OSSL_PARAM_END
+    };
+    return settable;
+}
+
+static void *ml_kem_gen(void *genctx, OSSL_CALLBACK *osslcb, void *cbarg)
+{
+    struct ml_kem_gen_ctx *gctx = genctx;
+    PROV_ML_KEM_KEY *key;
+    unsigned char seed[ML_KEM_SEED_BYTES + ML_KEM_X25519_KEYLEN];
+    size_t seedlen;
+
+    if (!ossl_prov_is_running() || gctx == NULL)
+        return NULL;
+
+    if ((key = ml_kem_key_new(gctx->libctx, gctx->hybrid)) == NULL)
+        return NULL;
+
+    /* If we're doing parameter generation then we just return a blank key */
+    if ((gctx->selection & OSSL_KEYMGMT_SELECT_KEYPAIR) == 0)
+        return key;
+
+    seedlen = ML_KEM_SEED_BYTES + (gctx->hybrid ? ML_KEM_X25519_KEYLEN : 0);
+    if (gctx->seedlen != 0)
+        memcpy(seed, gctx->seed, seedlen);
+    else if (RAND_priv_bytes_ex(gctx->libctx, seed, seedlen, 0) <= 0)
+        goto err;
+
+    if (!ossl_ml_kem_genkey(key->key, seed))
+        goto err;
+#ifndef OPENSSL_NO_ECX
+    if (key->hybrid) {
+        memcpy(key->xpriv, seed + ML_KEM_SEED_BYTES, ML_KEM_X25519_KEYLEN);
+        ossl_x25519_public_from_private(key->xpub, key->xpriv);
+    }
+#endif
+    OPENSSL_cleanse(seed, sizeof(seed));
+    return key;
+ err:
+    OPENSSL_cleanse(seed, sizeof(seed));
+    ml_kem_free_key(key);
+    return NULL;
+}
+
+static void ml_kem_gen_cleanup(void *genctx)
+{
+    OPENSSL_clear_free(genctx, sizeof(struct ml_kem_gen_ctx));
+}
+
+static void *ml_kem_dup(const void *keydata_from, int selection)
+{
+    const PROV_ML_KEM_KEY *from = keydata_from;
+    PROV_ML_KEM_KEY *key;
+    unsigned char buf[ML_KEM_768_PUBLIC_KEY_BYTES + ML_KEM_X25519_KEYLEN];
+
+    if (!ossl_prov_is_running())
+        return NULL;
+
+    if ((selection & OSSL_KEYMGMT_SELECT_PRIVATE_KEY) != 0) {
+        if ((key = OPENSSL_memdup(from, sizeof(*from))) == NULL)
+            return NULL;
+        if ((key->key = ossl_ml_kem_key_dup(from->key)) == NULL) {
+            OPENSSL_clear_free(key, sizeof(*key));
+            return NULL;
+        }
+        return key;
+    }
+
+    if ((key = ml_kem_key_new(from->libctx, from->hybrid)) == NULL)
+        return NULL;
+    if ((selection & OSSL_KEYMGMT_SELECT_PUBLIC_KEY) != 0
+            && ossl_ml_kem_have_pubkey(from->key)
+            && (!ml_kem_get_public(from, buf, ML_KEM_PUBLIC_KEY_BYTES(from))
+                || !ml_kem_set_public(key, buf,
+                                      ML_KEM_PUBLIC_KEY_BYTES(from)))) {
+        ml_kem_free_key(key);
+        return NULL;
+    }
+    return key;
+}
+
+#define MAKE_KEYMGMT_FUNCTIONS(alg) \
+    const OSSL_DISPATCH ossl_##alg##_keymgmt_functions[] = { \
+        { OSSL_FUNC_KEYMGMT_NEW, (void (*)(void))alg##_new_key }, \
+        { OSSL_FUNC_KEYMGMT_FREE, (void (*)(void))ml_kem_free_key }, \
+        { OSSL_FUNC_KEYMGMT_GET_PARAMS, (void (*)(void))ml_kem_get_params }, \
+        { OSSL_FUNC_KEYMGMT_GETTABLE_PARAMS, \
+          (void (*)(void))ml_kem_gettable_params }, \
+        { OSSL_FUNC_KEYMGMT_SET_PARAMS, (void (*)(void))ml_kem_set_params }, \
+        { OSSL_FUNC_KEYMGMT_SETTABLE_PARAMS, \
+          (void (*)(void))ml_kem_settable_params }, \
+        { OSSL_FUNC_KEYMGMT_HAS, (void (*)(void))ml_kem_has }, \
+        { OSSL_FUNC_KEYMGMT_MATCH, (void (*)(void))ml_kem_match }, \
+        { OSSL_FUNC_KEYMGMT_IMPORT, (void (*)(void))ml_kem_import }, \
+        { OSSL_FUNC_KEYMGMT_IMPORT_TYPES, \
+          (void (*)(void))ml_kem_imexport_types }, \
+        { OSSL_FUNC_KEYMGMT_EXPORT, (void (*)(void))ml_kem_export }, \
+        { OSSL_FUNC_KEYMGMT_EXPORT_TYPES, \
+          (void (*)(void))ml_kem_imexport_types }, \
+        { OSSL_FUNC_KEYMGMT_GEN_INIT, (void (*)(void))alg##_gen_init }, \
+        { OSSL_FUNC_KEYMGMT_GEN_SET_PARAMS, \
+          (void (*)(void))ml_kem_gen_set_params }, \
+        { OSSL_FUNC_KEYMGMT_GEN_SETTABLE_PARAMS, \
+          (void (*)(void))ml_kem_gen_settable_params }, \
+        { OSSL_FUNC_KEYMGMT_GEN, (void (*)(void))ml_kem_gen }, \
+        { OSSL_FUNC_KEYMGMT_GEN_CLEANUP, (void (*)(void))ml_kem_gen_cleanup }, \
+        { OSSL_FUNC_KEYMGMT_DUP, (void (*)(void))ml_kem_dup }, \
+        OSSL_DISPATCH_END \
+    };
+
+MAKE_KEYMGMT_FUNCTIONS(ml_kem_768)
+#ifndef OPENSSL_NO_ECX
+MAKE_KEYMGMT_FUNCTIONS(x25519_ml_kem_768)
+#endif
@@ -281,7 +281,7 @@ int ed25519_digest_sign(void *vpeddsactx, unsigned char *sigret,
     }
 
     if (ossl_ed25519_sign(sigret, tbs, tbslen, edkey->pubkey, edkey->privkey,
-            peddsactx->dom2_flag, peddsactx->prehash_flag, peddsactx->context_string_flag,
+            edkey->precomp, peddsactx->dom2_flag, peddsactx->prehash_flag, peddsactx->context_string_flag,
             peddsactx->context_string, peddsactx->context_string_len,
             peddsactx->libctx, NULL) == 0) {
         ERR_raise(ERR_LIB_PROV, PROV_R_FAILED_TO_SIGN);
@@ -407,7 +407,7 @@ int ed25519_digest_verify(void *vpeddsactx, const unsigned char *sig,
     }
 
     return ossl_ed25519_verify(tbs, tbslen, sig, edkey->pubkey,
-                               peddsactx->dom2_flag, peddsactx->prehash_flag, peddsactx->context_string_flag,
+                               edkey->precomp, peddsactx->dom2_flag, peddsactx->prehash_flag, peddsactx->context_string_flag,
                                peddsactx->context_string, peddsactx->context_string_len,
                                peddsactx->libctx, edkey->propq);
 }
@@ -46,6 +46,25 @@ static ossl_inline unsigned char *txe_data(const TXE *e)
     return (unsigned char *)(e + 1);
 }
 
+/*
+ * QTX_SEAL
+ * ========
+ * Packets are serialized with their payload in plaintext and sealed later,
+ * several at a time, so that the AEAD implementation can process them
+ * together. A QTX_SEAL records what is needed to seal one such packet. All
+ * positions are offsets into the data of the TXE, as TXEs can be reallocated.
+ */
+typedef struct qtx_seal_st {
+    TXE                 *txe;
+    OSSL_QRL_ENC_LEVEL  *el;
+    unsigned char       nonce[EVP_MAX_IV_LENGTH];
+    size_t              hdr_off, hdr_len, payload_len;
+    size_t              pn_off, sample_off, sample_len;
+} QTX_SEAL;
+
+/* Maximum number of packets awaiting sealing */
+#define QTX_SEAL_BATCH      32
+
 /*
  * QTX
  * ===
@@ -91,6 +110,16 @@ struct ossl_qtx_st {
      */
     uint64_t                    epoch_pkt_count;
 
+    /* Packets which have been written but not yet sealed, in order. */
+    QTX_SEAL                    seal[QTX_SEAL_BATCH];
+    size_t                      seal_count;
+
+    /*
+     * Set if sealing ever failed. The packets concerned are still in their
+     * datagrams, so from then on nothing may leave the QTX.
+     */
+    int                         seal_failed;
+
     ossl_mutate_packet_cb mutatecb;
     ossl_finish_mutate_cb finishmutatecb;
     void *mutatearg;
@@ -101,6 +130,108 @@ struct ossl_qtx_st {
     SSL *msg_callback_ssl;
 };
 
+/*
+ * Seal all packets awaiting sealing and apply header protection to them.
+ * This must be done before a TXE leaves the QTX or is reallocated, and before
+ * the keys of an EL change. A failure is permanent.
+ */
+static int qtx_seal_pending(OSSL_QTX *qtx)
+{
+    EVP_CIPHER_CTX *cctx[QTX_SEAL_BATCH];
+    const unsigned char *iv[QTX_SEAL_BATCH], *aad[QTX_SEAL_BATCH];
+    const unsigned char *in[QTX_SEAL_BATCH];
+    unsigned char *out[QTX_SEAL_BATCH], *tag[QTX_SEAL_BATCH];
+    size_t aadlen[QTX_SEAL_BATCH], inl[QTX_SEAL_BATCH];
+    int ok[QTX_SEAL_BATCH];
+    size_t i, j, n = qtx->seal_count;
+    int ret = 1;
+#ifdef FUZZING_BUILD_MODE_UNSAFE_FOR_PRODUCTION
+    unsigned char *scratch = NULL;
+    size_t scratch_len = 0;
+#endif
+
+    if (qtx->seal_failed)
+        return 0;
+
+    if (n == 0)
+        return 1;
+
+    qtx->seal_count = 0;
+
+#ifdef FUZZING_BUILD_MODE_UNSAFE_FOR_PRODUCTION
+    for (i = 0; i < n; ++i)
+        scratch_len += qtx->seal[i].payload_len;
+    if ((scratch = OPENSSL_malloc(scratch_len)) == NULL)
+        ret = 0;
+    scratch_len = 0;
+#endif
+
+    for (i = 0; i < n; ++i) {
+        QTX_SEAL *e = &qtx->seal[i];
+        unsigned char *data = txe_data(e->txe);
+
+        cctx[i]   = e->el->cctx[0];
+        iv[i]     = e->nonce;
+        aad[i]    = data + e->hdr_off;
+        aadlen[i] = e->hdr_len;
+        in[i]     = data + e->hdr_off + e->hdr_len;
+        out[i]    = (unsigned char *)in[i];
+        inl[i]    = e->payload_len;
+        tag[i]    = out[i] + e->payload_len;
+        ok[i]     = 0;
+#ifdef FUZZING_BUILD_MODE_UNSAFE_FOR_PRODUCTION
+        /* Encrypt elsewhere so that the plaintext remains in the packet */
+        if (scratch != NULL) {
+            out[i] = scratch + scratch_len;
+            scratch_len += inl[i];
+        }
+#endif
+    }
+
+    /* All messages in a call share a tag length. */
+    for (i = 0; ret && i < n; i = j) {
+        for (j = i + 1;
+             j < n && qtx->seal[j].el->tag_len == qtx->seal[i].el->tag_len;
+             ++j);
+
+        if (!EVP_CipherAEADBatch(cctx + i, j - i, iv + i, aad + i, aadlen + i,
+                                 out + i, in + i, inl + i, tag + i,
+                                 qtx->seal[i].el->tag_len, ok + i)) {
+            ERR_raise(ERR_LIB_SSL, ERR_R_EVP_LIB);
+            ret = 0;
+        }
+    }
+
+#ifdef FUZZING_BUILD_MODE_UNSAFE_FOR_PRODUCTION
+    OPENSSL_free(scratch);
+#endif
+
+    for (i = 0; i < n; ++i) {
+        QTX_SEAL *e = &qtx->seal[i];
+        unsigned char *data = txe_data(e->txe);
+
+        if (!ok[i]) {
+            /* Never let an unsealed payload out. */
+            OPENSSL_cleanse(data + e->hdr_off + e->hdr_len,
+                            e->payload_len + e->el->tag_len);
+            ret = 0;
+            continue;
+        }
+
+        /* Apply header protection. */
+        if (!ossl_quic_hdr_protector_encrypt_fields(&e->el->hpr,
+                                                    data + e->sample_off,
+                                                    e->sample_len,
+                                                    data + e->hdr_off,
+                                                    data + e->pn_off))
+            ret = 0;
+    }
+
+    if (!ret)
+        qtx->seal_failed = 1;
+    return ret;
+}
+
 /* Instantiates a new QTX. */
 OSSL_QTX *ossl_qtx_new(const OSSL_QTX_ARGS *args)
 {
@@ -166,7 +297,7 @@ int ossl_qtx_provide_secret(OSSL_QTX              *qtx,
                             const unsigned char   *secret,
                             size_t                 secret_len)
 {
-    if (enc_level >= QUIC_ENC_LEVEL_NUM)
+    if (enc_level >= QUIC_ENC_LEVEL_NUM || !qtx_seal_pending(qtx))
         return 0;
 
     return ossl_qrl_enc_level_set_provide_secret(&qtx->el_set,
@@ -183,7 +314,7 @@ int ossl_qtx_provide_secret(OSSL_QTX              *qtx,
 
 int ossl_qtx_discard_enc_level(OSSL_QTX *qtx, uint32_t enc_level)
 {
-    if (enc_level >= QUIC_ENC_LEVEL_NUM)
+    if (enc_level >= QUIC_ENC_LEVEL_NUM || !qtx_seal_pending(qtx))
         return 0;
 
     ossl_qrl_enc_level_set_discard(&qtx->el_set, enc_level);
@@ -252,6 +383,10 @@ static TXE *qtx_resize_txe(OSSL_QTX *qtx, TXE_LIST *txl, TXE *txe, size_t n)
     if (n >= SIZE_MAX - sizeof(TXE))
         return NULL;
 
+    /* Packets awaiting sealing refer to the TXE, so seal them now */
+    if (!qtx_seal_pending(qtx))
+        return NULL;
+
     /* Remove the item from the list to avoid accessing freed memory */
     p = ossl_list_txe_prev(txe);
     ossl_list_txe_remove(txl, txe);
@@ -467,16 +602,20 @@ static int qtx_write_hdr(OSSL_QTX *qtx, const QUIC_PKT_HDR *hdr, TXE *txe,
     return 1;
 }
 
+/*
+ * Copy the plaintext payload into the TXE and queue the packet for sealing
+ * together with other packets by qtx_seal_pending().
+ */
 static int qtx_encrypt_into_txe(OSSL_QTX *qtx, struct iovec_cur *cur, TXE *txe,
                                 uint32_t enc_level, QUIC_PN pn,
                                 const unsigned char *hdr, size_t hdr_len,
                                 QUIC_PKT_HDR_PTRS *ptrs)
 {
-    int l = 0, l2 = 0, nonce_len;
+    int nonce_len;
     OSSL_QRL_ENC_LEVEL *el
         = ossl_qrl_enc_level_set_get(&qtx->el_set, enc_level, 1);
-    unsigned char nonce[EVP_MAX_IV_LENGTH];
-    size_t i;
+    QTX_SEAL *e;
+    size_t i, payload_len = 0;
     EVP_CIPHER_CTX *cctx = NULL;
 
     /* We should not have been called if we do not have key material. */
@@ -505,30 +644,24 @@ static int qtx_encrypt_into_txe(OSSL_QTX *qtx, struct iovec_cur *cur, TXE *txe,
         return 0;
     }
 
-    /* Construct nonce (nonce=IV ^ PN). */
     nonce_len = EVP_CIPHER_CTX_get_iv_length(cctx);
     if (!ossl_assert(nonce_len >= (int)sizeof(QUIC_PN))) {
         ERR_raise(ERR_LIB_SSL, ERR_R_INTERNAL_ERROR);
         return 0;
     }
 
-    memcpy(nonce, el->iv[0], (size_t)nonce_len);
-    for (i = 0; i < sizeof(QUIC_PN); ++i)
-        nonce[nonce_len - i - 1] ^= (unsigned char)(pn >> (i * 8));
-
-    /* type and key will already have been setup; feed the IV. */
-    if (EVP_CipherInit_ex(cctx, NULL, NULL, NULL, nonce, /*enc=*/1) != 1) {
+    /* Keys are set up for either direction; make sure we are encrypting. */
+    if (!EVP_CIPHER_CTX_is_encrypting(cctx)
+            && EVP_CipherInit_ex(cctx, NULL, NULL, NULL, NULL, /*enc=*/1) != 1) {
         ERR_raise(ERR_LIB_SSL, ERR_R_EVP_LIB);
         return 0;
     }
 
-    /* Feed AAD data. */
-    if (EVP_CipherUpdate(cctx, NULL, &l, hdr, hdr_len) != 1) {
-        ERR_raise(ERR_LIB_SSL, ERR_R_EVP_LIB);
+    if ((qtx->seal_failed || qtx->seal_count == QTX_SEAL_BATCH)
+            && !qtx_seal_pending(qtx))
         return 0;
-    }
 
-    /* Encrypt plaintext directly into TXE. */
+    /* Copy the plaintext into the TXE; it is encrypted in place later. */
     for (;;) {
         const unsigned char *src;
         size_t src_len;
@@ -537,38 +670,26 @@ static int qtx_encrypt_into_txe(OSSL_QTX *qtx, struct iovec_cur *cur, TXE *txe,
         if (src_len == 0)
             break;
 
-        if (EVP_CipherUpdate(cctx, txe_data(txe) + txe->data_len,
-                             &l, src, src_len) != 1) {
-            ERR_raise(ERR_LIB_SSL, ERR_R_EVP_LIB);
-            return 0;
-        }
-
-#ifdef FUZZING_BUILD_MODE_UNSAFE_FOR_PRODUCTION
-        /* Ignore what we just encrypted and overwrite it with the plaintext */
-        memcpy(txe_data(txe) + txe->data_len, src, l);
-#endif
-
-        assert(l > 0 && src_len == (size_t)l);
-        txe->data_len += src_len;
+        memcpy(txe_data(txe) + txe->data_len + payload_len, src, src_len);
+        payload_len += src_len;
     }
 
-    /* Finalise and get tag. */
-    if (EVP_CipherFinal_ex(cctx, NULL, &l2) != 1) {
-        ERR_raise(ERR_LIB_SSL, ERR_R_EVP_LIB);
-        return 0;
-    }
+    e = &qtx->seal[qtx->seal_count++];
+    e->txe          = txe;
+    e->el           = el;
+    e->hdr_off      = hdr - txe_data(txe);
+    e->hdr_len      = hdr_len;
+    e->payload_len  = payload_len;
+    e->pn_off       = ptrs->raw_pn - txe_data(txe);
+    e->sample_off   = ptrs->raw_sample - txe_data(txe);
+    e->sample_len   = ptrs->raw_sample_len;
 
-    if (EVP_CIPHER_CTX_ctrl(cctx, EVP_CTRL_AEAD_GET_TAG,
-                            el->tag_len, txe_data(txe) + txe->data_len) != 1) {
-        ERR_raise(ERR_LIB_SSL, ERR_R_EVP_LIB);
-        return 0;
-    }
-
-    txe->data_len += el->tag_len;
+    /* Construct nonce (nonce=IV ^ PN). */
+    memcpy(e->nonce, el->iv[0], (size_t)nonce_len);
+    for (i = 0; i < sizeof(QUIC_PN); ++i)
+        e->nonce[nonce_len - i - 1] ^= (unsigned char)(pn >> (i * 8));
 
-    /* Apply header protection. */
-    if (!ossl_quic_hdr_protector_encrypt(&el->hpr, ptrs))
-        return 0;
+    txe->data_len += payload_len + el->tag_len;
 
     ++el->op_count;
     return 1;
@@ -786,9 +907,9 @@ int ossl_qtx_write_pkt(OSSL_QTX *qtx, const OSSL_QTX_PKT *pkt)
     for (;;) {
         /*
          * Start a new coalescing session or continue using the existing one and
-         * serialize/encrypt the packet. We always encrypt packets as soon as
-         * our caller gives them to us, which relieves the caller of any need to
-         * keep the plaintext around.
+         * serialize the packet. We always copy packets as soon as our caller
+         * gives them to us, which relieves the caller of any need to keep the
+         * plaintext around; they are sealed before they leave the QTX.
          */
         txe = qtx_ensure_cons(qtx);
         if (txe == NULL)
@@ -899,7 +1020,7 @@ int ossl_qtx_flush_net(OSSL_QTX *qtx)
     if (ossl_list_txe_head(&qtx->pending) == NULL)
         return QTX_FLUSH_NET_RES_OK; /* Nothing to send. */
 
-    if (qtx->bio == NULL)
+    if (qtx->bio == NULL || !qtx_seal_pending(qtx))
         return QTX_FLUSH_NET_RES_PERMANENT_FAIL;
 
     for (;;) {
@@ -962,7 +1083,7 @@ int ossl_qtx_pop_net(OSSL_QTX *qtx, BIO_MSG *msg)
 {
     TXE *txe = ossl_list_txe_head(&qtx->pending);
 
-    if (txe == NULL)
+    if (txe == NULL || !qtx_seal_pending(qtx))
         return 0;
 
     txe_to_msg(txe, msg);
@@ -1011,6 +1132,9 @@ size_t ossl_qtx_get_unflushed_pkt_count(OSSL_QTX *qtx)
 
 int ossl_qtx_trigger_key_update(OSSL_QTX *qtx)
 {
+    if (!qtx_seal_pending(qtx))
+        return 0;
+
     return ossl_qrl_enc_level_set_key_update(&qtx->el_set,
                                              QUIC_ENC_LEVEL_1RTT);
 }
@@ -478,6 +478,7 @@ int tls_write_records_multiblock(OSSL_RECORD_LAYER *rl,
                                  OSSL_RECORD_TEMPLATE *templates,
                                  size_t numtempl);
 
+int tls_cipher_can_pipeline(OSSL_RECORD_LAYER *rl);
 size_t tls_get_max_records_default(OSSL_RECORD_LAYER *rl, uint8_t type,
                                    size_t len,
                                    size_t maxfrag, size_t *preffrag);
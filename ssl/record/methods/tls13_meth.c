@@ -70,12 +70,24 @@ static int tls13_cipher(OSSL_RECORD_LAYER *rl, TLS_RL_RECORD *recs,
     const EVP_CIPHER *cipher;
     int mode;
 
-    if (n_recs != 1) {
+    if (n_recs == 0) {
         /* Should not happen */
         RLAYERfatal(rl, SSL_AD_INTERNAL_ERROR, ERR_R_INTERNAL_ERROR);
         return 0;
     }
 
+    if (n_recs > 1) {
+        /*
+         * Pipelined writes: each record has its own nonce derived from the
+         * sequence number, so we just encrypt them in order.
+         */
+        for (loop = 0; loop < n_recs; loop++) {
+            if (!tls13_cipher(rl, &recs[loop], 1, sending, mac, macsize))
+                return 0;
+        }
+        return 1;
+    }
+
     ctx = rl->enc_ctx;
     staticiv = rl->iv;
 
@@ -198,6 +198,20 @@ static int tls1_cipher(OSSL_RECORD_LAYER *rl, TLS_RL_RECORD *recs,
 
     enc = EVP_CIPHER_CTX_get0_cipher(rl->enc_ctx);
 
+    if (n_recs > 1 && enc != NULL && EVP_CIPHER_get0_provider(enc) != NULL) {
+        /*
+         * Provided ciphers have no pipeline ctrls. tls_cipher_can_pipeline()
+         * only lets AEAD ciphers through here, which need no explicit IV or
+         * padding from us, so just process the records one at a time.
+         */
+        for (ctr = 0; ctr < n_recs; ctr++) {
+            if (!tls1_cipher(rl, &recs[ctr], 1, sending,
+                             macs != NULL ? &macs[ctr] : NULL, macsize))
+                return 0;
+        }
+        return 1;
+    }
+
     if (sending) {
         int ivlen;
 
@@ -352,7 +366,7 @@ static int tls1_cipher(OSSL_RECORD_LAYER *rl, TLS_RL_RECORD *recs,
     if (provided) {
         int outlen;
 
-        /* Provided cipher - we do not support pipelining on this path */
+        /* Pipelined records were split up above */
         if (n_recs > 1) {
             RLAYERfatal(rl, SSL_AD_INTERNAL_ERROR, ERR_R_INTERNAL_ERROR);
             return 0;
@@ -722,9 +722,7 @@ int tls_get_more_records(OSSL_RECORD_LAYER *rl)
     } while (num_recs < max_recs
              && thisrr->type == SSL3_RT_APPLICATION_DATA
              && RLAYER_USE_EXPLICIT_IV(rl)
-             && rl->enc_ctx != NULL
-             && (EVP_CIPHER_get_flags(EVP_CIPHER_CTX_get0_cipher(rl->enc_ctx))
-                 & EVP_CIPH_FLAG_PIPELINE) != 0
+             && tls_cipher_can_pipeline(rl)
              && tls_record_app_data_waiting(rl));
 
     if (num_recs == 1
@@ -1493,6 +1491,30 @@ size_t tls_app_data_pending(OSSL_RECORD_LAYER *rl)
     return num;
 }
 
+/*
+ * Returns 1 if the current cipher can process several records in a single
+ * call to the cipher function, or 0 otherwise. Legacy ciphers advertise this
+ * with EVP_CIPH_FLAG_PIPELINE. Provided AEAD stream ciphers (AES-GCM, AES-CCM
+ * and ChaCha20-Poly1305) do not support the pipeline ctrls, but the cipher
+ * functions feed them the records one after another, which still lets us
+ * build, encrypt and flush a whole batch of records per write.
+ */
+int tls_cipher_can_pipeline(OSSL_RECORD_LAYER *rl)
+{
+    const EVP_CIPHER *ciph;
+
+    if (rl->enc_ctx == NULL
+            || (ciph = EVP_CIPHER_CTX_get0_cipher(rl->enc_ctx)) == NULL)
+        return 0;
+
+    if ((EVP_CIPHER_get_flags(ciph) & EVP_CIPH_FLAG_PIPELINE) != 0)
+        return RLAYER_USE_EXPLICIT_IV(rl);
+
+    return EVP_CIPHER_get0_provider(ciph) != NULL
+           && (EVP_CIPHER_get_flags(ciph) & EVP_CIPH_FLAG_AEAD_CIPHER) != 0
+           && EVP_CIPHER_get_block_size(ciph) == 1;
+}
+
 size_t tls_get_max_records_default(OSSL_RECORD_LAYER *rl, uint8_t type,
                                    size_t len,
                                    size_t maxfrag, size_t *preffrag)
@@ -1501,11 +1523,7 @@ size_t tls_get_max_records_default(OSSL_RECORD_LAYER *rl, uint8_t type,
      * If we have a pipeline capable cipher, and we have been configured to use
      * it, then return the preferred number of pipelines.
      */
-    if (rl->max_pipelines > 0
-            && rl->enc_ctx != NULL
-            && (EVP_CIPHER_get_flags(EVP_CIPHER_CTX_get0_cipher(rl->enc_ctx))
-                & EVP_CIPH_FLAG_PIPELINE) != 0
-            && RLAYER_USE_EXPLICIT_IV(rl)) {
+    if (rl->max_pipelines > 0 && tls_cipher_can_pipeline(rl)) {
         size_t pipes;
 
         if (len == 0)
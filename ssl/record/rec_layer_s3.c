@@ -216,6 +216,47 @@ static int tls_write_check_pending(SSL_CONNECTION *s, uint8_t type,
     return 1;
 }
 
+/*
+ * Dynamic record sizing. After a connection has been idle application data is
+ * sent in records of at most |initial_frag| bytes, so that the peer can start
+ * processing it without waiting for a full 16k record to arrive. The record
+ * size is doubled for every |boost_after| bytes sent until it reaches the
+ * configured maximum. Returns 1 if the fragment sizes were reduced, 0
+ * otherwise.
+ */
+static int dyn_rec_limit_fragment(SSL_CONNECTION *s, size_t *maxfrag,
+                                  size_t *splitfrag)
+{
+    size_t frag, steps;
+
+    if (!ossl_time_is_zero(s->dyn_rec.idle_timeout)) {
+        OSSL_TIME now = ossl_time_now();
+
+        if (s->dyn_rec.sent > 0
+                && ossl_time_compare(ossl_time_subtract(now,
+                                                        s->dyn_rec.last_write),
+                                     s->dyn_rec.idle_timeout) > 0) {
+            s->dyn_rec.sent = 0;
+            s->dyn_rec.idle_resets++;
+        }
+        s->dyn_rec.last_write = now;
+    }
+
+    frag = s->dyn_rec.initial_frag;
+    for (steps = s->dyn_rec.sent / s->dyn_rec.boost_after;
+         steps > 0 && frag < *maxfrag;
+         steps--)
+        frag <<= 1;
+
+    if (frag >= *maxfrag)
+        return 0;
+
+    *maxfrag = frag;
+    if (*splitfrag > frag)
+        *splitfrag = frag;
+    return 1;
+}
+
 /*
  * Call this to write data in records of type 'type' It will return <= 0 if
  * not all data has been sent or non-blocking IO.
@@ -357,14 +398,18 @@ int ssl3_write_bytes(SSL *ssl, uint8_t type, const void *buf_, size_t len,
     for (;;) {
         size_t tmppipelen, remain;
         size_t j, lensofar = 0;
+        size_t maxfrag = max_send_fragment, splitfrag = split_send_fragment;
+        int dynsmall = 0;
+
+        if (type == SSL3_RT_APPLICATION_DATA && s->dyn_rec.initial_frag != 0)
+            dynsmall = dyn_rec_limit_fragment(s, &maxfrag, &splitfrag);
 
         /*
         * Ask the record layer how it would like to split the amount of data
         * that we have, and how many of those records it would like in one go.
         */
         maxpipes = s->rlayer.wrlmethod->get_max_records(s->rlayer.wrl, type, n,
-                                                        max_send_fragment,
-                                                        &split_send_fragment);
+                                                        maxfrag, &splitfrag);
         /*
         * If max_pipelines is 0 then this means "undefined" and we default to
         * whatever the record layer wants to do. Otherwise we use the smallest
@@ -377,12 +422,12 @@ int ssl3_write_bytes(SSL *ssl, uint8_t type, const void *buf_, size_t len,
         if (maxpipes > SSL_MAX_PIPELINES)
             maxpipes = SSL_MAX_PIPELINES;
 
-        if (split_send_fragment > max_send_fragment) {
+        if (splitfrag > maxfrag) {
             SSLfatal(s, SSL_AD_INTERNAL_ERROR, ERR_R_INTERNAL_ERROR);
             return -1;
         }
 
-        if (n / maxpipes >= split_send_fragment) {
+        if (n / maxpipes >= splitfrag) {
             /*
              * We have enough data to completely fill all available
              * pipelines
@@ -390,11 +435,11 @@ int ssl3_write_bytes(SSL *ssl, uint8_t type, const void *buf_, size_t len,
             for (j = 0; j < maxpipes; j++) {
                 tmpls[j].type = type;
                 tmpls[j].version = recversion;
-                tmpls[j].buf = &(buf[tot]) + (j * split_send_fragment);
-                tmpls[j].buflen = split_send_fragment;
+                tmpls[j].buf = &(buf[tot]) + (j * splitfrag);
+                tmpls[j].buflen = splitfrag;
             }
             /* Remember how much data we are going to be sending */
-            s->rlayer.wpend_tot = maxpipes * split_send_fragment;
+            s->rlayer.wpend_tot = maxpipes * splitfrag;
         } else {
             /* We can partially fill all available pipelines */
             tmppipelen = n / maxpipes;
@@ -418,6 +463,14 @@ int ssl3_write_bytes(SSL *ssl, uint8_t type, const void *buf_, size_t len,
             s->rlayer.wpend_tot = n;
         }
 
+        if (type == SSL3_RT_APPLICATION_DATA && s->dyn_rec.initial_frag != 0) {
+            s->dyn_rec.sent += s->rlayer.wpend_tot;
+            if (dynsmall)
+                s->dyn_rec.small_records += maxpipes;
+            else
+                s->dyn_rec.full_records += maxpipes;
+        }
+
         i = HANDLE_RLAYER_WRITE_RETURN(s,
             s->rlayer.wrlmethod->write_records(s->rlayer.wrl, tmpls, maxpipes));
         if (i <= 0) {
@@ -3865,36 +3865,67 @@ long ssl3_ctx_ctrl(SSL_CTX *ctx, int cmd, long larg, void *parg)
     case SSL_CTRL_SET_TLSEXT_TICKET_KEYS:
     case SSL_CTRL_GET_TLSEXT_TICKET_KEYS:
         {
+            /*
+             * |keys| holds one or more keys of |tick_keylen| bytes each. The
+             * first key is used to encrypt new tickets, the others are only
+             * used to decrypt tickets, which then get renewed.
+             */
             unsigned char *keys = parg;
-            long tick_keylen = (sizeof(ctx->ext.tick_key_name) +
-                                sizeof(ctx->ext.secure->tick_hmac_key) +
-                                sizeof(ctx->ext.secure->tick_aes_key));
+            long tick_keylen = TLSEXT_KEYNAME_LENGTH
+                               + 2 * TLSEXT_TICK_KEY_LENGTH;
+            size_t i, nkeys;
+
             if (keys == NULL)
                 return tick_keylen;
-            if (larg != tick_keylen) {
+            if (larg <= 0 || larg % tick_keylen != 0
+                    || larg / tick_keylen > TLSEXT_TICK_MAX_KEYS) {
                 ERR_raise(ERR_LIB_SSL, SSL_R_INVALID_TICKET_KEYS_LENGTH);
                 return 0;
             }
+            nkeys = (size_t)(larg / tick_keylen);
             if (cmd == SSL_CTRL_SET_TLSEXT_TICKET_KEYS) {
-                memcpy(ctx->ext.tick_key_name, keys,
-                       sizeof(ctx->ext.tick_key_name));
-                memcpy(ctx->ext.secure->tick_hmac_key,
-                       keys + sizeof(ctx->ext.tick_key_name),
-                       sizeof(ctx->ext.secure->tick_hmac_key));
-                memcpy(ctx->ext.secure->tick_aes_key,
-                       keys + sizeof(ctx->ext.tick_key_name) +
-                       sizeof(ctx->ext.secure->tick_hmac_key),
-                       sizeof(ctx->ext.secure->tick_aes_key));
+                if (!CRYPTO_THREAD_write_lock(ctx->lock))
+                    return 0;
+                ssl_ticket_keys_clear_ctx(ctx);
+                for (i = 0; i < nkeys; i++, keys += tick_keylen) {
+                    memcpy(ctx->ext.tick_keys[i].name, keys,
+                           TLSEXT_KEYNAME_LENGTH);
+                    memcpy(ctx->ext.secure->tick_hmac_key[i],
+                           keys + TLSEXT_KEYNAME_LENGTH,
+                           TLSEXT_TICK_KEY_LENGTH);
+                    memcpy(ctx->ext.secure->tick_aes_key[i],
+                           keys + TLSEXT_KEYNAME_LENGTH
+                           + TLSEXT_TICK_KEY_LENGTH,
+                           TLSEXT_TICK_KEY_LENGTH);
+                }
+                for (; i < TLSEXT_TICK_MAX_KEYS; i++) {
+                    OPENSSL_cleanse(ctx->ext.secure->tick_hmac_key[i],
+                                    TLSEXT_TICK_KEY_LENGTH);
+                    OPENSSL_cleanse(ctx->ext.secure->tick_aes_key[i],
+                                    TLSEXT_TICK_KEY_LENGTH);
+                }
+                ctx->ext.tick_key_count = nkeys;
+                CRYPTO_THREAD_unlock(ctx->lock);
             } else {
-                memcpy(keys, ctx->ext.tick_key_name,
-                       sizeof(ctx->ext.tick_key_name));
-                memcpy(keys + sizeof(ctx->ext.tick_key_name),
-                       ctx->ext.secure->tick_hmac_key,
-                       sizeof(ctx->ext.secure->tick_hmac_key));
-                memcpy(keys + sizeof(ctx->ext.tick_key_name) +
-                       sizeof(ctx->ext.secure->tick_hmac_key),
-                       ctx->ext.secure->tick_aes_key,
-                       sizeof(ctx->ext.secure->tick_aes_key));
+                if (!CRYPTO_THREAD_read_lock(ctx->lock))
+                    return 0;
+                if (nkeys > ctx->ext.tick_key_count) {
+                    CRYPTO_THREAD_unlock(ctx->lock);
+                    ERR_raise(ERR_LIB_SSL, SSL_R_INVALID_TICKET_KEYS_LENGTH);
+                    return 0;
+                }
+                for (i = 0; i < nkeys; i++, keys += tick_keylen) {
+                    memcpy(keys, ctx->ext.tick_keys[i].name,
+                           TLSEXT_KEYNAME_LENGTH);
+                    memcpy(keys + TLSEXT_KEYNAME_LENGTH,
+                           ctx->ext.secure->tick_hmac_key[i],
+                           TLSEXT_TICK_KEY_LENGTH);
+                    memcpy(keys + TLSEXT_KEYNAME_LENGTH
+                           + TLSEXT_TICK_KEY_LENGTH,
+                           ctx->ext.secure->tick_aes_key[i],
+                           TLSEXT_TICK_KEY_LENGTH);
+                }
+                CRYPTO_THREAD_unlock(ctx->lock);
             }
             return 1;
         }
@@ -4006,6 +4037,7 @@ long ssl3_ctx_ctrl(SSL_CTX *ctx, int cmd, long larg, void *parg)
             ERR_raise(ERR_LIB_SSL, ERR_R_CRYPTO_LIB);
             return 0;
         }
+        ossl_ssl_ctx_certs_changed(ctx);
         break;
 
     case SSL_CTRL_GET_EXTRA_CHAIN_CERTS:
@@ -4018,6 +4050,7 @@ long ssl3_ctx_ctrl(SSL_CTX *ctx, int cmd, long larg, void *parg)
     case SSL_CTRL_CLEAR_EXTRA_CHAIN_CERTS:
         OSSL_STACK_OF_X509_free(ctx->extra_certs);
         ctx->extra_certs = NULL;
+        ossl_ssl_ctx_certs_changed(ctx);
         break;
 
     case SSL_CTRL_CHAIN:
@@ -307,6 +307,8 @@ int ssl_cert_set0_chain(SSL_CONNECTION *s, SSL_CTX *ctx, STACK_OF(X509) *chain)
     }
     OSSL_STACK_OF_X509_free(cpk->chain);
     cpk->chain = chain;
+    if (s == NULL)
+        ossl_ssl_ctx_certs_changed(ctx);
     return 1;
 }
 
@@ -342,6 +344,8 @@ int ssl_cert_add0_chain_cert(SSL_CONNECTION *s, SSL_CTX *ctx, X509 *x)
         cpk->chain = sk_X509_new_null();
     if (!cpk->chain || !sk_X509_push(cpk->chain, x))
         return 0;
+    if (s == NULL)
+        ossl_ssl_ctx_certs_changed(ctx);
     return 1;
 }
 
@@ -1081,6 +1085,8 @@ int ssl_build_cert_chain(SSL_CONNECTION *s, SSL_CTX *ctx, int flags)
     }
     OSSL_STACK_OF_X509_free(cpk->chain);
     cpk->chain = chain;
+    if (s == NULL)
+        ossl_ssl_ctx_certs_changed(ctx);
     if (rv == 0)
         rv = 1;
  err:
@@ -354,13 +354,86 @@ static int ossl_set1_compressed_cert(CERT *cert, int algorithm,
 }
 #endif
 
+/*
+ * Called whenever the server certificates or the compression preferences of
+ * |ctx| change. Anything compressed earlier may belong to a different chain
+ * by now, so it is dropped. With SSL_OP_PRECOMPRESS_CERTIFICATES set the
+ * chains are compressed again by ossl_ssl_ctx_precompress_certs() once the
+ * configuration is complete, i.e. when the first SSL object is created.
+ */
+void ossl_ssl_ctx_certs_changed(SSL_CTX *ctx)
+{
+#ifndef OPENSSL_NO_COMP_ALG
+    CERT *c = ctx->cert;
+    size_t i;
+    int j;
+
+    if ((ctx->options & SSL_OP_PRECOMPRESS_CERTIFICATES) == 0 || c == NULL)
+        return;
+
+    for (i = 0; i < c->ssl_pkey_num; i++) {
+        for (j = 0; j < TLSEXT_comp_cert_limit; j++) {
+            OSSL_COMP_CERT_free(c->pkeys[i].comp_cert[j]);
+            c->pkeys[i].comp_cert[j] = NULL;
+        }
+    }
+    ctx->cert_comp_pending = 1;
+#endif
+}
+
+/*
+ * Called by SSL_new() before the CERT of |ctx| is duplicated. The first call
+ * after a change compresses the chains, later ones only check a flag.
+ */
+int ossl_ssl_ctx_precompress_certs(SSL_CTX *ctx)
+{
+#ifndef OPENSSL_NO_COMP_ALG
+    SSL *tmp;
+    int pending;
+
+    if ((ctx->options & SSL_OP_PRECOMPRESS_CERTIFICATES) == 0
+            || ctx->cert == NULL)
+        return 1;
+
+    if (!CRYPTO_THREAD_read_lock(ctx->lock))
+        return 0;
+    pending = ctx->cert_comp_pending;
+    CRYPTO_THREAD_unlock(ctx->lock);
+    if (!pending)
+        return 1;
+
+    if (!CRYPTO_THREAD_write_lock(ctx->lock))
+        return 0;
+    if (ctx->cert_comp_pending) {
+        /*
+         * This is only an optimisation, failing to compress must not make
+         * the caller fail or leave anything on the error queue. The
+         * temporary connection is not created with SSL_new(), which would
+         * come back here.
+         */
+        ERR_set_mark();
+        if ((tmp = ossl_ssl_connection_new(ctx)) != NULL) {
+            (void)ssl_compress_certs(tmp, ctx->cert->pkeys, 0);
+            SSL_free(tmp);
+        }
+        ERR_pop_to_mark();
+        ctx->cert_comp_pending = 0;
+    }
+    CRYPTO_THREAD_unlock(ctx->lock);
+#endif
+    return 1;
+}
+
 /*-
  * Public API
  */
 int SSL_CTX_set1_cert_comp_preference(SSL_CTX *ctx, int *algs, size_t len)
 {
 #ifndef OPENSSL_NO_COMP_ALG
-    return ssl_set_cert_comp_pref(ctx->cert_comp_prefs, algs, len);
+    if (!ssl_set_cert_comp_pref(ctx->cert_comp_prefs, algs, len))
+        return 0;
+    ossl_ssl_ctx_certs_changed(ctx);
+    return 1;
 #else
     return 0;
 #endif
@@ -719,6 +719,8 @@ SSL *SSL_new(SSL_CTX *ctx)
         ERR_raise(ERR_LIB_SSL, SSL_R_SSL_CTX_HAS_NO_DEFAULT_SSL_VERSION);
         return NULL;
     }
+    if (!ossl_ssl_ctx_precompress_certs(ctx))
+        return NULL;
     return ctx->method->ssl_new(ctx);
 }
 
@@ -830,6 +832,9 @@ SSL *ossl_ssl_connection_new_int(SSL_CTX *ctx, const SSL_METHOD *method)
     s->max_send_fragment = ctx->max_send_fragment;
     s->split_send_fragment = ctx->split_send_fragment;
     s->max_pipelines = ctx->max_pipelines;
+    s->dyn_rec.initial_frag = ctx->dyn_rec.initial_frag;
+    s->dyn_rec.boost_after = ctx->dyn_rec.boost_after;
+    s->dyn_rec.idle_timeout = ctx->dyn_rec.idle_timeout;
     s->rlayer.default_read_buf_len = ctx->default_read_buf_len;
 
     s->ext.debug_cb = 0;
@@ -4011,13 +4016,17 @@ SSL_CTX *SSL_CTX_new_ex(OSSL_LIB_CTX *libctx, const char *propq,
     ret->split_send_fragment = SSL3_RT_MAX_PLAIN_LENGTH;
 
     /* Setup RFC5077 ticket keys */
-    if ((RAND_bytes_ex(libctx, ret->ext.tick_key_name,
-                       sizeof(ret->ext.tick_key_name), 0) <= 0)
-        || (RAND_priv_bytes_ex(libctx, ret->ext.secure->tick_hmac_key,
-                               sizeof(ret->ext.secure->tick_hmac_key), 0) <= 0)
-        || (RAND_priv_bytes_ex(libctx, ret->ext.secure->tick_aes_key,
-                               sizeof(ret->ext.secure->tick_aes_key), 0) <= 0))
+    if ((RAND_bytes_ex(libctx, ret->ext.tick_keys[0].name,
+                       sizeof(ret->ext.tick_keys[0].name), 0) <= 0)
+        || (RAND_priv_bytes_ex(libctx, ret->ext.secure->tick_hmac_key[0],
+                               sizeof(ret->ext.secure->tick_hmac_key[0]),
+                               0) <= 0)
+        || (RAND_priv_bytes_ex(libctx, ret->ext.secure->tick_aes_key[0],
+                               sizeof(ret->ext.secure->tick_aes_key[0]),
+                               0) <= 0))
         ret->options |= SSL_OP_NO_TICKET;
+    else
+        ret->ext.tick_key_count = 1;
 
     if (RAND_priv_bytes_ex(libctx, ret->ext.cookie_hmac_key,
                            sizeof(ret->ext.cookie_hmac_key), 0) <= 0) {
@@ -4063,6 +4072,8 @@ SSL_CTX *SSL_CTX_new_ex(OSSL_LIB_CTX *libctx, const char *propq,
         ret->cert_comp_prefs[i++] = TLSEXT_comp_cert_zlib;
     if (ossl_comp_has_alg(TLSEXT_comp_cert_zstd))
         ret->cert_comp_prefs[i++] = TLSEXT_comp_cert_zstd;
+    /* Lets SSL_OP_PRECOMPRESS_CERTIFICATES be set at any time before SSL_new() */
+    ret->cert_comp_pending = 1;
 #endif
     /*
      * Disable compression by default to prevent CRIME. Applications can
@@ -4189,7 +4200,9 @@ void SSL_CTX_free(SSL_CTX *a)
     OPENSSL_free(a->ext.supportedgroups);
     OPENSSL_free(a->ext.supported_groups_default);
     OPENSSL_free(a->ext.alpn);
+    ssl_ticket_keys_clear_ctx(a);
     OPENSSL_secure_free(a->ext.secure);
+    ossl_ssl_ctx_servernames_free(a);
 
     ssl_evp_md_free(a->md5);
     ssl_evp_md_free(a->sha1);
@@ -5776,6 +5789,63 @@ int SSL_set_block_padding(SSL *ssl, size_t block_size)
     return 1;
 }
 
+int SSL_CTX_set_dynamic_record_sizing(SSL_CTX *ctx, size_t initial_frag,
+                                      size_t boost_after,
+                                      uint64_t idle_timeout_ms)
+{
+    if (IS_QUIC_CTX(ctx))
+        return 0;
+
+    /* An |initial_frag| of 0 switches dynamic record sizing off */
+    if (initial_frag != 0
+            && (initial_frag < 512 || initial_frag > SSL3_RT_MAX_PLAIN_LENGTH
+                || boost_after == 0))
+        return 0;
+
+    ctx->dyn_rec.initial_frag = initial_frag;
+    ctx->dyn_rec.boost_after = boost_after;
+    ctx->dyn_rec.idle_timeout = ossl_ms2time(idle_timeout_ms);
+    return 1;
+}
+
+int SSL_set_dynamic_record_sizing(SSL *s, size_t initial_frag,
+                                  size_t boost_after, uint64_t idle_timeout_ms)
+{
+    SSL_CONNECTION *sc = SSL_CONNECTION_FROM_SSL_ONLY(s);
+
+    if (sc == NULL)
+        return 0;
+
+    if (initial_frag != 0
+            && (initial_frag < 512 || initial_frag > SSL3_RT_MAX_PLAIN_LENGTH
+                || boost_after == 0))
+        return 0;
+
+    sc->dyn_rec.initial_frag = initial_frag;
+    sc->dyn_rec.boost_after = boost_after;
+    sc->dyn_rec.idle_timeout = ossl_ms2time(idle_timeout_ms);
+    /* Start (again) from the smallest record size */
+    sc->dyn_rec.sent = 0;
+    return 1;
+}
+
+int SSL_get_dynamic_record_stats(const SSL *s, uint64_t *small_records,
+                                 uint64_t *full_records, uint64_t *idle_resets)
+{
+    const SSL_CONNECTION *sc = SSL_CONNECTION_FROM_CONST_SSL_ONLY(s);
+
+    if (sc == NULL)
+        return 0;
+
+    if (small_records != NULL)
+        *small_records = sc->dyn_rec.small_records;
+    if (full_records != NULL)
+        *full_records = sc->dyn_rec.full_records;
+    if (idle_resets != NULL)
+        *idle_resets = sc->dyn_rec.idle_resets;
+    return 1;
+}
+
 int SSL_set_num_tickets(SSL *s, size_t num_tickets)
 {
     SSL_CONNECTION *sc = SSL_CONNECTION_FROM_SSL(s);
@@ -6695,6 +6765,78 @@ int SSL_alloc_buffers(SSL *ssl)
            && rl->wrlmethod->alloc_buffers(rl->wrl);
 }
 
+int SSL_hibernate(SSL *ssl)
+{
+    RECORD_LAYER *rl;
+    SSL_CONNECTION *sc = SSL_CONNECTION_FROM_SSL_ONLY(ssl);
+
+    if (sc == NULL)
+        return 0;
+
+    /*
+     * DTLS keeps the handshake buffers around for retransmission, so there
+     * is nothing we could safely release there.
+     */
+    if (SSL_CONNECTION_IS_DTLS(sc)
+            || !SSL_is_init_finished(ssl)
+            || ossl_statem_get_in_handshake(sc)
+            || RECORD_LAYER_write_pending(&sc->rlayer)) {
+        ERR_raise(ERR_LIB_SSL, ERR_R_SHOULD_NOT_HAVE_BEEN_CALLED);
+        return 0;
+    }
+
+    rl = &sc->rlayer;
+
+    /*
+     * Records that have been passed up to us still point into the read
+     * buffer. Apart from that the record layer itself refuses to free buffers
+     * that hold pending data.
+     */
+    if (RECORD_LAYER_processed_read_pending(rl)
+            || !rl->rrlmethod->free_buffers(rl->rrl)
+            || !rl->wrlmethod->free_buffers(rl->wrl))
+        return 0;
+
+    /*
+     * Everything else that we release is only needed while a handshake is in
+     * progress and is recreated if a new one is started. The keys, sequence
+     * numbers and the session are left untouched.
+     */
+    BUF_MEM_free(sc->init_buf);
+    sc->init_buf = NULL;
+    sc->init_msg = NULL;
+    sc->init_num = 0;
+    sc->init_off = 0;
+
+    sk_SSL_CIPHER_free(sc->peer_ciphers);
+    sc->peer_ciphers = NULL;
+    OPENSSL_free(sc->s3.tmp.ciphers_raw);
+    sc->s3.tmp.ciphers_raw = NULL;
+    sc->s3.tmp.ciphers_rawlen = 0;
+    OPENSSL_free(sc->s3.tmp.ctype);
+    sc->s3.tmp.ctype = NULL;
+    sc->s3.tmp.ctype_len = 0;
+    sk_X509_NAME_pop_free(sc->s3.tmp.peer_ca_names, X509_NAME_free);
+    sc->s3.tmp.peer_ca_names = NULL;
+    EVP_PKEY_free(sc->s3.tmp.pkey);
+    sc->s3.tmp.pkey = NULL;
+    EVP_PKEY_free(sc->s3.peer_tmp);
+    sc->s3.peer_tmp = NULL;
+    OPENSSL_free(sc->s3.alpn_proposed);
+    sc->s3.alpn_proposed = NULL;
+    sc->s3.alpn_proposed_len = 0;
+    OPENSSL_free(sc->ext.tls13_cookie);
+    sc->ext.tls13_cookie = NULL;
+    sc->ext.tls13_cookie_len = 0;
+
+    if (sc->clienthello != NULL)
+        OPENSSL_free(sc->clienthello->pre_proc_exts);
+    OPENSSL_free(sc->clienthello);
+    sc->clienthello = NULL;
+
+    return 1;
+}
+
 void SSL_CTX_set_keylog_callback(SSL_CTX *ctx, SSL_CTX_keylog_cb_func cb)
 {
     ctx->keylog_callback = cb;
@@ -716,15 +716,32 @@ typedef enum tlsext_index_en {
 DEFINE_LHASH_OF_EX(SSL_SESSION);
 /* Needed in ssl_cert.c */
 DEFINE_LHASH_OF_EX(X509_NAME);
+/* Index of SSL_CTXs by servername, see ssl_sni.c */
+typedef struct ssl_servername_st SSL_SERVERNAME;
+DEFINE_LHASH_OF_EX(SSL_SERVERNAME);
 
 # define TLSEXT_KEYNAME_LENGTH  16
 # define TLSEXT_TICK_KEY_LENGTH 32
+/* Maximum number of built-in ticket keys that are accepted at the same time */
+# define TLSEXT_TICK_MAX_KEYS   8
 
 typedef struct ssl_ctx_ext_secure_st {
-    unsigned char tick_hmac_key[TLSEXT_TICK_KEY_LENGTH];
-    unsigned char tick_aes_key[TLSEXT_TICK_KEY_LENGTH];
+    unsigned char tick_hmac_key[TLSEXT_TICK_MAX_KEYS][TLSEXT_TICK_KEY_LENGTH];
+    unsigned char tick_aes_key[TLSEXT_TICK_MAX_KEYS][TLSEXT_TICK_KEY_LENGTH];
 } SSL_CTX_EXT_SECURE;
 
+/*
+ * A built-in ticket key. The cipher and MAC contexts are keyed on first use
+ * and then copied for every ticket, so issuing or decrypting a ticket does not
+ * need to fetch algorithms or expand keys again.
+ */
+typedef struct ssl_ticket_key_st {
+    unsigned char name[TLSEXT_KEYNAME_LENGTH];
+    EVP_CIPHER_CTX *enc_ctx;
+    EVP_CIPHER_CTX *dec_ctx;
+    EVP_MAC_CTX *mac_ctx;
+} SSL_TICKET_KEY;
+
 /*
  * Helper function for HMAC
  * The structure should be considered opaque, it will change once the low
@@ -750,6 +767,14 @@ int ssl_hmac_update(SSL_HMAC *ctx, const unsigned char *data, size_t len);
 int ssl_hmac_final(SSL_HMAC *ctx, unsigned char *md, size_t *len,
                    size_t max_size);
 size_t ssl_hmac_size(const SSL_HMAC *ctx);
+SSL_HMAC *ssl_hmac_new_dup(const EVP_MAC_CTX *src);
+
+int ssl_ticket_key_init(SSL_CTX *tctx, unsigned char *key_name,
+                        unsigned char *iv, int enc, EVP_CIPHER_CTX *cctx,
+                        SSL_HMAC **hctx, int *renew);
+void ssl_ticket_keys_clear_ctx(SSL_CTX *tctx);
+void ossl_ssl_ctx_servernames_free(SSL_CTX *ctx);
+SSL_CTX *ossl_ssl_ctx_get1_servername_ctx(SSL_CTX *ctx, const char *name);
 
 int ssl_get_EC_curve_nid(const EVP_PKEY *pkey);
 __owur int tls13_set_encoded_pub_key(EVP_PKEY *pkey,
@@ -984,6 +1009,16 @@ struct ssl_ctx_st {
     /* Up to how many pipelines should we use? If 0 then 1 is assumed */
     size_t max_pipelines;
 
+    /* Dynamic record sizing, see SSL_CTX_set_dynamic_record_sizing() */
+    struct {
+        /* Record size to start with, 0 if dynamic record sizing is off */
+        size_t initial_frag;
+        /* Number of bytes to send before doubling the record size */
+        size_t boost_after;
+        /* Idle time after which we go back to |initial_frag| */
+        OSSL_TIME idle_timeout;
+    } dyn_rec;
+
     /* The default read buffer length to use (0 means not set) */
     size_t default_read_buf_len;
 
@@ -1003,8 +1038,14 @@ struct ssl_ctx_st {
         /* TLS extensions servername callback */
         int (*servername_cb) (SSL *, int *, void *);
         void *servername_arg;
-        /* RFC 4507 session ticket keys */
-        unsigned char tick_key_name[TLSEXT_KEYNAME_LENGTH];
+        /* SSL_CTX to switch to for each accepted servername */
+        LHASH_OF(SSL_SERVERNAME) *servernames;
+        /*
+         * RFC 4507 session ticket keys. New tickets are encrypted with the
+         * first key, tickets encrypted with any of them are accepted.
+         */
+        SSL_TICKET_KEY tick_keys[TLSEXT_TICK_MAX_KEYS];
+        size_t tick_key_count;
         SSL_CTX_EXT_SECURE *secure;
 # ifndef OPENSSL_NO_DEPRECATED_3_0
         /* Callback to support customisation of ticket key setting */
@@ -1182,6 +1223,8 @@ struct ssl_ctx_st {
 #ifndef OPENSSL_NO_COMP_ALG
     /* certificate compression preferences */
     int cert_comp_prefs[TLSEXT_comp_cert_limit];
+    /* set when SSL_OP_PRECOMPRESS_CERTIFICATES work is outstanding */
+    int cert_comp_pending;
 #endif
 
     /* Certificate Type stuff - for RPK vs X.509 */
@@ -1564,6 +1607,19 @@ struct ssl_connection_st {
     /* Up to how many pipelines should we use? If 0 then 1 is assumed */
     size_t max_pipelines;
 
+    /* Dynamic record sizing settings, state and statistics */
+    struct {
+        size_t initial_frag;
+        size_t boost_after;
+        OSSL_TIME idle_timeout;
+        /* Application data bytes sent since we were last idle */
+        size_t sent;
+        OSSL_TIME last_write;
+        uint64_t small_records;
+        uint64_t full_records;
+        uint64_t idle_resets;
+    } dyn_rec;
+
     struct {
         /* Built-in extension flags */
         uint8_t extflags[TLSEXT_IDX_num_builtins];
@@ -2984,6 +3040,8 @@ static ossl_unused ossl_inline void ssl_tsan_counter(const SSL_CTX *ctx,
 
 int ossl_comp_has_alg(int a);
 size_t ossl_calculate_comp_expansion(int alg, size_t length);
+void ossl_ssl_ctx_certs_changed(SSL_CTX *ctx);
+int ossl_ssl_ctx_precompress_certs(SSL_CTX *ctx);
 
 void ossl_ssl_set_custom_record_layer(SSL_CONNECTION *s,
                                       const OSSL_RECORD_METHOD *meth,
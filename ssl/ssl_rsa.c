@@ -239,7 +239,10 @@ int SSL_CTX_use_certificate(SSL_CTX *ctx, X509 *x)
         ERR_raise(ERR_LIB_SSL, rv);
         return 0;
     }
-    return ssl_set_cert(ctx->cert, x, ctx);
+    if (!ssl_set_cert(ctx->cert, x, ctx))
+        return 0;
+    ossl_ssl_ctx_certs_changed(ctx);
+    return 1;
 }
 
 static int ssl_set_cert(CERT *c, X509 *x, SSL_CTX *ctx)
@@ -1040,6 +1043,9 @@ static int ssl_set_cert_and_key(SSL *ssl, SSL_CTX *ctx, X509 *x509, EVP_PKEY *pr
 
     c->key = &(c->pkeys[i]);
 
+    if (ssl == NULL)
+        ossl_ssl_ctx_certs_changed(ctx);
+
     ret = 1;
  out:
     EVP_PKEY_free(pubkey);
@@ -0,0 +1,243 @@
+/*
+ * Copyright 2024 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+#include <string.h>
+#include <openssl/x509v3.h>
+#include "internal/cryptlib.h"
+#include "ssl_local.h"
+
+/*
+ * Index of the SSL_CTX to switch to for each servername a server accepts.
+ * Wildcard names "*.example.com" are stored without their leading label, so
+ * looking up a name takes at most two hash lookups whatever the number of
+ * names: one for the name itself and one for the name without its leading
+ * label among the wildcards.
+ */
+struct ssl_servername_st {
+    const char *name;
+    int wildcard;
+    SSL_CTX *ctx;
+};
+
+static unsigned long servername_hash(const SSL_SERVERNAME *a)
+{
+    return OPENSSL_LH_strhash(a->name) ^ (unsigned long)a->wildcard;
+}
+
+static int servername_cmp(const SSL_SERVERNAME *a, const SSL_SERVERNAME *b)
+{
+    if (a->wildcard != b->wildcard)
+        return a->wildcard - b->wildcard;
+    return strcmp(a->name, b->name);
+}
+
+static void servername_free(SSL_SERVERNAME *a)
+{
+    SSL_CTX_free(a->ctx);
+    OPENSSL_free(a);
+}
+
+void ossl_ssl_ctx_servernames_free(SSL_CTX *ctx)
+{
+    if (ctx->ext.servernames == NULL)
+        return;
+    lh_SSL_SERVERNAME_doall(ctx->ext.servernames, servername_free);
+    lh_SSL_SERVERNAME_free(ctx->ext.servernames);
+    ctx->ext.servernames = NULL;
+}
+
+/*
+ * Copy |name| in lower case to |buf| which has room for the longest possible
+ * host name, returning 0 if it is empty or too long. Host names are ASCII, so
+ * this doesn't depend on the locale.
+ */
+static int servername_lower(char *buf, const char *name, size_t len)
+{
+    size_t i;
+
+    if (len == 0 || len > TLSEXT_MAXLEN_host_name)
+        return 0;
+    for (i = 0; i < len; i++)
+        buf[i] = name[i] >= 'A' && name[i] <= 'Z' ? name[i] - 'A' + 'a'
+                                                  : name[i];
+    buf[len] = '\0';
+    return 1;
+}
+
+/*
+ * Check that |*name| can be indexed, stripping any wildcard label. Only a
+ * whole leftmost label may be a wildcard.
+ */
+static int servername_check(const char **name, size_t *len, int *wildcard)
+{
+    *wildcard = 0;
+    if (*len > 2 && (*name)[0] == '*' && (*name)[1] == '.') {
+        *wildcard = 1;
+        *name += 2;
+        *len -= 2;
+    }
+    return *len > 0 && *len <= TLSEXT_MAXLEN_host_name
+        && memchr(*name, '*', *len) == NULL
+        && memchr(*name, '\0', *len) == NULL;
+}
+
+static int servername_add(SSL_CTX *ctx, const char *name, size_t len,
+                          int wildcard, SSL_CTX *sni_ctx)
+{
+    SSL_SERVERNAME *sn, *old;
+    char *p;
+
+    /* The name is stored in the same allocation as the entry */
+    if ((sn = OPENSSL_malloc(sizeof(*sn) + len + 1)) == NULL)
+        return 0;
+    p = (char *)(sn + 1);
+    servername_lower(p, name, len);
+    sn->name = p;
+    sn->wildcard = wildcard;
+    sn->ctx = sni_ctx;
+
+    if (ctx->ext.servernames == NULL
+            && (ctx->ext.servernames = lh_SSL_SERVERNAME_new(servername_hash,
+                                                             servername_cmp))
+               == NULL) {
+        ERR_raise(ERR_LIB_SSL, ERR_R_CRYPTO_LIB);
+        OPENSSL_free(sn);
+        return 0;
+    }
+    old = lh_SSL_SERVERNAME_insert(ctx->ext.servernames, sn);
+    if (old != NULL) {
+        servername_free(old);
+    } else if (lh_SSL_SERVERNAME_error(ctx->ext.servernames)) {
+        ERR_raise(ERR_LIB_SSL, ERR_R_CRYPTO_LIB);
+        OPENSSL_free(sn);
+        return 0;
+    }
+    SSL_CTX_up_ref(sni_ctx);
+    return 1;
+}
+
+/*
+ * Add the DNS names in the subject alternative names of |x|, skipping any
+ * that can't be indexed. Returns the number of names added or -1 on error.
+ */
+static int servername_add_cert(SSL_CTX *ctx, X509 *x, SSL_CTX *sni_ctx)
+{
+    GENERAL_NAMES *gens;
+    const GENERAL_NAME *gen;
+    const char *name;
+    size_t len;
+    int i, wildcard, found = 0;
+
+    gens = X509_get_ext_d2i(x, NID_subject_alt_name, NULL, NULL);
+    for (i = 0; i < sk_GENERAL_NAME_num(gens); i++) {
+        gen = sk_GENERAL_NAME_value(gens, i);
+        if (gen->type != GEN_DNS)
+            continue;
+        name = (const char *)gen->d.dNSName->data;
+        len = gen->d.dNSName->length;
+        if (!servername_check(&name, &len, &wildcard))
+            continue;
+        if (!servername_add(ctx, name, len, wildcard, sni_ctx)) {
+            found = -1;
+            break;
+        }
+        found++;
+    }
+    GENERAL_NAMES_free(gens);
+    return found;
+}
+
+int SSL_CTX_add1_servername_ctx(SSL_CTX *ctx, const char *name,
+                                SSL_CTX *sni_ctx)
+{
+    size_t i, len;
+    int ret = 0, found = 0, wildcard;
+
+    if (ctx == NULL || sni_ctx == NULL || ctx == sni_ctx) {
+        ERR_raise(ERR_LIB_SSL, ERR_R_PASSED_INVALID_ARGUMENT);
+        return 0;
+    }
+
+    if (!CRYPTO_THREAD_write_lock(ctx->lock))
+        return 0;
+    if (name != NULL) {
+        len = strlen(name);
+        if (servername_check(&name, &len, &wildcard))
+            ret = servername_add(ctx, name, len, wildcard, sni_ctx);
+        else
+            ERR_raise(ERR_LIB_SSL, ERR_R_PASSED_INVALID_ARGUMENT);
+    } else {
+        for (i = 0; i < sni_ctx->cert->ssl_pkey_num; i++) {
+            X509 *x = sni_ctx->cert->pkeys[i].x509;
+
+            if (x == NULL)
+                continue;
+            if ((ret = servername_add_cert(ctx, x, sni_ctx)) < 0)
+                break;
+            found += ret;
+        }
+        if (ret >= 0 && found == 0)
+            ERR_raise(ERR_LIB_SSL, SSL_R_NO_CERTIFICATE_ASSIGNED);
+        ret = ret >= 0 && found > 0;
+    }
+    CRYPTO_THREAD_unlock(ctx->lock);
+    return ret;
+}
+
+/* Look up |name| in the index of |ctx|. The caller holds the lock of |ctx|. */
+static SSL_CTX *servername_find(const SSL_CTX *ctx, const char *name)
+{
+    char buf[TLSEXT_MAXLEN_host_name + 1];
+    SSL_SERVERNAME key, *sn;
+    char *dot;
+
+    if (ctx->ext.servernames == NULL || name == NULL
+            || !servername_lower(buf, name, strlen(name)))
+        return NULL;
+
+    key.name = buf;
+    key.wildcard = 0;
+    sn = lh_SSL_SERVERNAME_retrieve(ctx->ext.servernames, &key);
+    /* A wildcard stands for exactly one non-empty leftmost label */
+    if (sn == NULL && (dot = strchr(buf, '.')) != NULL && dot != buf
+            && dot[1] != '\0') {
+        key.name = dot + 1;
+        key.wildcard = 1;
+        sn = lh_SSL_SERVERNAME_retrieve(ctx->ext.servernames, &key);
+    }
+    return sn != NULL ? sn->ctx : NULL;
+}
+
+SSL_CTX *SSL_CTX_get0_servername_ctx(const SSL_CTX *ctx, const char *name)
+{
+    SSL_CTX *ret;
+
+    if (!CRYPTO_THREAD_read_lock(ctx->lock))
+        return NULL;
+    ret = servername_find(ctx, name);
+    CRYPTO_THREAD_unlock(ctx->lock);
+    return ret;
+}
+
+/*
+ * Like SSL_CTX_get0_servername_ctx() but returns a reference, so that the
+ * SSL_CTX stays valid even if the name is registered again meanwhile.
+ */
+SSL_CTX *ossl_ssl_ctx_get1_servername_ctx(SSL_CTX *ctx, const char *name)
+{
+    SSL_CTX *ret;
+
+    if (!CRYPTO_THREAD_read_lock(ctx->lock))
+        return NULL;
+    ret = servername_find(ctx, name);
+    if (ret != NULL && !SSL_CTX_up_ref(ret))
+        ret = NULL;
+    CRYPTO_THREAD_unlock(ctx->lock);
+    return ret;
+}
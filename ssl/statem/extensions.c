@@ -990,6 +990,8 @@ static int final_server_name(SSL_CONNECTION *s, unsigned int context, int sent)
     int altmp = SSL_AD_UNRECOGNIZED_NAME;
     SSL *ssl = SSL_CONNECTION_GET_SSL(s);
     SSL_CTX *sctx = SSL_CONNECTION_GET_CTX(s);
+    int (*servername_cb) (SSL *, int *, void *);
+    void *servername_arg;
     int was_ticket = (SSL_get_options(ssl) & SSL_OP_NO_TICKET) == 0;
 
     if (!ossl_assert(sctx != NULL) || !ossl_assert(s->session_ctx != NULL)) {
@@ -997,9 +999,33 @@ static int final_server_name(SSL_CONNECTION *s, unsigned int context, int sent)
         return 0;
     }
 
-    if (sctx->ext.servername_cb != NULL)
-        ret = sctx->ext.servername_cb(ssl, &altmp,
-                                      sctx->ext.servername_arg);
+    /*
+     * Switch to the SSL_CTX registered for the servername, if any, before
+     * running the servername callback so that it can still override it. The
+     * callback is still the one of the SSL_CTX the connection started with,
+     * as if it had made the switch itself.
+     */
+    servername_cb = sctx->ext.servername_cb;
+    servername_arg = sctx->ext.servername_arg;
+    if (s->server) {
+        const char *name = SSL_get_servername(ssl, TLSEXT_NAMETYPE_host_name);
+        SSL_CTX *sni_ctx = ossl_ssl_ctx_get1_servername_ctx(sctx, name);
+
+        if (sni_ctx != NULL) {
+            if (SSL_set_SSL_CTX(ssl, sni_ctx) == NULL) {
+                SSL_CTX_free(sni_ctx);
+                SSLfatal(s, SSL_AD_INTERNAL_ERROR, ERR_R_INTERNAL_ERROR);
+                return 0;
+            }
+            /* The connection holds its own reference now */
+            sctx = sni_ctx;
+            SSL_CTX_free(sni_ctx);
+            ret = SSL_TLSEXT_ERR_OK;
+        }
+    }
+
+    if (servername_cb != NULL)
+        ret = servername_cb(ssl, &altmp, servername_arg);
     else if (s->session_ctx->ext.servername_cb != NULL)
         ret = s->session_ctx->ext.servername_cb(ssl, &altmp,
                                        s->session_ctx->ext.servername_arg);
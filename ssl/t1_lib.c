@@ -20,6 +20,7 @@
 #include <openssl/bn.h>
 #include <openssl/provider.h>
 #include <openssl/param_build.h>
+#include <openssl/rand.h>
 #include "internal/nelem.h"
 #include "internal/sizes.h"
 #include "internal/tlsgroups.h"
@@ -2254,11 +2255,6 @@ SSL_TICKET_STATUS tls_decrypt_ticket(SSL_CONNECTION *s,
     }
 
     /* Initialize session ticket encryption and HMAC contexts */
-    hctx = ssl_hmac_new(tctx);
-    if (hctx == NULL) {
-        ret = SSL_TICKET_FATAL_ERR_MALLOC;
-        goto end;
-    }
     ctx = EVP_CIPHER_CTX_new();
     if (ctx == NULL) {
         ret = SSL_TICKET_FATAL_ERR_MALLOC;
@@ -2273,6 +2269,12 @@ SSL_TICKET_STATUS tls_decrypt_ticket(SSL_CONNECTION *s,
         unsigned char *nctick = (unsigned char *)etick;
         int rv = 0;
 
+        hctx = ssl_hmac_new(tctx);
+        if (hctx == NULL) {
+            ret = SSL_TICKET_FATAL_ERR_MALLOC;
+            goto end;
+        }
+
         if (tctx->ext.ticket_key_evp_cb != NULL)
             rv = tctx->ext.ticket_key_evp_cb(SSL_CONNECTION_GET_SSL(s), nctick,
                                              nctick + TLSEXT_KEYNAME_LENGTH,
@@ -2297,29 +2299,20 @@ SSL_TICKET_STATUS tls_decrypt_ticket(SSL_CONNECTION *s,
         if (rv == 2)
             renew_ticket = 1;
     } else {
-        EVP_CIPHER *aes256cbc = NULL;
+        int rv;
 
-        /* Check key name matches */
-        if (memcmp(etick, tctx->ext.tick_key_name,
-                   TLSEXT_KEYNAME_LENGTH) != 0) {
-            ret = SSL_TICKET_NO_DECRYPT;
+        /* Find the key by name and set up copies of its contexts */
+        rv = ssl_ticket_key_init(tctx, (unsigned char *)etick,
+                                 (unsigned char *)etick + TLSEXT_KEYNAME_LENGTH,
+                                 0, ctx, &hctx, &renew_ticket);
+        if (rv < 0) {
+            ret = SSL_TICKET_FATAL_ERR_OTHER;
             goto end;
         }
-
-        aes256cbc = EVP_CIPHER_fetch(sctx->libctx, "AES-256-CBC",
-                                     sctx->propq);
-        if (aes256cbc == NULL
-            || ssl_hmac_init(hctx, tctx->ext.secure->tick_hmac_key,
-                             sizeof(tctx->ext.secure->tick_hmac_key),
-                             "SHA256") <= 0
-            || EVP_DecryptInit_ex(ctx, aes256cbc, NULL,
-                                  tctx->ext.secure->tick_aes_key,
-                                  etick + TLSEXT_KEYNAME_LENGTH) <= 0) {
-            EVP_CIPHER_free(aes256cbc);
-            ret = SSL_TICKET_FATAL_ERR_OTHER;
+        if (rv == 0) {
+            ret = SSL_TICKET_NO_DECRYPT;
             goto end;
         }
-        EVP_CIPHER_free(aes256cbc);
         if (SSL_CONNECTION_IS_TLS13(s))
             renew_ticket = 1;
     }
@@ -3973,6 +3966,165 @@ size_t ssl_hmac_size(const SSL_HMAC *ctx)
     return 0;
 }
 
+/*
+ * Create a new SSL_HMAC from a copy of the already keyed |src|.
+ */
+SSL_HMAC *ssl_hmac_new_dup(const EVP_MAC_CTX *src)
+{
+    SSL_HMAC *ret = OPENSSL_zalloc(sizeof(*ret));
+
+    if (ret == NULL)
+        return NULL;
+    if ((ret->ctx = EVP_MAC_CTX_dup(src)) == NULL) {
+        OPENSSL_free(ret);
+        return NULL;
+    }
+    return ret;
+}
+
+/*
+ * Free the prepared contexts of all built-in ticket keys. They get set up
+ * again on next use. Must be called with the SSL_CTX lock held for writing
+ * (or when no other thread can access |tctx|).
+ */
+void ssl_ticket_keys_clear_ctx(SSL_CTX *tctx)
+{
+    size_t i;
+
+    for (i = 0; i < TLSEXT_TICK_MAX_KEYS; i++) {
+        SSL_TICKET_KEY *key = &tctx->ext.tick_keys[i];
+
+        EVP_CIPHER_CTX_free(key->enc_ctx);
+        EVP_CIPHER_CTX_free(key->dec_ctx);
+        EVP_MAC_CTX_free(key->mac_ctx);
+        key->enc_ctx = key->dec_ctx = NULL;
+        key->mac_ctx = NULL;
+    }
+}
+
+/* Must be called with the SSL_CTX lock held for writing */
+static int ticket_key_prepare(SSL_CTX *tctx, SSL_TICKET_KEY *key)
+{
+    size_t idx = key - tctx->ext.tick_keys;
+    EVP_CIPHER *aes256cbc = NULL;
+    EVP_MAC *hmac = NULL;
+    OSSL_PARAM params[2];
+    int ok = 0;
+
+    if (key->mac_ctx != NULL)
+        return 1;
+
+    params[0] = OSSL_PARAM_construct_utf8_string(OSSL_MAC_PARAM_DIGEST,
+                                                 "SHA256", 0);
+    params[1] = OSSL_PARAM_construct_end();
+
+    aes256cbc = EVP_CIPHER_fetch(tctx->libctx, "AES-256-CBC", tctx->propq);
+    hmac = EVP_MAC_fetch(tctx->libctx, "HMAC", tctx->propq);
+    if (aes256cbc == NULL
+            || hmac == NULL
+            || (key->enc_ctx = EVP_CIPHER_CTX_new()) == NULL
+            || (key->dec_ctx = EVP_CIPHER_CTX_new()) == NULL
+            || (key->mac_ctx = EVP_MAC_CTX_new(hmac)) == NULL
+            || !EVP_EncryptInit_ex(key->enc_ctx, aes256cbc, NULL,
+                                   tctx->ext.secure->tick_aes_key[idx], NULL)
+            || !EVP_DecryptInit_ex(key->dec_ctx, aes256cbc, NULL,
+                                   tctx->ext.secure->tick_aes_key[idx], NULL)
+            || !EVP_MAC_init(key->mac_ctx, tctx->ext.secure->tick_hmac_key[idx],
+                             TLSEXT_TICK_KEY_LENGTH, params))
+        goto err;
+
+    ok = 1;
+ err:
+    if (!ok) {
+        EVP_CIPHER_CTX_free(key->enc_ctx);
+        EVP_CIPHER_CTX_free(key->dec_ctx);
+        EVP_MAC_CTX_free(key->mac_ctx);
+        key->enc_ctx = key->dec_ctx = NULL;
+        key->mac_ctx = NULL;
+    }
+    EVP_CIPHER_free(aes256cbc);
+    EVP_MAC_free(hmac);
+    return ok;
+}
+
+static SSL_TICKET_KEY *ticket_key_find(SSL_CTX *tctx,
+                                       const unsigned char *key_name, int enc)
+{
+    size_t i;
+
+    if (tctx->ext.tick_key_count == 0)
+        return NULL;
+    if (enc)
+        return &tctx->ext.tick_keys[0];
+    for (i = 0; i < tctx->ext.tick_key_count; i++)
+        if (memcmp(key_name, tctx->ext.tick_keys[i].name,
+                   TLSEXT_KEYNAME_LENGTH) == 0)
+            return &tctx->ext.tick_keys[i];
+    return NULL;
+}
+
+/*
+ * Set up |cctx| and |*hctx| to encrypt (|enc| == 1) or decrypt a ticket with
+ * one of the built-in ticket keys of |tctx|.
+ *
+ * When encrypting, the current key is used: its name is written to |key_name|
+ * and a random IV is generated into |iv|. When decrypting, the key is looked
+ * up by |key_name| and |iv| is used as is. |*renew| is set to 1 if the ticket
+ * was encrypted with an older key and should be replaced.
+ *
+ * Returns 1 on success, 0 if no key matches |key_name| or -1 on error. On
+ * success the caller must free |*hctx|.
+ */
+int ssl_ticket_key_init(SSL_CTX *tctx, unsigned char *key_name,
+                        unsigned char *iv, int enc, EVP_CIPHER_CTX *cctx,
+                        SSL_HMAC **hctx, int *renew)
+{
+    SSL_TICKET_KEY *key;
+    int ret = -1, ivlen;
+
+    *hctx = NULL;
+    if (!CRYPTO_THREAD_read_lock(tctx->lock))
+        return -1;
+    key = ticket_key_find(tctx, key_name, enc);
+    if (key != NULL && key->mac_ctx == NULL) {
+        /* First use of this key, so set up its contexts */
+        CRYPTO_THREAD_unlock(tctx->lock);
+        if (!CRYPTO_THREAD_write_lock(tctx->lock))
+            return -1;
+        /* The keys might have changed while we were not holding the lock */
+        key = ticket_key_find(tctx, key_name, enc);
+        if (key != NULL && !ticket_key_prepare(tctx, key))
+            goto end;
+    }
+    if (key == NULL) {
+        ret = 0;
+        goto end;
+    }
+
+    if (enc)
+        memcpy(key_name, key->name, TLSEXT_KEYNAME_LENGTH);
+    if (renew != NULL)
+        *renew = (key != &tctx->ext.tick_keys[0]);
+    if (!EVP_CIPHER_CTX_copy(cctx, enc ? key->enc_ctx : key->dec_ctx)
+            || (*hctx = ssl_hmac_new_dup(key->mac_ctx)) == NULL)
+        goto end;
+    ret = 1;
+ end:
+    CRYPTO_THREAD_unlock(tctx->lock);
+    if (ret != 1)
+        return ret;
+
+    ivlen = EVP_CIPHER_CTX_get_iv_length(cctx);
+    if (ivlen <= 0
+            || (enc && RAND_bytes_ex(tctx->libctx, iv, ivlen, 0) <= 0)
+            || !EVP_CipherInit_ex(cctx, NULL, NULL, NULL, iv, enc)) {
+        ssl_hmac_free(*hctx);
+        *hctx = NULL;
+        return -1;
+    }
+    return 1;
+}
+
 int ssl_get_EC_curve_nid(const EVP_PKEY *pkey)
 {
     char gname[OSSL_MAX_NAME_SIZE];
@@ -83,6 +83,7 @@ static int verify_cb(int preverify_ok, X509_STORE_CTX *x509_ctx)
  * Test 1 = app pre-compresses certificate in SSL_CTX
  * Test 2 = app pre-compresses certificate in SSL_CTX, client authentication
  * Test 3 = app pre-compresses certificate in SSL_CTX, but it's unused due to prefs
+ * Test 4 = certificate is pre-compressed in SSL_CTX by SSL_OP_PRECOMPRESS_CERTIFICATES
  */
 /* Compression helper */
 static int ssl_comp_cert(SSL *ssl, int alg)
@@ -161,7 +162,9 @@ static int test_ssl_cert_comp(int test)
     if (!TEST_true(create_ssl_ctx_pair(NULL, TLS_server_method(),
                                        TLS_client_method(),
                                        TLS1_3_VERSION, 0,
-                                       &sctx, &cctx, cert, privkey)))
+                                       &sctx, &cctx,
+                                       test == 4 ? NULL : cert,
+                                       test == 4 ? NULL : privkey)))
         goto end;
     if (test == 3) {
         /* coverity[deadcode] */
@@ -188,10 +191,23 @@ static int test_ssl_cert_comp(int test)
         if (!TEST_true(SSL_CTX_compress_certs(sctx, expected_server)))
             goto end;
     }
+    if (test == 4) {
+        SSL_CTX_set_options(sctx, SSL_OP_PRECOMPRESS_CERTIFICATES);
+        if (!TEST_int_eq(SSL_CTX_use_certificate_chain_file(sctx, cert), 1)
+                || !TEST_int_eq(SSL_CTX_use_PrivateKey_file(sctx, privkey,
+                                                            SSL_FILETYPE_PEM),
+                                1)
+                || !TEST_ptr_null(sctx->cert->key->comp_cert[expected_server]))
+            goto end;
+    }
 
     if (!TEST_true(create_ssl_objects(sctx, cctx, &serverssl, &clientssl,
                                       NULL, NULL)))
         goto end;
+    /* The chain is compressed once, when the first SSL object is created */
+    if (test == 4
+            && !TEST_ptr(sctx->cert->key->comp_cert[expected_server]))
+        goto end;
 
     if (!TEST_true(SSL_set_app_data(clientssl, &client_seen)))
         goto end;
@@ -266,7 +282,7 @@ int setup_tests(void)
     if (privkey == NULL)
         goto err;
 
-    ADD_ALL_TESTS(test_ssl_cert_comp, 4);
+    ADD_ALL_TESTS(test_ssl_cert_comp, 5);
     return 1;
 
  err:
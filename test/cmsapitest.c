@@ -1,5 +1,5 @@
 /*
- * Copyright 2018-2023 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2018-2024 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -13,6 +13,8 @@
 #include <openssl/bio.h>
 #include <openssl/x509.h>
 #include <openssl/pem.h>
+#include <openssl/err.h>
+#include <openssl/thread.h>
 #include "../crypto/cms/cms_local.h" /* for d.signedData and d.envelopedData */
 
 #include "testutil.h"
@@ -101,6 +103,60 @@ static int test_CMS_add1_cert(void)
     return ret;
 }
 
+/*
+ * Verify a SignedData with several signers, using worker threads for the
+ * signer certificates in the second iteration. A failure should be reported
+ * once, for the first signer, whatever the number of threads.
+ */
+static int test_CMS_verify_signers(int idx)
+{
+    CMS_ContentInfo *cms = NULL;
+    X509_STORE *store = NULL, *empty = NULL;
+    BIO *msg = NULL;
+    unsigned long err;
+    int i, count = 0, ret = 0;
+    const unsigned char data[] = "Hello, world";
+
+    if (idx == 1 && !OSSL_set_max_threads(NULL, 3))
+        return TEST_skip("thread pool not available");
+
+    if (!TEST_ptr(msg = BIO_new_mem_buf(data, sizeof(data)))
+            || !TEST_ptr(cms = CMS_sign(NULL, NULL, NULL, msg,
+                                        CMS_BINARY | CMS_PARTIAL)))
+        goto end;
+    for (i = 0; i < 5; i++)
+        if (!TEST_ptr(CMS_add1_signer(cms, cert, privkey, NULL, 0)))
+            goto end;
+    if (!TEST_true(CMS_final(cms, msg, NULL, CMS_BINARY))
+            || !TEST_ptr(store = X509_STORE_new())
+            || !TEST_true(X509_STORE_add_cert(store, cert))
+            || !TEST_true(X509_STORE_set_flags(store,
+                                               X509_V_FLAG_PARTIAL_CHAIN))
+            || !TEST_true(X509_STORE_set_purpose(store, X509_PURPOSE_ANY))
+            || !TEST_ptr(empty = X509_STORE_new())
+            || !TEST_true(CMS_verify(cms, NULL, store, NULL, NULL,
+                                     CMS_BINARY)))
+        goto end;
+
+    ERR_clear_error();
+    if (!TEST_false(CMS_verify(cms, NULL, empty, NULL, NULL, CMS_BINARY)))
+        goto end;
+    while ((err = ERR_get_error()) != 0)
+        if (ERR_GET_LIB(err) == ERR_LIB_CMS
+                && ERR_GET_REASON(err) == CMS_R_CERTIFICATE_VERIFY_ERROR)
+            count++;
+    ret = TEST_int_eq(count, 1);
+
+ end:
+    if (idx == 1)
+        OSSL_set_max_threads(NULL, 0);
+    X509_STORE_free(store);
+    X509_STORE_free(empty);
+    CMS_ContentInfo_free(cms);
+    BIO_free(msg);
+    return ret;
+}
+
 static int test_d2i_CMS_bio_NULL(void)
 {
     BIO *bio, *content = NULL;
@@ -427,6 +483,7 @@ int setup_tests(void)
     ADD_TEST(test_encrypt_decrypt_aes_192_gcm);
     ADD_TEST(test_encrypt_decrypt_aes_256_gcm);
     ADD_TEST(test_CMS_add1_cert);
+    ADD_ALL_TESTS(test_CMS_verify_signers, 2);
     ADD_TEST(test_d2i_CMS_bio_NULL);
     ADD_ALL_TESTS(test_d2i_CMS_decode, 2);
     return 1;
@@ -371,6 +371,85 @@ static int test_unknown_critical_crl(int n)
     return r;
 }
 
+static int test_crl_lookup(void)
+{
+    X509_CRL *crl = CRL_from_strings(kRevokedCRL);
+    X509_REVOKED *rev = NULL, *added, *found = NULL;
+    ASN1_INTEGER *serial = NULL;
+    int r = 0;
+
+    if (!TEST_ptr(crl)
+            || !TEST_ptr(serial = ASN1_INTEGER_new())
+            || !TEST_true(ASN1_INTEGER_set(serial, 0x1000))
+            || !TEST_int_eq(X509_CRL_get0_by_serial(crl, &found, serial), 1)
+            || !TEST_int_eq(ASN1_INTEGER_cmp(X509_REVOKED_get0_serialNumber(found),
+                                             serial), 0)
+            || !TEST_int_eq(X509_CRL_get0_by_cert(crl, &found, test_leaf), 1)
+            || !TEST_true(ASN1_INTEGER_set(serial, 0x1001))
+            || !TEST_int_eq(X509_CRL_get0_by_serial(crl, NULL, serial), 0)
+            || !TEST_true(ASN1_INTEGER_set(serial, -0x1000))
+            || !TEST_int_eq(X509_CRL_get0_by_serial(crl, NULL, serial), 0))
+        goto err;
+
+    /* Entries added after decoding are found as well */
+    if (!TEST_ptr(rev = X509_REVOKED_new())
+            || !TEST_true(ASN1_INTEGER_set(serial, 42))
+            || !TEST_true(X509_REVOKED_set_serialNumber(rev, serial))
+            || !TEST_true(X509_CRL_add0_revoked(crl, rev)))
+        goto err;
+    added = rev;
+    rev = NULL;
+    if (!TEST_int_eq(X509_CRL_get0_by_serial(crl, &found, serial), 1)
+            || !TEST_ptr_eq(found, added)
+            || !TEST_int_eq(X509_CRL_get0_by_cert(crl, NULL, test_leaf), 1))
+        goto err;
+    r = 1;
+ err:
+    X509_REVOKED_free(rev);
+    ASN1_INTEGER_free(serial);
+    X509_CRL_free(crl);
+    return r;
+}
+
+/*
+ * Changes to the stack of revoked entries must not make lookups return
+ * entries that are gone, and X509_CRL_sort() makes changed entries visible.
+ */
+static int test_crl_lookup_changed(void)
+{
+    X509_CRL *crl = CRL_from_strings(kRevokedCRL);
+    X509_REVOKED *rev = NULL, *added, *old, *found = NULL;
+    ASN1_INTEGER *serial = NULL;
+    int r = 0;
+
+    if (!TEST_ptr(crl)
+            || !TEST_ptr(serial = ASN1_INTEGER_new())
+            || !TEST_true(ASN1_INTEGER_set(serial, 42))
+            || !TEST_ptr(rev = X509_REVOKED_new())
+            || !TEST_true(X509_REVOKED_set_serialNumber(rev, serial))
+            || !TEST_int_eq(sk_X509_REVOKED_num(X509_CRL_get_REVOKED(crl)), 1))
+        goto err;
+    /* Replace the only entry, which revokes test_leaf */
+    old = sk_X509_REVOKED_value(X509_CRL_get_REVOKED(crl), 0);
+    (void)sk_X509_REVOKED_set(X509_CRL_get_REVOKED(crl), 0, rev);
+    X509_REVOKED_free(old);
+    added = rev;
+    rev = NULL;
+
+    if (!TEST_int_eq(X509_CRL_get0_by_cert(crl, NULL, test_leaf), 0)
+            || !TEST_true(X509_CRL_sort(crl))
+            || !TEST_int_eq(X509_CRL_get0_by_serial(crl, &found, serial), 1)
+            || !TEST_ptr_eq(found, added)
+            || !TEST_int_eq(X509_CRL_get0_by_cert(crl, NULL, test_leaf), 0))
+        goto err;
+    r = 1;
+ err:
+    X509_REVOKED_free(rev);
+    ASN1_INTEGER_free(serial);
+    X509_CRL_free(crl);
+    return r;
+}
+
 static int test_reuse_crl(void)
 {
     X509_CRL *reused_crl = CRL_from_strings(kBasicCRL);
@@ -403,6 +482,8 @@ int setup_tests(void)
     ADD_TEST(test_known_critical_crl);
     ADD_ALL_TESTS(test_unknown_critical_crl, OSSL_NELEM(unknown_critical_crls));
     ADD_TEST(test_reuse_crl);
+    ADD_TEST(test_crl_lookup);
+    ADD_TEST(test_crl_lookup_changed);
     return 1;
 }
 
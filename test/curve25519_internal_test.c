@@ -0,0 +1,146 @@
+/*
+ * Copyright 2024 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+#include <openssl/core_names.h>
+#include <openssl/evp.h>
+#include <openssl/rand.h>
+#include "crypto/ecx.h"
+#include "testutil.h"
+
+/* Test vectors from RFC7748 for X25519 */
+
+static const uint8_t in_scalar1[32] = {
+    0xa5, 0x46, 0xe3, 0x6b, 0xf0, 0x52, 0x7c, 0x9d, 0x3b, 0x16, 0x15, 0x4b,
+    0x82, 0x46, 0x5e, 0xdd, 0x62, 0x14, 0x4c, 0x0a, 0xc1, 0xfc, 0x5a, 0x18,
+    0x50, 0x6a, 0x22, 0x44, 0xba, 0x44, 0x9a, 0xc4
+};
+
+static const uint8_t in_u1[32] = {
+    0xe6, 0xdb, 0x68, 0x67, 0x58, 0x30, 0x30, 0xdb, 0x35, 0x94, 0xc1, 0xa4,
+    0x24, 0xb1, 0x5f, 0x7c, 0x72, 0x66, 0x24, 0xec, 0x26, 0xb3, 0x35, 0x3b,
+    0x10, 0xa9, 0x03, 0xa6, 0xd0, 0xab, 0x1c, 0x4c
+};
+
+static const uint8_t out_u1[32] = {
+    0xc3, 0xda, 0x55, 0x37, 0x9d, 0xe9, 0xc6, 0x90, 0x8e, 0x94, 0xea, 0x4d,
+    0xf2, 0x8d, 0x08, 0x4f, 0x32, 0xec, 0xcf, 0x03, 0x49, 0x1c, 0x71, 0xf7,
+    0x54, 0xb4, 0x07, 0x55, 0x77, 0xa2, 0x85, 0x52
+};
+
+static const uint8_t in_scalar2[32] = {
+    0x4b, 0x66, 0xe9, 0xd4, 0xd1, 0xb4, 0x67, 0x3c, 0x5a, 0xd2, 0x26, 0x91,
+    0x95, 0x7d, 0x6a, 0xf5, 0xc1, 0x1b, 0x64, 0x21, 0xe0, 0xea, 0x01, 0xd4,
+    0x2c, 0xa4, 0x16, 0x9e, 0x79, 0x18, 0xba, 0x0d
+};
+
+static const uint8_t in_u2[32] = {
+    0xe5, 0x21, 0x0f, 0x12, 0x78, 0x68, 0x11, 0xd3, 0xf4, 0xb7, 0x95, 0x9d,
+    0x05, 0x38, 0xae, 0x2c, 0x31, 0xdb, 0xe7, 0x10, 0x6f, 0xc0, 0x3c, 0x3e,
+    0xfc, 0x4c, 0xd5, 0x49, 0xc7, 0x15, 0xa4, 0x93
+};
+
+static const uint8_t out_u2[32] = {
+    0x95, 0xcb, 0xde, 0x94, 0x76, 0xe8, 0x90, 0x7d, 0x7a, 0xad, 0xe4, 0x5c,
+    0xb4, 0xb8, 0x73, 0xf8, 0x8b, 0x59, 0x5a, 0x68, 0x79, 0x9f, 0xa1, 0x52,
+    0xe6, 0xf8, 0xf7, 0x64, 0x7a, 0xac, 0x79, 0x57
+};
+
+static int test_x25519(void)
+{
+    uint8_t out[32];
+
+    return TEST_true(ossl_x25519(out, in_scalar1, in_u1))
+        && TEST_mem_eq(out, sizeof(out), out_u1, sizeof(out_u1))
+        && TEST_true(ossl_x25519(out, in_scalar2, in_u2))
+        && TEST_mem_eq(out, sizeof(out), out_u2, sizeof(out_u2));
+}
+
+static int ed25519_sign(EVP_PKEY *pkey, const unsigned char *msg,
+                        size_t msglen, unsigned char sig[ED25519_SIGSIZE])
+{
+    EVP_MD_CTX *ctx = EVP_MD_CTX_new();
+    size_t siglen = ED25519_SIGSIZE;
+    int ret;
+
+    ret = TEST_ptr(ctx)
+        && TEST_int_eq(EVP_DigestSignInit(ctx, NULL, NULL, NULL, pkey), 1)
+        && TEST_int_eq(EVP_DigestSign(ctx, sig, &siglen, msg, msglen), 1)
+        && TEST_size_t_eq(siglen, ED25519_SIGSIZE);
+    EVP_MD_CTX_free(ctx);
+    return ret;
+}
+
+static int ed25519_verify(EVP_PKEY *pkey, const unsigned char *msg,
+                          size_t msglen, const unsigned char *sig)
+{
+    EVP_MD_CTX *ctx = EVP_MD_CTX_new();
+    int ret = 0;
+
+    if (ctx != NULL
+            && EVP_DigestVerifyInit(ctx, NULL, NULL, NULL, pkey) == 1)
+        ret = EVP_DigestVerify(ctx, sig, ED25519_SIGSIZE, msg, msglen);
+    EVP_MD_CTX_free(ctx);
+    return ret;
+}
+
+/*
+ * Signatures are deterministic, so they must be the same with and without
+ * precomputation, and verify with and without it.
+ */
+static int test_ed25519_precompute(int idx)
+{
+    EVP_PKEY *pkey = NULL, *dup = NULL;
+    unsigned char msg[100], sig[ED25519_SIGSIZE], sig2[ED25519_SIGSIZE];
+    int precompute = -1, ret = 0;
+
+    if (!TEST_ptr(pkey = EVP_PKEY_Q_keygen(NULL, NULL, "ED25519"))
+            || !TEST_int_eq(RAND_bytes(msg, sizeof(msg)), 1)
+            || !ed25519_sign(pkey, msg, sizeof(msg), sig)
+            || !TEST_true(EVP_PKEY_get_int_param(pkey,
+                                                 OSSL_PKEY_PARAM_PRECOMPUTE,
+                                                 &precompute))
+            || !TEST_int_eq(precompute, 0)
+            || !TEST_true(EVP_PKEY_set_int_param(pkey,
+                                                 OSSL_PKEY_PARAM_PRECOMPUTE,
+                                                 1))
+            || !TEST_true(EVP_PKEY_get_int_param(pkey,
+                                                 OSSL_PKEY_PARAM_PRECOMPUTE,
+                                                 &precompute))
+            || !TEST_int_eq(precompute, 1)
+            || !ed25519_sign(pkey, msg, sizeof(msg), sig2)
+            || !TEST_mem_eq(sig, sizeof(sig), sig2, sizeof(sig2)))
+        goto err;
+
+    if (idx == 1) {
+        /* A duplicate has the tables of its own */
+        if (!TEST_ptr(dup = EVP_PKEY_dup(pkey)))
+            goto err;
+        EVP_PKEY_free(pkey);
+        pkey = dup;
+    }
+    if (!TEST_int_eq(ed25519_verify(pkey, msg, sizeof(msg), sig), 1))
+        goto err;
+    sig[idx * 40] ^= 1;
+    if (!TEST_int_eq(ed25519_verify(pkey, msg, sizeof(msg), sig), 0))
+        goto err;
+    sig[idx * 40] ^= 1;
+    msg[0] ^= 1;
+    if (!TEST_int_eq(ed25519_verify(pkey, msg, sizeof(msg), sig), 0))
+        goto err;
+    ret = 1;
+ err:
+    EVP_PKEY_free(pkey);
+    return ret;
+}
+
+int setup_tests(void)
+{
+    ADD_TEST(test_x25519);
+    ADD_ALL_TESTS(test_ed25519_precompute, 2);
+    return 1;
+}
@@ -362,6 +362,60 @@ static int test_ecdsa_sig_NULL(void)
     return ret;
 }
 
+/*
+ * Verify enough times with the same key for the multiples of its public key
+ * to be precomputed, checking that they are dropped when the key changes.
+ */
+static int test_verify_repeated(int n)
+{
+    EC_KEY *eckey = NULL, *eckey2 = NULL, *dup = NULL;
+    ECDSA_SIG *sig = NULL, *sig2 = NULL;
+    unsigned char dgst[32], bad[32];
+    int nid = curves[n].nid, i, ret = 0;
+
+    /* skip built-in curves where ord(G) is not prime, and SM2 */
+    if (nid == NID_ipsec4 || nid == NID_ipsec3 || nid == NID_sm2)
+        return 1;
+
+    if (!TEST_int_gt(RAND_bytes(dgst, sizeof(dgst)), 0)
+        || !TEST_ptr(eckey = EC_KEY_new_by_curve_name(nid))
+        || !TEST_true(EC_KEY_generate_key(eckey))
+        || !TEST_ptr(eckey2 = EC_KEY_new_by_curve_name(nid))
+        || !TEST_true(EC_KEY_generate_key(eckey2))
+        || !TEST_ptr(sig = ECDSA_do_sign(dgst, sizeof(dgst), eckey))
+        || !TEST_ptr(sig2 = ECDSA_do_sign(dgst, sizeof(dgst), eckey2)))
+        goto err;
+    memcpy(bad, dgst, sizeof(bad));
+    bad[0] ^= 1;
+
+    for (i = 0; i < 20; i++)
+        if (!TEST_int_eq(ECDSA_do_verify(dgst, sizeof(dgst), sig, eckey), 1))
+            goto err;
+
+    if (!TEST_int_eq(ECDSA_do_verify(bad, sizeof(bad), sig, eckey), 0)
+        || !TEST_int_eq(ECDSA_do_verify(dgst, sizeof(dgst), sig2, eckey), 0)
+        || !TEST_ptr(dup = EC_KEY_dup(eckey))
+        || !TEST_int_eq(ECDSA_do_verify(dgst, sizeof(dgst), sig, dup), 1)
+        || !TEST_true(EC_KEY_set_public_key(eckey,
+                                            EC_KEY_get0_public_key(eckey2))))
+        goto err;
+
+    for (i = 0; i < 20; i++)
+        if (!TEST_int_eq(ECDSA_do_verify(dgst, sizeof(dgst), sig2, eckey), 1))
+            goto err;
+
+    if (!TEST_int_eq(ECDSA_do_verify(dgst, sizeof(dgst), sig, eckey), 0))
+        goto err;
+    ret = 1;
+ err:
+    EC_KEY_free(eckey);
+    EC_KEY_free(eckey2);
+    EC_KEY_free(dup);
+    ECDSA_SIG_free(sig);
+    ECDSA_SIG_free(sig2);
+    return ret;
+}
+
 #endif /* OPENSSL_NO_EC */
 
 int setup_tests(void)
@@ -382,6 +436,7 @@ int setup_tests(void)
     }
     ADD_ALL_TESTS(test_builtin_as_ec, crv_len);
     ADD_TEST(test_ecdsa_sig_NULL);
+    ADD_ALL_TESTS(test_verify_repeated, crv_len);
 # ifndef OPENSSL_NO_SM2
     ADD_ALL_TESTS(test_builtin_as_sm2, crv_len);
 # endif
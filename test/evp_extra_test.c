@@ -5463,6 +5463,249 @@ static int test_aes_gcm_ivlen_change_cve_2023_5363(void)
                            gcm_ct, sizeof(gcm_ct), gcm_tag, sizeof(gcm_tag));
 }
 
+static const char *aead_batch_ciphers[] = {
+    "AES-128-GCM",
+    "AES-256-GCM",
+    "AES-128-CCM",
+#if !defined(OPENSSL_NO_CHACHA) && !defined(OPENSSL_NO_POLY1305)
+    "ChaCha20-Poly1305",
+#endif
+};
+
+#define AEAD_BATCH_NUM      40
+#define AEAD_BATCH_KEYS     3
+#define AEAD_BATCH_MAXLEN   1500
+
+/* Seal a single message with the regular EVP calls */
+static int aead_seal_one(EVP_CIPHER *cipher, const unsigned char *key,
+                         const unsigned char *iv, const unsigned char *aad,
+                         size_t aadlen, const unsigned char *in, size_t inl,
+                         unsigned char *out, unsigned char *tag, size_t taglen)
+{
+    EVP_CIPHER_CTX *ctx = EVP_CIPHER_CTX_new();
+    int outl, tmpl, ret = 0;
+
+    if (!TEST_ptr(ctx)
+            || !TEST_true(EVP_EncryptInit_ex2(ctx, cipher, key, iv, NULL)))
+        goto err;
+    if (EVP_CIPHER_get_mode(cipher) == EVP_CIPH_CCM_MODE
+            && !TEST_true(EVP_EncryptUpdate(ctx, NULL, &outl, NULL, (int)inl)))
+        goto err;
+    if (!TEST_true(EVP_EncryptUpdate(ctx, NULL, &outl, aad, (int)aadlen))
+            || !TEST_true(EVP_EncryptUpdate(ctx, out, &outl, in, (int)inl))
+            || !TEST_true(EVP_EncryptFinal_ex(ctx, out + outl, &tmpl))
+            || !TEST_int_gt(EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_GET_TAG,
+                                                (int)taglen, tag), 0))
+        goto err;
+    ret = 1;
+ err:
+    EVP_CIPHER_CTX_free(ctx);
+    return ret;
+}
+
+/*
+ * Seal a batch of messages of assorted lengths under several keys with
+ * EVP_CipherAEADBatch(), compare the result with sealing each message on its
+ * own and open the batch again, with one of the tags corrupted.
+ */
+static int test_evp_aead_batch(int idx)
+{
+    EVP_CIPHER *cipher = NULL;
+    EVP_CIPHER_CTX *ectx[AEAD_BATCH_KEYS] = { NULL };
+    EVP_CIPHER_CTX *dctx[AEAD_BATCH_KEYS] = { NULL };
+    EVP_CIPHER_CTX *ctx[AEAD_BATCH_NUM];
+    unsigned char key[AEAD_BATCH_KEYS][32], ivs[AEAD_BATCH_NUM][16];
+    unsigned char aads[AEAD_BATCH_NUM][20], tags[AEAD_BATCH_NUM][16];
+    unsigned char reftag[16], *pt = NULL, *ct = NULL, *ref = NULL;
+    const unsigned char *iv[AEAD_BATCH_NUM], *aad[AEAD_BATCH_NUM];
+    const unsigned char *in[AEAD_BATCH_NUM];
+    unsigned char *out[AEAD_BATCH_NUM], *tag[AEAD_BATCH_NUM];
+    size_t aadlen[AEAD_BATCH_NUM], inl[AEAD_BATCH_NUM], taglen;
+    int ok[AEAD_BATCH_NUM];
+    size_t i, k;
+    int testresult = 0;
+
+    if (!TEST_ptr(cipher = EVP_CIPHER_fetch(testctx, aead_batch_ciphers[idx],
+                                            testpropq))
+            || !TEST_ptr(pt = OPENSSL_malloc(AEAD_BATCH_NUM * AEAD_BATCH_MAXLEN))
+            || !TEST_ptr(ct = OPENSSL_malloc(AEAD_BATCH_NUM * AEAD_BATCH_MAXLEN))
+            || !TEST_ptr(ref = OPENSSL_malloc(AEAD_BATCH_MAXLEN)))
+        goto err;
+
+    for (i = 0; i < AEAD_BATCH_NUM * AEAD_BATCH_MAXLEN; i++)
+        pt[i] = (unsigned char)(i * 131 + (i >> 8));
+    for (i = 0; i < sizeof(key); i++)
+        ((unsigned char *)key)[i] = (unsigned char)(i * 7 + 1);
+    for (i = 0; i < sizeof(ivs); i++)
+        ((unsigned char *)ivs)[i] = (unsigned char)(i * 13 + 5);
+    for (i = 0; i < sizeof(aads); i++)
+        ((unsigned char *)aads)[i] = (unsigned char)(i * 17 + 3);
+
+    for (k = 0; k < AEAD_BATCH_KEYS; k++)
+        if (!TEST_ptr(ectx[k] = EVP_CIPHER_CTX_new())
+                || !TEST_ptr(dctx[k] = EVP_CIPHER_CTX_new())
+                || !TEST_true(EVP_EncryptInit_ex2(ectx[k], cipher, key[k],
+                                                  NULL, NULL))
+                || !TEST_true(EVP_DecryptInit_ex2(dctx[k], cipher, key[k],
+                                                  NULL, NULL)))
+            goto err;
+    /* ChaCha20-Poly1305 does not report its tag length before it is set */
+    if ((taglen = EVP_CIPHER_CTX_get_tag_length(ectx[0])) == 0)
+        taglen = 16;
+    if (!TEST_size_t_le(taglen, sizeof(reftag)))
+        goto err;
+
+    /* Runs of messages under the same key, mostly short, a few long ones */
+    for (i = 0; i < AEAD_BATCH_NUM; i++) {
+        ctx[i] = ectx[(i / 5 + i) % AEAD_BATCH_KEYS];
+        iv[i] = ivs[i];
+        aad[i] = aads[i];
+        aadlen[i] = i % sizeof(aads[i]);
+        in[i] = pt + i * AEAD_BATCH_MAXLEN;
+        out[i] = ct + i * AEAD_BATCH_MAXLEN;
+        inl[i] = i % 7 == 6 ? AEAD_BATCH_MAXLEN - i : (i * 37) % 300 + 1;
+        tag[i] = tags[i];
+    }
+
+    if (!TEST_true(EVP_CipherAEADBatch(ctx, AEAD_BATCH_NUM, iv, aad, aadlen,
+                                       out, in, inl, tag, taglen, ok)))
+        goto err;
+
+    for (i = 0; i < AEAD_BATCH_NUM; i++) {
+        k = (i / 5 + i) % AEAD_BATCH_KEYS;
+        if (!TEST_int_eq(ok[i], 1)
+                || !aead_seal_one(cipher, key[k], iv[i], aad[i], aadlen[i],
+                                  in[i], inl[i], ref, reftag, taglen)
+                || !TEST_mem_eq(out[i], inl[i], ref, inl[i])
+                || !TEST_mem_eq(tag[i], taglen, reftag, taglen)) {
+            TEST_info("message %zu", i);
+            goto err;
+        }
+    }
+
+    /* Open in place, with one corrupted tag */
+    tags[5][0] ^= 1;
+    for (i = 0; i < AEAD_BATCH_NUM; i++) {
+        ctx[i] = dctx[(i / 5 + i) % AEAD_BATCH_KEYS];
+        in[i] = out[i];
+    }
+    if (!TEST_false(EVP_CipherAEADBatch(ctx, AEAD_BATCH_NUM, iv, aad, aadlen,
+                                        out, in, inl, tag, taglen, ok)))
+        goto err;
+    for (i = 0; i < AEAD_BATCH_NUM; i++) {
+        if (i == 5) {
+            if (!TEST_int_eq(ok[i], 0))
+                goto err;
+            continue;
+        }
+        if (!TEST_int_eq(ok[i], 1)
+                || !TEST_mem_eq(out[i], inl[i], pt + i * AEAD_BATCH_MAXLEN,
+                                inl[i])) {
+            TEST_info("message %zu", i);
+            goto err;
+        }
+    }
+    testresult = 1;
+ err:
+    ERR_clear_error();
+    for (k = 0; k < AEAD_BATCH_KEYS; k++) {
+        EVP_CIPHER_CTX_free(ectx[k]);
+        EVP_CIPHER_CTX_free(dctx[k]);
+    }
+    EVP_CIPHER_free(cipher);
+    OPENSSL_free(pt);
+    OPENSSL_free(ct);
+    OPENSSL_free(ref);
+    return testresult;
+}
+
+static const char *digest_batch_mds[] = {
+    "SHA1",
+    "SHA224",
+    "SHA256",
+    "SHA384",
+    "SHA512",
+    "SHA512-224",
+    "SHA512-256",
+    "SHA3-224",
+    "SHA3-256",
+    "SHA3-512",
+    "KECCAK-256",
+    "SHAKE128",
+    "SHAKE256",
+};
+
+#define DIGEST_BATCH_NUM    50
+#define DIGEST_BATCH_MAXLEN 4000
+#define DIGEST_BATCH_XOFLEN 300
+
+/*
+ * Hash a batch of messages with EVP_DigestBatch() and compare with hashing
+ * them one at a time. Lengths are chosen around the padding boundaries of 64 and
+ * 128 byte blocks and of the Keccak rates, with a few long messages in
+ * between so that lanes of a multi-buffer implementation finish at
+ * different times. XOFs squeeze more than one block per message.
+ */
+static int test_evp_digest_batch(int idx)
+{
+    static const size_t lens[] = {
+        0, 1, 55, 56, 63, 64, 65, 71, 72, 111, 112, 119, 120, 127, 128, 129,
+        135, 136, 167, 168, 255, 256
+    };
+    EVP_MD *md = NULL;
+    EVP_MD_CTX *ctx = NULL;
+    unsigned char *buf = NULL, *res = NULL;
+    unsigned char ref[DIGEST_BATCH_XOFLEN];
+    const unsigned char *in[DIGEST_BATCH_NUM];
+    unsigned char *out[DIGEST_BATCH_NUM];
+    size_t inl[DIGEST_BATCH_NUM], mdlen, i;
+    int xof, testresult = 0;
+
+    if (!TEST_ptr(md = EVP_MD_fetch(testctx, digest_batch_mds[idx], testpropq))
+            || !TEST_ptr(ctx = EVP_MD_CTX_new())
+            || !TEST_ptr(buf = OPENSSL_malloc(DIGEST_BATCH_MAXLEN))
+            || !TEST_ptr(res = OPENSSL_malloc(DIGEST_BATCH_NUM
+                                              * DIGEST_BATCH_XOFLEN)))
+        goto err;
+    xof = (EVP_MD_get_flags(md) & EVP_MD_FLAG_XOF) != 0;
+    mdlen = xof ? DIGEST_BATCH_XOFLEN : (size_t)EVP_MD_get_size(md);
+
+    for (i = 0; i < DIGEST_BATCH_MAXLEN; i++)
+        buf[i] = (unsigned char)(i * 151 + (i >> 8));
+    for (i = 0; i < DIGEST_BATCH_NUM; i++) {
+        in[i] = buf + i;
+        inl[i] = i % 9 == 4 ? DIGEST_BATCH_MAXLEN - 64 - i * 11
+                            : lens[i % OSSL_NELEM(lens)] + (i / 23) * 128;
+        out[i] = res + i * DIGEST_BATCH_XOFLEN;
+    }
+
+    if ((!xof && !TEST_false(EVP_DigestBatch(md, DIGEST_BATCH_NUM, in, inl,
+                                             out, mdlen + 1)))
+            || !TEST_true(EVP_DigestBatch(md, 0, NULL, NULL, NULL, mdlen))
+            || !TEST_true(EVP_DigestBatch(md, DIGEST_BATCH_NUM, in, inl, out,
+                                          mdlen)))
+        goto err;
+
+    for (i = 0; i < DIGEST_BATCH_NUM; i++) {
+        if (!TEST_true(EVP_DigestInit_ex(ctx, md, NULL))
+                || !TEST_true(EVP_DigestUpdate(ctx, in[i], inl[i]))
+                || !TEST_true(xof ? EVP_DigestFinalXOF(ctx, ref, mdlen)
+                                  : EVP_DigestFinal_ex(ctx, ref, NULL))
+                || !TEST_mem_eq(out[i], mdlen, ref, mdlen)) {
+            TEST_info("message %zu, length %zu", i, inl[i]);
+            goto err;
+        }
+    }
+    testresult = 1;
+ err:
+    ERR_clear_error();
+    EVP_MD_CTX_free(ctx);
+    EVP_MD_free(md);
+    OPENSSL_free(buf);
+    OPENSSL_free(res);
+    return testresult;
+}
+
 #ifndef OPENSSL_NO_RC4
 static int rc4_encrypt(const unsigned char *rc4_key, size_t rc4_key_s,
                        const unsigned char *rc4_pt, size_t rc4_pt_s,
@@ -5740,6 +5983,9 @@ int setup_tests(void)
     ADD_TEST(test_aes_rc4_keylen_change_cve_2023_5363);
 #endif
 
+    ADD_ALL_TESTS(test_evp_aead_batch, OSSL_NELEM(aead_batch_ciphers));
+    ADD_ALL_TESTS(test_evp_digest_batch, OSSL_NELEM(digest_batch_mds));
+
     return 1;
 }
 
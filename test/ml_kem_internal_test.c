@@ -0,0 +1,268 @@
+/*
+ * Copyright 2024 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+#include <string.h>
+#include <openssl/core_names.h>
+#include <openssl/evp.h>
+#include <openssl/params.h>
+#include "crypto/ml_kem.h"
+#include "testutil.h"
+
+/*
+ * Known answers for the deterministic seeds d = 00..1f, z = 20..3f and
+ * m = 40..5f, given as SHA3-256 digests of the (long) encodings.
+ */
+static const unsigned char ek_hash[32] = {
+    0xa2, 0x4e, 0x16, 0xd8, 0xf8, 0xf9, 0x38, 0x3a, 0x95, 0xb7, 0x70, 0x50,
+    0xf4, 0xd9, 0xfd, 0x2f, 0x57, 0x33, 0xee, 0xc1, 0xd6, 0x3e, 0xf3, 0xc2,
+    0x3e, 0xbf, 0x99, 0x18, 0x17, 0x36, 0x69, 0xa7
+};
+
+static const unsigned char dk_hash[32] = {
+    0x11, 0x49, 0xf1, 0x7c, 0x3c, 0x4a, 0xc6, 0xab, 0x1e, 0x3e, 0x2d, 0x9d,
+    0x8b, 0xd0, 0x17, 0x13, 0x55, 0xac, 0x0f, 0xa3, 0x1b, 0xb8, 0x85, 0x5c,
+    0x48, 0xce, 0xad, 0xe8, 0x74, 0xc0, 0x86, 0x4b
+};
+
+static const unsigned char ct_hash[32] = {
+    0xb4, 0xcf, 0xbd, 0x24, 0xce, 0xf6, 0x7a, 0xfd, 0x37, 0x64, 0x27, 0x6c,
+    0x69, 0x80, 0xe0, 0xf8, 0x8f, 0x8e, 0x9c, 0xa5, 0x7f, 0x59, 0xb7, 0xf1,
+    0x2f, 0xe1, 0xa9, 0xc1, 0xe7, 0x2f, 0x47, 0x10
+};
+
+static const unsigned char shared_secret[32] = {
+    0x9c, 0xdd, 0xd0, 0x89, 0xff, 0xe7, 0x0e, 0x39, 0x96, 0xe7, 0x6f, 0x7c,
+    0x8d, 0x06, 0x74, 0x6d, 0xf3, 0x4d, 0x07, 0xe8, 0x65, 0x7b, 0xc0, 0xfc,
+    0xf2, 0xbb, 0x0e, 0x1c, 0x30, 0x84, 0xae, 0xa1
+};
+
+/* The implicit rejection secret J(z || c) after flipping a bit of c */
+static const unsigned char rejection_secret[32] = {
+    0xdc, 0xfc, 0x80, 0xc6, 0xdb, 0x46, 0xff, 0x70, 0x28, 0xe3, 0xa4, 0x39,
+    0x86, 0x51, 0xc0, 0x63, 0xae, 0x7a, 0x42, 0xc1, 0x07, 0xa6, 0xdc, 0x8c,
+    0xb0, 0x71, 0x41, 0x86, 0x16, 0x98, 0xab, 0x92
+};
+
+static int sha3_256_eq(const unsigned char *in, size_t inlen,
+                       const unsigned char expected[32])
+{
+    unsigned char md[32];
+    unsigned int mdlen = 0;
+
+    return TEST_true(EVP_Digest(in, inlen, md, &mdlen, EVP_sha3_256(), NULL))
+        && TEST_mem_eq(md, mdlen, expected, 32);
+}
+
+static void fill_seed(unsigned char *buf, size_t len, unsigned char start)
+{
+    size_t i;
+
+    for (i = 0; i < len; i++)
+        buf[i] = (unsigned char)(start + i);
+}
+
+static int test_ml_kem_kat(void)
+{
+    ML_KEM_KEY *key = NULL, *pub = NULL;
+    unsigned char seed[ML_KEM_SEED_BYTES], m[ML_KEM_ENCAP_SEED_BYTES];
+    unsigned char *ek = NULL, *dk = NULL, *ct = NULL;
+    unsigned char ss[ML_KEM_SHARED_SECRET_BYTES];
+    unsigned char ss2[ML_KEM_SHARED_SECRET_BYTES];
+    int ret = 0;
+
+    fill_seed(seed, sizeof(seed), 0);
+    fill_seed(m, sizeof(m), 64);
+
+    if (!TEST_ptr(key = ossl_ml_kem_key_new())
+            || !TEST_ptr(pub = ossl_ml_kem_key_new())
+            || !TEST_ptr(ek = OPENSSL_malloc(ML_KEM_768_PUBLIC_KEY_BYTES))
+            || !TEST_ptr(dk = OPENSSL_malloc(ML_KEM_768_PRIVATE_KEY_BYTES))
+            || !TEST_ptr(ct = OPENSSL_malloc(ML_KEM_768_CIPHERTEXT_BYTES)))
+        goto err;
+
+    if (!TEST_true(ossl_ml_kem_genkey(key, seed))
+            || !TEST_true(ossl_ml_kem_encode_public_key(key, ek,
+                                                ML_KEM_768_PUBLIC_KEY_BYTES))
+            || !TEST_true(ossl_ml_kem_encode_private_key(key, dk,
+                                                ML_KEM_768_PRIVATE_KEY_BYTES))
+            || !sha3_256_eq(ek, ML_KEM_768_PUBLIC_KEY_BYTES, ek_hash)
+            || !sha3_256_eq(dk, ML_KEM_768_PRIVATE_KEY_BYTES, dk_hash))
+        goto err;
+
+    /* Encapsulate to a key parsed from the encoding */
+    if (!TEST_true(ossl_ml_kem_parse_public_key(pub, ek,
+                                                ML_KEM_768_PUBLIC_KEY_BYTES))
+            || !TEST_false(ossl_ml_kem_have_prvkey(pub))
+            || !TEST_true(ossl_ml_kem_pubkey_cmp(key, pub))
+            || !TEST_true(ossl_ml_kem_encap_seed(pub, m,
+                                                 ct, ML_KEM_768_CIPHERTEXT_BYTES,
+                                                 ss, sizeof(ss)))
+            || !sha3_256_eq(ct, ML_KEM_768_CIPHERTEXT_BYTES, ct_hash)
+            || !TEST_mem_eq(ss, sizeof(ss), shared_secret, sizeof(shared_secret)))
+        goto err;
+
+    /* Decapsulate with a key parsed from the encoding */
+    if (!TEST_true(ossl_ml_kem_parse_private_key(pub, dk,
+                                                 ML_KEM_768_PRIVATE_KEY_BYTES))
+            || !TEST_true(ossl_ml_kem_decap(pub, ct, ML_KEM_768_CIPHERTEXT_BYTES,
+                                            ss2, sizeof(ss2)))
+            || !TEST_mem_eq(ss2, sizeof(ss2), shared_secret,
+                            sizeof(shared_secret)))
+        goto err;
+
+    /* A modified ciphertext yields the implicit rejection secret */
+    ct[0] ^= 1;
+    if (!TEST_true(ossl_ml_kem_decap(key, ct, ML_KEM_768_CIPHERTEXT_BYTES,
+                                     ss2, sizeof(ss2)))
+            || !TEST_mem_eq(ss2, sizeof(ss2), rejection_secret,
+                            sizeof(rejection_secret)))
+        goto err;
+    ret = 1;
+ err:
+    ossl_ml_kem_key_free(key);
+    ossl_ml_kem_key_free(pub);
+    OPENSSL_free(ek);
+    OPENSSL_clear_free(dk, ML_KEM_768_PRIVATE_KEY_BYTES);
+    OPENSSL_free(ct);
+    return ret;
+}
+
+/* FIPS 203 requires rejecting encapsulation keys with coefficients >= q */
+static int test_ml_kem_invalid_public_key(void)
+{
+    ML_KEM_KEY *key = NULL;
+    unsigned char seed[ML_KEM_SEED_BYTES];
+    unsigned char *ek = NULL;
+    int ret = 0;
+
+    fill_seed(seed, sizeof(seed), 0);
+    if (!TEST_ptr(key = ossl_ml_kem_key_new())
+            || !TEST_ptr(ek = OPENSSL_malloc(ML_KEM_768_PUBLIC_KEY_BYTES))
+            || !TEST_true(ossl_ml_kem_genkey(key, seed))
+            || !TEST_true(ossl_ml_kem_encode_public_key(key, ek,
+                                                ML_KEM_768_PUBLIC_KEY_BYTES)))
+        goto err;
+
+    /* Set the first 12-bit coefficient to q = 3329 = 0xd01 */
+    ek[0] = 0x01;
+    ek[1] = (ek[1] & 0xf0) | 0x0d;
+    if (!TEST_false(ossl_ml_kem_parse_public_key(key, ek,
+                                                 ML_KEM_768_PUBLIC_KEY_BYTES))
+            || !TEST_false(ossl_ml_kem_have_pubkey(key))
+            || !TEST_false(ossl_ml_kem_parse_public_key(key, ek,
+                                                ML_KEM_768_PUBLIC_KEY_BYTES - 1)))
+        goto err;
+    ret = 1;
+ err:
+    ossl_ml_kem_key_free(key);
+    OPENSSL_free(ek);
+    return ret;
+}
+
+static const char *kem_algs[] = { "ML-KEM-768", "X25519MLKEM768" };
+
+/*
+ * Run through the provider the way TLS 1.3 does: the client generates a key
+ * pair, the server loads the encoded public key into a blank key and
+ * encapsulates to it, and the client decapsulates the ciphertext.
+ */
+static int test_ml_kem_tls_flow(int idx)
+{
+    const char *alg = kem_algs[idx];
+    EVP_PKEY_CTX *ctx = NULL;
+    EVP_PKEY *client = NULL, *server = NULL;
+    unsigned char seed[ML_KEM_SEED_BYTES + 32];
+    unsigned char *pub = NULL, *ct = NULL, *ss1 = NULL, *ss2 = NULL;
+    size_t publen, ctlen, ss1len, ss2len;
+    size_t extra = idx == 0 ? 0 : 32;
+    OSSL_PARAM params[2];
+    int ret = 0;
+
+    fill_seed(seed, sizeof(seed), 0);
+    params[0] = OSSL_PARAM_construct_octet_string(OSSL_PKEY_PARAM_ML_KEM_SEED,
+                                                  seed,
+                                                  ML_KEM_SEED_BYTES + extra);
+    params[1] = OSSL_PARAM_construct_end();
+
+    if (!TEST_ptr(ctx = EVP_PKEY_CTX_new_from_name(NULL, alg, NULL))
+            || !TEST_int_gt(EVP_PKEY_keygen_init(ctx), 0)
+            || !TEST_int_gt(EVP_PKEY_CTX_set_group_name(ctx, idx == 0
+                                                        ? "MLKEM768"
+                                                        : "X25519MLKEM768"), 0)
+            || !TEST_int_gt(EVP_PKEY_CTX_set_params(ctx, params), 0)
+            || !TEST_int_gt(EVP_PKEY_keygen(ctx, &client), 0)
+            || !TEST_int_eq(EVP_PKEY_get_security_bits(client), 192))
+        goto err;
+    EVP_PKEY_CTX_free(ctx);
+    ctx = NULL;
+
+    publen = EVP_PKEY_get1_encoded_public_key(client, &pub);
+    if (!TEST_size_t_eq(publen, ML_KEM_768_PUBLIC_KEY_BYTES + extra)
+            || !sha3_256_eq(pub, ML_KEM_768_PUBLIC_KEY_BYTES, ek_hash))
+        goto err;
+
+    if (!TEST_ptr(ctx = EVP_PKEY_CTX_new_from_name(NULL, alg, NULL))
+            || !TEST_int_gt(EVP_PKEY_paramgen_init(ctx), 0)
+            || !TEST_int_gt(EVP_PKEY_paramgen(ctx, &server), 0)
+            || !TEST_true(EVP_PKEY_set1_encoded_public_key(server, pub, publen))
+            || !TEST_int_eq(EVP_PKEY_eq(client, server), 1))
+        goto err;
+    EVP_PKEY_CTX_free(ctx);
+    ctx = NULL;
+
+    if (!TEST_ptr(ctx = EVP_PKEY_CTX_new(server, NULL))
+            || !TEST_int_gt(EVP_PKEY_encapsulate_init(ctx, NULL), 0)
+            || !TEST_int_gt(EVP_PKEY_encapsulate(ctx, NULL, &ctlen,
+                                                 NULL, &ss1len), 0)
+            || !TEST_size_t_eq(ctlen, ML_KEM_768_CIPHERTEXT_BYTES + extra)
+            || !TEST_size_t_eq(ss1len, ML_KEM_SHARED_SECRET_BYTES + extra)
+            || !TEST_ptr(ct = OPENSSL_malloc(ctlen))
+            || !TEST_ptr(ss1 = OPENSSL_malloc(ss1len))
+            || !TEST_int_gt(EVP_PKEY_encapsulate(ctx, ct, &ctlen,
+                                                 ss1, &ss1len), 0))
+        goto err;
+    EVP_PKEY_CTX_free(ctx);
+    ctx = NULL;
+
+    if (!TEST_ptr(ctx = EVP_PKEY_CTX_new(client, NULL))
+            || !TEST_int_gt(EVP_PKEY_decapsulate_init(ctx, NULL), 0)
+            || !TEST_int_gt(EVP_PKEY_decapsulate(ctx, NULL, &ss2len,
+                                                 ct, ctlen), 0)
+            || !TEST_ptr(ss2 = OPENSSL_malloc(ss2len))
+            || !TEST_int_gt(EVP_PKEY_decapsulate(ctx, ss2, &ss2len,
+                                                 ct, ctlen), 0)
+            || !TEST_mem_eq(ss1, ss1len, ss2, ss2len))
+        goto err;
+
+    /* A short ciphertext is rejected rather than implicitly rejected */
+    if (!TEST_int_le(EVP_PKEY_decapsulate(ctx, ss2, &ss2len,
+                                          ct, ctlen - 1), 0))
+        goto err;
+    ret = 1;
+ err:
+    EVP_PKEY_CTX_free(ctx);
+    EVP_PKEY_free(client);
+    EVP_PKEY_free(server);
+    OPENSSL_free(pub);
+    OPENSSL_free(ct);
+    OPENSSL_free(ss1);
+    OPENSSL_free(ss2);
+    return ret;
+}
+
+int setup_tests(void)
+{
+    ADD_TEST(test_ml_kem_kat);
+    ADD_TEST(test_ml_kem_invalid_public_key);
+#ifndef OPENSSL_NO_ECX
+    ADD_ALL_TESTS(test_ml_kem_tls_flow, 2);
+#else
+    ADD_ALL_TESTS(test_ml_kem_tls_flow, 1);
+#endif
+    return 1;
+}
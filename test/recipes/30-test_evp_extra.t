@@ -1,5 +1,5 @@
 #! /usr/bin/env perl
-# Copyright 2015-2021 The OpenSSL Project Authors. All Rights Reserved.
+# Copyright 2015-2024 The OpenSSL Project Authors. All Rights Reserved.
 #
 # Licensed under the Apache License 2.0 (the "License").  You may not use
 # this file except in compliance with the License.  You can obtain a copy
@@ -14,7 +14,7 @@ use OpenSSL::Test qw/:DEFAULT bldtop_dir/;
 
 setup("test_evp_extra");
 
-plan tests => 3;
+plan tests => 5;
 
 ok(run(test(["evp_extra_test"])), "running evp_extra_test");
 
@@ -22,3 +22,16 @@ ok(run(test(["evp_extra_test"])), "running evp_extra_test");
 ok(run(test(["evp_extra_test", "-context"])), "running evp_extra_test with a non-default library context");
 
 ok(run(test(["evp_extra_test2"])), "running evp_extra_test2");
+
+# Exercise the fallbacks of the multi-buffer digests on x86_64: the 8-lane
+# code without AVX-512 and the serial code without SSSE3
+{
+    local $ENV{OPENSSL_ia32cap} = ":~0x10000";
+    ok(run(test(["evp_extra_test", "-test", "test_evp_digest_batch"])),
+       "running evp_extra_test batch digests without AVX-512");
+}
+{
+    local $ENV{OPENSSL_ia32cap} = "~0x20000000000";
+    ok(run(test(["evp_extra_test", "-test", "test_evp_digest_batch"])),
+       "running evp_extra_test batch digests without SSSE3");
+}
@@ -8300,6 +8300,111 @@ static int test_ticket_callbacks(int tst)
     return testresult;
 }
 
+#ifndef OPENSSL_NO_TLS1_2
+static int ticket_key_resume(SSL_CTX *sctx, SSL_CTX *cctx, SSL_SESSION *sess,
+                             int *reused, SSL_SESSION **newsess)
+{
+    SSL *serverssl = NULL, *clientssl = NULL;
+    int ret = 0;
+
+    if (!TEST_true(create_ssl_objects(sctx, cctx, &serverssl, &clientssl,
+                                      NULL, NULL))
+            || (sess != NULL && !TEST_true(SSL_set_session(clientssl, sess)))
+            || !TEST_true(create_ssl_connection(serverssl, clientssl,
+                                                SSL_ERROR_NONE)))
+        goto end;
+
+    *reused = SSL_session_reused(clientssl);
+    if (!TEST_ptr(*newsess = SSL_get1_session(clientssl)))
+        goto end;
+    shutdown_ssl_connection(serverssl, clientssl);
+    serverssl = clientssl = NULL;
+    ret = 1;
+ end:
+    SSL_free(serverssl);
+    SSL_free(clientssl);
+    return ret;
+}
+
+/*
+ * Test rotation of the built-in session ticket keys: tickets encrypted with
+ * any configured key are accepted and renewed, but only the first key is used
+ * to encrypt new tickets.
+ */
+static int test_ticket_key_rotation(void)
+{
+    SSL_CTX *cctx = NULL, *sctx = NULL;
+    SSL_SESSION *sess1 = NULL, *sess2 = NULL, *sess3 = NULL;
+    unsigned char keys[2 * 80], keys2[2 * 80];
+    const unsigned char *tick1, *tick2;
+    size_t tick1len, tick2len;
+    long keylen;
+    int reused, testresult = 0;
+
+    if (!TEST_true(create_ssl_ctx_pair(libctx, TLS_server_method(),
+                                       TLS_client_method(), TLS1_VERSION,
+                                       TLS1_2_VERSION, &sctx, &cctx, cert,
+                                       privkey)))
+        goto end;
+
+    /* Make sure that resumption can only happen via tickets */
+    SSL_CTX_set_session_cache_mode(sctx, SSL_SESS_CACHE_OFF);
+
+    keylen = SSL_CTX_set_tlsext_ticket_keys(sctx, NULL, 0);
+    if (!TEST_long_eq(keylen, 80)
+            || !TEST_int_gt(RAND_bytes_ex(libctx, keys, sizeof(keys), 0), 0))
+        goto end;
+
+    /* Issue a ticket with the second key only */
+    if (!TEST_true(SSL_CTX_set_tlsext_ticket_keys(sctx, keys + keylen, keylen))
+            || !TEST_true(ticket_key_resume(sctx, cctx, NULL, &reused, &sess1))
+            || !TEST_false(reused))
+        goto end;
+
+    /* Rotate: the first key is new, the old one is still accepted */
+    if (!TEST_false(SSL_CTX_set_tlsext_ticket_keys(sctx, keys, keylen + 1))
+            || !TEST_true(SSL_CTX_set_tlsext_ticket_keys(sctx, keys,
+                                                         2 * keylen))
+            || !TEST_true(SSL_CTX_get_tlsext_ticket_keys(sctx, keys2,
+                                                         2 * keylen))
+            || !TEST_mem_eq(keys, sizeof(keys), keys2, sizeof(keys2)))
+        goto end;
+
+    /* The old ticket is accepted and replaced by one with the new key */
+    if (!TEST_true(ticket_key_resume(sctx, cctx, sess1, &reused, &sess2))
+            || !TEST_true(reused))
+        goto end;
+    SSL_SESSION_get0_ticket(sess1, &tick1, &tick1len);
+    SSL_SESSION_get0_ticket(sess2, &tick2, &tick2len);
+    if (!TEST_mem_ne(tick1, tick1len, tick2, tick2len)
+            || !TEST_mem_eq(tick2, 16, keys, 16))
+        goto end;
+
+    /* Once the old key is removed its tickets are no longer accepted */
+    if (!TEST_true(SSL_CTX_set_tlsext_ticket_keys(sctx, keys, keylen))
+            || !TEST_false(SSL_CTX_get_tlsext_ticket_keys(sctx, keys2,
+                                                          2 * keylen))
+            || !TEST_true(ticket_key_resume(sctx, cctx, sess1, &reused,
+                                            &sess3))
+            || !TEST_false(reused))
+        goto end;
+    SSL_SESSION_free(sess3);
+    sess3 = NULL;
+    if (!TEST_true(ticket_key_resume(sctx, cctx, sess2, &reused, &sess3))
+            || !TEST_true(reused))
+        goto end;
+
+    testresult = 1;
+ end:
+    SSL_SESSION_free(sess1);
+    SSL_SESSION_free(sess2);
+    SSL_SESSION_free(sess3);
+    SSL_CTX_free(sctx);
+    SSL_CTX_free(cctx);
+    return testresult;
+}
+#endif
+
 /*
  * Test incorrect shutdown.
  * Test 0: client does not shutdown properly,
@@ -9380,6 +9485,121 @@ static int test_servername(int tst)
     return testresult;
 }
 
+static int servername_ctx_cb_calls;
+
+/* Count the calls and switch to the SSL_CTX in |arg|, if any */
+static int servername_ctx_cb(SSL *s, int *al, void *arg)
+{
+    servername_ctx_cb_calls++;
+    if (arg != NULL && SSL_set_SSL_CTX(s, arg) == NULL)
+        return SSL_TLSEXT_ERR_ALERT_FATAL;
+    return SSL_TLSEXT_ERR_OK;
+}
+
+static int servername_ctx_fail_cb(SSL *s, int *al, void *arg)
+{
+    return SSL_TLSEXT_ERR_ALERT_FATAL;
+}
+
+/*
+ * Test selecting an SSL_CTX by servername with SSL_CTX_add1_servername_ctx()
+ * Test 0: A name of the certificate of the registered SSL_CTX
+ * Test 1: A name matching a wildcard
+ * Test 2: A name registered as such and matching a wildcard
+ * Test 3: A name that isn't registered
+ * Test 4: As test 0, the servername callback of the initial SSL_CTX is called
+ * Test 5: As test 0, the servername callback switches to another SSL_CTX
+ */
+static int test_servername_ctx(int tst)
+{
+    SSL_CTX *cctx = NULL, *sctx = NULL, *snictx = NULL, *wildctx = NULL;
+    SSL_CTX *expected;
+    SSL *clientssl = NULL, *serverssl = NULL;
+    static const char *hosts[] = {
+        "Server.Example", "www.wild.example", "exact.wild.example",
+        "other.example", "server.example", "server.example"
+    };
+    int testresult = 0;
+
+    if (!TEST_true(create_ssl_ctx_pair(libctx, TLS_server_method(),
+                                       TLS_client_method(),
+                                       TLS1_VERSION, 0,
+                                       &sctx, &cctx, cert, privkey))
+            || !TEST_ptr(snictx = SSL_CTX_new_ex(libctx, NULL,
+                                                 TLS_server_method()))
+            || !TEST_ptr(wildctx = SSL_CTX_new_ex(libctx, NULL,
+                                                  TLS_server_method()))
+            || !TEST_int_eq(SSL_CTX_use_certificate_file(snictx, cert,
+                                                         SSL_FILETYPE_PEM), 1)
+            || !TEST_int_eq(SSL_CTX_use_PrivateKey_file(snictx, privkey,
+                                                        SSL_FILETYPE_PEM), 1)
+            || !TEST_int_eq(SSL_CTX_use_certificate_file(wildctx, cert,
+                                                         SSL_FILETYPE_PEM), 1)
+            || !TEST_int_eq(SSL_CTX_use_PrivateKey_file(wildctx, privkey,
+                                                        SSL_FILETYPE_PEM), 1))
+        goto end;
+
+    if (!TEST_false(SSL_CTX_add1_servername_ctx(sctx, "a.*.example", snictx))
+            || !TEST_false(SSL_CTX_add1_servername_ctx(sctx, "", snictx))
+            || !TEST_false(SSL_CTX_add1_servername_ctx(sctx, "self.example",
+                                                       sctx))
+            || !TEST_false(SSL_CTX_add1_servername_ctx(sctx, NULL, cctx)))
+        goto end;
+
+    /* servercert.pem has the DNS name server.example */
+    if (!TEST_true(SSL_CTX_add1_servername_ctx(sctx, NULL, snictx))
+            || !TEST_true(SSL_CTX_add1_servername_ctx(sctx, "*.WILD.example",
+                                                      wildctx))
+            || !TEST_true(SSL_CTX_add1_servername_ctx(sctx,
+                                                      "exact.wild.example",
+                                                      snictx))
+            || !TEST_ptr_eq(SSL_CTX_get0_servername_ctx(sctx,
+                                                        "server.example"),
+                            snictx)
+            || !TEST_ptr_null(SSL_CTX_get0_servername_ctx(sctx,
+                                                          "wild.example"))
+            || !TEST_ptr_null(SSL_CTX_get0_servername_ctx(sctx,
+                                                          ".wild.example"))
+            || !TEST_ptr_null(SSL_CTX_get0_servername_ctx(sctx,
+                                                          "a.b.wild.example")))
+        goto end;
+
+    servername_ctx_cb_calls = 0;
+    if (tst >= 4) {
+        SSL_CTX_set_tlsext_servername_callback(sctx, servername_ctx_cb);
+        SSL_CTX_set_tlsext_servername_arg(sctx, tst == 5 ? wildctx : NULL);
+        /* Only the callback of the SSL_CTX the SSL was made with is called */
+        SSL_CTX_set_tlsext_servername_callback(snictx, servername_ctx_fail_cb);
+    }
+
+    expected = tst == 1 || tst == 5 ? wildctx : tst == 3 ? sctx : snictx;
+    if (!TEST_true(create_ssl_objects(sctx, cctx, &serverssl, &clientssl,
+                                      NULL, NULL))
+            || !TEST_true(SSL_set_tlsext_host_name(clientssl, hosts[tst]))
+            || !TEST_true(create_ssl_connection(serverssl, clientssl,
+                                                SSL_ERROR_NONE))
+            || !TEST_ptr_eq(SSL_get_SSL_CTX(serverssl), expected)
+            || !TEST_int_eq(servername_ctx_cb_calls, tst >= 4))
+        goto end;
+
+    /* The servername is acknowledged if it selected an SSL_CTX */
+    if (!TEST_str_eq(SSL_SESSION_get0_hostname(SSL_get_session(serverssl)),
+                     tst == 3 ? NULL : hosts[tst]))
+        goto end;
+
+    testresult = 1;
+
+ end:
+    SSL_free(serverssl);
+    SSL_free(clientssl);
+    SSL_CTX_free(sctx);
+    SSL_CTX_free(cctx);
+    SSL_CTX_free(snictx);
+    SSL_CTX_free(wildctx);
+
+    return testresult;
+}
+
 #if !defined(OPENSSL_NO_EC) \
     && (!defined(OSSL_NO_USABLE_TLS1_3) || !defined(OPENSSL_NO_TLS1_2))
 /*
@@ -9597,6 +9817,62 @@ static int test_pluggable_group(int idx)
     return testresult;
 }
 
+# ifndef OPENSSL_NO_ML_KEM
+/*
+ * Test the built-in post-quantum KEM groups
+ * Test 0: MLKEM768
+ * Test 1: X25519MLKEM768
+ */
+static int test_ml_kem_group(int idx)
+{
+    SSL_CTX *cctx = NULL, *sctx = NULL;
+    SSL *clientssl = NULL, *serverssl = NULL;
+    int testresult = 0;
+    const char *group_name = idx == 0 ? "MLKEM768" : "X25519MLKEM768";
+    int group_id = idx == 0 ? 0x0201 : 0x11EC;
+
+#  ifdef OPENSSL_NO_ECX
+    if (idx == 1)
+        return TEST_skip("No X25519 support in this build");
+#  endif
+    /* ML-KEM is not available from the FIPS provider */
+    if (is_fips)
+        return TEST_skip("No ML-KEM support in the FIPS provider");
+
+    if (!TEST_true(create_ssl_ctx_pair(libctx, TLS_server_method(),
+                                       TLS_client_method(),
+                                       TLS1_3_VERSION,
+                                       TLS1_3_VERSION,
+                                       &sctx, &cctx, cert, privkey))
+            || !TEST_true(create_ssl_objects(sctx, cctx, &serverssl, &clientssl,
+                                             NULL, NULL)))
+        goto end;
+
+    if (!TEST_true(SSL_set1_groups_list(serverssl, group_name))
+            || !TEST_true(SSL_set1_groups_list(clientssl, group_name)))
+        goto end;
+
+    if (!TEST_true(create_ssl_connection(serverssl, clientssl, SSL_ERROR_NONE)))
+        goto end;
+
+    if (!TEST_str_eq(group_name, SSL_get0_group_name(serverssl))
+            || !TEST_str_eq(group_name, SSL_get0_group_name(clientssl))
+            || !TEST_int_eq(SSL_get_negotiated_group(clientssl),
+                            TLSEXT_nid_unknown | group_id))
+        goto end;
+
+    testresult = 1;
+
+ end:
+    SSL_free(serverssl);
+    SSL_free(clientssl);
+    SSL_CTX_free(sctx);
+    SSL_CTX_free(cctx);
+
+    return testresult;
+}
+# endif
+
 /*
  * This function triggers encode, decode and sign functions
  * of the artificial "xorhmacsig" algorithm implemented in tls-provider
@@ -10748,9 +11024,10 @@ static ENGINE *load_dasync(void)
 
 /*
  * Test TLSv1.2 with a pipeline capable cipher. TLSv1.3 and DTLS do not
- * support this yet. The only pipeline capable cipher that we have is in the
- * dasync engine (providers don't support this yet), so we have to use
- * deprecated APIs for this test.
+ * support this yet. The only cipher that supports the EVP pipeline ctrls is in
+ * the dasync engine (providers don't support them), so we have to use
+ * deprecated APIs for this test. See test_pipelining_aead() for provided
+ * ciphers.
  *
  * Test 0: Client has pipelining enabled, server does not
  * Test 1: Server has pipelining enabled, client does not
@@ -10944,6 +11221,316 @@ end:
 }
 #endif /* !defined(OPENSSL_NO_TLS1_2) && !defined(OPENSSL_NO_DYNAMIC_ENGINE) */
 
+/*
+ * Test dynamic record sizing
+ * Test 0: TLSv1.2, configured on the SSL_CTX
+ * Test 1: TLSv1.3, configured on the SSL
+ */
+static int test_dynamic_record_sizing(int idx)
+{
+    SSL_CTX *cctx = NULL, *sctx = NULL;
+    SSL *clientssl = NULL, *serverssl = NULL;
+    int testresult = 0;
+    unsigned char *msg = NULL, *buf = NULL;
+    size_t written, readbytes, offset, msglen = 4096, i;
+    /* Record size doubles every 1024 bytes, starting from 512 */
+    static const size_t expected[] = { 512, 512, 1024, 2048 };
+    uint64_t small_records, full_records, idle_resets;
+
+#ifdef OPENSSL_NO_TLS1_2
+    if (idx == 0)
+        return TEST_skip("No TLSv1.2");
+#endif
+#ifdef OSSL_NO_USABLE_TLS1_3
+    if (idx == 1)
+        return TEST_skip("No usable TLSv1.3");
+#endif
+
+    if (!TEST_true(create_ssl_ctx_pair(libctx, TLS_server_method(),
+                                       TLS_client_method(),
+                                       idx == 0 ? 0 : TLS1_3_VERSION,
+                                       idx == 0 ? TLS1_2_VERSION : 0,
+                                       &sctx, &cctx, cert, privkey)))
+        goto end;
+
+    if (!TEST_false(SSL_CTX_set_dynamic_record_sizing(cctx, 511, 1024, 0))
+            || !TEST_false(SSL_CTX_set_dynamic_record_sizing(cctx, 512, 0, 0))
+            || !TEST_false(SSL_CTX_set_dynamic_record_sizing(cctx,
+                                                SSL3_RT_MAX_PLAIN_LENGTH + 1,
+                                                1024, 0)))
+        goto end;
+
+    if (idx == 0
+            && !TEST_true(SSL_CTX_set_dynamic_record_sizing(cctx, 512, 1024,
+                                                            0)))
+        goto end;
+
+    if (!TEST_true(create_ssl_objects(sctx, cctx, &serverssl,
+                                      &clientssl, NULL, NULL)))
+        goto end;
+
+    if (idx == 1
+            && !TEST_true(SSL_set_dynamic_record_sizing(clientssl, 512, 1024,
+                                                        0)))
+        goto end;
+
+    if (!TEST_true(create_ssl_connection(serverssl, clientssl, SSL_ERROR_NONE)))
+        goto end;
+
+    msg = OPENSSL_malloc(msglen);
+    buf = OPENSSL_malloc(msglen);
+    if (!TEST_ptr(msg) || !TEST_ptr(buf))
+        goto end;
+    memset(msg, 'A', msglen);
+
+    if (!TEST_true(SSL_write_ex(clientssl, msg, msglen, &written))
+            || !TEST_size_t_eq(written, msglen))
+        goto end;
+
+    /* Each SSL_read_ex() returns the data from a single record */
+    for (offset = 0, i = 0; offset < msglen; offset += readbytes, i++) {
+        if (!TEST_size_t_lt(i, OSSL_NELEM(expected))
+                || !TEST_true(SSL_read_ex(serverssl, buf + offset,
+                                          msglen - offset, &readbytes))
+                || !TEST_size_t_eq(readbytes, expected[i]))
+            goto end;
+    }
+    if (!TEST_mem_eq(msg, msglen, buf, offset))
+        goto end;
+
+    if (!TEST_true(SSL_get_dynamic_record_stats(clientssl, &small_records,
+                                                &full_records, &idle_resets))
+            || !TEST_uint64_t_eq(small_records, OSSL_NELEM(expected))
+            || !TEST_uint64_t_eq(full_records, 0)
+            || !TEST_uint64_t_eq(idle_resets, 0))
+        goto end;
+
+    /*
+     * The next record is sent with an 8192 byte limit, after that records have
+     * grown to full size.
+     */
+    for (i = 0; i < 2; i++) {
+        if (!TEST_true(SSL_write_ex(clientssl, msg, msglen, &written))
+                || !TEST_true(SSL_read_ex(serverssl, buf, msglen, &readbytes))
+                || !TEST_size_t_eq(readbytes, msglen))
+            goto end;
+    }
+    if (!TEST_true(SSL_get_dynamic_record_stats(clientssl, &small_records,
+                                                &full_records, NULL))
+            || !TEST_uint64_t_eq(small_records, OSSL_NELEM(expected) + 1)
+            || !TEST_uint64_t_eq(full_records, 1))
+        goto end;
+
+    testresult = 1;
+end:
+    OPENSSL_free(msg);
+    OPENSSL_free(buf);
+    SSL_free(serverssl);
+    SSL_free(clientssl);
+    SSL_CTX_free(sctx);
+    SSL_CTX_free(cctx);
+    return testresult;
+}
+
+/*
+ * Test SSL_hibernate()
+ * Test 0: TLSv1.2
+ * Test 1: TLSv1.3, including a key update after hibernating
+ */
+static int test_hibernate(int idx)
+{
+    SSL_CTX *cctx = NULL, *sctx = NULL;
+    SSL *clientssl = NULL, *serverssl = NULL;
+    int testresult = 0;
+    const char *msg = "Hello world";
+    char buf[80];
+    size_t written, readbytes;
+
+#ifdef OPENSSL_NO_TLS1_2
+    if (idx == 0)
+        return TEST_skip("No TLSv1.2");
+#endif
+#ifdef OSSL_NO_USABLE_TLS1_3
+    if (idx == 1)
+        return TEST_skip("No usable TLSv1.3");
+#endif
+
+    if (!TEST_true(create_ssl_ctx_pair(libctx, TLS_server_method(),
+                                       TLS_client_method(),
+                                       idx == 0 ? 0 : TLS1_3_VERSION,
+                                       idx == 0 ? TLS1_2_VERSION : 0,
+                                       &sctx, &cctx, cert, privkey))
+            || !TEST_true(create_ssl_objects(sctx, cctx, &serverssl,
+                                             &clientssl, NULL, NULL)))
+        goto end;
+
+    /* Not possible before the handshake has completed */
+    if (!TEST_false(SSL_hibernate(clientssl)))
+        goto end;
+
+    if (!TEST_true(create_ssl_connection(serverssl, clientssl, SSL_ERROR_NONE))
+            || !TEST_true(SSL_hibernate(clientssl))
+            || !TEST_true(SSL_hibernate(serverssl))
+            /* Calling it again on a hibernating connection is fine */
+            || !TEST_true(SSL_hibernate(serverssl)))
+        goto end;
+
+    if (!TEST_true(SSL_write_ex(clientssl, msg, strlen(msg), &written))
+            || !TEST_true(SSL_read_ex(serverssl, buf, sizeof(buf), &readbytes))
+            || !TEST_mem_eq(msg, strlen(msg), buf, readbytes)
+            || !TEST_true(SSL_hibernate(serverssl))
+            || !TEST_true(SSL_write_ex(serverssl, msg, strlen(msg), &written))
+            || !TEST_true(SSL_read_ex(clientssl, buf, sizeof(buf), &readbytes))
+            || !TEST_mem_eq(msg, strlen(msg), buf, readbytes)
+            || !TEST_true(SSL_hibernate(clientssl)))
+        goto end;
+
+    /* Not possible while there is unread application data */
+    if (!TEST_true(SSL_write_ex(clientssl, msg, strlen(msg), &written))
+            || !TEST_true(SSL_read_ex(serverssl, buf, 1, &readbytes))
+            || !TEST_false(SSL_hibernate(serverssl))
+            || !TEST_true(SSL_read_ex(serverssl, buf + 1, sizeof(buf) - 1,
+                                      &readbytes))
+            || !TEST_mem_eq(msg, strlen(msg), buf, readbytes + 1)
+            || !TEST_true(SSL_hibernate(serverssl)))
+        goto end;
+
+    if (idx == 1) {
+        if (!TEST_true(SSL_key_update(clientssl, SSL_KEY_UPDATE_REQUESTED))
+                || !TEST_int_eq(SSL_do_handshake(clientssl), 1)
+                || !TEST_true(SSL_hibernate(clientssl))
+                || !TEST_false(SSL_read_ex(serverssl, buf, sizeof(buf),
+                                           &readbytes))
+                || !TEST_true(SSL_hibernate(serverssl))
+                || !TEST_true(SSL_write_ex(serverssl, msg, strlen(msg),
+                                           &written))
+                || !TEST_true(SSL_read_ex(clientssl, buf, sizeof(buf),
+                                          &readbytes))
+                || !TEST_mem_eq(msg, strlen(msg), buf, readbytes))
+            goto end;
+    }
+
+    testresult = 1;
+end:
+    SSL_free(serverssl);
+    SSL_free(clientssl);
+    SSL_CTX_free(sctx);
+    SSL_CTX_free(cctx);
+    return testresult;
+}
+
+#ifndef OPENSSL_NO_TLS1_2
+/*
+ * Test pipelining with provided AEAD ciphers
+ * Test 0: TLSv1.2 with AES-GCM
+ * Test 1: TLSv1.2 with ChaCha20-Poly1305
+ * Test 2: TLSv1.3 with AES-GCM (write pipelining only)
+ */
+static int test_pipelining_aead(int idx)
+{
+    SSL_CTX *cctx = NULL, *sctx = NULL;
+    SSL *clientssl = NULL, *serverssl = NULL;
+    int testresult = 0, numreads;
+    /* A 50 byte message */
+    unsigned char *msg = (unsigned char *)
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwx";
+    unsigned char buf[50];
+    size_t written, readbytes, offset, msglen = 50, fragsize = 10;
+    size_t numpipes = 5;
+    int tls13 = (idx == 2);
+
+# ifdef OSSL_NO_USABLE_TLS1_3
+    if (tls13)
+        return TEST_skip("No usable TLSv1.3");
+# endif
+# if defined(OPENSSL_NO_CHACHA) || defined(OPENSSL_NO_POLY1305)
+    if (idx == 1)
+        return TEST_skip("No ChaCha20-Poly1305");
+# endif
+    if (is_fips && idx == 1)
+        return TEST_skip("No ChaCha20-Poly1305 in FIPS");
+
+    if (!TEST_true(create_ssl_ctx_pair(libctx, TLS_server_method(),
+                                       TLS_client_method(),
+                                       tls13 ? TLS1_3_VERSION : 0,
+                                       tls13 ? 0 : TLS1_2_VERSION,
+                                       &sctx, &cctx, cert, privkey)))
+        goto end;
+
+    if (tls13) {
+        if (!TEST_true(SSL_CTX_set_ciphersuites(cctx,
+                                                "TLS_AES_128_GCM_SHA256")))
+            goto end;
+    } else if (!TEST_true(SSL_CTX_set_cipher_list(cctx,
+                                                  idx == 0
+                                                  ? "AES128-GCM-SHA256"
+                                                  : "ECDHE-RSA-CHACHA20-POLY1305"))) {
+        goto end;
+    }
+
+    if (!TEST_true(create_ssl_objects(sctx, cctx, &serverssl,
+                                      &clientssl, NULL, NULL)))
+        goto end;
+
+    if (!TEST_true(SSL_set_max_pipelines(clientssl, numpipes))
+            || !TEST_true(SSL_set_split_send_fragment(clientssl, fragsize)))
+        goto end;
+
+    if (!TEST_true(create_ssl_connection(serverssl, clientssl, SSL_ERROR_NONE)))
+        goto end;
+
+    /*
+     * A single write should be split into |numpipes| records, which the
+     * server reads back in |numpipes| separate calls.
+     */
+    if (!TEST_true(SSL_write_ex(clientssl, msg, msglen, &written))
+            || !TEST_size_t_eq(written, msglen))
+        goto end;
+
+    for (offset = 0, numreads = 0;
+         offset < msglen;
+         offset += readbytes, numreads++) {
+        if (!TEST_true(SSL_read_ex(serverssl, buf + offset,
+                                   msglen - offset, &readbytes)))
+            goto end;
+    }
+    if (!TEST_mem_eq(msg, msglen, buf, offset)
+            || !TEST_int_eq(numreads, numpipes))
+        goto end;
+
+    /* Now the other direction, in |numpipes| separate records */
+    for (offset = 0; offset < msglen; offset += fragsize) {
+        if (!TEST_true(SSL_write_ex(serverssl, msg + offset, fragsize,
+                                    &written))
+                || !TEST_size_t_eq(written, fragsize))
+            goto end;
+    }
+
+    /*
+     * In TLSv1.2 the client decrypts all the records in one go. TLSv1.3 does
+     * not do read pipelining, so there it takes one call per record.
+     */
+    for (offset = 0, numreads = 0;
+         offset < msglen;
+         offset += readbytes, numreads++) {
+        if (!TEST_true(SSL_read_ex(clientssl, buf + offset,
+                                   msglen - offset, &readbytes)))
+            goto end;
+    }
+    if (!TEST_mem_eq(msg, msglen, buf, offset)
+            || !TEST_int_eq(numreads, tls13 ? (int)numpipes : 1))
+        goto end;
+
+    testresult = 1;
+end:
+    SSL_free(serverssl);
+    SSL_free(clientssl);
+    SSL_CTX_free(sctx);
+    SSL_CTX_free(cctx);
+    return testresult;
+}
+#endif /* OPENSSL_NO_TLS1_2 */
+
 static int check_version_string(SSL *s, int version)
 {
     const char *verstr = NULL;
@@ -11616,6 +12203,9 @@ int setup_tests(void)
     ADD_ALL_TESTS(test_ssl_pending, 2);
     ADD_ALL_TESTS(test_ssl_get_shared_ciphers, OSSL_NELEM(shared_ciphers_data));
     ADD_ALL_TESTS(test_ticket_callbacks, 20);
+#ifndef OPENSSL_NO_TLS1_2
+    ADD_TEST(test_ticket_key_rotation);
+#endif
     ADD_ALL_TESTS(test_shutdown, 7);
     ADD_TEST(test_async_shutdown);
     ADD_ALL_TESTS(test_incorrect_shutdown, 2);
@@ -11626,12 +12216,16 @@ int setup_tests(void)
     ADD_ALL_TESTS(test_multiblock_write, OSSL_NELEM(multiblock_cipherlist_data));
 #endif
     ADD_ALL_TESTS(test_servername, 10);
+    ADD_ALL_TESTS(test_servername_ctx, 6);
 #if !defined(OPENSSL_NO_EC) \
     && (!defined(OSSL_NO_USABLE_TLS1_3) || !defined(OPENSSL_NO_TLS1_2))
     ADD_ALL_TESTS(test_sigalgs_available, 6);
 #endif
 #ifndef OPENSSL_NO_TLS1_3
     ADD_ALL_TESTS(test_pluggable_group, 2);
+# ifndef OPENSSL_NO_ML_KEM
+    ADD_ALL_TESTS(test_ml_kem_group, 2);
+# endif
     ADD_ALL_TESTS(test_pluggable_signature, 4);
 #endif
 #ifndef OPENSSL_NO_TLS1_2
@@ -11661,6 +12255,11 @@ int setup_tests(void)
 #if !defined(OPENSSL_NO_TLS1_2) && !defined(OPENSSL_NO_DYNAMIC_ENGINE)
     ADD_ALL_TESTS(test_pipelining, 7);
 #endif
+#ifndef OPENSSL_NO_TLS1_2
+    ADD_ALL_TESTS(test_pipelining_aead, 3);
+#endif
+    ADD_ALL_TESTS(test_dynamic_record_sizing, 2);
+    ADD_ALL_TESTS(test_hibernate, 2);
     ADD_ALL_TESTS(test_version, 6);
     ADD_TEST(test_rstate_string);
     ADD_ALL_TESTS(test_handshake_retry, 16);
@@ -1,5 +1,5 @@
 /*
- * Copyright 2016-2023 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2016-2024 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -518,7 +518,8 @@ static int test_multi_fetch_worker(void)
                            2, &thread_multi_simple_fetch, 1, default_provider);
 }
 
-static int test_multi_shared_pkey_common(void (*worker)(void))
+static int test_multi_shared_pkey_common(void (*worker)(void),
+                                         size_t num_workers)
 {
     int testresult = 0;
 
@@ -527,7 +528,7 @@ static int test_multi_shared_pkey_common(void (*worker)(void))
                                         : default_provider)
             || !TEST_ptr(shared_evp_pkey = load_pkey_pem(privkey, multi_libctx))
             || !start_threads(1, &thread_shared_evp_pkey)
-            || !start_threads(1, worker))
+            || !start_threads(num_workers, worker))
         goto err;
 
     thread_shared_evp_pkey();
@@ -555,13 +556,31 @@ static void thread_downgrade_shared_evp_pkey(void)
 
 static int test_multi_downgrade_shared_pkey(void)
 {
-    return test_multi_shared_pkey_common(&thread_downgrade_shared_evp_pkey);
+    return test_multi_shared_pkey_common(&thread_downgrade_shared_evp_pkey, 1);
 }
 #endif
 
 static int test_multi_shared_pkey(void)
 {
-    return test_multi_shared_pkey_common(&thread_shared_evp_pkey);
+    return test_multi_shared_pkey_common(&thread_shared_evp_pkey, 1);
+}
+
+static void thread_shared_evp_pkey_repeat(void)
+{
+    int i;
+
+    for (i = 0; i < 4; i++)
+        thread_shared_evp_pkey();
+}
+
+/*
+ * Several threads repeatedly decrypting with the same key, so that each
+ * reuses a blinding of its own
+ */
+static int test_multi_shared_pkey_many(void)
+{
+    return test_multi_shared_pkey_common(&thread_shared_evp_pkey_repeat,
+                                         MAXIMUM_THREADS - 1);
 }
 
 static int test_multi_load_unload_provider(void)
@@ -858,6 +877,7 @@ int setup_tests(void)
     ADD_TEST(test_multi_general_worker_fips_provider);
     ADD_TEST(test_multi_fetch_worker);
     ADD_TEST(test_multi_shared_pkey);
+    ADD_TEST(test_multi_shared_pkey_many);
 #ifndef OPENSSL_NO_DEPRECATED_3_0
     ADD_TEST(test_multi_downgrade_shared_pkey);
 #endif
@@ -1,5 +1,5 @@
 /*
- * Copyright 2020-2022 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2020-2024 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -17,6 +17,7 @@
 # include <sys/resource.h>
 # include <openssl/pem.h>
 # include <openssl/x509.h>
+# include <openssl/pkcs7.h>
 # include <openssl/err.h>
 # include <openssl/bio.h>
 # include "internal/e_os.h"
@@ -75,6 +76,25 @@ static void readpkey(const char *contents, int size)
     BIO_free(b);
 }
 
+static void readpkcs7(const char *contents, int size)
+{
+    BIO *b = BIO_new_mem_buf(contents, size);
+    PKCS7 *p7;
+
+    if (b == NULL) {
+        ERR_print_errors_fp(stderr);
+        exit(EXIT_FAILURE);
+    }
+    p7 = PEM_read_bio_PKCS7(b, NULL, NULL, NULL);
+    if (p7 == NULL) {
+        ERR_print_errors_fp(stderr);
+        exit(EXIT_FAILURE);
+    }
+
+    PKCS7_free(p7);
+    BIO_free(b);
+}
+
 static void print_timeval(const char *what, struct timeval *tp)
 {
     printf("%s %d sec %d microsec\n", what, (int)tp->tv_sec, (int)tp->tv_usec);
@@ -89,6 +109,7 @@ static void usage(void)
     fprintf(stderr, "  -w<T> What to load T is a single character:\n");
     fprintf(stderr, "          c for cert\n");
     fprintf(stderr, "          p for private key\n");
+    fprintf(stderr, "          7 for PKCS#7 structure\n");
     exit(EXIT_FAILURE);
 }
 # endif
@@ -127,6 +148,7 @@ int main(int ac, char **av)
                 break;
             case 'c':
             case 'p':
+            case '7':
                 what = *optarg;
                 break;
             }
@@ -167,6 +189,9 @@ int main(int ac, char **av)
         case 'p':
             readpkey(contents, (int)sb.st_size);
             break;
+        case '7':
+            readpkcs7(contents, (int)sb.st_size);
+            break;
         }
     }
 
@@ -186,6 +211,9 @@ int main(int ac, char **av)
         case 'p':
             readpkey(contents, (int)sb.st_size);
             break;
+        case '7':
+            readpkcs7(contents, (int)sb.st_size);
+            break;
         }
     }
     if (getrusage(RUSAGE_SELF, &end) < 0) {
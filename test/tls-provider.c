@@ -2164,6 +2164,13 @@ struct X509_pubkey_st {
     /* extra data for the callback, used by d2i_PUBKEY_ex */
     OSSL_LIB_CTX *libctx;
     char *propq;
+
+    /* Flag to force legacy keys */
+    unsigned int flag_force_legacy : 1;
+
+    /* Used to decode keys read by d2i when first used */
+    CRYPTO_RWLOCK *lock;
+    volatile int pkey_pending;
 };
 
 ASN1_SEQUENCE(X509_PUBKEY_INTERNAL) = {
@@ -104,6 +104,65 @@ static int test_alt_chains_cert_forgery(void)
     return ret;
 }
 
+static int test_store_lookup(void)
+{
+    STACK_OF(X509) *roots = load_certs_pem(roots_f);
+    STACK_OF(X509) *untrusted = load_certs_pem(untrusted_f);
+    STACK_OF(X509) *found = NULL;
+    STACK_OF(X509_OBJECT) *objs = NULL;
+    X509_STORE *store = X509_STORE_new();
+    X509_STORE_CTX *ctx = X509_STORE_CTX_new();
+    const X509_NAME *nm;
+    int i, ret = 0;
+
+    if (!TEST_ptr(roots)
+            || !TEST_ptr(untrusted)
+            || !TEST_ptr(store)
+            || !TEST_ptr(ctx))
+        goto err;
+
+    /* Duplicates are only added once */
+    for (i = 0; i < 2; i++) {
+        if (!TEST_true(X509_STORE_add_cert(store, sk_X509_value(roots, 0)))
+                || !TEST_true(X509_STORE_add_cert(store,
+                                                  sk_X509_value(roots, 1)))
+                || !TEST_true(X509_STORE_add_cert(store,
+                                                  sk_X509_value(untrusted, 0))))
+            goto err;
+    }
+    if (!TEST_ptr(objs = X509_STORE_get1_objects(store))
+            || !TEST_int_eq(sk_X509_OBJECT_num(objs), 3))
+        goto err;
+
+    /* Both versions of subinterCA have the same subject */
+    nm = X509_get_subject_name(sk_X509_value(untrusted, 0));
+    if (!TEST_true(X509_STORE_CTX_init(ctx, store, NULL, NULL))
+            || !TEST_ptr(found = X509_STORE_CTX_get1_certs(ctx, nm))
+            || !TEST_int_eq(sk_X509_num(found), 2)
+            || !TEST_int_eq(X509_cmp(sk_X509_value(found, 0),
+                                     sk_X509_value(roots, 1)), 0)
+            || !TEST_int_eq(X509_cmp(sk_X509_value(found, 1),
+                                     sk_X509_value(untrusted, 0)), 0))
+        goto err;
+    OSSL_STACK_OF_X509_free(found);
+
+    /* Nothing is found for the leaf, which is not in the store */
+    nm = X509_get_subject_name(sk_X509_value(untrusted, 1));
+    if (!TEST_ptr(found = X509_STORE_CTX_get1_certs(ctx, nm))
+            || !TEST_int_eq(sk_X509_num(found), 0))
+        goto err;
+
+    ret = 1;
+ err:
+    OSSL_STACK_OF_X509_free(found);
+    sk_X509_OBJECT_pop_free(objs, X509_OBJECT_free);
+    X509_STORE_CTX_free(ctx);
+    X509_STORE_free(store);
+    OSSL_STACK_OF_X509_free(roots);
+    OSSL_STACK_OF_X509_free(untrusted);
+    return ret;
+}
+
 static int test_distinguishing_id(void)
 {
     X509 *x = NULL;
@@ -290,6 +349,192 @@ static int test_purpose_any(void)
     return do_test_purpose(X509_PURPOSE_ANY, 1);
 }
 
+static int lookup_calls = 0;
+
+static int counting_get_by_subject(X509_LOOKUP *lookup, X509_LOOKUP_TYPE type,
+                                   const X509_NAME *name, X509_OBJECT *ret)
+{
+    lookup_calls++;
+    return 0;
+}
+
+static int verify_cached(X509_STORE *store, X509 *x, STACK_OF(X509) *untrusted,
+                         const char *host, int expected_calls)
+{
+    X509_STORE_CTX *ctx = X509_STORE_CTX_new();
+    int ret = -1;
+
+    lookup_calls = 0;
+    if (!TEST_ptr(ctx)
+            || !TEST_true(X509_STORE_CTX_init(ctx, store, x, untrusted))
+            || (host != NULL
+                && !TEST_true(X509_VERIFY_PARAM_set1_host(X509_STORE_CTX_get0_param(ctx),
+                                                          host, 0))))
+        goto err;
+    ret = X509_verify_cert(ctx);
+    if (ret > 0 && !TEST_int_eq(X509_STORE_CTX_get_num_untrusted(ctx), 2))
+        ret = -1;
+    if (ret > 0 && !TEST_int_eq(sk_X509_num(X509_STORE_CTX_get0_chain(ctx)), 3))
+        ret = -1;
+    /* The store is only searched when the chain is actually built */
+    if (expected_calls && !TEST_int_gt(lookup_calls, 0))
+        ret = -1;
+    if (!expected_calls && !TEST_int_eq(lookup_calls, 0))
+        ret = -1;
+ err:
+    X509_STORE_CTX_free(ctx);
+    return ret;
+}
+
+static int test_verify_cache(void)
+{
+    X509 *eecert = load_cert_from_file(ee_cert);
+    X509 *untrcert = load_cert_from_file(ca_cert);
+    X509 *trcert = load_cert_from_file(sroot_cert);
+    X509 *othercert = load_cert_from_file(bad_f);
+    STACK_OF(X509) *untrusted = sk_X509_new_null();
+    X509_STORE *store = X509_STORE_new();
+    X509_LOOKUP_METHOD *meth = X509_LOOKUP_meth_new("counting");
+    int testresult = 0;
+
+    if (!TEST_ptr(eecert)
+            || !TEST_ptr(untrcert)
+            || !TEST_ptr(trcert)
+            || !TEST_ptr(othercert)
+            || !TEST_ptr(untrusted)
+            || !TEST_ptr(store)
+            || !TEST_ptr(meth)
+            || !TEST_true(X509_LOOKUP_meth_set_get_by_subject(meth,
+                                                              counting_get_by_subject))
+            || !TEST_ptr(X509_STORE_add_lookup(store, meth))
+            || !TEST_true(X509_STORE_add_cert(store, trcert))
+            || !TEST_true(sk_X509_push(untrusted, untrcert)))
+        goto err;
+    untrcert = NULL;
+
+    /* Nothing is cached unless the cache is enabled */
+    if (!TEST_int_eq(verify_cached(store, eecert, untrusted, NULL, 1), 1)
+            || !TEST_int_eq(verify_cached(store, eecert, untrusted, NULL, 1), 1))
+        goto err;
+
+    if (!TEST_true(X509_STORE_set_verify_cache_size(store, 16))
+            || !TEST_int_eq(verify_cached(store, eecert, untrusted, NULL, 1), 1)
+            || !TEST_int_eq(verify_cached(store, eecert, untrusted, NULL, 0), 1))
+        goto err;
+
+    /* Host name checks are repeated on a cache hit */
+    if (!TEST_int_eq(verify_cached(store, eecert, untrusted,
+                                   "server.example", 0), 1)
+            || !TEST_int_eq(verify_cached(store, eecert, untrusted,
+                                          "other.example", 0), 0))
+        goto err;
+
+    /* A different set of untrusted certificates is a different entry */
+    if (!TEST_int_eq(verify_cached(store, eecert, NULL, NULL, 1), 0))
+        goto err;
+
+    /* Changing the store empties the cache */
+    if (!TEST_true(X509_STORE_add_cert(store, othercert))
+            || !TEST_int_eq(verify_cached(store, eecert, untrusted, NULL, 1), 1)
+            || !TEST_int_eq(verify_cached(store, eecert, untrusted, NULL, 0), 1))
+        goto err;
+
+    if (!TEST_true(X509_STORE_set_verify_cache_size(store, 0))
+            || !TEST_int_eq(verify_cached(store, eecert, untrusted, NULL, 1), 1))
+        goto err;
+
+    testresult = 1;
+ err:
+    X509_STORE_free(store);
+    X509_LOOKUP_meth_free(meth);
+    OSSL_STACK_OF_X509_free(untrusted);
+    X509_free(eecert);
+    X509_free(untrcert);
+    X509_free(trcert);
+    X509_free(othercert);
+    return testresult;
+}
+
+static int test_snapshot(void)
+{
+    const char *snapfile = "verify_extra_test.snap";
+    X509 *eecert = load_cert_from_file(ee_cert);
+    X509 *untrcert = load_cert_from_file(ca_cert);
+    X509 *trcert = load_cert_from_file(sroot_cert);
+    X509 *othercert = load_cert_from_file(bad_f);
+    STACK_OF(X509) *untrusted = sk_X509_new_null();
+    STACK_OF(X509_OBJECT) *objs = NULL;
+    X509_STORE *store = X509_STORE_new();
+    X509_STORE *snapstore = X509_STORE_new();
+    X509_STORE_CTX *ctx = X509_STORE_CTX_new();
+    BIO *out = NULL;
+    int testresult = 0;
+
+    if (!TEST_ptr(eecert)
+            || !TEST_ptr(untrcert)
+            || !TEST_ptr(trcert)
+            || !TEST_ptr(othercert)
+            || !TEST_ptr(untrusted)
+            || !TEST_ptr(store)
+            || !TEST_ptr(snapstore)
+            || !TEST_ptr(ctx)
+            || !TEST_true(X509_STORE_add_cert(store, trcert))
+            || !TEST_true(X509_STORE_add_cert(store, othercert))
+            || !TEST_true(sk_X509_push(untrusted, untrcert)))
+        goto err;
+    untrcert = NULL;
+
+    if (!TEST_ptr(out = BIO_new_file(snapfile, "wb"))
+            || !TEST_true(X509_STORE_write_snapshot(store, out)))
+        goto err;
+    BIO_free(out);
+    out = NULL;
+
+    /* Nothing is decoded when the snapshot is attached */
+    if (!TEST_true(X509_STORE_load_snapshot(snapstore, snapfile))
+            || !TEST_ptr(objs = X509_STORE_get1_objects(snapstore))
+            || !TEST_int_eq(sk_X509_OBJECT_num(objs), 0))
+        goto err;
+    sk_X509_OBJECT_pop_free(objs, X509_OBJECT_free);
+    objs = NULL;
+
+    /* Only the trust anchor that is needed is decoded */
+    if (!TEST_true(X509_STORE_CTX_init(ctx, snapstore, eecert, untrusted))
+            || !TEST_int_eq(X509_verify_cert(ctx), 1)
+            || !TEST_int_eq(sk_X509_num(X509_STORE_CTX_get0_chain(ctx)), 3)
+            || !TEST_ptr(objs = X509_STORE_get1_objects(snapstore))
+            || !TEST_int_eq(sk_X509_OBJECT_num(objs), 1)
+            || !TEST_int_eq(X509_cmp(X509_OBJECT_get0_X509(sk_X509_OBJECT_value(objs, 0)),
+                                     trcert), 0))
+        goto err;
+
+    /* Garbage is rejected */
+    if (!TEST_ptr(out = BIO_new_file(snapfile, "wb"))
+            || !TEST_int_eq(BIO_puts(out, "OSSLSNP1garbage!"), 16))
+        goto err;
+    BIO_free(out);
+    out = NULL;
+    X509_STORE_free(snapstore);
+    if (!TEST_ptr(snapstore = X509_STORE_new())
+            || !TEST_false(X509_STORE_load_snapshot(snapstore, snapfile)))
+        goto err;
+
+    testresult = 1;
+ err:
+    BIO_free(out);
+    remove(snapfile);
+    sk_X509_OBJECT_pop_free(objs, X509_OBJECT_free);
+    X509_STORE_CTX_free(ctx);
+    X509_STORE_free(store);
+    X509_STORE_free(snapstore);
+    OSSL_STACK_OF_X509_free(untrusted);
+    X509_free(eecert);
+    X509_free(untrcert);
+    X509_free(trcert);
+    X509_free(othercert);
+    return testresult;
+}
+
 OPT_TEST_DECLARE_USAGE("certs-dir\n")
 
 int setup_tests(void)
@@ -314,6 +559,7 @@ int setup_tests(void)
 
     ADD_TEST(test_alt_chains_cert_forgery);
     ADD_TEST(test_store_ctx);
+    ADD_TEST(test_store_lookup);
     ADD_TEST(test_distinguishing_id);
     ADD_TEST(test_req_distinguishing_id);
     ADD_TEST(test_self_signed_good);
@@ -322,6 +568,8 @@ int setup_tests(void)
     ADD_TEST(test_purpose_ssl_client);
     ADD_TEST(test_purpose_ssl_server);
     ADD_TEST(test_purpose_any);
+    ADD_TEST(test_verify_cache);
+    ADD_TEST(test_snapshot);
     return 1;
  err:
     cleanup_tests();
@@ -1,5 +1,5 @@
 /*
- * Copyright 2016-2021 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2016-2024 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the Apache License 2.0 (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -16,6 +16,7 @@
 #include <openssl/x509v3.h>
 #include "testutil.h"
 #include "internal/nelem.h"
+#include "crypto/x509.h"
 
 /**********************************************************************
  *
@@ -102,9 +103,192 @@ static int test_a2i_ipaddress(int idx)
     return good;
 }
 
+/*
+ * Name constraints of a CA certificate are checked through an index built
+ * when its extensions are cached. It must give the same results as checking
+ * the NAME_CONSTRAINTS directly.
+ */
+#define NC_TEST_CONSTRAINTS \
+    "permitted;DNS:example.com, permitted;DNS:.Example.ORG, " \
+    "excluded;DNS:bad.example.com, " \
+    "permitted;IP:10.0.0.0/255.0.0.0, " \
+    "permitted;IP:2001:db8::/ffff:ffff::, " \
+    "excluded;IP:10.9.0.0/255.255.0.0"
+
+typedef struct {
+    const char *san;
+    int expected;
+} NC_TESTDATA;
+
+static NC_TESTDATA nc_index_tests[] = {
+    {"DNS:example.com", X509_V_OK},
+    {"DNS:WWW.Example.COM", X509_V_OK},
+    {"DNS:badexample.com", X509_V_ERR_PERMITTED_VIOLATION},
+    {"DNS:a.b.example.org", X509_V_OK},
+    {"DNS:example.org", X509_V_ERR_PERMITTED_VIOLATION},
+    {"DNS:bad.example.com", X509_V_ERR_EXCLUDED_VIOLATION},
+    {"DNS:x.Bad.example.com", X509_V_ERR_EXCLUDED_VIOLATION},
+    {"DNS:example.net", X509_V_ERR_PERMITTED_VIOLATION},
+    {"IP:10.1.2.3", X509_V_OK},
+    {"IP:10.9.1.1", X509_V_ERR_EXCLUDED_VIOLATION},
+    {"IP:11.0.0.1", X509_V_ERR_PERMITTED_VIOLATION},
+    {"IP:2001:db8::1", X509_V_OK},
+    {"IP:2001:db9::1", X509_V_ERR_PERMITTED_VIOLATION},
+    {"email:a@example.net", X509_V_OK},
+};
+
+static X509 *nc_test_cert(int nid, const char *value)
+{
+    X509 *x = X509_new();
+    X509_EXTENSION *ext = X509V3_EXT_conf_nid(NULL, NULL, nid, value);
+
+    if (!TEST_ptr(x) || !TEST_ptr(ext) || !TEST_true(X509_add_ext(x, ext, -1))
+            || !TEST_int_ge(X509_check_purpose(x, -1, 0), 0)) {
+        X509_free(x);
+        x = NULL;
+    }
+    X509_EXTENSION_free(ext);
+    return x;
+}
+
+static int test_name_constraints_index(int idx)
+{
+    X509 *ca = NULL, *x = NULL;
+    int ret = 0;
+
+    if (!TEST_ptr(ca = nc_test_cert(NID_name_constraints,
+                                    NC_TEST_CONSTRAINTS))
+            || !TEST_ptr(ca->nc_index)
+            || !TEST_ptr(x = nc_test_cert(NID_subject_alt_name,
+                                          nc_index_tests[idx].san)))
+        goto err;
+
+    if (!TEST_int_eq(NAME_CONSTRAINTS_check(x, ca->nc),
+                     nc_index_tests[idx].expected)
+            || !TEST_int_eq(ossl_x509_check_name_constraints(x, ca),
+                            nc_index_tests[idx].expected))
+        goto err;
+    ret = 1;
+
+ err:
+    X509_free(ca);
+    X509_free(x);
+    return ret;
+}
+
+/*
+ * The index doesn't change which certificates are rejected for having too
+ * many names and constraints to check.
+ */
+static int test_name_constraints_limit(int idx)
+{
+    const char *type = idx == 0 ? "DNS" : "email";
+    const char *prefix = idx == 0 ? "" : "a@";
+    X509 *ca = NULL, *x = NULL;
+    BIO *nc = NULL, *san = NULL;
+    char *ncstr, *sanstr;
+    int i, ret = 0;
+
+    if (!TEST_ptr(nc = BIO_new(BIO_s_mem()))
+            || !TEST_ptr(san = BIO_new(BIO_s_mem())))
+        goto err;
+    /* More than the NAME_CHECK_MAX of 1 << 20 pairs of names and constraints */
+    for (i = 0; i < 1100; i++) {
+        if (!TEST_int_gt(BIO_printf(nc, "%spermitted;%s:t%d.test",
+                                    i == 0 ? "" : ",", type, i), 0)
+                || !TEST_int_gt(BIO_printf(san, "%s%s:%st%d.test",
+                                           i == 0 ? "" : ",", type, prefix,
+                                           i), 0))
+            goto err;
+    }
+    if (!TEST_int_eq(BIO_write(nc, "", 1), 1)
+            || !TEST_int_eq(BIO_write(san, "", 1), 1))
+        goto err;
+    BIO_get_mem_data(nc, &ncstr);
+    BIO_get_mem_data(san, &sanstr);
+    if (!TEST_ptr(ca = nc_test_cert(NID_name_constraints, ncstr))
+            || !TEST_ptr(x = nc_test_cert(NID_subject_alt_name, sanstr)))
+        goto err;
+
+    if (!TEST_int_eq(NAME_CONSTRAINTS_check(x, ca->nc),
+                     X509_V_ERR_UNSPECIFIED)
+            || !TEST_int_eq(ossl_x509_check_name_constraints(x, ca),
+                            X509_V_ERR_UNSPECIFIED))
+        goto err;
+    ret = 1;
+
+ err:
+    BIO_free(nc);
+    BIO_free(san);
+    X509_free(ca);
+    X509_free(x);
+    return ret;
+}
+
+/*
+ * A dNSName with many labels is matched in time linear in its length, and
+ * is rejected once its labels exceed the limit on the work of the check.
+ */
+static int test_name_constraints_labels(int idx)
+{
+    /* Test 0 = 100000 labels, test 1 = more than NAME_CHECK_MAX labels */
+    size_t labels = idx == 0 ? 100000 : (1 << 20) + 1, i;
+    X509 *ca = NULL, *x = NULL;
+    GENERAL_NAMES *gens = NULL;
+    GENERAL_NAME *gen = NULL;
+    ASN1_IA5STRING *dns = NULL;
+    unsigned char *name = NULL;
+    int ret = 0;
+
+    /* "a.a. ... a.example.net" */
+    if (!TEST_ptr(name = OPENSSL_malloc(labels * 2 + sizeof("example.net"))))
+        goto err;
+    for (i = 0; i < labels; i++) {
+        name[2 * i] = 'a';
+        name[2 * i + 1] = '.';
+    }
+    memcpy(name + 2 * labels, "example.net", sizeof("example.net") - 1);
+
+    if (!TEST_ptr(ca = nc_test_cert(NID_name_constraints,
+                                    NC_TEST_CONSTRAINTS))
+            || !TEST_ptr(x = X509_new())
+            || !TEST_ptr(gens = GENERAL_NAMES_new())
+            || !TEST_ptr(gen = GENERAL_NAME_new())
+            || !TEST_ptr(dns = ASN1_IA5STRING_new())
+            || !TEST_true(ASN1_STRING_set(dns, name,
+                                          (int)(labels * 2 + 11))))
+        goto err;
+    GENERAL_NAME_set0_value(gen, GEN_DNS, dns);
+    dns = NULL;
+    if (!TEST_true(sk_GENERAL_NAME_push(gens, gen)))
+        goto err;
+    gen = NULL;
+    if (!TEST_true(X509_add1_ext_i2d(x, NID_subject_alt_name, gens, 0, 0))
+            || !TEST_int_ge(X509_check_purpose(x, -1, 0), 0))
+        goto err;
+
+    if (!TEST_int_eq(ossl_x509_check_name_constraints(x, ca),
+                     idx == 0 ? X509_V_ERR_PERMITTED_VIOLATION
+                              : X509_V_ERR_UNSPECIFIED))
+        goto err;
+    ret = 1;
+
+ err:
+    OPENSSL_free(name);
+    ASN1_IA5STRING_free(dns);
+    GENERAL_NAME_free(gen);
+    GENERAL_NAMES_free(gens);
+    X509_free(ca);
+    X509_free(x);
+    return ret;
+}
+
 int setup_tests(void)
 {
     ADD_TEST(test_standard_exts);
     ADD_ALL_TESTS(test_a2i_ipaddress, OSSL_NELEM(a2i_ipaddress_tests));
+    ADD_ALL_TESTS(test_name_constraints_index, OSSL_NELEM(nc_index_tests));
+    ADD_ALL_TESTS(test_name_constraints_limit, 2);
+    ADD_ALL_TESTS(test_name_constraints_labels, 2);
     return 1;
 }
@@ -114,6 +114,152 @@ static int test_x509_crl_tbs_cache(void)
     return ret;
 }
 
+/*
+ * A successful X509_verify() is remembered on the certificate, make sure that
+ * this is never used for another key or after the certificate changes.
+ */
+static int test_x509_verify_memo(void)
+{
+    int ret = 0;
+    X509 *x = NULL, *y = NULL;
+    EVP_PKEY *otherkey = NULL;
+    ASN1_TIME *tm = NULL;
+    unsigned char *der = NULL;
+    const unsigned char *p = certdata;
+    int derlen;
+
+    if (!TEST_ptr(x = d2i_X509(NULL, &p, sizeof(certdata)))
+            || !TEST_int_gt(X509_sign(x, privkey, signmd), 0)
+            || !TEST_int_gt(derlen = i2d_X509(x, &der), 0))
+        goto err;
+    p = der;
+    if (!TEST_ptr(y = d2i_X509(NULL, &p, derlen))
+            || !TEST_ptr(otherkey = EVP_PKEY_Q_keygen(NULL, NULL, "EC",
+                                                      "P-256"))
+            || !TEST_int_eq(X509_verify(y, pubkey), 1)
+            || !TEST_int_eq(X509_verify(y, pubkey), 1)
+            || !TEST_int_eq(X509_verify(y, privkey), 1)
+            || !TEST_int_le(X509_verify(y, otherkey), 0)
+            || !TEST_ptr(tm = ASN1_TIME_set(NULL, 0))
+            || !TEST_true(X509_set1_notAfter(y, tm))
+            || !TEST_int_le(X509_verify(y, pubkey), 0))
+        goto err;
+    ret = 1;
+ err:
+    ASN1_TIME_free(tm);
+    EVP_PKEY_free(otherkey);
+    OPENSSL_free(der);
+    X509_free(y);
+    X509_free(x);
+    return ret;
+}
+
+/*
+ * The public key of a decoded certificate is only decoded into an EVP_PKEY
+ * when it is first used, check that this is transparent.
+ */
+static int test_x509_pubkey_deferred(void)
+{
+    int ret = 0;
+    X509 *x = NULL, *y = NULL;
+    X509_PUBKEY *xpk = NULL;
+    EVP_PKEY *pk;
+    const unsigned char *p = certdata;
+
+    if (!TEST_ptr(x = d2i_X509(NULL, &p, sizeof(certdata))))
+        goto err;
+    p = certdata;
+    if (!TEST_ptr(y = d2i_X509(NULL, &p, sizeof(certdata)))
+            || !TEST_ptr(xpk = X509_PUBKEY_dup(X509_get_X509_PUBKEY(x)))
+            || !TEST_int_eq(X509_PUBKEY_eq(xpk, X509_get_X509_PUBKEY(y)), 1)
+            || !TEST_ptr(pk = X509_get0_pubkey(x))
+            || !TEST_ptr_eq(X509_get0_pubkey(x), pk)
+            || !TEST_ptr_eq(X509_PUBKEY_get0(X509_get_X509_PUBKEY(x)), pk)
+            || !TEST_int_eq(EVP_PKEY_eq(X509_PUBKEY_get0(xpk), pk), 1)
+            || !TEST_int_eq(EVP_PKEY_eq(X509_get0_pubkey(y), pk), 1))
+        goto err;
+    ret = 1;
+ err:
+    X509_PUBKEY_free(xpk);
+    X509_free(y);
+    X509_free(x);
+    return ret;
+}
+
+/*
+ * Malformed key bits are rejected by d2i, even though the key itself is only
+ * decoded on first use.
+ */
+static const unsigned char spki_rsa[] = {
+    0x30, 0x1a, 0x30, 0x0d, 0x06, 0x09, 0x2a, 0x86, 0x48, 0x86, 0xf7, 0x0d,
+    0x01, 0x01, 0x01, 0x05, 0x00, 0x03, 0x09, 0x00, 0x30, 0x06, 0x02, 0x01,
+    0x03, 0x02, 0x01, 0x03
+};
+
+/* The RSAPublicKey is followed by a spurious zero octet */
+static const unsigned char spki_rsa_trailing[] = {
+    0x30, 0x1b, 0x30, 0x0d, 0x06, 0x09, 0x2a, 0x86, 0x48, 0x86, 0xf7, 0x0d,
+    0x01, 0x01, 0x01, 0x05, 0x00, 0x03, 0x0a, 0x00, 0x30, 0x06, 0x02, 0x01,
+    0x03, 0x02, 0x01, 0x03, 0x00
+};
+
+/* The RSAPublicKey claims to be longer than the key bits */
+static const unsigned char spki_rsa_truncated[] = {
+    0x30, 0x1a, 0x30, 0x0d, 0x06, 0x09, 0x2a, 0x86, 0x48, 0x86, 0xf7, 0x0d,
+    0x01, 0x01, 0x01, 0x05, 0x00, 0x03, 0x09, 0x00, 0x30, 0x07, 0x02, 0x01,
+    0x03, 0x02, 0x01, 0x03
+};
+
+static int test_x509_pubkey_malformed(void)
+{
+    static const struct {
+        const unsigned char *der;
+        size_t len;
+        int ok;
+    } tests[] = {
+        { spki_rsa, sizeof(spki_rsa), 1 },
+        { spki_rsa_trailing, sizeof(spki_rsa_trailing), 0 },
+        { spki_rsa_truncated, sizeof(spki_rsa_truncated), 0 },
+    };
+    unsigned char ed[12 + 32] = {
+        0x30, 0x2a, 0x30, 0x05, 0x06, 0x03, 0x2b, 0x65, 0x70, 0x03, 0x21, 0x00
+    };
+    X509_PUBKEY *xpk;
+    const unsigned char *p;
+    size_t i;
+
+    for (i = 0; i < OSSL_NELEM(tests); i++) {
+        p = tests[i].der;
+        xpk = d2i_X509_PUBKEY(NULL, &p, (long)tests[i].len);
+        X509_PUBKEY_free(xpk);
+        if (!TEST_int_eq(xpk != NULL, tests[i].ok)) {
+            TEST_info("SPKI %zu", i);
+            return 0;
+        }
+    }
+
+    /* An Ed25519 key of the right length */
+    p = ed;
+    xpk = d2i_X509_PUBKEY(NULL, &p, sizeof(ed));
+    X509_PUBKEY_free(xpk);
+    if (!TEST_ptr(xpk))
+        return 0;
+
+    /* One octet short */
+    ed[1]--;
+    ed[10]--;
+    p = ed;
+    if (!TEST_ptr_null(d2i_X509_PUBKEY(NULL, &p, sizeof(ed) - 1)))
+        return 0;
+
+    /* Not a whole number of octets */
+    ed[1]++;
+    ed[10]++;
+    ed[11] = 1;
+    p = ed;
+    return TEST_ptr_null(d2i_X509_PUBKEY(NULL, &p, sizeof(ed)));
+}
+
 int setup_tests(void)
 {
     const unsigned char *p;
@@ -138,6 +284,9 @@ int setup_tests(void)
 
     ADD_TEST(test_x509_tbs_cache);
     ADD_TEST(test_x509_crl_tbs_cache);
+    ADD_TEST(test_x509_verify_memo);
+    ADD_TEST(test_x509_pubkey_deferred);
+    ADD_TEST(test_x509_pubkey_malformed);
     return 1;
 }
 